@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO application bundle format (one dataset, sorted TOC + blobs).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_bundle | struct | Validated view of a bundle image |
+ * | luaz_bundle_item | struct | Module name and blob for the bundle writer |
+ * | luaz_bundle_open | function | Validate a bundle image and set up a view |
+ * | luaz_bundle_find | function | Binary-search the TOC for a module |
+ * | luaz_bundle_entry | function | Return a TOC entry by index |
+ * | luaz_bundle_build | function | Build a bundle image from modules |
+ *
+ * Bundle layout (all integers big-endian u32):
+ * - Header (32 bytes): magic "LZAB", version, entry count, TOC offset,
+ *   name table length, data offset, total length, CRC32 of TOC + names.
+ * - TOC (20 bytes per entry, sorted by name bytes): name offset,
+ *   name length, blob offset, blob length, blob CRC32.
+ * - Name table, then blobs (Lua source or lua_dump output).
+ * Names and sources are stored in the code page of the packing platform;
+ * build the bundle where it runs. Bytes past the total length (for
+ * example RECFM=FB padding) are ignored.
+ */
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_BUNDLE_VERSION 1u
+#define LUAZ_BUNDLE_HDR_LEN 32u
+#define LUAZ_BUNDLE_TOC_LEN 20u
+
+struct luaz_bundle {
+  const unsigned char *base;
+  unsigned long len;
+  unsigned long count;
+  const unsigned char *toc;
+  const unsigned char *names;
+  unsigned long names_len;
+};
+
+struct luaz_bundle_item {
+  const char *name;
+  const char *data;
+  unsigned long len;
+};
+
+/**
+ * @brief Validate a bundle image and set up a view over it.
+ *
+ * Checks the header, TOC/name table bounds and CRC32, and every blob
+ * range. The image is not copied; it must outlive the view.
+ *
+ * @param b Output view.
+ * @param buf Bundle image.
+ * @param len Image length in bytes (may include trailing padding).
+ * @return 0 on success, or LUZ_E_BUNDLE on a malformed image.
+ */
+int luaz_bundle_open(struct luaz_bundle *b, const void *buf,
+                     unsigned long len);
+
+/**
+ * @brief Find a module in the bundle TOC (binary search).
+ *
+ * @param b Bundle view.
+ * @param name Module name.
+ * @param data Output blob pointer (into the image).
+ * @param len Output blob length.
+ * @return 1 when found, 0 when absent, or LUZ_E_BUNDLE on blob CRC mismatch.
+ */
+int luaz_bundle_find(const struct luaz_bundle *b, const char *name,
+                     const char **data, unsigned long *len);
+
+/**
+ * @brief Return a TOC entry by index (TOC order).
+ *
+ * @param b Bundle view.
+ * @param index 0-based entry index.
+ * @param name Output name pointer (not NUL-terminated).
+ * @param name_len Output name length.
+ * @param data_len Output blob length (may be NULL).
+ * @return 0 on success, or LUZ_E_BUNDLE if index is out of range.
+ */
+int luaz_bundle_entry(const struct luaz_bundle *b, unsigned long index,
+                      const char **name, unsigned long *name_len,
+                      unsigned long *data_len);
+
+/**
+ * @brief Build a bundle image from a list of modules.
+ *
+ * Items are sorted by name in place. The image is allocated with malloc()
+ * and owned by the caller.
+ *
+ * @param items Modules (name, blob, blob length).
+ * @param count Number of items.
+ * @param out Output image pointer.
+ * @param out_len Output image length.
+ * @return 0 on success, or LUZ_E_BUNDLE on duplicate/invalid names or
+ *         allocation failure.
+ */
+int luaz_bundle_build(struct luaz_bundle_item *items, unsigned long count,
+                      char **out, unsigned long *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUNDLE_H */
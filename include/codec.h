@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO character set conversion (codec module, ds encoding= option).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | LUAZ_CODEC_* | macro | Encoding ids and conversion kinds |
+ * | luaz_codec | struct | Prepared conversion between two encodings |
+ * | luaz_codec_find | function | Look up an encoding name |
+ * | luaz_codec_name | function | Canonical name of an encoding id |
+ * | luaz_codec_newline | function | Newline byte of an encoding |
+ * | luaz_codec_space | function | Blank byte of an encoding |
+ * | luaz_codec_init | function | Prepare a conversion |
+ * | luaz_codec_text | function | Map one newline byte onto another |
+ * | luaz_codec_bound | function | Worst-case output size |
+ * | luaz_codec_run | function | Convert a byte range |
+ * | luaz_codec_partial | function | Length of an incomplete UTF-8 tail |
+ * | luaz_codec_push | function | Convert a byte range into a Lua string |
+ * | luaopen_codec | function | Lua module entrypoint |
+ *
+ * Every supported code page is a permutation of ISO-8859-1, so a
+ * conversion is one 256-byte table, optionally followed by UTF-8 encoding
+ * (byte to UTF-8) or preceded by UTF-8 decoding (UTF-8 to byte). Only
+ * UTF-8 input can fail: invalid sequences and code points above U+00FF.
+ */
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+
+#include "LUA"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_CODEC_IBM1047 0
+#define LUAZ_CODEC_IBM037 1
+#define LUAZ_CODEC_IBM273 2
+#define LUAZ_CODEC_IBM500 3
+#define LUAZ_CODEC_LATIN1 4
+#define LUAZ_CODEC_UTF8 5
+#define LUAZ_CODEC_COUNT 6
+
+#define LUAZ_CODEC_MAP 0    /* byte to byte */
+#define LUAZ_CODEC_ENCODE 1 /* byte to UTF-8 */
+#define LUAZ_CODEC_DECODE 2 /* UTF-8 to byte */
+
+struct luaz_codec {
+  int from;
+  int to;
+  int kind;
+  int ident;          /* MAP with an identity table: output = input */
+  int repl;           /* substitution byte, or -1 to fail */
+  unsigned char map[256];
+};
+
+/**
+ * @brief Look up an encoding name.
+ *
+ * Case is ignored, and so are '-' and '_': "IBM-1047", "ibm1047",
+ * "CP1047" and "1047" all name the same code page.
+ *
+ * @param name Encoding name.
+ * @return Encoding id, or -1 when the name is unknown.
+ */
+int luaz_codec_find(const char *name);
+
+/**
+ * @brief Return the canonical name of an encoding id.
+ *
+ * @param id Encoding id.
+ * @return Name such as "IBM-1047", or NULL for an invalid id.
+ */
+const char *luaz_codec_name(int id);
+
+/**
+ * @brief Return the newline byte of an encoding (NL 0x15 for EBCDIC, LF
+ *        0x0A otherwise).
+ *
+ * @param id Encoding id.
+ * @return Newline byte.
+ */
+int luaz_codec_newline(int id);
+
+/**
+ * @brief Return the blank byte of an encoding (0x40 for EBCDIC, 0x20
+ *        otherwise).
+ *
+ * @param id Encoding id.
+ * @return Blank byte.
+ */
+int luaz_codec_space(int id);
+
+/**
+ * @brief Prepare a conversion.
+ *
+ * @param cv Conversion to fill.
+ * @param from Source encoding id.
+ * @param to Target encoding id.
+ * @param repl Substitution byte in the target encoding for invalid or
+ *             unmappable input, or -1 to fail instead.
+ * @return 0 on success, or -1 for an invalid id.
+ */
+int luaz_codec_init(struct luaz_codec *cv, int from, int to, int repl);
+
+/**
+ * @brief Convert one newline byte into another instead of the table entry.
+ *
+ * Text streams use the C runtime newline as the record separator whatever
+ * the data encoding; this keeps it a newline on both sides.
+ *
+ * @param cv Prepared conversion.
+ * @param nl_in Newline byte in the source (below 0x80 for UTF-8).
+ * @param nl_out Newline byte in the target.
+ */
+void luaz_codec_text(struct luaz_codec *cv, int nl_in, int nl_out);
+
+/**
+ * @brief Return the largest output size for n input bytes.
+ *
+ * @param cv Prepared conversion.
+ * @param n Input length.
+ * @return Output bound, or 0 when it would overflow size_t.
+ */
+size_t luaz_codec_bound(const struct luaz_codec *cv, size_t n);
+
+/**
+ * @brief Convert a byte range.
+ *
+ * @param cv Prepared conversion.
+ * @param in Input bytes.
+ * @param n Input length.
+ * @param out Output (at least luaz_codec_bound(cv, n) bytes).
+ * @param outlen Output length.
+ * @param bad Offset of the failing input byte on error (may be NULL).
+ * @return 0 on success, or -1 on invalid or unmappable input.
+ */
+int luaz_codec_run(const struct luaz_codec *cv, const unsigned char *in,
+                   size_t n, unsigned char *out, size_t *outlen, size_t *bad);
+
+/**
+ * @brief Return the length of an incomplete UTF-8 sequence at the end of
+ *        a chunk, so that a block reader can carry it into the next one.
+ *
+ * @param cv Prepared conversion.
+ * @param in Chunk bytes.
+ * @param n Chunk length.
+ * @return 0..3 (always 0 unless the source is UTF-8).
+ */
+size_t luaz_codec_partial(const struct luaz_codec *cv,
+                          const unsigned char *in, size_t n);
+
+/**
+ * @brief Convert a byte range and push the result as a Lua string.
+ *
+ * @param L Lua state.
+ * @param cv Prepared conversion.
+ * @param p Input bytes.
+ * @param n Input length.
+ * @param bad Offset of the failing input byte on error (may be NULL).
+ * @return 0 with the string pushed, or -1 with nothing pushed.
+ */
+int luaz_codec_push(lua_State *L, const struct luaz_codec *cv, const char *p,
+                    size_t n, size_t *bad);
+
+/**
+ * @brief Lua module entrypoint for codec.
+ *
+ * @param L Lua state.
+ * @return 1 (module table).
+ */
+int luaopen_codec(lua_State *L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CODEC_H */
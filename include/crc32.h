@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO CRC32 (IEEE 802.3, reflected) shared by HASHCMP and LUAPATH.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_crc32_update | function | Update a running CRC32 with bytes |
+ * | luaz_crc32 | function | Compute CRC32 of a buffer |
+ */
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Update a running CRC32 with bytes.
+ *
+ * The running value is not pre/post-inverted: start with 0xFFFFFFFF and
+ * XOR the final value with 0xFFFFFFFF (luaz_crc32 does both).
+ *
+ * @param crc Running CRC32 value.
+ * @param buf Input bytes.
+ * @param len Number of bytes.
+ * @return Updated running CRC32 value.
+ */
+uint32_t luaz_crc32_update(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * @brief Compute CRC32 of a buffer.
+ *
+ * @param buf Input bytes.
+ * @param len Number of bytes.
+ * @return Final CRC32 value.
+ */
+uint32_t luaz_crc32(const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC32_H */
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO COBOL copybook record decoder (ds.copybook).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_dscopy_test | function | Test whether a stack slot is a copybook |
+ * | luaz_dscopy_decode | function | Decode one record with a copybook plan |
+ * | luaz_dscopy_l_copybook | function | Lua ds.copybook(text [, opts]) |
+ * | luaz_dscopy_open | function | Register the copybook metatable |
+ *
+ * A copybook is parsed once into a plan: a preorder array of items with
+ * offsets, sizes, OCCURS counts and DSREC field decoders for elementary
+ * items. Decoding walks the plan in C and builds nested Lua tables.
+ */
+#ifndef DSCOPY_H
+#define DSCOPY_H
+
+#include <stddef.h>
+
+#include "LUA"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_DSCOPY_MT "luaz.ds.copybook"
+
+/**
+ * @brief Test whether a stack slot holds a copybook plan.
+ *
+ * @param L Lua state.
+ * @param idx Stack index.
+ * @return Nonzero for a copybook.
+ */
+int luaz_dscopy_test(lua_State *L, int idx);
+
+/**
+ * @brief Decode one record with a copybook plan.
+ *
+ * @param L Lua state.
+ * @param cidx Stack index of the copybook.
+ * @param rec Record bytes.
+ * @param len Record length (items past it decode as absent).
+ * @param tidx Stack index of a table to fill (nested tables in it are
+ *             reused), or 0 for a new table.
+ * @return 1 (the table is pushed).
+ */
+int luaz_dscopy_decode(lua_State *L, int cidx, const char *rec, size_t len,
+                       int tidx);
+
+/**
+ * @brief Lua binding for ds.copybook(text [, opts]).
+ *
+ * @param L Lua state.
+ * @return 1 (copybook).
+ */
+int luaz_dscopy_l_copybook(lua_State *L);
+
+/**
+ * @brief Register the copybook metatable (called from luaopen_ds).
+ *
+ * @param L Lua state.
+ */
+void luaz_dscopy_open(lua_State *L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSCOPY_H */
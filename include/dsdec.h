@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO fixed-point decimal values (ds.decimal).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_dsdec | struct | Decimal userdata body (sign, scale, digits) |
+ * | luaz_dsdec_push | function | Push a zero decimal userdata |
+ * | luaz_dsdec_decode | function | Decode zoned, packed or binary bytes |
+ * | luaz_dsdec_push_field | function | Push one layout field as a decimal |
+ * | luaz_dsdec_l_decimal | function | Lua ds.decimal(value [, scale]) |
+ * | luaz_dsdec_l_unpack | function | Lua ds.unpack_decimal(fmt, s [, ...]) |
+ * | luaz_dsdec_l_sum | function | Lua ds.decimal_sum(batch [, spec]) |
+ * | luaz_dsdec_open | function | Register the decimal metatable |
+ *
+ * A decimal is an exact value of up to LUAZ_DSDEC_DIGITS digits with a
+ * scale of 0..LUAZ_DSDEC_DIGITS. The magnitude is kept in base 10^9
+ * limbs, least significant first; the extra limbs give intermediate
+ * products and quotients room before they are rounded back to 31 digits.
+ */
+#ifndef DSDEC_H
+#define DSDEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "DSREC"
+#include "LUA"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_DSDEC_MT "luaz.ds.decimal"
+#define LUAZ_DSDEC_DIGITS 31
+#define LUAZ_DSDEC_LIMBS 12
+
+struct luaz_dsdec {
+  int neg;
+  int scale;
+  uint32_t w[LUAZ_DSDEC_LIMBS];
+};
+
+/**
+ * @brief Push a decimal userdata with the value zero.
+ *
+ * @param L Lua state.
+ * @return Decimal body.
+ */
+struct luaz_dsdec *luaz_dsdec_push(lua_State *L);
+
+/**
+ * @brief Decode a zoned, packed or binary field into a decimal.
+ *
+ * Uses the ds.layout rules: the last sign nibble B or D is negative,
+ * binary is big-endian and two's complement when sign is set.
+ *
+ * @param d Output decimal.
+ * @param type LUAZ_DSREC_ZONED, LUAZ_DSREC_PACKED or LUAZ_DSREC_BINARY.
+ * @param p Field bytes.
+ * @param n Field length.
+ * @param scale Implied decimal places (0..LUAZ_DSDEC_DIGITS).
+ * @param sign Nonzero for signed binary.
+ * @return 0 on success, or -1 when the bytes are not valid for the type.
+ */
+int luaz_dsdec_decode(struct luaz_dsdec *d, int type, const unsigned char *p,
+                      size_t n, int scale, int sign);
+
+/**
+ * @brief Push one layout field of a record as a decimal (nil if invalid).
+ *
+ * @param L Lua state.
+ * @param f Field (numeric type, decimal flag set).
+ * @param p Field bytes.
+ * @param n Bytes present (less than f->len for a short record).
+ */
+void luaz_dsdec_push_field(lua_State *L, const struct luaz_dsrec_field *f,
+                           const char *p, size_t n);
+
+/**
+ * @brief Lua binding for ds.decimal(value [, scale]).
+ *
+ * @param L Lua state.
+ * @return 1 (decimal, or nil for text that is not a number).
+ */
+int luaz_dsdec_l_decimal(lua_State *L);
+
+/**
+ * @brief Lua binding for ds.unpack_decimal(fmt, s [, scale [, pos [, len]]]).
+ *
+ * @param L Lua state.
+ * @return 1 (decimal, or nil for invalid bytes).
+ */
+int luaz_dsdec_l_unpack(lua_State *L);
+
+/**
+ * @brief Lua binding for ds.decimal_sum(batch [, spec]).
+ *
+ * @param L Lua state.
+ * @return 2 (sum and count), or 2 (nil and message) for invalid data.
+ */
+int luaz_dsdec_l_sum(lua_State *L);
+
+/**
+ * @brief Register the decimal metatable (called from luaopen_ds).
+ *
+ * @param L Lua state.
+ */
+void luaz_dsdec_open(lua_State *L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSDEC_H */
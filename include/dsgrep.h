@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO substring scanning of dataset blocks (ds.grep).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | LUAZ_DSGREP_NEEDLE_MAX | macro | Longest literal needle |
+ * | luaz_dsgrep | struct | Prepared needle (shift and fold tables) |
+ * | luaz_dsgrep_hit_fn | typedef | Callback for one matching line |
+ * | luaz_dsgrep_init | function | Prepare a literal needle |
+ * | luaz_dsgrep_find | function | Find the needle in a byte range |
+ * | luaz_dsgrep_lines | function | Report the lines of a block that match |
+ * | luaz_dsgrep_literal | function | Longest literal a Lua pattern requires |
+ *
+ * Literals are found with Boyer-Moore-Horspool (memchr for one byte).
+ * Case folding uses a 256-byte table built from the codec tables of the
+ * data code page, so EBCDIC and accented Latin-1 letters fold as well.
+ */
+#ifndef DSGREP_H
+#define DSGREP_H
+
+#include <stddef.h>
+
+#include "LUA"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_DSGREP_NEEDLE_MAX 256
+
+struct luaz_dsgrep {
+  unsigned char needle[LUAZ_DSGREP_NEEDLE_MAX]; /* folded when fold is set */
+  size_t len;                                   /* 0 matches every line */
+  int fold;
+  unsigned char ftab[256];
+  size_t shift[256];
+};
+
+/**
+ * @brief Callback for one matching line.
+ *
+ * @param ud Caller data.
+ * @param lineno Line number (1-based, counted across blocks).
+ * @param line Line bytes without the newline.
+ * @param n Line length.
+ * @return 0 to continue, 1 to stop, or -1 to stop with an error.
+ */
+typedef int (*luaz_dsgrep_hit_fn)(void *ud, lua_Integer lineno,
+                                  const char *line, size_t n);
+
+/**
+ * @brief Prepare a literal needle.
+ *
+ * @param g Needle to fill.
+ * @param needle Needle bytes (empty matches everything).
+ * @param n Needle length (at most LUAZ_DSGREP_NEEDLE_MAX).
+ * @param fold_cp Codec id of the data for case folding, or -1 for none.
+ * @return 0 on success, or -1 for a needle that is too long or an
+ *         invalid code page.
+ */
+int luaz_dsgrep_init(struct luaz_dsgrep *g, const char *needle, size_t n,
+                     int fold_cp);
+
+/**
+ * @brief Find the first occurrence of the needle.
+ *
+ * @param g Prepared needle.
+ * @param p Bytes to search.
+ * @param n Length.
+ * @return Start of the match, or NULL.
+ */
+const char *luaz_dsgrep_find(const struct luaz_dsgrep *g, const char *p,
+                             size_t n);
+
+/**
+ * @brief Report every line of a block that contains the needle.
+ *
+ * The block is split at newline bytes; a last line without a newline is
+ * a line too. Lines without a match are only counted.
+ *
+ * @param g Prepared needle.
+ * @param p Block bytes.
+ * @param n Block length.
+ * @param lineno In: lines before the block; out: lines through it.
+ * @param hit Callback for each matching line.
+ * @param ud Callback data.
+ * @return 0 after the whole block, or the callback's nonzero result.
+ */
+int luaz_dsgrep_lines(const struct luaz_dsgrep *g, const char *p, size_t n,
+                      lua_Integer *lineno, luaz_dsgrep_hit_fn hit, void *ud);
+
+/**
+ * @brief Extract the longest literal every match of a Lua pattern must
+ *        contain, for use as a prefilter.
+ *
+ * @param pat Pattern.
+ * @param n Pattern length.
+ * @param out Output buffer.
+ * @param cap Output capacity (longer literals are cut, still required).
+ * @return Literal length (0 when the pattern requires none).
+ */
+size_t luaz_dsgrep_literal(const char *pat, size_t n, char *out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSGREP_H */
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO PDS/PDSE member enumeration helpers (ds.members).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | LUAZ_DSMEM_* | macro | ISPF statistics sizes and flags |
+ * | luaz_dsmem_stats | struct | Decoded ISPF statistics of one member |
+ * | luaz_dsmem_ops | struct | Directory block reader hooks |
+ * | luaz_dsmem_set_ops | function | Register a directory block reader |
+ * | luaz_dsmem_get_ops | function | Return the registered reader or NULL |
+ * | luaz_dsmem_stats | function | Decode ISPF statistics from user data |
+ * | luaz_dsmem_match | function | Match a member name against a pattern |
+ *
+ * Directory blocks are parsed with PDSDIR; this module decodes the ISPF
+ * statistics kept in the user data of each entry. Without registered
+ * hooks ds.members reads the directory with RECFM=U record I/O; the
+ * host stand-in (IOHOST) registers hooks that build the same blocks
+ * from a directory of files.
+ */
+#ifndef DSMEM_H
+#define DSMEM_H
+
+#include "PDSDIR"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_DSMEM_ISPF_LEN 30     /* user data bytes of ISPF statistics */
+#define LUAZ_DSMEM_ISPF_EXT_LEN 40 /* with 4-byte line counts */
+#define LUAZ_DSMEM_SCLM 0x80u      /* flag byte: SCLM managed */
+#define LUAZ_DSMEM_EXT 0x20u       /* flag byte: 4-byte line counts */
+
+struct luaz_dsmem_stats {
+  int version;
+  int mod;
+  int sclm;
+  char created[11]; /* YYYY/MM/DD */
+  char changed[20]; /* YYYY/MM/DD HH:MM:SS */
+  long size;        /* current lines */
+  long init;        /* lines when created */
+  long modified;    /* lines changed */
+  char user[9];     /* blanks trimmed */
+};
+
+struct luaz_dsmem_ops {
+  /* Open the directory of name ("DD:ddname" or a DSN); 0 on success. */
+  int (*open)(const char *name, void **dir);
+  /* Next 256-byte block: len in/out (0 at end); 0 on success, -1 on error. */
+  int (*read)(void *dir, unsigned char *blk, unsigned long *len);
+  int (*close)(void *dir);
+};
+
+/**
+ * @brief Register a directory block reader (NULL restores record I/O).
+ *
+ * @param ops Reader hooks, copied.
+ */
+void luaz_dsmem_set_ops(const struct luaz_dsmem_ops *ops);
+
+/**
+ * @brief Return the registered directory block reader.
+ *
+ * @return Reader hooks, or NULL when none is registered.
+ */
+const struct luaz_dsmem_ops *luaz_dsmem_get_ops(void);
+
+/**
+ * @brief Decode the ISPF statistics of a directory entry.
+ *
+ * @param e Directory entry.
+ * @param st Decoded statistics.
+ * @return 0 on success, or -1 when the user data holds no valid ISPF
+ *         statistics (load modules, members written outside ISPF).
+ */
+int luaz_dsmem_stats(const struct luaz_pdsdir_entry *e,
+                     struct luaz_dsmem_stats *st);
+
+/**
+ * @brief Match a member name against an ISPF member pattern: '*' any
+ *        characters, '%' one character, letters in either case.
+ *
+ * @param pattern Pattern (NULL or empty matches every name).
+ * @param name Member name.
+ * @return 1 on a match, or 0.
+ */
+int luaz_dsmem_match(const char *pattern, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSMEM_H */
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO fixed-position record layouts (ds.layout).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_dsrec_field | struct | One compiled field (offset, length, type) |
+ * | luaz_dsrec_layout | struct | Compiled layout userdata body |
+ * | luaz_dsrec_push_new | function | Push an empty layout userdata |
+ * | luaz_dsrec_check | function | Check a layout argument |
+ * | luaz_dsrec_decode | function | Decode one record with a layout |
+ * | luaz_dsrec_push_value | function | Push one field of a record |
+ * | luaz_dsrec_l_layout | function | Lua ds.layout(spec) |
+ * | luaz_dsrec_open | function | Register the layout metatable |
+ *
+ * A layout is compiled once into an array of fields; decoding a record is
+ * one C pass that pushes one value per field or stores them into a
+ * caller-supplied table. Field names live in the userdata's first user
+ * value (an array of strings, one per field).
+ */
+#ifndef DSREC_H
+#define DSREC_H
+
+#include <stddef.h>
+
+#include "LUA"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_DSREC_MT "luaz.ds.layout"
+#define LUAZ_DSREC_FIELDS_MAX 4096
+
+#define LUAZ_DSREC_STRING 0
+#define LUAZ_DSREC_NUMBER 1
+#define LUAZ_DSREC_ZONED 2
+#define LUAZ_DSREC_PACKED 3
+#define LUAZ_DSREC_BINARY 4
+
+#define LUAZ_DSREC_PACKED_MAX 16
+#define LUAZ_DSREC_ZONED_MAX 31
+#define LUAZ_DSREC_BINARY_MAX 8
+
+struct luaz_dsrec_field {
+  size_t off;
+  size_t len;
+  int type;
+  int trim;
+  int scale;
+  int sign;
+  int dec;
+};
+
+struct luaz_dsrec_layout {
+  int nfields;
+  size_t reclen;
+  struct luaz_dsrec_field field[1];
+};
+
+/**
+ * @brief Push a layout userdata with room for nfields fields.
+ *
+ * Fields are zeroed and the name table (user value 1) is left on the
+ * stack above the userdata, for the caller to fill and pop.
+ *
+ * @param L Lua state.
+ * @param nfields Number of fields (1..LUAZ_DSREC_FIELDS_MAX).
+ * @return Layout body.
+ */
+struct luaz_dsrec_layout *luaz_dsrec_push_new(lua_State *L, int nfields);
+
+/**
+ * @brief Check that a stack slot holds a layout.
+ *
+ * @param L Lua state.
+ * @param idx Stack index.
+ * @return Layout body (raises a Lua error otherwise).
+ */
+struct luaz_dsrec_layout *luaz_dsrec_check(lua_State *L, int idx);
+
+/**
+ * @brief Decode one record with a layout.
+ *
+ * @param L Lua state.
+ * @param lidx Stack index of the layout.
+ * @param rec Record bytes.
+ * @param len Record length (short records yield empty fields).
+ * @param tidx Stack index of a table to fill, or 0 to push the values.
+ * @return Number of values pushed (the field count, or 1 for the table).
+ */
+int luaz_dsrec_decode(lua_State *L, int lidx, const char *rec, size_t len,
+                      int tidx);
+
+/**
+ * @brief Push one field of a record.
+ *
+ * Zoned and packed fields take their sign from the last sign nibble
+ * (B or D is negative); binary fields are big-endian, two's complement
+ * when sign is set. Numeric fields yield an integer when scale is 0 and
+ * the value fits in 18 digits, a float otherwise, and nil when the bytes
+ * are not valid for the type. Fields with the decimal flag set yield a
+ * ds.decimal instead (see DSDEC).
+ *
+ * @param L Lua state.
+ * @param f Field.
+ * @param rec Record bytes.
+ * @param len Record length (bytes past it are absent).
+ */
+void luaz_dsrec_push_value(lua_State *L, const struct luaz_dsrec_field *f,
+                           const char *rec, size_t len);
+
+/**
+ * @brief Lua binding for ds.layout(spec).
+ *
+ * @param L Lua state.
+ * @return 1 (layout).
+ */
+int luaz_dsrec_l_layout(lua_State *L);
+
+/**
+ * @brief Register the layout metatable (called from luaopen_ds).
+ *
+ * @param L Lua state.
+ */
+void luaz_dsrec_open(lua_State *L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSREC_H */
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO external merge sort of dataset records (ds.sort).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | LUAZ_DSSORT_* | macro | Limits, memory defaults and error phases |
+ * | luaz_dssort_key | struct | One key field (offset, length, order) |
+ * | luaz_dssort_io | struct | Input, output and work dataset callbacks |
+ * | luaz_dssort | struct | Sort specification and result counters |
+ * | luaz_dssort_init | function | Reset a sort to the defaults |
+ * | luaz_dssort_keys | function | Compile a Lua key list |
+ * | luaz_dssort_run | function | Sort input records into the output |
+ *
+ * Records are collected in one arena of the configured memory size,
+ * ordered by a radix sort on an 8-byte key prefix (records whose
+ * prefixes tie are finished with a merge sort on the full keys), and
+ * spilled as sorted runs to work datasets when the arena fills. The
+ * runs are then merged with a heap, LUAZ_DSSORT_MERGE_MAX at a time.
+ * Equal keys keep their input order.
+ */
+#ifndef DSSORT_H
+#define DSSORT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "LUA"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_DSSORT_KEYS_MAX 16
+#define LUAZ_DSSORT_MERGE_MAX 32
+#define LUAZ_DSSORT_MEMORY_MIN (1024u * 1024u)
+#define LUAZ_DSSORT_MEMORY_DEFAULT (16u * 1024u * 1024u)
+#define LUAZ_DSSORT_MEMORY_MAX (1024u * 1024u * 1024u)
+
+#define LUAZ_DSSORT_E_READ 1  /* io->read failed */
+#define LUAZ_DSSORT_E_WRITE 2 /* io->write failed */
+#define LUAZ_DSSORT_E_SPILL 3 /* work dataset open, write or read failed */
+#define LUAZ_DSSORT_E_NOMEM 4 /* arena or merge buffers not available */
+
+struct luaz_dssort_key {
+  size_t off;  /* 0-based position in the record */
+  size_t len;
+  int desc;
+};
+
+struct luaz_dssort_io {
+  void *ud;
+  /* Next input record: 1 with p and n set, 0 at end of input, -1 on error. */
+  int (*read)(void *ud, const char **p, size_t *n);
+  /* One output record: 0 on success, -1 on error. Only called after read
+   * returned 0, so the output may replace the input. */
+  int (*write)(void *ud, const char *p, size_t n);
+  /* Create (create != 0) or reopen work dataset run; NULL on error. A new
+   * run holds exactly bytes bytes, so the callback can size its space. */
+  FILE *(*spill_open)(void *ud, int run, int create, lua_Integer bytes);
+  /* Delete work dataset run. */
+  void (*spill_remove)(void *ud, int run);
+};
+
+struct luaz_dssort {
+  struct luaz_dssort_key keys[LUAZ_DSSORT_KEYS_MAX];
+  int nkeys;
+  size_t keylen;       /* sum of the key lengths */
+  size_t memory;       /* run arena size in bytes */
+  lua_Integer records; /* records read */
+  lua_Integer written; /* records written to the output */
+  int runs;            /* work datasets created */
+  int err;             /* LUAZ_DSSORT_E_* after a failure */
+};
+
+/**
+ * @brief Reset a sort: no keys, default memory, zero counters.
+ *
+ * @param s Sort.
+ */
+void luaz_dssort_init(struct luaz_dssort *s);
+
+/**
+ * @brief Compile a Lua list of {pos=n, len=n [, order="A|D"]} keys.
+ *
+ * Fails for a value that is not a list, an empty list, more than
+ * LUAZ_DSSORT_KEYS_MAX keys or an invalid key; it does not raise.
+ *
+ * @param L Lua state.
+ * @param idx Stack index of the key list.
+ * @param s Sort receiving the keys.
+ * @param bad Output number of the invalid key (0 = the list itself).
+ * @return 0 on success, or -1 on an invalid list or key.
+ */
+int luaz_dssort_keys(lua_State *L, int idx, struct luaz_dssort *s,
+                     int *bad);
+
+/**
+ * @brief Sort every input record into the output.
+ *
+ * Key bytes compare unsigned; key bytes past the end of a short record
+ * compare as 0x00. Work datasets are removed before returning, on
+ * failure too.
+ *
+ * @param s Sort with keys and memory set.
+ * @param io Callbacks.
+ * @return 0 on success, or -1 with s->err set.
+ */
+int luaz_dssort_run(struct luaz_dssort *s, const struct luaz_dssort_io *io);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSSORT_H */
@@ -41,5 +41,8 @@
 #define LUZ_E_DS_TMPNAME 30028
 #define LUZ_E_DS_MEMBER 30029
 #define LUZ_E_DS_INFO 30037
+#define LUZ_E_BUNDLE 30038
+#define LUZ_E_LZM 30039
+#define LUZ_E_CODEC 30058
 
 #endif /* ERRORS_H */
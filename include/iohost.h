@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO host-filesystem stand-in for DDNAME I/O (off-host benchmarks).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_io_host_register | function | Register directory-backed LUAPATH hooks |
+ */
+#ifndef IOHOST_H
+#define IOHOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register directory-backed LUAPATH hooks for Lua runtime.
+ *
+ * Each DDNAME maps to a directory under root and each member to a file:
+ * <root>/<DDNAME>/<MEMBER>. DDNAMEs come from policy like the DDNAME
+ * backend (luapath.dd defaults to LUAPATH; luabc.dd enables the
+ * bytecode cache, luabc.write its write-back). ds.members directories
+ * are served from the same layout (see luaz_dsmem_set_ops).
+ *
+ * @param root Root directory of the stand-in libraries.
+ * @return 0 on success, or nonzero on failure.
+ */
+int luaz_io_host_register(const char *root);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOHOST_H */
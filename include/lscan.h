@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO block-buffered line scanner for dataset streams.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_lscan | struct | Scanner state (stream, block buffer, cursor) |
+ * | luaz_lscan_init | function | Attach a scanner to a stream |
+ * | luaz_lscan_free | function | Release the block buffer |
+ * | luaz_lscan_find_nl | function | Word-at-a-time newline search |
+ * | luaz_lscan_next | function | Return the next line or line segment |
+ * | luaz_lscan_read | function | Read bytes through the block buffer |
+ * | luaz_lscan_at_eof | function | Test for end of data |
+ * | luaz_lscan_readahead | function | Start a read-ahead producer thread |
+ *
+ * Lines are returned as pointers into the block buffer, so a line that
+ * fits in the current block costs no copy. A line that straddles a block
+ * boundary is returned in segments (LUAZ_LSCAN_PART) that the caller
+ * joins.
+ *
+ * With read-ahead, a producer thread fills a ring of blocks while the
+ * caller scans; the stream must then only be touched by the scanner until
+ * luaz_lscan_free() has stopped the thread.
+ */
+#ifndef LSCAN_H
+#define LSCAN_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_LSCAN_BLOCK_DEFAULT 65536u
+#define LUAZ_LSCAN_BLOCK_MIN 256u
+#define LUAZ_LSCAN_RA_MAX 64
+
+#define LUAZ_LSCAN_EOF 0
+#define LUAZ_LSCAN_LINE 1
+#define LUAZ_LSCAN_PART 2
+
+struct luaz_lscan {
+  FILE *fp;
+  char *blk;
+  size_t cap;
+  size_t pos;
+  size_t len;
+  int eof;
+  int err;
+  int nl;
+  void *ra;
+};
+
+/**
+ * @brief Attach a scanner to an open stream.
+ *
+ * @param s Scanner state.
+ * @param fp Stream opened for reading.
+ * @param cap Block size (0 = LUAZ_LSCAN_BLOCK_DEFAULT).
+ * @return 0 on success, or -1 when the block cannot be allocated.
+ */
+int luaz_lscan_init(struct luaz_lscan *s, FILE *fp, size_t cap);
+
+/**
+ * @brief Release the block buffer (the stream is not closed).
+ *
+ * Stops and joins the read-ahead thread first, if one runs.
+ *
+ * @param s Scanner state.
+ */
+void luaz_lscan_free(struct luaz_lscan *s);
+
+/**
+ * @brief Find the first newline in a buffer, one machine word at a time.
+ *
+ * @param p Buffer start.
+ * @param n Buffer length.
+ * @return Pointer to the newline, or NULL when there is none.
+ */
+const char *luaz_lscan_find_nl(const char *p, size_t n);
+
+/**
+ * @brief Return the next line, or the next segment of a long line.
+ *
+ * @param s Scanner state.
+ * @param out Output pointer into the block buffer (valid until the next
+ *            scanner call).
+ * @param len Output length, excluding the newline.
+ * @return LUAZ_LSCAN_LINE when the data ends a line (s->nl is 1 when a
+ *         newline ended it, 0 when the stream did), LUAZ_LSCAN_PART for a
+ *         segment that continues in the next block, LUAZ_LSCAN_EOF at end
+ *         of data, or -1 on a read error.
+ */
+int luaz_lscan_next(struct luaz_lscan *s, const char **out, size_t *len);
+
+/**
+ * @brief Read up to n bytes, draining the block buffer first.
+ *
+ * @param s Scanner state.
+ * @param dst Output buffer.
+ * @param n Number of bytes wanted.
+ * @return Bytes read (less than n only at EOF or on error; see s->err).
+ */
+size_t luaz_lscan_read(struct luaz_lscan *s, void *dst, size_t n);
+
+/**
+ * @brief Test whether any data is left.
+ *
+ * @param s Scanner state.
+ * @return 1 at end of data, 0 when data remains, or -1 on a read error.
+ */
+int luaz_lscan_at_eof(struct luaz_lscan *s);
+
+/**
+ * @brief Start a producer thread that reads nblocks blocks ahead.
+ *
+ * Call before the first read. On failure (for example POSIX(OFF) on z/OS)
+ * the scanner stays synchronous and errno holds the reason.
+ *
+ * @param s Scanner state.
+ * @param nblocks Blocks read ahead of the one being scanned
+ *                (1..LUAZ_LSCAN_RA_MAX).
+ * @return 0 when the thread runs, or -1 (errno set) when the scanner stays
+ *         synchronous.
+ */
+int luaz_lscan_readahead(struct luaz_lscan *s, int nblocks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LSCAN_H */
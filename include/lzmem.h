@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO compressed member format (LZ4-class blocks).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_lzm_hdr | struct | Parsed compressed member header |
+ * | luaz_lzm_parse | function | Recognise and parse a member header |
+ * | luaz_lzm_block_decode | function | Decompress one LZ4 block |
+ * | luaz_lzm_block_encode | function | Compress one LZ4 block |
+ * | luaz_lzm_decode | function | Decompress a whole member image |
+ * | luaz_lzm_encode | function | Compress a buffer into a member image |
+ *
+ * Member layout (integers big-endian u32):
+ * - Header (16 bytes): magic 0x1A "LZM", raw length, block size, CRC32 of
+ *   the raw bytes.
+ * - Blocks: u32 word (bit 31 set = stored, low 31 bits = payload length)
+ *   followed by the payload. Every block but the last holds block size
+ *   raw bytes. Compressed payloads use the LZ4 block format.
+ * The first byte (0x1A) cannot start Lua source or a lua_dump chunk, so
+ * loaders tell compressed members apart by it. Bytes after the last block
+ * (for example RECFM=FB padding) are ignored.
+ */
+#ifndef LZMEM_H
+#define LZMEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_LZM_MAGIC0 0x1A
+#define LUAZ_LZM_HDR_LEN 16u
+#define LUAZ_LZM_BLOCK_HDR_LEN 4u
+#define LUAZ_LZM_BLOCK_DEFAULT 65536ul
+#define LUAZ_LZM_BLOCK_MAX 1048576ul
+#define LUAZ_LZM_STORED 0x80000000ul
+
+struct luaz_lzm_hdr {
+  unsigned long raw_len;
+  unsigned long block_size;
+  unsigned long crc;
+};
+
+/**
+ * @brief Recognise and parse a compressed member header.
+ *
+ * @param buf First bytes of the member.
+ * @param len Number of bytes available.
+ * @param hdr Output header (may be NULL).
+ * @return 1 for a valid header, 0 when the data is not compressed, or
+ *         LUZ_E_LZM when the magic matches but the header is invalid.
+ */
+int luaz_lzm_parse(const void *buf, unsigned long len,
+                   struct luaz_lzm_hdr *hdr);
+
+/**
+ * @brief Decompress one LZ4 block into exactly dst_len bytes.
+ *
+ * @param src Compressed payload.
+ * @param src_len Payload length.
+ * @param dst Output buffer.
+ * @param dst_len Expected raw length.
+ * @return 0 on success, or LUZ_E_LZM on malformed input.
+ */
+int luaz_lzm_block_decode(const unsigned char *src, unsigned long src_len,
+                          unsigned char *dst, unsigned long dst_len);
+
+/**
+ * @brief Compress one block with the LZ4 block format.
+ *
+ * @param src Raw bytes.
+ * @param src_len Raw length.
+ * @param dst Output buffer.
+ * @param dst_cap Output capacity.
+ * @return Payload length, or 0 when the result does not fit dst_cap
+ *         (store the block instead).
+ */
+unsigned long luaz_lzm_block_encode(const unsigned char *src,
+                                    unsigned long src_len,
+                                    unsigned char *dst,
+                                    unsigned long dst_cap);
+
+/**
+ * @brief Decompress a whole member image into a heap buffer.
+ *
+ * The buffer is allocated with malloc() with one spare byte past the raw
+ * length; the CRC32 of the result is verified.
+ *
+ * @param buf Member image (header first).
+ * @param len Image length (may include trailing padding).
+ * @param out Output buffer (caller frees).
+ * @param out_len Output raw length.
+ * @return 0 on success, or LUZ_E_LZM on malformed input or allocation
+ *         failure.
+ */
+int luaz_lzm_decode(const void *buf, unsigned long len, char **out,
+                    unsigned long *out_len);
+
+/**
+ * @brief Compress a buffer into a member image.
+ *
+ * @param buf Raw bytes.
+ * @param len Raw length.
+ * @param block_size Block size (0 = LUAZ_LZM_BLOCK_DEFAULT).
+ * @param out Output image allocated with malloc() (caller frees).
+ * @param out_len Output image length.
+ * @return 0 on success, or LUZ_E_LZM on invalid arguments or allocation
+ *         failure.
+ */
+int luaz_lzm_encode(const void *buf, unsigned long len,
+                    unsigned long block_size, char **out,
+                    unsigned long *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LZMEM_H */
@@ -8,6 +8,21 @@
  * |--------|------|---------|
  * | luaz_path_lookup | function | Map long module name to member via LUAMAP |
  * | luaz_path_load | function | Load module source from LUAPATH |
+ * | luaz_path_load_alloc | function | Load module source in one read pass |
+ * | luaz_path_open | function | Open a LUAPATH member for block reads |
+ * | luaz_path_read | function | Read the next block of an open member |
+ * | luaz_path_close | function | Close an open member stream |
+ * | luaz_path_member_exists | function | Check a member against the LUAPATH index |
+ * | luaz_path_bundle_find | function | Look up a module in the application bundle |
+ * | luaz_path_bc_get | function | Fetch validated bytecode from the cache DD |
+ * | luaz_path_bc_put | function | Store bytecode in the cache DD |
+ * | luaz_path_bc_writable | function | Report whether cache write-back is on |
+ * | luaz_path_load_chunk | function | Compile member text via the bytecode cache |
+ * | luaz_path_invalidate | function | Drop cached LUAMAP and member indexes |
+ * | luaz_path_reset | function | Drop cached LUAMAP index and counters |
+ * | luaz_path_stat_count | function | Return number of LUAPATH counters |
+ * | luaz_path_stat_name | function | Get LUAPATH counter name by index |
+ * | luaz_path_stat_value | function | Get LUAPATH counter value by index |
  */
 #ifndef PATH_H
 #define PATH_H
@@ -16,9 +31,19 @@
 extern "C" {
 #endif
 
+typedef int (*luaz_path_member_cb)(void *ud, const char *member, int concat);
+
 struct luaz_path_ops {
   int (*luamap_read)(char *buf, unsigned long *len);
   int (*member_read)(const char *member, char *buf, unsigned long *len);
+  int (*member_read_alloc)(const char *member, char **buf, unsigned long *len);
+  int (*bc_read_alloc)(const char *member, char **buf, unsigned long *len);
+  int (*bc_write)(const char *member, const char *buf, unsigned long len);
+  int (*member_list)(luaz_path_member_cb cb, void *ud);
+  int (*member_open)(const char *member, void **stream);
+  int (*stream_read)(void *stream, char *buf, unsigned long *len);
+  int (*stream_close)(void *stream);
+  int (*bundle_read_alloc)(char **buf, unsigned long *len);
 };
 
 int luaz_path_lookup(const char *modname, char *member, unsigned long *len);
@@ -27,6 +52,174 @@ int luaz_path_load(const char *modname, const char *member,
 int luaz_path_resolve(const char *modname, char *member, unsigned long *len);
 int luaz_path_set_ops(const struct luaz_path_ops *ops);
 
+/**
+ * @brief Load module source from LUAPATH with one open/read/close.
+ *
+ * The buffer is allocated with malloc() and owned by the caller (free()).
+ * It always has one spare byte after the data for a NUL terminator.
+ *
+ * @param modname Module name (informational).
+ * @param member Resolved member name.
+ * @param buf Output buffer pointer (NULL on failure).
+ * @param len Output data length in bytes.
+ * @return 0 on success, or LUZ_E_PATH_LOAD on failure.
+ */
+int luaz_path_load_alloc(const char *modname, const char *member,
+                         char **buf, unsigned long *len);
+
+/**
+ * @brief Open a LUAPATH member for streaming reads.
+ *
+ * Used by loaders that feed lua_load() block by block instead of
+ * holding the whole member in memory.
+ *
+ * @param modname Module name (informational).
+ * @param member Resolved member name.
+ * @param stream Output opaque stream handle (close with luaz_path_close).
+ * @return 0 on success, or LUZ_E_PATH_LOAD on failure.
+ */
+int luaz_path_open(const char *modname, const char *member, void **stream);
+
+/**
+ * @brief Read the next block from an open LUAPATH member.
+ *
+ * @param stream Stream handle from luaz_path_open.
+ * @param buf Output buffer.
+ * @param len In/out: capacity on input, bytes read on output (0 at end).
+ * @return 0 on success, or LUZ_E_PATH_LOAD on read failure.
+ */
+int luaz_path_read(void *stream, char *buf, unsigned long *len);
+
+/**
+ * @brief Close a LUAPATH member stream.
+ *
+ * @param stream Stream handle from luaz_path_open (NULL is ignored).
+ */
+void luaz_path_close(void *stream);
+
+/**
+ * @brief Check whether a member exists in the LUAPATH concatenation.
+ *
+ * Answered from the member index built from the LUAPATH directories on
+ * first use (one directory pass per Lua state).
+ *
+ * @param member Member name.
+ * @param concat Output 0-based concatenation index (may be NULL).
+ * @return 1 if present, 0 if absent, -1 if no directory index is available.
+ */
+int luaz_path_member_exists(const char *member, int *concat);
+
+/**
+ * @brief Look up a module in the application bundle (luabundle.dd).
+ *
+ * The bundle is read and validated once per hook registration; the blob
+ * is a slice of that image and stays valid until luaz_path_invalidate().
+ *
+ * @param modname Full module name (no LUAMAP mapping).
+ * @param data Output blob pointer (source or lua_dump output).
+ * @param len Output blob length.
+ * @return 1 when found, 0 when absent from the bundle, -1 when no bundle
+ *         is configured, or LUZ_E_BUNDLE for a malformed bundle/entry.
+ */
+int luaz_path_bundle_find(const char *modname, const char **data,
+                          unsigned long *len);
+
+/**
+ * @brief Fetch bytecode for a member from the bytecode cache DD.
+ *
+ * The entry is used only when its header matches the CRC32 and length
+ * of the current source text.
+ *
+ * @param member Resolved member name.
+ * @param src Module source text.
+ * @param srclen Source length in bytes.
+ * @param code Output payload (malloc'd, caller frees; NULL on miss).
+ * @param codelen Output payload length.
+ * @return 0 on hit, or LUZ_E_PATH_LOAD on miss/disabled cache.
+ */
+int luaz_path_bc_get(const char *member, const char *src,
+                     unsigned long srclen, char **code,
+                     unsigned long *codelen);
+
+/**
+ * @brief Store lua_dump output for a member in the bytecode cache DD.
+ *
+ * @param member Resolved member name.
+ * @param src Module source text the bytecode was compiled from.
+ * @param srclen Source length in bytes.
+ * @param code lua_dump output.
+ * @param codelen lua_dump output length.
+ * @return 0 on success, or LUZ_E_PATH_LOAD on failure/disabled write-back.
+ */
+int luaz_path_bc_put(const char *member, const char *src,
+                     unsigned long srclen, const char *code,
+                     unsigned long codelen);
+
+/**
+ * @brief Report whether bytecode cache write-back is enabled.
+ *
+ * @return 1 when a cache write hook is registered, 0 otherwise.
+ */
+int luaz_path_bc_writable(void);
+
+struct lua_State;
+
+/**
+ * @brief Compile a LUAPATH member's text into a chunk on the Lua stack.
+ *
+ * A current bytecode cache entry skips the parser (an unloadable entry
+ * counts as a miss); a fresh compile is written back when write-back is
+ * on. Shared by require (searcher_Lua) and the LUAEXEC preload manifest;
+ * defined in lua-vm loadlib.c.
+ *
+ * @param L Lua state.
+ * @param member Resolved member name (also the chunk name).
+ * @param src Member text.
+ * @param srclen Text length in bytes (> 0).
+ * @return LUA_OK with the chunk pushed, or a luaL_loadbufferx() status
+ *         with the error message pushed.
+ */
+int luaz_path_load_chunk(struct lua_State *L, const char *member,
+                         const char *src, unsigned long srclen);
+
+/**
+ * @brief Drop the cached LUAMAP and member indexes, keeping counters.
+ *
+ * The next lookup re-reads LUAMAP and the LUAPATH directories, so
+ * members added during the run become visible.
+ */
+void luaz_path_invalidate(void);
+
+/**
+ * @brief Drop the cached LUAMAP index and reset LUAPATH counters.
+ *
+ * The next long-name lookup reloads LUAMAP from LUAPATH.
+ */
+void luaz_path_reset(void);
+
+/**
+ * @brief Return number of LUAPATH counters.
+ *
+ * @return Count of counters exposed by the LUAPATH layer.
+ */
+int luaz_path_stat_count(void);
+
+/**
+ * @brief Return LUAPATH counter name by index.
+ *
+ * @param index Counter index.
+ * @return Counter name, or NULL if index is invalid.
+ */
+const char *luaz_path_stat_name(int index);
+
+/**
+ * @brief Return LUAPATH counter value by index.
+ *
+ * @param index Counter index.
+ * @return Counter value, or 0 if index is invalid.
+ */
+unsigned long luaz_path_stat_value(int index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO PDS/PDSE directory block parser.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_pdsdir_entry | struct | One directory entry (name, TTR, user data) |
+ * | luaz_pdsdir_state | struct | Parser state across blocks/concatenation |
+ * | luaz_pdsdir_cb | typedef | Per-entry callback |
+ * | luaz_pdsdir_init | function | Reset parser state |
+ * | luaz_pdsdir_block | function | Parse one 256-byte directory block |
+ */
+#ifndef PDSDIR_H
+#define PDSDIR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LUAZ_PDSDIR_BLKSIZE 256u
+
+struct luaz_pdsdir_entry {
+  char name[9];               /* member name, blanks trimmed */
+  unsigned char ttr[3];       /* relative track/record of the member */
+  unsigned char alias;        /* 1 when the entry is an alias */
+  unsigned char ulen;         /* user data length in bytes (0..62) */
+  const unsigned char *user;  /* user data (points into the block) */
+  int concat;                 /* 0-based concatenation index */
+};
+
+struct luaz_pdsdir_state {
+  int concat;   /* concatenation index of the current directory */
+  int ended;    /* end-of-directory marker seen in the current dataset */
+};
+
+/**
+ * @brief Per-entry callback.
+ *
+ * @param ud Caller context.
+ * @param e Directory entry (valid for the duration of the call).
+ * @return 0 to continue, nonzero to stop parsing.
+ */
+typedef int (*luaz_pdsdir_cb)(void *ud, const struct luaz_pdsdir_entry *e);
+
+/**
+ * @brief Reset parser state before reading a DD or dataset directory.
+ *
+ * @param st Parser state.
+ */
+void luaz_pdsdir_init(struct luaz_pdsdir_state *st);
+
+/**
+ * @brief Parse one directory block (RECFM=U, 256 bytes, no key).
+ *
+ * Directories of a concatenation are read back to back; each
+ * end-of-directory marker (name X'FF..FF') advances the concatenation
+ * index, so an empty library still takes its number. Unused directory
+ * blocks (fewer than 2 bytes used) are skipped.
+ *
+ * @param st Parser state.
+ * @param blk Block bytes.
+ * @param len Block length in bytes.
+ * @param cb Per-entry callback.
+ * @param ud Callback context.
+ * @return 0 on success, 1 when the callback stopped parsing, or -1 on
+ *         malformed input.
+ */
+int luaz_pdsdir_block(struct luaz_pdsdir_state *st, const unsigned char *blk,
+                      unsigned long len, luaz_pdsdir_cb cb, void *ud);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PDSDIR_H */
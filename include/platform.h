@@ -23,6 +23,19 @@ struct luaz_platform_ops {
   int (*get_env)(const char *key, char *out, unsigned long *len);
   int (*luapath_read_luamap)(char *buf, unsigned long *len);
   int (*luapath_read_member)(const char *member, char *buf, unsigned long *len);
+  int (*luapath_read_member_alloc)(const char *member, char **buf,
+                                   unsigned long *len);
+  int (*luabc_read_member_alloc)(const char *member, char **buf,
+                                 unsigned long *len);
+  int (*luabc_write_member)(const char *member, const char *buf,
+                            unsigned long len);
+  int (*luapath_list_members)(int (*cb)(void *ud, const char *member,
+                                        int concat),
+                              void *ud);
+  int (*luapath_open_member)(const char *member, void **stream);
+  int (*luapath_read_stream)(void *stream, char *buf, unsigned long *len);
+  int (*luapath_close_stream)(void *stream);
+  int (*luabundle_read_alloc)(char **buf, unsigned long *len);
 };
 
 int luaz_platform_set_ops(const struct luaz_platform_ops *ops);
@@ -809,53 +809,91 @@ static int skipcomment (FILE *f, int *cp) {
 
 
 #if defined(LUAZ_ZOS)
-/* Read a stream into a growable buffer. */
-static int read_stream_alloc(FILE *f, char **out, size_t *out_len) {
-  char *buf = NULL;
-  size_t cap = 0;
-  size_t total = 0;
-
-  if (out == NULL || out_len == NULL)
-    return -1;
-
-  for (;;) {
-    char tmp[4096];
-    size_t n = fread(tmp, 1, sizeof(tmp), f);
-    if (n == 0) {
-      if (ferror(f)) {
-        free(buf);
-        return -1;
-      }
-      break;
+/*
+** Streaming reader for LUAPATH members and DD: scripts. Blocks are read
+** straight into 'buff' and handed to lua_load, so at most one block of
+** the chunk is held by the loader. An optional BOM and a first line
+** starting with '#' are skipped inside the reader; the newline ending
+** that line is kept to preserve line numbers (dropped before a binary
+** chunk, as in the standard loader).
+*/
+typedef struct LoadZ {
+  FILE *f;  /* DD: stream, or NULL when reading a LUAPATH member */
+  void *stream;  /* LUAPATH member stream (luaz_path_open) */
+  int started;  /* first block already scanned for BOM/comment? */
+  int eof;  /* end of stream (or read error) reached */
+  int err;  /* read error */
+  size_t held;  /* bytes of 'buff' still to be returned */
+  size_t total;  /* bytes read from the stream */
+  char buff[BUFSIZ];  /* area for reading the stream */
+} LoadZ;
+
+
+static size_t fillZ (LoadZ *lz) {
+  size_t n;
+  if (lz->eof) return 0;
+  if (lz->f != NULL) {
+    n = fread(lz->buff, 1, sizeof(lz->buff), lz->f);
+    if (n == 0 && ferror(lz->f)) lz->err = 1;
+  }
+  else {
+    unsigned long len = sizeof(lz->buff);
+    if (luaz_path_read(lz->stream, lz->buff, &len) != 0) {
+      lz->err = 1;
+      len = 0;
     }
-    if (total + n < total)
-      {
-        free(buf);
-        return -1;
+    n = (size_t)len;
+  }
+  if (n == 0) lz->eof = 1;
+  lz->total += n;
+  return n;
+}
+
+
+static const char *getZ (lua_State *L, void *ud, size_t *size) {
+  LoadZ *lz = (LoadZ *)ud;
+  size_t n, off = 0;
+  UNUSED(L);
+  if (lz->held > 0) {  /* block kept back behind a pending newline? */
+    *size = lz->held;
+    lz->held = 0;
+    return lz->buff;
+  }
+  n = fillZ(lz);
+  if (!lz->started) {
+    lz->started = 1;
+    if (n >= 3 && (unsigned char)lz->buff[0] == 0xEF &&
+        (unsigned char)lz->buff[1] == 0xBB &&
+        (unsigned char)lz->buff[2] == 0xBF)
+      off = 3;  /* skip BOM */
+    if (off < n && lz->buff[off] == '#') {  /* first-line comment? */
+      const char *nl;
+      while ((nl = (const char *)memchr(lz->buff + off, '\n', n - off))
+             == NULL) {
+        off = 0;
+        if ((n = fillZ(lz)) == 0) return NULL;  /* comment up to EOF */
       }
-    if (total + n > cap) {
-      size_t next = cap == 0 ? 8192 : cap * 2;
-      while (next < total + n)
-        next *= 2;
-      {
-        char *nbuf = (char *)realloc(buf, next);
-        if (nbuf == NULL) {
-          free(buf);
-          return -1;
+      off = ct_diff2sz(nl - lz->buff);  /* keep the newline */
+      if (off + 1 == n) {  /* newline ends the block: peek at the next */
+        n = fillZ(lz);
+        if (n > 0 && lz->buff[0] == LUA_SIGNATURE[0]) {
+          *size = n;  /* binary chunk: drop the newline */
+          return lz->buff;
         }
-        buf = nbuf;
-        cap = next;
+        lz->held = n;
+        *size = 1;
+        return "\n";
       }
+      if (lz->buff[off + 1] == LUA_SIGNATURE[0])
+        off++;  /* binary chunk: drop the newline */
     }
-    memcpy(buf + total, tmp, n);
-    total += n;
   }
-
-  *out = buf;
-  *out_len = total;
-  return 0;
+  if (n <= off) return NULL;
+  *size = n - off;
+  return lz->buff + off;
 }
 
+
 /* Return nonzero if filename references a DDNAME path. */
 static int is_ddname_path(const char *filename) {
   if (filename == NULL)
@@ -869,10 +907,8 @@ static int load_ddname(lua_State *L, const char *filename, int fnameindex,
                        const char *mode) {
   char path[128];
   const char *open_path = filename;
-  FILE *f;
-  char *buf = NULL;
-  size_t len = 0;
-  int status;
+  LoadZ lz;
+  int status, readstatus;
 
   if (strncmp(filename, "//DD:", 5) != 0) {
     int rc = snprintf(path, sizeof(path), "//DD:%s", filename + 3);
@@ -884,23 +920,21 @@ static int load_ddname(lua_State *L, const char *filename, int fnameindex,
     open_path = path;
   }
 
-  f = fopen(open_path, "r");
-  if (f == NULL)
+  memset(&lz, 0, sizeof(lz));
+  errno = 0;
+  lz.f = fopen(open_path, "r");
+  if (lz.f == NULL)
     return errfile(L, "open", fnameindex);
 
-  if (read_stream_alloc(f, &buf, &len) != 0) {
-    fclose(f);
-    free(buf);
+  status = lua_load(L, getZ, &lz, filename, mode);
+  readstatus = lz.err;
+  fclose(lz.f);
+  if (readstatus) {
+    lua_settop(L, fnameindex);  /* ignore results from 'lua_load' */
     lua_pushfstring(L, "cannot read %s", filename);
     lua_remove(L, fnameindex);
     return LUA_ERRFILE;
   }
-  fclose(f);
-
-  status = luaL_loadbufferx(L, buf, len, filename, mode);
-  free(buf);
-  if (status == LUA_OK)
-    return LUA_OK;
   lua_remove(L, fnameindex);
   return status;
 }
@@ -913,12 +947,7 @@ LUALIB_API int luaL_loadfilex (lua_State *L, const char *filename,
   int fnameindex = lua_gettop(L) + 1;  /* index of filename on the stack */
   char member[9];
   unsigned long mlen = sizeof(member);
-  unsigned long buflen = 0;
-  char *buf = NULL;
-  char *work = NULL;
-  const char *start;
-  size_t len;
-  int add_nl = 0;
+  LoadZ lz;
 
   if (filename == NULL) {
     lua_pushliteral(L, "=stdin");
@@ -935,66 +964,21 @@ LUALIB_API int luaL_loadfilex (lua_State *L, const char *filename,
     return LUA_ERRFILE;
   }
 
-  if (luaz_path_load(filename, member, NULL, &buflen) != 0 || buflen == 0) {
+  /* stream the member block by block; no whole-member buffer */
+  memset(&lz, 0, sizeof(lz));
+  if (luaz_path_open(filename, member, &lz.stream) != 0) {
     lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", filename);
     lua_remove(L, fnameindex);
     return LUA_ERRFILE;
   }
-  if (buflen > (unsigned long)(SIZE_MAX - 1)) {
-    lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", filename);
-    lua_remove(L, fnameindex);
-    return LUA_ERRFILE;
-  }
-
-  buf = (char *)malloc((size_t)buflen + 1);
-  if (buf == NULL) {
-    lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", filename);
-    lua_remove(L, fnameindex);
-    return LUA_ERRFILE;
-  }
-  if (luaz_path_load(filename, member, buf, &buflen) != 0) {
-    free(buf);
+  status = lua_load(L, getZ, &lz, lua_tostring(L, -1), mode);
+  luaz_path_close(lz.stream);
+  if (lz.err || lz.total == 0) {  /* read error or empty member */
+    lua_settop(L, fnameindex);  /* ignore results from 'lua_load' */
     lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", filename);
     lua_remove(L, fnameindex);
     return LUA_ERRFILE;
   }
-  buf[buflen] = '\0';
-
-  start = buf;
-  len = (size_t)buflen;
-  if (len >= 3 && (unsigned char)start[0] == 0xEF &&
-      (unsigned char)start[1] == 0xBB &&
-      (unsigned char)start[2] == 0xBF) {
-    start += 3;
-    len -= 3;
-  }
-  if (len > 0 && start[0] == '#') {
-    const char *nl = memchr(start, '\n', len);
-    if (nl != NULL) {
-      start = nl + 1;
-      len = (size_t)(buf + buflen - start);
-      add_nl = 1;
-    }
-  }
-
-  if (add_nl) {
-    work = (char *)malloc(len + 1);
-    if (work == NULL) {
-      free(buf);
-      lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", filename);
-      lua_remove(L, fnameindex);
-      return LUA_ERRFILE;
-    }
-    work[0] = '\n';
-    if (len > 0)
-      memcpy(work + 1, start, len);
-    status = luaL_loadbufferx(L, work, len + 1, lua_tostring(L, -1), mode);
-    free(work);
-  }
-  else {
-    status = luaL_loadbufferx(L, start, len, lua_tostring(L, -1), mode);
-  }
-  free(buf);
   lua_remove(L, fnameindex);
   return status;
 #else
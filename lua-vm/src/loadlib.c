@@ -575,25 +575,167 @@ static int checkload (lua_State *L, int stat, const char *filename) {
 
 
 #if defined(LUAZ_ZOS)
+/*
+** Growable buffer for lua_dump output written back to the bytecode cache.
+*/
+typedef struct BCDump {
+  char *b;
+  size_t n;
+  size_t cap;
+  int err;
+} BCDump;
+
+
+static int bcdump_writer (lua_State *L, const void *p, size_t sz, void *ud) {
+  BCDump *d = (BCDump *)ud;
+  (void)L;
+  if (d->err || p == NULL || sz == 0)
+    return d->err;
+  if (d->n + sz > d->cap) {
+    size_t ncap = (d->cap == 0) ? 4096 : d->cap;
+    char *nb;
+    while (ncap < d->n + sz)
+      ncap *= 2;
+    nb = (char *)realloc(d->b, ncap);
+    if (nb == NULL)
+      return (d->err = 1);
+    d->b = nb;
+    d->cap = ncap;
+  }
+  memcpy(d->b + d->n, p, sz);
+  d->n += sz;
+  return 0;
+}
+
+
+/*
+** Write the compiled chunk at the top of the stack back to the bytecode
+** cache DD. Failures are ignored: the cache is an optimization only.
+*/
+static void bccache_store (lua_State *L, const char *member,
+                           const char *src, unsigned long srclen) {
+  BCDump d = {NULL, 0, 0, 0};
+  if (lua_dump(L, bcdump_writer, &d, 0) == 0 && !d.err && d.n > 0)
+    (void)luaz_path_bc_put(member, src, srclen, d.b, (unsigned long)d.n);
+  free(d.b);
+}
+
+
+/*
+** Compile a LUAPATH member's text into a chunk on the stack: a current
+** bytecode cache (luabc.dd) entry skips the parser, an unloadable entry
+** is treated as a miss, and a fresh compile is written back when
+** write-back is on. Shared by searcher_Lua and the LUAEXEC preload
+** manifest. Returns the luaL_loadbufferx status (error message pushed).
+*/
+int luaz_path_load_chunk (lua_State *L, const char *member,
+                          const char *src, unsigned long srclen) {
+  char *code = NULL;
+  unsigned long codelen = 0;
+  int status;
+  if (src[0] != LUA_SIGNATURE[0] &&
+      luaz_path_bc_get(member, src, srclen, &code, &codelen) == 0) {
+    status = luaL_loadbufferx(L, code, codelen, member, "b");
+    free(code);
+    if (status == LUA_OK)
+      return LUA_OK;
+    lua_pop(L, 1);  /* remove error message */
+  }
+  status = luaL_loadbufferx(L, src, srclen, member, NULL);
+  if (status == LUA_OK && src[0] != LUA_SIGNATURE[0] &&
+      luaz_path_bc_writable())
+    bccache_store(L, member, src, srclen);
+  return status;
+}
+
+
+/*
+** Negative-lookup cache: registry table mapping module names that failed
+** with LUZ47002/LUZ47003 to their error message. Repeated probes (for
+** example 'pcall(require, name)') are answered without dataset I/O until
+** 'package.invalidate' drops the entry.
+*/
+static const char *const NEGCACHE = "_LUZ_NEGCACHE";
+static const char *const NEGHITS = "_LUZ_NEGHITS";
+
+
+static int negcache_raise (lua_State *L, const char *name) {
+  luaL_getsubtable(L, LUA_REGISTRYINDEX, NEGCACHE);
+  if (lua_getfield(L, -1, name) != LUA_TSTRING) {
+    lua_pop(L, 2);
+    return 0;
+  }
+  lua_getfield(L, LUA_REGISTRYINDEX, NEGHITS);
+  lua_pushinteger(L, lua_tointeger(L, -1) + 1);
+  lua_setfield(L, LUA_REGISTRYINDEX, NEGHITS);
+  lua_pop(L, 1);
+  return lua_error(L);  /* cached message is on top */
+}
+
+
+/* record the failure message on top of the stack and raise it */
+static int negcache_fail (lua_State *L, const char *name) {
+  luaL_getsubtable(L, LUA_REGISTRYINDEX, NEGCACHE);
+  lua_pushvalue(L, -2);
+  lua_setfield(L, -2, name);
+  lua_pop(L, 1);
+  return lua_error(L);
+}
+
+
+/*
+** Application bundle (luabundle.dd): full module names are looked up in
+** the bundle TOC; the blob is a slice of the bundle read once per state.
+** Without a configured bundle the searcher is silent.
+*/
+static int searcher_bundle (lua_State *L) {
+  const char *name = luaL_checkstring(L, 1);
+  const char *data = NULL;
+  unsigned long len = 0;
+  int rc = luaz_path_bundle_find(name, &data, &len);
+  if (rc < 0)
+    return 0;  /* no bundle configured */
+  if (rc == 0) {
+    lua_pushfstring(L, "no module '%s' in application bundle", name);
+    return 1;
+  }
+  if (rc != 1)
+    return luaL_error(L, "LUZ47005 application bundle invalid for '%s'",
+                      name);
+  if (luaL_loadbufferx(L, data, (size_t)len, name, NULL) != LUA_OK)
+    return luaL_error(L, "LUZ47004 module load error");
+  lua_pushstring(L, name);
+  return 2;
+}
+
+
 static int searcher_Lua (lua_State *L) {
   const char *name = luaL_checkstring(L, 1);
   char member[9];
   unsigned long mlen = sizeof(member);
   unsigned long buflen = 0;
-  char *buf;
-  if (luaz_path_resolve(name, member, &mlen) != 0)
-    return luaL_error(L, "LUZ47002 LUAMAP entry not found for '%s'", name);
+  char *buf = NULL;
+  int status;
+  negcache_raise(L, name);
+  if (luaz_path_resolve(name, member, &mlen) != 0) {
+    lua_pushfstring(L, "LUZ47002 LUAMAP entry not found for '%s'", name);
+    return negcache_fail(L, name);
+  }
   if (mlen == 0 || mlen > 8)
     return luaL_error(L, "LUZ47001 invalid module name mapping");
 
-  if (luaz_path_load(name, member, NULL, &buflen) != 0 || buflen == 0)
-    return luaL_error(L, "LUZ47003 LUAPATH load failed for '%s'", name);
-
-  buf = (char *)lua_newuserdata(L, buflen);
-  if (luaz_path_load(name, member, buf, &buflen) != 0)
-    return luaL_error(L, "LUZ47003 LUAPATH load failed for '%s'", name);
+  /* one open/read/close per member; no sizing pre-read */
+  if (luaz_path_load_alloc(name, member, &buf, &buflen) != 0 || buflen == 0) {
+    free(buf);
+    lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", name);
+    return negcache_fail(L, name);
+  }
 
-  if (luaL_loadbufferx(L, buf, buflen, member, NULL) != LUA_OK)
+  /* bytecode cache (luabc.dd): skip the parser when the source CRC32
+     matches */
+  status = luaz_path_load_chunk(L, member, buf, buflen);
+  free(buf);
+  if (status != LUA_OK)
     return luaL_error(L, "LUZ47004 module load error");
 
   lua_pushstring(L, member);
@@ -760,11 +902,82 @@ static int ll_require (lua_State *L) {
 /* }====================================================== */
 
 
+#if defined(LUAZ_ZOS)
+/*
+** package.pathstats(): snapshot of LUAPATH/LUAMAP counters kept by the
+** z/OS LUAPATH layer (for example LUAMAP index loads and hits).
+*/
+static int ll_pathstats (lua_State *L) {
+  int i;
+  int n = luaz_path_stat_count();
+  lua_Integer entries = 0;
+  lua_createtable(L, 0, n + 2);
+  for (i = 0; i < n; i++) {
+    const char *name = luaz_path_stat_name(i);
+    if (name == NULL)
+      continue;
+    lua_pushinteger(L, (lua_Integer)luaz_path_stat_value(i));
+    lua_setfield(L, -2, name);
+  }
+  /* per-state negative-lookup cache */
+  lua_getfield(L, LUA_REGISTRYINDEX, NEGHITS);
+  lua_pushinteger(L, lua_tointeger(L, -1));
+  lua_setfield(L, -3, "neg_hits");
+  lua_pop(L, 1);
+  luaL_getsubtable(L, LUA_REGISTRYINDEX, NEGCACHE);
+  lua_pushnil(L);
+  while (lua_next(L, -2) != 0) {
+    lua_pop(L, 1);
+    entries++;
+  }
+  lua_pop(L, 1);
+  lua_pushinteger(L, entries);
+  lua_setfield(L, -2, "neg_entries");
+  return 1;
+}
+
+
+/*
+** package.invalidate([name]): forget cached require failures (one module
+** or all) and drop the LUAMAP/member indexes so LUAPATH changes made
+** during the run become visible. Returns the number of entries removed.
+*/
+static int ll_invalidate (lua_State *L) {
+  lua_Integer removed = 0;
+  const char *name = luaL_optstring(L, 1, NULL);
+  luaL_getsubtable(L, LUA_REGISTRYINDEX, NEGCACHE);
+  if (name != NULL) {
+    if (lua_getfield(L, -1, name) != LUA_TNIL) {
+      lua_pushnil(L);
+      lua_setfield(L, -3, name);
+      removed = 1;
+    }
+    lua_pop(L, 1);
+  }
+  else {
+    lua_pushnil(L);
+    while (lua_next(L, -2) != 0) {
+      lua_pop(L, 1);
+      removed++;
+    }
+    lua_newtable(L);
+    lua_setfield(L, LUA_REGISTRYINDEX, NEGCACHE);
+  }
+  lua_pop(L, 1);
+  luaz_path_invalidate();
+  lua_pushinteger(L, removed);
+  return 1;
+}
+#endif
 
 
 static const luaL_Reg pk_funcs[] = {
   {"loadlib", ll_loadlib},
   {"searchpath", ll_searchpath},
+#if defined(LUAZ_ZOS)
+  {"pathstats", ll_pathstats},
+  {"invalidate", ll_invalidate},
+#endif
   /* placeholders */
   {"preload", NULL},
   {"cpath", NULL},
@@ -784,6 +997,9 @@ static const luaL_Reg ll_funcs[] = {
 static void createsearcherstable (lua_State *L) {
   static const lua_CFunction searchers[] = {
     searcher_preload,
+#if defined(LUAZ_ZOS)
+    searcher_bundle,
+#endif
     searcher_Lua,
     searcher_C,
     searcher_Croot,
@@ -8,6 +8,19 @@
  * |--------|------|---------|
  * | luaz_path_lookup | function | Map long module name to member via LUAMAP |
  * | luaz_path_load | function | Load module source from LUAPATH |
+ * | luaz_path_load_alloc | function | Load module source in one read pass |
+ * | luaz_path_open | function | Open a LUAPATH member for block reads |
+ * | luaz_path_read | function | Read the next block of an open member |
+ * | luaz_path_close | function | Close an open member stream |
+ * | luaz_path_bundle_find | function | Look up a module in the application bundle |
+ * | luaz_path_bc_get | function | Fetch validated bytecode from the cache DD |
+ * | luaz_path_bc_put | function | Store bytecode in the cache DD |
+ * | luaz_path_bc_writable | function | Report whether cache write-back is on |
+ * | luaz_path_load_chunk | function | Compile member text via the bytecode cache |
+ * | luaz_path_invalidate | function | Drop cached LUAMAP and member indexes |
+ * | luaz_path_stat_count | function | Return number of LUAPATH counters |
+ * | luaz_path_stat_name | function | Get LUAPATH counter name by index |
+ * | luaz_path_stat_value | function | Get LUAPATH counter value by index |
  */
 #ifndef PTHSTB_H
 #define PTHSTB_H
@@ -15,6 +28,26 @@
 int luaz_path_lookup(const char *modname, char *member, unsigned long *len);
 int luaz_path_load(const char *modname, const char *member,
                    char *buf, unsigned long *len);
+int luaz_path_load_alloc(const char *modname, const char *member,
+                         char **buf, unsigned long *len);
 int luaz_path_resolve(const char *modname, char *member, unsigned long *len);
+int luaz_path_open(const char *modname, const char *member, void **stream);
+int luaz_path_read(void *stream, char *buf, unsigned long *len);
+void luaz_path_close(void *stream);
+int luaz_path_bundle_find(const char *modname, const char **data,
+                          unsigned long *len);
+int luaz_path_bc_get(const char *member, const char *src,
+                     unsigned long srclen, char **code,
+                     unsigned long *codelen);
+int luaz_path_bc_put(const char *member, const char *src,
+                     unsigned long srclen, const char *code,
+                     unsigned long codelen);
+int luaz_path_bc_writable(void);
+int luaz_path_load_chunk(struct lua_State *L, const char *member,
+                         const char *src, unsigned long srclen);
+void luaz_path_invalidate(void);
+int luaz_path_stat_count(void);
+const char *luaz_path_stat_name(int index);
+unsigned long luaz_path_stat_value(int index);
 
 #endif /* PTHSTB_H */
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+#
+# Build and run an off-host benchmark against the IOHOST stand-in backend.
+#
+# Object Table:
+# | Object | Kind | Purpose |
+# |--------|------|---------|
+# | host_bench.sh | script | Compile lua-vm (LUAZ_ZOS) + LUAPATH core on the host and run a bench |
+#
+# Usage: scripts/host_bench.sh <bench> [args...]   (bench: tests/bench/<bench>.c)
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BENCH=${1:?usage: host_bench.sh <bench> [args...]}
+shift
+OUT=${HOST_BENCH_DIR:-"$ROOT/build/host"}
+CC=${CC:-cc}
+CORE_SRCS=${HOST_BENCH_SRCS:-"bundle codec crc32 dscopy dsdec dsgrep dsmem dsrec dssort iohost lscan lzmem path pdsdir platform policy"}
+
+mkdir -p "$OUT/inc" "$OUT/obj" "$OUT/data"
+# PDS member-style includes ("PATH", "POLICY", ...) -> include/*.h
+tr -d '\r' < "$ROOT/pds-map-inc.csv" | tail -n +2 | while IFS=, read -r rel mem; do
+  [ -n "$mem" ] && ln -sf "$ROOT/$rel" "$OUT/inc/$mem"
+done
+
+CFLAGS="-O2 -std=gnu99 -DLUAZ_ZOS -DLUA_USE_LINUX -I$ROOT/lua-vm/src -I$OUT/inc"
+OBJS=""
+for f in "$ROOT"/lua-vm/src/*.c; do
+  b=$(basename "$f" .c)
+  case "$b" in lua|luac) continue ;; esac
+  $CC $CFLAGS -c "$f" -o "$OUT/obj/$b.o"
+  OBJS="$OBJS $OUT/obj/$b.o"
+done
+for b in $CORE_SRCS; do
+  $CC $CFLAGS -c "$ROOT/src/$b.c" -o "$OUT/obj/src_$b.o"
+  OBJS="$OBJS $OUT/obj/src_$b.o"
+done
+$CC $CFLAGS -o "$OUT/$BENCH" "$ROOT/tests/bench/$BENCH.c" $OBJS -lm -ldl -lpthread
+"$OUT/$BENCH" "$OUT/data" "$@"
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO application bundle reader and writer.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bundle_get_u32 | function | Fetch a big-endian 32-bit field |
+ * | bundle_put_u32 | function | Store a big-endian 32-bit field |
+ * | bundle_name_cmp | function | Compare a name with a TOC entry name |
+ * | bundle_item_cmp | function | qsort comparator for writer items |
+ * | luaz_bundle_open | function | Validate a bundle image and set up a view |
+ * | luaz_bundle_find | function | Binary-search the TOC for a module |
+ * | luaz_bundle_entry | function | Return a TOC entry by index |
+ * | luaz_bundle_build | function | Build a bundle image from modules |
+ *
+ * Platform Requirements:
+ * - Pure byte handling; no I/O. Callers read the image in one pass.
+ * - Names compare as raw bytes (EBCDIC order on z/OS).
+ */
+#include "BUNDLE"
+#include "CRC32"
+#include "ERRORS"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const unsigned char g_bundle_magic[4] = {'L', 'Z', 'A', 'B'};
+
+static unsigned long bundle_get_u32(const unsigned char *p)
+{
+  return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+         ((unsigned long)p[2] << 8) | (unsigned long)p[3];
+}
+
+static void bundle_put_u32(unsigned char *p, unsigned long v)
+{
+  p[0] = (unsigned char)((v >> 24) & 0xFFu);
+  p[1] = (unsigned char)((v >> 16) & 0xFFu);
+  p[2] = (unsigned char)((v >> 8) & 0xFFu);
+  p[3] = (unsigned char)(v & 0xFFu);
+}
+
+/**
+ * @brief Compare a name with the name of a TOC entry.
+ *
+ * @param b Bundle view.
+ * @param ent TOC entry.
+ * @param name Name bytes.
+ * @param nlen Name length.
+ * @return <0, 0 or >0 like memcmp (shorter name sorts first on a tie).
+ */
+static int bundle_name_cmp(const struct luaz_bundle *b,
+                           const unsigned char *ent, const char *name,
+                           size_t nlen)
+{
+  unsigned long eoff = bundle_get_u32(ent);
+  unsigned long elen = bundle_get_u32(ent + 4);
+  size_t n = (nlen < (size_t)elen) ? nlen : (size_t)elen;
+  int rc = memcmp(name, b->names + eoff, n);
+
+  if (rc != 0)
+    return rc;
+  if (nlen == (size_t)elen)
+    return 0;
+  return (nlen < (size_t)elen) ? -1 : 1;
+}
+
+static int bundle_item_cmp(const void *a, const void *b)
+{
+  const struct luaz_bundle_item *x = (const struct luaz_bundle_item *)a;
+  const struct luaz_bundle_item *y = (const struct luaz_bundle_item *)b;
+  size_t xl = strlen(x->name);
+  size_t yl = strlen(y->name);
+  int rc = memcmp(x->name, y->name, (xl < yl) ? xl : yl);
+
+  if (rc != 0)
+    return rc;
+  if (xl == yl)
+    return 0;
+  return (xl < yl) ? -1 : 1;
+}
+
+int luaz_bundle_open(struct luaz_bundle *b, const void *buf,
+                     unsigned long len)
+{
+  const unsigned char *p = (const unsigned char *)buf;
+  unsigned long count;
+  unsigned long toc_off;
+  unsigned long names_len;
+  unsigned long data_off;
+  unsigned long total;
+  unsigned long i;
+
+  if (b == NULL || p == NULL || len < LUAZ_BUNDLE_HDR_LEN)
+    return LUZ_E_BUNDLE;
+  memset(b, 0, sizeof(*b));
+  if (memcmp(p, g_bundle_magic, sizeof(g_bundle_magic)) != 0 ||
+      bundle_get_u32(p + 4) != LUAZ_BUNDLE_VERSION)
+    return LUZ_E_BUNDLE;
+  count = bundle_get_u32(p + 8);
+  toc_off = bundle_get_u32(p + 12);
+  names_len = bundle_get_u32(p + 16);
+  data_off = bundle_get_u32(p + 20);
+  total = bundle_get_u32(p + 24);
+
+  /* Total length excludes record padding; everything must fit inside. */
+  if (total > len || toc_off < LUAZ_BUNDLE_HDR_LEN || toc_off > total ||
+      count > (total - toc_off) / LUAZ_BUNDLE_TOC_LEN)
+    return LUZ_E_BUNDLE;
+  if (names_len > total - toc_off - count * LUAZ_BUNDLE_TOC_LEN ||
+      data_off != toc_off + count * LUAZ_BUNDLE_TOC_LEN + names_len)
+    return LUZ_E_BUNDLE;
+  if ((unsigned long)luaz_crc32(p + toc_off, (size_t)(data_off - toc_off)) !=
+      bundle_get_u32(p + 28))
+    return LUZ_E_BUNDLE;
+
+  b->base = p;
+  b->len = total;
+  b->count = count;
+  b->toc = p + toc_off;
+  b->names = p + toc_off + count * LUAZ_BUNDLE_TOC_LEN;
+  b->names_len = names_len;
+
+  for (i = 0; i < count; i++) {
+    const unsigned char *ent = b->toc + i * LUAZ_BUNDLE_TOC_LEN;
+    unsigned long noff = bundle_get_u32(ent);
+    unsigned long nlen = bundle_get_u32(ent + 4);
+    unsigned long doff = bundle_get_u32(ent + 8);
+    unsigned long dlen = bundle_get_u32(ent + 12);
+
+    if (nlen == 0 || noff > names_len || nlen > names_len - noff ||
+        doff < data_off || doff > total || dlen > total - doff) {
+      memset(b, 0, sizeof(*b));
+      return LUZ_E_BUNDLE;
+    }
+    /* The TOC must be strictly sorted for the binary search. */
+    if (i > 0 &&
+        bundle_name_cmp(b, ent - LUAZ_BUNDLE_TOC_LEN,
+                        (const char *)b->names + noff, (size_t)nlen) <= 0) {
+      memset(b, 0, sizeof(*b));
+      return LUZ_E_BUNDLE;
+    }
+  }
+  return 0;
+}
+
+int luaz_bundle_find(const struct luaz_bundle *b, const char *name,
+                     const char **data, unsigned long *len)
+{
+  unsigned long lo = 0;
+  unsigned long hi;
+  size_t nlen;
+
+  if (b == NULL || b->base == NULL || name == NULL || data == NULL ||
+      len == NULL)
+    return 0;
+  nlen = strlen(name);
+  hi = b->count;
+  while (lo < hi) {
+    unsigned long mid = lo + (hi - lo) / 2;
+    const unsigned char *ent = b->toc + mid * LUAZ_BUNDLE_TOC_LEN;
+    int rc = bundle_name_cmp(b, ent, name, nlen);
+
+    if (rc == 0) {
+      unsigned long doff = bundle_get_u32(ent + 8);
+      unsigned long dlen = bundle_get_u32(ent + 12);
+
+      if ((unsigned long)luaz_crc32(b->base + doff, (size_t)dlen) !=
+          bundle_get_u32(ent + 16))
+        return LUZ_E_BUNDLE;
+      *data = (const char *)b->base + doff;
+      *len = dlen;
+      return 1;
+    }
+    if (rc < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return 0;
+}
+
+int luaz_bundle_entry(const struct luaz_bundle *b, unsigned long index,
+                      const char **name, unsigned long *name_len,
+                      unsigned long *data_len)
+{
+  const unsigned char *ent;
+
+  if (b == NULL || b->base == NULL || index >= b->count || name == NULL ||
+      name_len == NULL)
+    return LUZ_E_BUNDLE;
+  ent = b->toc + index * LUAZ_BUNDLE_TOC_LEN;
+  *name = (const char *)b->names + bundle_get_u32(ent);
+  *name_len = bundle_get_u32(ent + 4);
+  if (data_len != NULL)
+    *data_len = bundle_get_u32(ent + 12);
+  return 0;
+}
+
+int luaz_bundle_build(struct luaz_bundle_item *items, unsigned long count,
+                      char **out, unsigned long *out_len)
+{
+  unsigned long names_len = 0;
+  unsigned long data_len = 0;
+  unsigned long toc_off = LUAZ_BUNDLE_HDR_LEN;
+  unsigned long data_off;
+  unsigned long total;
+  unsigned long noff = 0;
+  unsigned long doff;
+  unsigned char *img;
+  unsigned long i;
+
+  if (out == NULL || out_len == NULL || (items == NULL && count > 0))
+    return LUZ_E_BUNDLE;
+  *out = NULL;
+  *out_len = 0;
+  for (i = 0; i < count; i++) {
+    size_t nlen;
+    if (items[i].name == NULL || (items[i].data == NULL && items[i].len > 0))
+      return LUZ_E_BUNDLE;
+    nlen = strlen(items[i].name);
+    if (nlen == 0)
+      return LUZ_E_BUNDLE;
+    names_len += (unsigned long)nlen;
+    data_len += items[i].len;
+  }
+  if (count > 0)
+    qsort(items, (size_t)count, sizeof(*items), bundle_item_cmp);
+  for (i = 1; i < count; i++) {
+    if (bundle_item_cmp(&items[i - 1], &items[i]) == 0)
+      return LUZ_E_BUNDLE;
+  }
+
+  data_off = toc_off + count * LUAZ_BUNDLE_TOC_LEN + names_len;
+  total = data_off + data_len;
+  img = (unsigned char *)malloc(total > 0 ? (size_t)total : 1u);
+  if (img == NULL)
+    return LUZ_E_BUNDLE;
+
+  memcpy(img, g_bundle_magic, sizeof(g_bundle_magic));
+  bundle_put_u32(img + 4, LUAZ_BUNDLE_VERSION);
+  bundle_put_u32(img + 8, count);
+  bundle_put_u32(img + 12, toc_off);
+  bundle_put_u32(img + 16, names_len);
+  bundle_put_u32(img + 20, data_off);
+  bundle_put_u32(img + 24, total);
+
+  doff = data_off;
+  for (i = 0; i < count; i++) {
+    unsigned char *ent = img + toc_off + i * LUAZ_BUNDLE_TOC_LEN;
+    unsigned long nlen = (unsigned long)strlen(items[i].name);
+
+    memcpy(img + toc_off + count * LUAZ_BUNDLE_TOC_LEN + noff,
+           items[i].name, (size_t)nlen);
+    if (items[i].len > 0)
+      memcpy(img + doff, items[i].data, (size_t)items[i].len);
+    bundle_put_u32(ent, noff);
+    bundle_put_u32(ent + 4, nlen);
+    bundle_put_u32(ent + 8, doff);
+    bundle_put_u32(ent + 12, items[i].len);
+    bundle_put_u32(ent + 16,
+                   (unsigned long)luaz_crc32(img + doff,
+                                             (size_t)items[i].len));
+    noff += nlen;
+    doff += items[i].len;
+  }
+  bundle_put_u32(img + 28,
+                 (unsigned long)luaz_crc32(img + toc_off,
+                                           (size_t)(data_off - toc_off)));
+
+  *out = (char *)img;
+  *out_len = total;
+  return 0;
+}
@@ -0,0 +1,816 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO character set conversion (codec module, ds encoding= option).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | g_e*_l1, g_l1_e* | table | EBCDIC code page to/from ISO-8859-1 |
+ * | codec_alias | struct | Encoding name alias |
+ * | codec_to_l1 | function | Table from an encoding to ISO-8859-1 |
+ * | codec_from_l1 | function | Table from ISO-8859-1 to an encoding |
+ * | codec_map | function | Map bytes through a table, 8 at a time |
+ * | codec_encode | function | Map bytes and encode them as UTF-8 |
+ * | codec_utf8_next | function | Decode and validate one UTF-8 sequence |
+ * | codec_decode | function | Decode UTF-8 and map code points to bytes |
+ * | codec_check | function | Check an encoding name argument |
+ * | l_codec_convert | function | Lua codec.convert(s, from, to [, repl]) |
+ * | luaz_codec_find | function | Look up an encoding name |
+ * | luaz_codec_name | function | Canonical name of an encoding id |
+ * | luaz_codec_newline | function | Newline byte of an encoding |
+ * | luaz_codec_space | function | Blank byte of an encoding |
+ * | luaz_codec_init | function | Prepare a conversion |
+ * | luaz_codec_text | function | Map one newline byte onto another |
+ * | luaz_codec_bound | function | Worst-case output size |
+ * | luaz_codec_run | function | Convert a byte range |
+ * | luaz_codec_partial | function | Length of an incomplete UTF-8 tail |
+ * | luaz_codec_push | function | Convert a byte range into a Lua string |
+ * | luaopen_codec | function | Lua module entrypoint |
+ *
+ * The EBCDIC tables follow the z/OS conventions for text: NL (0x15) maps
+ * to LF (0x0A) and LF (0x25) to NEL (0x85), as iconv and the z/OS UNIX
+ * tools do. IBM-273 maps 0xBC to the macron (0xAF), the ISO-8859-1
+ * character of the original code page.
+ *
+ * Platform Requirements:
+ * - The tables are fixed byte values, independent of the compile-time
+ *   character set; encoding names are compared in the native one.
+ */
+#include "CODEC"
+#include "ERRORS"
+
+#include "LAUXLIB"
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CODEC_HIGH 0x8080808080808080ULL
+#define CODEC_NAME_MAX 16
+
+static const unsigned char g_e1047_l1[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x9C, 0x09, 0x86, 0x7F,
+    0x97, 0x8D, 0x8E, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x9D, 0x0A, 0x08, 0x87,
+    0x18, 0x19, 0x92, 0x8F, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x17, 0x1B,
+    0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x05, 0x06, 0x07,
+    0x90, 0x91, 0x16, 0x93, 0x94, 0x95, 0x96, 0x04,
+    0x98, 0x99, 0x9A, 0x9B, 0x14, 0x15, 0x9E, 0x1A,
+    0x20, 0xA0, 0xE2, 0xE4, 0xE0, 0xE1, 0xE3, 0xE5,
+    0xE7, 0xF1, 0xA2, 0x2E, 0x3C, 0x28, 0x2B, 0x7C,
+    0x26, 0xE9, 0xEA, 0xEB, 0xE8, 0xED, 0xEE, 0xEF,
+    0xEC, 0xDF, 0x21, 0x24, 0x2A, 0x29, 0x3B, 0x5E,
+    0x2D, 0x2F, 0xC2, 0xC4, 0xC0, 0xC1, 0xC3, 0xC5,
+    0xC7, 0xD1, 0xA6, 0x2C, 0x25, 0x5F, 0x3E, 0x3F,
+    0xF8, 0xC9, 0xCA, 0xCB, 0xC8, 0xCD, 0xCE, 0xCF,
+    0xCC, 0x60, 0x3A, 0x23, 0x40, 0x27, 0x3D, 0x22,
+    0xD8, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0xAB, 0xBB, 0xF0, 0xFD, 0xFE, 0xB1,
+    0xB0, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70,
+    0x71, 0x72, 0xAA, 0xBA, 0xE6, 0xB8, 0xC6, 0xA4,
+    0xB5, 0x7E, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+    0x79, 0x7A, 0xA1, 0xBF, 0xD0, 0x5B, 0xDE, 0xAE,
+    0xAC, 0xA3, 0xA5, 0xB7, 0xA9, 0xA7, 0xB6, 0xBC,
+    0xBD, 0xBE, 0xDD, 0xA8, 0xAF, 0x5D, 0xB4, 0xD7,
+    0x7B, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0xAD, 0xF4, 0xF6, 0xF2, 0xF3, 0xF5,
+    0x7D, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50,
+    0x51, 0x52, 0xB9, 0xFB, 0xFC, 0xF9, 0xFA, 0xFF,
+    0x5C, 0xF7, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5A, 0xB2, 0xD4, 0xD6, 0xD2, 0xD3, 0xD5,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0xB3, 0xDB, 0xDC, 0xD9, 0xDA, 0x9F
+};
+
+static const unsigned char g_l1_e1047[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x37, 0x2D, 0x2E, 0x2F,
+    0x16, 0x05, 0x15, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x3C, 0x3D, 0x32, 0x26,
+    0x18, 0x19, 0x3F, 0x27, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x40, 0x5A, 0x7F, 0x7B, 0x5B, 0x6C, 0x50, 0x7D,
+    0x4D, 0x5D, 0x5C, 0x4E, 0x6B, 0x60, 0x4B, 0x61,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+    0xF8, 0xF9, 0x7A, 0x5E, 0x4C, 0x7E, 0x6E, 0x6F,
+    0x7C, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6,
+    0xD7, 0xD8, 0xD9, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6,
+    0xE7, 0xE8, 0xE9, 0xAD, 0xE0, 0xBD, 0x5F, 0x6D,
+    0x79, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,
+    0x97, 0x98, 0x99, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6,
+    0xA7, 0xA8, 0xA9, 0xC0, 0x4F, 0xD0, 0xA1, 0x07,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x06, 0x17,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x09, 0x0A, 0x1B,
+    0x30, 0x31, 0x1A, 0x33, 0x34, 0x35, 0x36, 0x08,
+    0x38, 0x39, 0x3A, 0x3B, 0x04, 0x14, 0x3E, 0xFF,
+    0x41, 0xAA, 0x4A, 0xB1, 0x9F, 0xB2, 0x6A, 0xB5,
+    0xBB, 0xB4, 0x9A, 0x8A, 0xB0, 0xCA, 0xAF, 0xBC,
+    0x90, 0x8F, 0xEA, 0xFA, 0xBE, 0xA0, 0xB6, 0xB3,
+    0x9D, 0xDA, 0x9B, 0x8B, 0xB7, 0xB8, 0xB9, 0xAB,
+    0x64, 0x65, 0x62, 0x66, 0x63, 0x67, 0x9E, 0x68,
+    0x74, 0x71, 0x72, 0x73, 0x78, 0x75, 0x76, 0x77,
+    0xAC, 0x69, 0xED, 0xEE, 0xEB, 0xEF, 0xEC, 0xBF,
+    0x80, 0xFD, 0xFE, 0xFB, 0xFC, 0xBA, 0xAE, 0x59,
+    0x44, 0x45, 0x42, 0x46, 0x43, 0x47, 0x9C, 0x48,
+    0x54, 0x51, 0x52, 0x53, 0x58, 0x55, 0x56, 0x57,
+    0x8C, 0x49, 0xCD, 0xCE, 0xCB, 0xCF, 0xCC, 0xE1,
+    0x70, 0xDD, 0xDE, 0xDB, 0xDC, 0x8D, 0x8E, 0xDF
+};
+
+static const unsigned char g_e037_l1[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x9C, 0x09, 0x86, 0x7F,
+    0x97, 0x8D, 0x8E, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x9D, 0x0A, 0x08, 0x87,
+    0x18, 0x19, 0x92, 0x8F, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x17, 0x1B,
+    0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x05, 0x06, 0x07,
+    0x90, 0x91, 0x16, 0x93, 0x94, 0x95, 0x96, 0x04,
+    0x98, 0x99, 0x9A, 0x9B, 0x14, 0x15, 0x9E, 0x1A,
+    0x20, 0xA0, 0xE2, 0xE4, 0xE0, 0xE1, 0xE3, 0xE5,
+    0xE7, 0xF1, 0xA2, 0x2E, 0x3C, 0x28, 0x2B, 0x7C,
+    0x26, 0xE9, 0xEA, 0xEB, 0xE8, 0xED, 0xEE, 0xEF,
+    0xEC, 0xDF, 0x21, 0x24, 0x2A, 0x29, 0x3B, 0xAC,
+    0x2D, 0x2F, 0xC2, 0xC4, 0xC0, 0xC1, 0xC3, 0xC5,
+    0xC7, 0xD1, 0xA6, 0x2C, 0x25, 0x5F, 0x3E, 0x3F,
+    0xF8, 0xC9, 0xCA, 0xCB, 0xC8, 0xCD, 0xCE, 0xCF,
+    0xCC, 0x60, 0x3A, 0x23, 0x40, 0x27, 0x3D, 0x22,
+    0xD8, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0xAB, 0xBB, 0xF0, 0xFD, 0xFE, 0xB1,
+    0xB0, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70,
+    0x71, 0x72, 0xAA, 0xBA, 0xE6, 0xB8, 0xC6, 0xA4,
+    0xB5, 0x7E, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+    0x79, 0x7A, 0xA1, 0xBF, 0xD0, 0xDD, 0xDE, 0xAE,
+    0x5E, 0xA3, 0xA5, 0xB7, 0xA9, 0xA7, 0xB6, 0xBC,
+    0xBD, 0xBE, 0x5B, 0x5D, 0xAF, 0xA8, 0xB4, 0xD7,
+    0x7B, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0xAD, 0xF4, 0xF6, 0xF2, 0xF3, 0xF5,
+    0x7D, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50,
+    0x51, 0x52, 0xB9, 0xFB, 0xFC, 0xF9, 0xFA, 0xFF,
+    0x5C, 0xF7, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5A, 0xB2, 0xD4, 0xD6, 0xD2, 0xD3, 0xD5,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0xB3, 0xDB, 0xDC, 0xD9, 0xDA, 0x9F
+};
+
+static const unsigned char g_l1_e037[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x37, 0x2D, 0x2E, 0x2F,
+    0x16, 0x05, 0x15, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x3C, 0x3D, 0x32, 0x26,
+    0x18, 0x19, 0x3F, 0x27, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x40, 0x5A, 0x7F, 0x7B, 0x5B, 0x6C, 0x50, 0x7D,
+    0x4D, 0x5D, 0x5C, 0x4E, 0x6B, 0x60, 0x4B, 0x61,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+    0xF8, 0xF9, 0x7A, 0x5E, 0x4C, 0x7E, 0x6E, 0x6F,
+    0x7C, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6,
+    0xD7, 0xD8, 0xD9, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6,
+    0xE7, 0xE8, 0xE9, 0xBA, 0xE0, 0xBB, 0xB0, 0x6D,
+    0x79, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,
+    0x97, 0x98, 0x99, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6,
+    0xA7, 0xA8, 0xA9, 0xC0, 0x4F, 0xD0, 0xA1, 0x07,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x06, 0x17,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x09, 0x0A, 0x1B,
+    0x30, 0x31, 0x1A, 0x33, 0x34, 0x35, 0x36, 0x08,
+    0x38, 0x39, 0x3A, 0x3B, 0x04, 0x14, 0x3E, 0xFF,
+    0x41, 0xAA, 0x4A, 0xB1, 0x9F, 0xB2, 0x6A, 0xB5,
+    0xBD, 0xB4, 0x9A, 0x8A, 0x5F, 0xCA, 0xAF, 0xBC,
+    0x90, 0x8F, 0xEA, 0xFA, 0xBE, 0xA0, 0xB6, 0xB3,
+    0x9D, 0xDA, 0x9B, 0x8B, 0xB7, 0xB8, 0xB9, 0xAB,
+    0x64, 0x65, 0x62, 0x66, 0x63, 0x67, 0x9E, 0x68,
+    0x74, 0x71, 0x72, 0x73, 0x78, 0x75, 0x76, 0x77,
+    0xAC, 0x69, 0xED, 0xEE, 0xEB, 0xEF, 0xEC, 0xBF,
+    0x80, 0xFD, 0xFE, 0xFB, 0xFC, 0xAD, 0xAE, 0x59,
+    0x44, 0x45, 0x42, 0x46, 0x43, 0x47, 0x9C, 0x48,
+    0x54, 0x51, 0x52, 0x53, 0x58, 0x55, 0x56, 0x57,
+    0x8C, 0x49, 0xCD, 0xCE, 0xCB, 0xCF, 0xCC, 0xE1,
+    0x70, 0xDD, 0xDE, 0xDB, 0xDC, 0x8D, 0x8E, 0xDF
+};
+
+static const unsigned char g_e273_l1[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x9C, 0x09, 0x86, 0x7F,
+    0x97, 0x8D, 0x8E, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x9D, 0x0A, 0x08, 0x87,
+    0x18, 0x19, 0x92, 0x8F, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x17, 0x1B,
+    0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x05, 0x06, 0x07,
+    0x90, 0x91, 0x16, 0x93, 0x94, 0x95, 0x96, 0x04,
+    0x98, 0x99, 0x9A, 0x9B, 0x14, 0x15, 0x9E, 0x1A,
+    0x20, 0xA0, 0xE2, 0x7B, 0xE0, 0xE1, 0xE3, 0xE5,
+    0xE7, 0xF1, 0xC4, 0x2E, 0x3C, 0x28, 0x2B, 0x21,
+    0x26, 0xE9, 0xEA, 0xEB, 0xE8, 0xED, 0xEE, 0xEF,
+    0xEC, 0x7E, 0xDC, 0x24, 0x2A, 0x29, 0x3B, 0x5E,
+    0x2D, 0x2F, 0xC2, 0x5B, 0xC0, 0xC1, 0xC3, 0xC5,
+    0xC7, 0xD1, 0xF6, 0x2C, 0x25, 0x5F, 0x3E, 0x3F,
+    0xF8, 0xC9, 0xCA, 0xCB, 0xC8, 0xCD, 0xCE, 0xCF,
+    0xCC, 0x60, 0x3A, 0x23, 0xA7, 0x27, 0x3D, 0x22,
+    0xD8, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0xAB, 0xBB, 0xF0, 0xFD, 0xFE, 0xB1,
+    0xB0, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70,
+    0x71, 0x72, 0xAA, 0xBA, 0xE6, 0xB8, 0xC6, 0xA4,
+    0xB5, 0xDF, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+    0x79, 0x7A, 0xA1, 0xBF, 0xD0, 0xDD, 0xDE, 0xAE,
+    0xA2, 0xA3, 0xA5, 0xB7, 0xA9, 0x40, 0xB6, 0xBC,
+    0xBD, 0xBE, 0xAC, 0x7C, 0xAF, 0xA8, 0xB4, 0xD7,
+    0xE4, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0xAD, 0xF4, 0xA6, 0xF2, 0xF3, 0xF5,
+    0xFC, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50,
+    0x51, 0x52, 0xB9, 0xFB, 0x7D, 0xF9, 0xFA, 0xFF,
+    0xD6, 0xF7, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5A, 0xB2, 0xD4, 0x5C, 0xD2, 0xD3, 0xD5,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0xB3, 0xDB, 0x5D, 0xD9, 0xDA, 0x9F
+};
+
+static const unsigned char g_l1_e273[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x37, 0x2D, 0x2E, 0x2F,
+    0x16, 0x05, 0x15, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x3C, 0x3D, 0x32, 0x26,
+    0x18, 0x19, 0x3F, 0x27, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x40, 0x4F, 0x7F, 0x7B, 0x5B, 0x6C, 0x50, 0x7D,
+    0x4D, 0x5D, 0x5C, 0x4E, 0x6B, 0x60, 0x4B, 0x61,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+    0xF8, 0xF9, 0x7A, 0x5E, 0x4C, 0x7E, 0x6E, 0x6F,
+    0xB5, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6,
+    0xD7, 0xD8, 0xD9, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6,
+    0xE7, 0xE8, 0xE9, 0x63, 0xEC, 0xFC, 0x5F, 0x6D,
+    0x79, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,
+    0x97, 0x98, 0x99, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6,
+    0xA7, 0xA8, 0xA9, 0x43, 0xBB, 0xDC, 0x59, 0x07,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x06, 0x17,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x09, 0x0A, 0x1B,
+    0x30, 0x31, 0x1A, 0x33, 0x34, 0x35, 0x36, 0x08,
+    0x38, 0x39, 0x3A, 0x3B, 0x04, 0x14, 0x3E, 0xFF,
+    0x41, 0xAA, 0xB0, 0xB1, 0x9F, 0xB2, 0xCC, 0x7C,
+    0xBD, 0xB4, 0x9A, 0x8A, 0xBA, 0xCA, 0xAF, 0xBC,
+    0x90, 0x8F, 0xEA, 0xFA, 0xBE, 0xA0, 0xB6, 0xB3,
+    0x9D, 0xDA, 0x9B, 0x8B, 0xB7, 0xB8, 0xB9, 0xAB,
+    0x64, 0x65, 0x62, 0x66, 0x4A, 0x67, 0x9E, 0x68,
+    0x74, 0x71, 0x72, 0x73, 0x78, 0x75, 0x76, 0x77,
+    0xAC, 0x69, 0xED, 0xEE, 0xEB, 0xEF, 0xE0, 0xBF,
+    0x80, 0xFD, 0xFE, 0xFB, 0x5A, 0xAD, 0xAE, 0xA1,
+    0x44, 0x45, 0x42, 0x46, 0xC0, 0x47, 0x9C, 0x48,
+    0x54, 0x51, 0x52, 0x53, 0x58, 0x55, 0x56, 0x57,
+    0x8C, 0x49, 0xCD, 0xCE, 0xCB, 0xCF, 0x6A, 0xE1,
+    0x70, 0xDD, 0xDE, 0xDB, 0xD0, 0x8D, 0x8E, 0xDF
+};
+
+static const unsigned char g_e500_l1[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x9C, 0x09, 0x86, 0x7F,
+    0x97, 0x8D, 0x8E, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x9D, 0x0A, 0x08, 0x87,
+    0x18, 0x19, 0x92, 0x8F, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x17, 0x1B,
+    0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x05, 0x06, 0x07,
+    0x90, 0x91, 0x16, 0x93, 0x94, 0x95, 0x96, 0x04,
+    0x98, 0x99, 0x9A, 0x9B, 0x14, 0x15, 0x9E, 0x1A,
+    0x20, 0xA0, 0xE2, 0xE4, 0xE0, 0xE1, 0xE3, 0xE5,
+    0xE7, 0xF1, 0x5B, 0x2E, 0x3C, 0x28, 0x2B, 0x21,
+    0x26, 0xE9, 0xEA, 0xEB, 0xE8, 0xED, 0xEE, 0xEF,
+    0xEC, 0xDF, 0x5D, 0x24, 0x2A, 0x29, 0x3B, 0x5E,
+    0x2D, 0x2F, 0xC2, 0xC4, 0xC0, 0xC1, 0xC3, 0xC5,
+    0xC7, 0xD1, 0xA6, 0x2C, 0x25, 0x5F, 0x3E, 0x3F,
+    0xF8, 0xC9, 0xCA, 0xCB, 0xC8, 0xCD, 0xCE, 0xCF,
+    0xCC, 0x60, 0x3A, 0x23, 0x40, 0x27, 0x3D, 0x22,
+    0xD8, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0xAB, 0xBB, 0xF0, 0xFD, 0xFE, 0xB1,
+    0xB0, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70,
+    0x71, 0x72, 0xAA, 0xBA, 0xE6, 0xB8, 0xC6, 0xA4,
+    0xB5, 0x7E, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+    0x79, 0x7A, 0xA1, 0xBF, 0xD0, 0xDD, 0xDE, 0xAE,
+    0xA2, 0xA3, 0xA5, 0xB7, 0xA9, 0xA7, 0xB6, 0xBC,
+    0xBD, 0xBE, 0xAC, 0x7C, 0xAF, 0xA8, 0xB4, 0xD7,
+    0x7B, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0xAD, 0xF4, 0xF6, 0xF2, 0xF3, 0xF5,
+    0x7D, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50,
+    0x51, 0x52, 0xB9, 0xFB, 0xFC, 0xF9, 0xFA, 0xFF,
+    0x5C, 0xF7, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5A, 0xB2, 0xD4, 0xD6, 0xD2, 0xD3, 0xD5,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0xB3, 0xDB, 0xDC, 0xD9, 0xDA, 0x9F
+};
+
+static const unsigned char g_l1_e500[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x37, 0x2D, 0x2E, 0x2F,
+    0x16, 0x05, 0x15, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x3C, 0x3D, 0x32, 0x26,
+    0x18, 0x19, 0x3F, 0x27, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x40, 0x4F, 0x7F, 0x7B, 0x5B, 0x6C, 0x50, 0x7D,
+    0x4D, 0x5D, 0x5C, 0x4E, 0x6B, 0x60, 0x4B, 0x61,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+    0xF8, 0xF9, 0x7A, 0x5E, 0x4C, 0x7E, 0x6E, 0x6F,
+    0x7C, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6,
+    0xD7, 0xD8, 0xD9, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6,
+    0xE7, 0xE8, 0xE9, 0x4A, 0xE0, 0x5A, 0x5F, 0x6D,
+    0x79, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,
+    0x97, 0x98, 0x99, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6,
+    0xA7, 0xA8, 0xA9, 0xC0, 0xBB, 0xD0, 0xA1, 0x07,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x06, 0x17,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x09, 0x0A, 0x1B,
+    0x30, 0x31, 0x1A, 0x33, 0x34, 0x35, 0x36, 0x08,
+    0x38, 0x39, 0x3A, 0x3B, 0x04, 0x14, 0x3E, 0xFF,
+    0x41, 0xAA, 0xB0, 0xB1, 0x9F, 0xB2, 0x6A, 0xB5,
+    0xBD, 0xB4, 0x9A, 0x8A, 0xBA, 0xCA, 0xAF, 0xBC,
+    0x90, 0x8F, 0xEA, 0xFA, 0xBE, 0xA0, 0xB6, 0xB3,
+    0x9D, 0xDA, 0x9B, 0x8B, 0xB7, 0xB8, 0xB9, 0xAB,
+    0x64, 0x65, 0x62, 0x66, 0x63, 0x67, 0x9E, 0x68,
+    0x74, 0x71, 0x72, 0x73, 0x78, 0x75, 0x76, 0x77,
+    0xAC, 0x69, 0xED, 0xEE, 0xEB, 0xEF, 0xEC, 0xBF,
+    0x80, 0xFD, 0xFE, 0xFB, 0xFC, 0xAD, 0xAE, 0x59,
+    0x44, 0x45, 0x42, 0x46, 0x43, 0x47, 0x9C, 0x48,
+    0x54, 0x51, 0x52, 0x53, 0x58, 0x55, 0x56, 0x57,
+    0x8C, 0x49, 0xCD, 0xCE, 0xCB, 0xCF, 0xCC, 0xE1,
+    0x70, 0xDD, 0xDE, 0xDB, 0xDC, 0x8D, 0x8E, 0xDF
+};
+
+struct codec_alias {
+  const char *name;
+  int id;
+};
+
+/* Names after case folding with '-' and '_' removed. */
+static const struct codec_alias g_codec_aliases[] = {
+    {"IBM1047", LUAZ_CODEC_IBM1047}, {"CP1047", LUAZ_CODEC_IBM1047},
+    {"1047", LUAZ_CODEC_IBM1047},    {"IBM037", LUAZ_CODEC_IBM037},
+    {"IBM37", LUAZ_CODEC_IBM037},    {"CP037", LUAZ_CODEC_IBM037},
+    {"CP37", LUAZ_CODEC_IBM037},     {"037", LUAZ_CODEC_IBM037},
+    {"IBM273", LUAZ_CODEC_IBM273},   {"CP273", LUAZ_CODEC_IBM273},
+    {"273", LUAZ_CODEC_IBM273},      {"IBM500", LUAZ_CODEC_IBM500},
+    {"CP500", LUAZ_CODEC_IBM500},    {"500", LUAZ_CODEC_IBM500},
+    {"ISO88591", LUAZ_CODEC_LATIN1}, {"88591", LUAZ_CODEC_LATIN1},
+    {"LATIN1", LUAZ_CODEC_LATIN1},   {"UTF8", LUAZ_CODEC_UTF8},
+    {NULL, 0},
+};
+
+static const char *const g_codec_names[LUAZ_CODEC_COUNT] = {
+    "IBM-1047", "IBM-037", "IBM-273", "IBM-500", "ISO8859-1", "UTF-8"};
+
+/**
+ * @brief Return the table from an encoding to ISO-8859-1.
+ *
+ * @param id Encoding id.
+ * @return Table, or NULL for ISO-8859-1 and UTF-8 (identity).
+ */
+static const unsigned char *codec_to_l1(int id)
+{
+  switch (id) {
+  case LUAZ_CODEC_IBM1047:
+    return g_e1047_l1;
+  case LUAZ_CODEC_IBM037:
+    return g_e037_l1;
+  case LUAZ_CODEC_IBM273:
+    return g_e273_l1;
+  case LUAZ_CODEC_IBM500:
+    return g_e500_l1;
+  default:
+    return NULL;
+  }
+}
+
+/**
+ * @brief Return the table from ISO-8859-1 to an encoding.
+ *
+ * @param id Encoding id.
+ * @return Table, or NULL for ISO-8859-1 and UTF-8 (identity).
+ */
+static const unsigned char *codec_from_l1(int id)
+{
+  switch (id) {
+  case LUAZ_CODEC_IBM1047:
+    return g_l1_e1047;
+  case LUAZ_CODEC_IBM037:
+    return g_l1_e037;
+  case LUAZ_CODEC_IBM273:
+    return g_l1_e273;
+  case LUAZ_CODEC_IBM500:
+    return g_l1_e500;
+  default:
+    return NULL;
+  }
+}
+
+/**
+ * @brief Map bytes through a table, eight per loop iteration.
+ *
+ * @param map Byte table.
+ * @param in Input bytes.
+ * @param n Input length.
+ * @param out Output (n bytes).
+ */
+static void codec_map(const unsigned char *map, const unsigned char *in,
+                      size_t n, unsigned char *out)
+{
+  while (n >= 8) {
+    out[0] = map[in[0]];
+    out[1] = map[in[1]];
+    out[2] = map[in[2]];
+    out[3] = map[in[3]];
+    out[4] = map[in[4]];
+    out[5] = map[in[5]];
+    out[6] = map[in[6]];
+    out[7] = map[in[7]];
+    in += 8;
+    out += 8;
+    n -= 8;
+  }
+  while (n-- > 0)
+    *out++ = map[*in++];
+}
+
+/**
+ * @brief Map bytes to ISO-8859-1 and encode them as UTF-8.
+ *
+ * Each group of eight mapped bytes is tested with one 64-bit mask; a
+ * group without high bits is stored as is.
+ *
+ * @param map Table to ISO-8859-1.
+ * @param in Input bytes.
+ * @param n Input length.
+ * @param out Output (up to 2 * n bytes).
+ * @return Output length.
+ */
+static size_t codec_encode(const unsigned char *map, const unsigned char *in,
+                           size_t n, unsigned char *out)
+{
+  unsigned char *o = out;
+  unsigned char t[8];
+  uint64_t w;
+  int i;
+
+  while (n >= 8) {
+    codec_map(map, in, 8, t);
+    memcpy(&w, t, 8);
+    if ((w & CODEC_HIGH) == 0) {
+      memcpy(o, t, 8);
+      o += 8;
+    }
+    else {
+      for (i = 0; i < 8; i++) {
+        if (t[i] < 0x80) {
+          *o++ = t[i];
+        }
+        else {
+          *o++ = (unsigned char)(0xC0 | (t[i] >> 6));
+          *o++ = (unsigned char)(0x80 | (t[i] & 0x3F));
+        }
+      }
+    }
+    in += 8;
+    n -= 8;
+  }
+  while (n-- > 0) {
+    unsigned char c = map[*in++];
+    if (c < 0x80) {
+      *o++ = c;
+    }
+    else {
+      *o++ = (unsigned char)(0xC0 | (c >> 6));
+      *o++ = (unsigned char)(0x80 | (c & 0x3F));
+    }
+  }
+  return (size_t)(o - out);
+}
+
+/**
+ * @brief Decode one multi-byte UTF-8 sequence.
+ *
+ * Overlong forms, surrogates and values above U+10FFFF are invalid.
+ *
+ * @param p Sequence start (lead byte >= 0x80).
+ * @param n Bytes available.
+ * @param cp Output code point.
+ * @return Sequence length, or 0 when the bytes are not valid UTF-8.
+ */
+static size_t codec_utf8_next(const unsigned char *p, size_t n,
+                              unsigned long *cp)
+{
+  unsigned char c = p[0];
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xBF;
+  size_t len;
+  size_t i;
+
+  if (c >= 0xC2 && c <= 0xDF) {
+    len = 2;
+    *cp = c & 0x1F;
+  }
+  else if (c >= 0xE0 && c <= 0xEF) {
+    len = 3;
+    *cp = c & 0x0F;
+    if (c == 0xE0)
+      lo = 0xA0;
+    else if (c == 0xED)
+      hi = 0x9F;
+  }
+  else if (c >= 0xF0 && c <= 0xF4) {
+    len = 4;
+    *cp = c & 0x07;
+    if (c == 0xF0)
+      lo = 0x90;
+    else if (c == 0xF4)
+      hi = 0x8F;
+  }
+  else {
+    return 0;
+  }
+  if (n < len || p[1] < lo || p[1] > hi)
+    return 0;
+  for (i = 1; i < len; i++) {
+    if ((p[i] & 0xC0) != 0x80)
+      return 0;
+    *cp = (*cp << 6) | (p[i] & 0x3F);
+  }
+  return len;
+}
+
+/**
+ * @brief Decode UTF-8 and map the code points to single bytes.
+ *
+ * Runs of eight ASCII bytes (one 64-bit mask test) are mapped without
+ * decoding.
+ *
+ * @param cv Prepared DECODE conversion.
+ * @param in Input bytes.
+ * @param n Input length.
+ * @param out Output (up to n bytes).
+ * @param outlen Output length.
+ * @param bad Offset of the failing input byte on error (may be NULL).
+ * @return 0 on success, or -1 on invalid or unmappable input.
+ */
+static int codec_decode(const struct luaz_codec *cv, const unsigned char *in,
+                        size_t n, unsigned char *out, size_t *outlen,
+                        size_t *bad)
+{
+  unsigned char *o = out;
+  size_t i = 0;
+  uint64_t w;
+
+  while (i < n) {
+    unsigned long cp = 0;
+    size_t len;
+    if (n - i >= 8) {
+      memcpy(&w, in + i, 8);
+      if ((w & CODEC_HIGH) == 0) {
+        codec_map(cv->map, in + i, 8, o);
+        o += 8;
+        i += 8;
+        continue;
+      }
+    }
+    if (in[i] < 0x80) {
+      *o++ = cv->map[in[i++]];
+      continue;
+    }
+    len = codec_utf8_next(in + i, n - i, &cp);
+    if (len == 0 || cp > 0xFF) {
+      if (cv->repl < 0) {
+        if (bad != NULL)
+          *bad = i;
+        return -1;
+      }
+      *o++ = (unsigned char)cv->repl;
+      i += (len == 0) ? 1 : len;
+      continue;
+    }
+    *o++ = cv->map[cp];
+    i += len;
+  }
+  *outlen = (size_t)(o - out);
+  return 0;
+}
+
+/**
+ * @brief Check an encoding name argument.
+ *
+ * @param L Lua state.
+ * @param idx Stack index.
+ * @return Encoding id (raises on an unknown name).
+ */
+static int codec_check(lua_State *L, int idx)
+{
+  const char *name = luaL_checkstring(L, idx);
+  int id = luaz_codec_find(name);
+
+  if (id < 0)
+    return luaL_argerror(L, idx,
+                         lua_pushfstring(L, "unknown encoding '%s'", name));
+  return id;
+}
+
+/**
+ * @brief Lua binding for codec.convert(s, from, to [, repl]).
+ *
+ * @param L Lua state.
+ * @return 1 (converted string), or 3 (nil, message, code) when s holds
+ *         invalid or unmappable UTF-8 and no replacement byte is given.
+ */
+static int l_codec_convert(lua_State *L)
+{
+  struct luaz_codec cv;
+  size_t n = 0;
+  const char *s = luaL_checklstring(L, 1, &n);
+  int from = codec_check(L, 2);
+  int to = codec_check(L, 3);
+  int repl = -1;
+  size_t bad = 0;
+
+  if (!lua_isnoneornil(L, 4)) {
+    size_t rlen = 0;
+    const char *r = luaL_checklstring(L, 4, &rlen);
+    luaL_argcheck(L, rlen == 1, 4, "replacement must be one byte");
+    repl = (unsigned char)r[0];
+  }
+  luaz_codec_init(&cv, from, to, repl);
+  if (cv.ident) {
+    lua_settop(L, 1);
+    return 1;
+  }
+  if (luaz_codec_push(L, &cv, s, n, &bad) != 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30058 codec.convert invalid or unmappable "
+                       "character at byte %I",
+                    (LUAI_UACINT)(bad + 1));
+    lua_pushinteger(L, LUZ_E_CODEC);
+    return 3;
+  }
+  return 1;
+}
+
+int luaz_codec_find(const char *name)
+{
+  char key[CODEC_NAME_MAX + 1];
+  size_t n = 0;
+  int i;
+
+  if (name == NULL)
+    return -1;
+  for (; *name != '\0'; name++) {
+    if (*name == '-' || *name == '_')
+      continue;
+    if (n == CODEC_NAME_MAX)
+      return -1;
+    key[n++] = (char)toupper((unsigned char)*name);
+  }
+  key[n] = '\0';
+  for (i = 0; g_codec_aliases[i].name != NULL; i++) {
+    if (strcmp(key, g_codec_aliases[i].name) == 0)
+      return g_codec_aliases[i].id;
+  }
+  return -1;
+}
+
+const char *luaz_codec_name(int id)
+{
+  if (id < 0 || id >= LUAZ_CODEC_COUNT)
+    return NULL;
+  return g_codec_names[id];
+}
+
+int luaz_codec_newline(int id)
+{
+  return (codec_to_l1(id) != NULL) ? 0x15 : 0x0A;
+}
+
+int luaz_codec_space(int id)
+{
+  return (codec_to_l1(id) != NULL) ? 0x40 : 0x20;
+}
+
+int luaz_codec_init(struct luaz_codec *cv, int from, int to, int repl)
+{
+  const unsigned char *in;
+  const unsigned char *out;
+  int i;
+
+  if (from < 0 || from >= LUAZ_CODEC_COUNT || to < 0 ||
+      to >= LUAZ_CODEC_COUNT)
+    return -1;
+  cv->from = from;
+  cv->to = to;
+  cv->repl = repl;
+  if (from == LUAZ_CODEC_UTF8 && to != LUAZ_CODEC_UTF8) {
+    cv->kind = LUAZ_CODEC_DECODE;
+    in = NULL;
+    out = codec_from_l1(to);
+  }
+  else if (from != LUAZ_CODEC_UTF8 && to == LUAZ_CODEC_UTF8) {
+    cv->kind = LUAZ_CODEC_ENCODE;
+    in = codec_to_l1(from);
+    out = NULL;
+  }
+  else {
+    /* Byte to byte through ISO-8859-1; UTF-8 to UTF-8 is a copy. */
+    cv->kind = LUAZ_CODEC_MAP;
+    in = codec_to_l1(from);
+    out = codec_from_l1(to);
+  }
+  cv->ident = (cv->kind == LUAZ_CODEC_MAP);
+  for (i = 0; i < 256; i++) {
+    unsigned char c = (in != NULL) ? in[i] : (unsigned char)i;
+    cv->map[i] = (out != NULL) ? out[c] : c;
+    if (cv->map[i] != i)
+      cv->ident = 0;
+  }
+  return 0;
+}
+
+void luaz_codec_text(struct luaz_codec *cv, int nl_in, int nl_out)
+{
+  cv->map[nl_in & 0xFF] = (unsigned char)nl_out;
+  if (nl_in != nl_out)
+    cv->ident = 0;
+}
+
+size_t luaz_codec_bound(const struct luaz_codec *cv, size_t n)
+{
+  if (cv->kind != LUAZ_CODEC_ENCODE)
+    return n;
+  return (n > ((size_t)-1) / 2) ? 0 : n * 2;
+}
+
+int luaz_codec_run(const struct luaz_codec *cv, const unsigned char *in,
+                   size_t n, unsigned char *out, size_t *outlen, size_t *bad)
+{
+  switch (cv->kind) {
+  case LUAZ_CODEC_ENCODE:
+    *outlen = codec_encode(cv->map, in, n, out);
+    return 0;
+  case LUAZ_CODEC_DECODE:
+    return codec_decode(cv, in, n, out, outlen, bad);
+  default:
+    if (cv->ident)
+      memcpy(out, in, n);
+    else
+      codec_map(cv->map, in, n, out);
+    *outlen = n;
+    return 0;
+  }
+}
+
+size_t luaz_codec_partial(const struct luaz_codec *cv,
+                          const unsigned char *in, size_t n)
+{
+  size_t k;
+
+  if (cv->kind != LUAZ_CODEC_DECODE)
+    return 0;
+  /* Walk back over continuation bytes to the lead byte, if close. */
+  for (k = 1; k <= 3 && k <= n; k++) {
+    unsigned char c = in[n - k];
+    size_t need;
+    if ((c & 0xC0) == 0x80)
+      continue;
+    if (c >= 0xF0)
+      need = 4;
+    else if (c >= 0xE0)
+      need = 3;
+    else if (c >= 0xC0)
+      need = 2;
+    else
+      return 0;
+    return (need > k) ? k : 0;
+  }
+  return 0;
+}
+
+int luaz_codec_push(lua_State *L, const struct luaz_codec *cv, const char *p,
+                    size_t n, size_t *bad)
+{
+  luaL_Buffer b;
+  size_t cap;
+  size_t len = 0;
+  char *o;
+
+  if (cv->ident || n == 0) {
+    lua_pushlstring(L, p, n);
+    return 0;
+  }
+  cap = luaz_codec_bound(cv, n);
+  if (cap == 0)
+    return luaL_error(L, "LUZ30058 codec string too large");
+  o = luaL_buffinitsize(L, &b, cap);
+  if (luaz_codec_run(cv, (const unsigned char *)p, n, (unsigned char *)o,
+                     &len, bad) != 0) {
+    lua_pop(L, 1); /* buffer placeholder left by luaL_buffinitsize */
+    return -1;
+  }
+  luaL_pushresultsize(&b, len);
+  return 0;
+}
+
+int luaopen_codec(lua_State *L)
+{
+  static const luaL_Reg funcs[] = {
+      {"convert", l_codec_convert},
+      {NULL, NULL},
+  };
+
+  luaL_newlib(L, funcs);
+  return 1;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO CRC32 (IEEE 802.3, reflected) shared by HASHCMP and LUAPATH.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | crc32_init_table | function | Initialize CRC32 table |
+ * | luaz_crc32_update | function | Update a running CRC32 with bytes |
+ * | luaz_crc32 | function | Compute CRC32 of a buffer |
+ *
+ * Platform Requirements:
+ * - LE: required (C runtime).
+ * - EBCDIC: hashes raw bytes as stored; no code page conversion.
+ */
+#include "CRC32"
+
+static uint32_t crc32_table[256];
+static int crc32_table_ready = 0;
+
+/**
+ * @brief Initialize the CRC32 lookup table (polynomial 0xEDB88320).
+ */
+static void crc32_init_table(void)
+{
+  uint32_t i;
+  for (i = 0; i < 256; i++) {
+    uint32_t c = i;
+    int j;
+    for (j = 0; j < 8; j++) {
+      if (c & 1)
+        c = 0xEDB88320u ^ (c >> 1);
+      else
+        c = c >> 1;
+    }
+    crc32_table[i] = c;
+  }
+  crc32_table_ready = 1;
+}
+
+uint32_t luaz_crc32_update(uint32_t crc, const void *buf, size_t len)
+{
+  const unsigned char *p = (const unsigned char *)buf;
+  size_t i;
+
+  if (!crc32_table_ready)
+    crc32_init_table();
+  for (i = 0; i < len; i++)
+    crc = crc32_table[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+  return crc;
+}
+
+uint32_t luaz_crc32(const void *buf, size_t len)
+{
+  return luaz_crc32_update(0xFFFFFFFFu, buf, len) ^ 0xFFFFFFFFu;
+}
@@ -20,16 +20,85 @@
  * | ds_recfm_string | function | Build RECFM string from fldata flags |
  * | ds_dsorg_string | function | Build DSORG string from fldata flags |
  * | ds_mode_from_lua | function | Parse open mode from Lua args |
- * | ds_readline_stream | function | Read a line from a DDNAME stream |
+ * | ds_opts_from_lua | function | Parse open options (type, bufsize, buffering, readahead, encoding) |
+ * | ds_opt_bad | function | Record the first invalid option key |
+ * | ds_push_bad_opt | function | Push the failure triple naming an invalid option |
+ * | ds_read_record | function | Read one record from a type=record stream |
+ * | ds_scan_line | function | Read a line from the handle's block scanner |
+ * | ds_codec_top | function | Convert the value just read to the internal encoding |
+ * | ds_readline_handle | function | Read a line or record from a handle |
+ * | ds_writeline_handle | function | Write a line or record to a handle |
+ * | ds_next_record | function | Fetch the next record or line as raw bytes |
+ * | ds_stream_error | function | Read error state of a stream handle |
+ * | ds_slab | struct | lua_Alloc read buffer handed over as an external string |
+ * | ds_slab_init | function | Start an empty slab |
+ * | ds_slab_reserve | function | Grow a slab for more bytes |
+ * | ds_slab_free | function | Release an unpushed slab |
+ * | ds_slab_copy | function | Push a (converted) copy of a slab under protection |
+ * | ds_slab_push | function | Push a slab with lua_pushexternalstring |
+ * | ds_read_slab | function | Read the rest of a handle into a slab |
+ * | ds_read_all | function | Read the rest of a handle ("a") |
+ * | ds_read_count | function | Read up to a byte count |
+ * | ds_read_fail | function | Push the nil, message, code of a failed read |
+ * | ds_codec_arg | function | Convert a string to write to the dataset encoding |
+ * | ds_write_codec_fail | function | Push the nil, message, code of a failed conversion |
  * | ds_ud_close | function | Close and free DS userdata handle |
  * | ds_ud_check | function | Validate DS userdata handle |
+ * | ds_ocache_entry | struct | Open-form cache entry (key, mode, probe) |
+ * | ds_ocache_enabled | function | Check ds.opencache policy |
+ * | ds_ocache_find | function | Look up the probe that opened a key |
+ * | ds_ocache_store | function | Remember the probe that opened a key |
+ * | ds_fmodes | function | Map open mode to fopen mode variants |
+ * | ds_open_probe | function | Run the fopen chain, cached probe first |
+ * | ds_bufmult | function | Read the ds.bufmult policy multiplier |
+ * | ds_apply_buffering | function | setvbuf() from bufsize/BLKSIZE options |
+ * | ds_handle_new | function | Allocate a handle around an open stream |
+ * | ds_open_dd_opts | function | Open DDNAME with open options |
+ * | ds_open_dsn_opts | function | Open DSN with open options |
+ * | l_ds_openstats | function | Lua helper for ds.openstats |
  * | l_ds_open_dd | function | Lua wrapper for ds.open_dd |
  * | l_ds_open_dsn | function | Lua wrapper for ds.open_dsn |
+ * | ds_slurp_ddname | function | Split a DD: prefix off a ds.slurp name |
+ * | ds_open_named | function | Open a DD: name or DSN with open options |
+ * | l_ds_slurp | function | Lua wrapper for ds.slurp |
+ * | ds_copy | struct | ds.copy state (handles, reformatting, counters) |
+ * | ds_copy_opts_from_lua | function | Parse ds.copy options |
+ * | ds_copy_reserve | function | Grow the ds.copy work buffer |
+ * | ds_copy_records | function | Copy record by record with reformatting |
+ * | ds_copy_stream | function | Copy a text stream in large blocks |
+ * | l_ds_copy | function | Lua wrapper for ds.copy |
+ * | ds_sort_io | struct | ds.sort handles and work dataset paths |
+ * | ds_sort_read | function | ds.sort input record callback |
+ * | ds_sort_open_output | function | Open the ds.sort output after the input |
+ * | ds_sort_write | function | ds.sort output record callback |
+ * | ds_sort_spill_open | function | Create or reopen a ds.sort work dataset |
+ * | ds_sort_spill_remove | function | Delete a ds.sort work dataset |
+ * | ds_sort_field | function | Read a name option of ds.sort |
+ * | l_ds_sort | function | Lua wrapper for ds.sort |
+ * | ds_grep | struct | ds.grep scan state (needle, result tables) |
+ * | ds_grep_hit | function | Check and store one candidate line |
+ * | ds_grep_stream | function | Scan a text stream in blocks |
+ * | ds_grep_records | function | Scan a record handle |
+ * | l_ds_grep | function | Lua wrapper for ds.grep |
+ * | ds_dir | struct | ds.members directory reader state |
+ * | ds_dir_entry | function | Keep one matching directory entry |
+ * | ds_dir_open | function | Open a directory (record I/O or hooks) |
+ * | ds_dir_next | function | Return the next matching entry |
+ * | ds_dir_close | function | Close a directory |
+ * | ds_dir_push | function | Push one member name or table |
+ * | l_ds_members_iter | function | Iterator for ds.members{iter=true} |
+ * | l_ds_members_gc | function | __gc for the ds.members reader state |
+ * | l_ds_members | function | Lua wrapper for ds.members |
  * | l_ds_member | function | Lua helper for ds.member |
  * | l_ds_info | function | Lua helper for ds.info |
  * | l_ds_handle_readline | function | Lua handle:readline() |
  * | l_ds_handle_lines | function | Lua handle:lines() |
  * | l_ds_handle_writeline | function | Lua handle:writeline() |
+ * | l_ds_handle_read | function | Lua handle:read(fmt...) |
+ * | l_ds_handle_write | function | Lua handle:write(...) |
+ * | l_ds_handle_read_records | function | Lua handle:read_records() |
+ * | l_ds_handle_write_records | function | Lua handle:write_records() |
+ * | l_ds_handle_fields | function | Lua handle:fields(layout or copybook) |
  * | l_ds_handle_close | function | Lua handle:close() |
  * | l_ds_handle_gc | function | Lua handle:__gc() |
  * | l_ds_lines_iter | function | Iterator for handle:lines() |
@@ -43,8 +112,17 @@
  * | lua_ds_write | function | Write to DDNAME stream |
  * | lua_ds_close | function | Close DDNAME stream |
  */
+#include "CODEC"
 #include "DS"
+#include "DSCOPY"
+#include "DSDEC"
+#include "DSGREP"
+#include "DSMEM"
+#include "DSREC"
+#include "DSSORT"
 #include "ERRORS"
+#include "LSCAN"
+#include "POLICY"
 
 #include "LUA"
 #include "LAUXLIB"
@@ -61,13 +139,104 @@ extern int fldata(FILE *file, char *filename, fldata_t *info);
 struct lua_ds_handle {
   FILE *fp;
   char mode;
+  int recio;
+  char *rbuf;
+  unsigned long rcap;
+  unsigned long blksize;
+  int scan_on;
+  struct luaz_lscan scan;
+  struct luaz_codec *cv;
+  int cv_err;
+  size_t cv_bad;
+};
+
+struct ds_open_opts {
+  int recio;
+  unsigned long bufsize;
+  int buffering;
+  int readahead;
+  int enc;
+  int internal;
+  int repl;
+  const char *bad; /* first invalid option key, or NULL */
 };
 
 struct lua_ds_ud {
   struct lua_ds_handle *h;
 };
 
+/* Growing read buffer owned by the state's allocator until it is pushed
+ * as an external string. */
+struct ds_slab {
+  lua_Alloc allocf;
+  void *ud;
+  char *p;
+  size_t len;
+  size_t cap;
+};
+
 static const char *g_ds_handle_mt = "luaz.ds.handle";
+static const char *g_ds_members_mt = "luaz.ds.members";
+
+/* Open-form cache: the fopen probe (path form x mode) that last opened a
+ * DDNAME or DSN path in a given mode is tried first on the next open. */
+#define DS_OCACHE_SLOTS 32
+#define DS_DD_FORMS 5
+#define DS_OPEN_MODES 3
+#define DS_FMODE_RECORD 1
+
+/* Largest record the C runtime returns for RECFM=V/U when fldata() does
+ * not report __maxreclen; batch tables are preallocated up to this many
+ * slots regardless of the requested count. */
+#define DS_LRECL_MAX 32760u
+#define DS_BATCH_PREALLOC 4096
+#define DS_READ_CHUNK 32768u
+
+/* ds.sort work datasets: binary streams, so FB only sets the blocking;
+ * a free name is looked for DS_SORT_NAME_TRIES times. Space is counted
+ * in DS_SORT_BLKSIZE blocks: the run size as primary (at most
+ * DS_SORT_PRIMARY_MAX) and an eighth of it as secondary. */
+#define DS_SORT_PATH 64
+#define DS_SORT_BLKSIZE 24576
+#define DS_SORT_WMODE "wb,recfm=FB,lrecl=4096,blksize=24576,"           \
+                      "space=(24576,(%ld,%ld),rlse)"
+#define DS_SORT_PRIMARY_MAX 60000L
+#define DS_SORT_NAME_TRIES 16
+
+/* Stream buffer sizing: BLKSIZE x ds.bufmult (default DS_BUFMULT_DEFAULT),
+ * capped at DS_BUFSIZE_MAX; DS_BUFFERING_DEFAULT keeps the runtime mode. */
+#define DS_BUFMULT_DEFAULT 4ul
+#define DS_BUFMULT_MAX 64ul
+#define DS_BUFSIZE_MAX 16777216ul
+#define DS_BUFFERING_DEFAULT (-1)
+
+typedef struct ds_ocache_entry {
+  char kind;
+  char mode;
+  unsigned char probe;
+  char key[96];
+} ds_ocache_entry;
+
+enum {
+  DS_OSTAT_OPENS = 0,
+  DS_OSTAT_HITS,
+  DS_OSTAT_MISSES,
+  DS_OSTAT_PROBES,
+  DS_OSTAT_PROBES_SAVED,
+  DS_OSTAT_COUNT
+};
+
+static const char *const g_ds_ostat_names[DS_OSTAT_COUNT] = {
+  "opens",
+  "hits",
+  "misses",
+  "probes",
+  "probes_saved"
+};
+
+static ds_ocache_entry g_ds_ocache[DS_OCACHE_SLOTS];
+static unsigned int g_ds_ocache_next = 0;
+static unsigned long g_ds_ostats[DS_OSTAT_COUNT];
 
 /**
  * @brief Validate a DDNAME string for length only.
@@ -482,378 +651,2918 @@ static int ds_mode_from_lua(lua_State *L, int idx, char *out_mode)
 }
 
 /**
- * @brief Read a logical line from a dataset stream.
+ * @brief Record the first invalid option key.
  *
- * @param L Lua state for buffer allocation.
- * @param fp Open FILE stream.
- * @return 1 and push line on success, 0 on EOF, -1 on error.
+ * @param opts Options being parsed.
+ * @param key Option key (static string).
+ * @return -1, for use as the parser's return code.
  */
-static int ds_readline_stream(lua_State *L, FILE *fp)
+static int ds_opt_bad(struct ds_open_opts *opts, const char *key)
 {
-  char buf[256];
-  luaL_Buffer b;
-  int have_data = 0;
-
-  if (L == NULL || fp == NULL)
-    return -1;
-
-  luaL_buffinit(L, &b);
-  while (fgets(buf, sizeof(buf), fp) != NULL) {
-    size_t len = strlen(buf);
-    have_data = 1;
-    if (len > 0 && buf[len - 1] == '\n') {
-      luaL_addlstring(&b, buf, len - 1);
-      luaL_pushresult(&b);
-      return 1;
-    }
-    luaL_addlstring(&b, buf, len);
-    if (len + 1 < sizeof(buf)) {
-      luaL_pushresult(&b);
-      return 1;
-    }
-  }
-
-  if (ferror(fp))
-    return -1;
-  if (!have_data)
-    return 0;
-  luaL_pushresult(&b);
-  return 1;
+  if (opts->bad == NULL)
+    opts->bad = key;
+  return -1;
 }
 
 /**
- * @brief Close a DS userdata handle and clear its pointer.
+ * @brief Push the failure triple for an invalid option.
  *
- * @param ud DS userdata wrapper.
- * @return 0 on success, or LUZ_E_DS_CLOSE on failure.
- */
-static int ds_ud_close(struct lua_ds_ud *ud)
-{
-  if (ud == NULL || ud->h == NULL)
-    return LUZ_E_DS_CLOSE;
-  if (lua_ds_close(ud->h) != 0)
-    return LUZ_E_DS_CLOSE;
-  ud->h = NULL;
-  return 0;
-}
-
-/**
- * @brief Validate and return the DS handle from Lua userdata.
+ * The message names the key and its value, e.g.
+ * "LUZ30006 ds.open_dd invalid option bufsize=0".
  *
  * @param L Lua state.
- * @param idx Stack index.
- * @return DS handle pointer or NULL if invalid/closed.
+ * @param idx Stack index of the options table (or the mode string).
+ * @param fn Function name for the message.
+ * @param key Invalid option key, or NULL when none can be named.
+ * @return 3 (nil, message, code).
  */
-static struct lua_ds_handle *ds_ud_check(lua_State *L, int idx)
+static int ds_push_bad_opt(lua_State *L, int idx, const char *fn,
+                           const char *key)
 {
-  struct lua_ds_ud *ud = NULL;
-  if (L == NULL)
-    return NULL;
-  ud = (struct lua_ds_ud *)luaL_checkudata(L, idx, g_ds_handle_mt);
-  if (ud == NULL || ud->h == NULL)
-    return NULL;
-  return ud->h;
+  idx = lua_absindex(L, idx);
+  lua_pushnil(L);
+  if (key == NULL) {
+    lua_pushfstring(L, "LUZ30006 %s invalid options", fn);
+  }
+  else {
+    if (lua_istable(L, idx))
+      lua_getfield(L, idx, key);
+    else
+      lua_pushvalue(L, idx);
+    lua_pushfstring(L, "LUZ30006 %s invalid option %s=%s", fn, key,
+                    luaL_tolstring(L, -1, NULL));
+    lua_replace(L, -3);
+    lua_pop(L, 1);
+  }
+  lua_pushinteger(L, LUZ_E_DS_OPEN);
+  return 3;
 }
 
 /**
- * @brief Open a DDNAME stream with the given mode.
+ * @brief Parse open options (type=) from a Lua options table.
  *
- * @param ddname DDNAME string.
- * @param mode Mode string ("r", "w", or "a").
- * @param out Output handle pointer.
- * @return 0 on success, or LUZ_E_DS_OPEN on failure.
+ * encoding= names the dataset character set and internal= the one Lua
+ * strings use (default UTF-8); replacement= is one internal-encoding
+ * character (ASCII for UTF-8) written in place of invalid input.
+ *
+ * @param L Lua state.
+ * @param idx Stack index of the mode string or options table.
+ * @param opts Output options.
+ * @return 0 on success, or -1 on an invalid option (opts->bad names it).
  */
-int lua_ds_open_dd(const char *ddname, const char *mode, struct lua_ds_handle **out)
+static int ds_opts_from_lua(lua_State *L, int idx, struct ds_open_opts *opts)
 {
-  char path[64];
-  const char *fmode;
-  const char *fmode_rec;
-  const char *fmode_fb;
-  struct lua_ds_handle *h;
-  char ddname_uc[9];
-
-  if (out)
-    *out = 0;
-  if (!ddname_valid(ddname) || out == NULL || mode == NULL || mode[0] == '\0')
-    return LUZ_E_DS_OPEN;
+  const char *type = NULL;
+  int rc = 0;
 
-  switch (mode[0]) {
-  case 'r':
-    fmode = "rb";
-    fmode_rec = "rb,type=record";
-    fmode_fb = "rb,recfm=FB,lrecl=80";
-    break;
-  case 'w':
-    fmode = "wb";
-    fmode_rec = "wb,type=record";
-    fmode_fb = "wb,recfm=FB,lrecl=80";
-    break;
-  case 'a':
-    fmode = "ab";
-    fmode_rec = "ab,type=record";
-    fmode_fb = "ab,recfm=FB,lrecl=80";
-    break;
-  default:
-    return LUZ_E_DS_OPEN;
+  opts->recio = 0;
+  opts->bufsize = 0;
+  opts->buffering = DS_BUFFERING_DEFAULT;
+  opts->readahead = 0;
+  opts->enc = -1;
+  opts->internal = LUAZ_CODEC_UTF8;
+  opts->repl = -1;
+  opts->bad = NULL;
+  if (!lua_istable(L, idx))
+    return 0;
+  lua_getfield(L, idx, "type");
+  if (lua_isstring(L, -1))
+    type = lua_tostring(L, -1);
+  else if (!lua_isnil(L, -1))
+    rc = ds_opt_bad(opts, "type");
+  if (type != NULL) {
+    if (strcmp(type, "record") == 0)
+      opts->recio = 1;
+    else if (strcmp(type, "stream") != 0)
+      rc = ds_opt_bad(opts, "type");
   }
+  lua_pop(L, 1);
 
-  h = (struct lua_ds_handle *)malloc(sizeof(*h));
-  if (h == NULL)
-    return LUZ_E_DS_OPEN;
-
-  /* Change note: normalize DDNAME to upper-case before fopen.
-   * Problem: mixed-case DDNAMEs can fail to resolve in DD: paths.
-   * Expected effect: DDNAME lookup is consistent for batch DDs.
-   * Impact: ds.open_dd accepts lower-case DDNAMEs.
-   */
-  if (ddname_copy_upper(ddname, ddname_uc, sizeof(ddname_uc)) != 0) {
-    free(h);
-    return LUZ_E_DS_OPEN;
+  lua_getfield(L, idx, "bufsize");
+  if (lua_isinteger(L, -1)) {
+    lua_Integer n = lua_tointeger(L, -1);
+    if (n <= 0 || (lua_Unsigned)n > DS_BUFSIZE_MAX)
+      rc = ds_opt_bad(opts, "bufsize");
+    else
+      opts->bufsize = (unsigned long)n;
   }
-
-  h->fp = NULL;
-  if (snprintf(path, sizeof(path), "//DD:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "DD:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "dd:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "//%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "//DD:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_rec);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "DD:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_rec);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "dd:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_rec);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_rec);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "//%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_rec);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "//DD:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_fb);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "DD:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_fb);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "dd:%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_fb);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_fb);
-  if (h->fp == NULL && snprintf(path, sizeof(path), "//%s", ddname_uc) > 0)
-    h->fp = fopen(path, fmode_fb);
-  if (h->fp == NULL) {
-    free(h);
-    return LUZ_E_DS_OPEN;
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(opts, "bufsize");
   }
-  h->mode = mode[0];
-  *out = h;
-  return 0;
-}
-
-/**
- * @brief Open a DSN stream with the given mode.
- *
- * @param dsn Dataset name string (plain or fully formatted).
- * @param mode Mode string ("r", "w", or "a").
- * @param out Output handle pointer.
- * @return 0 on success, or LUZ_E_DS_OPEN on failure.
- */
-int lua_ds_open_dsn(const char *dsn, const char *mode, struct lua_ds_handle **out)
-{
-  char path[96];
-  const char *fmode;
-  const char *fmode_rec;
-  const char *fmode_fb;
-  struct lua_ds_handle *h;
+  lua_pop(L, 1);
 
-  if (out)
-    *out = 0;
-  if (dsn == NULL || out == NULL || mode == NULL || mode[0] == '\0')
-    return LUZ_E_DS_OPEN;
+  lua_getfield(L, idx, "readahead");
+  if (lua_isinteger(L, -1)) {
+    lua_Integer n = lua_tointeger(L, -1);
+    if (n < 0 || n > LUAZ_LSCAN_RA_MAX)
+      rc = ds_opt_bad(opts, "readahead");
+    else
+      opts->readahead = (int)n;
+  }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(opts, "readahead");
+  }
+  lua_pop(L, 1);
+  if (opts->recio && opts->readahead > 0)
+    rc = ds_opt_bad(opts, "readahead");
 
-  switch (mode[0]) {
-  case 'r':
-    fmode = "rb";
-    fmode_rec = "rb,type=record";
-    fmode_fb = "rb,recfm=FB,lrecl=80";
-    break;
-  case 'w':
-    fmode = "wb";
-    fmode_rec = "wb,type=record";
-    fmode_fb = "wb,recfm=FB,lrecl=80";
-    break;
-  case 'a':
-    fmode = "ab";
-    fmode_rec = "ab,type=record";
-    fmode_fb = "ab,recfm=FB,lrecl=80";
-    break;
-  default:
-    return LUZ_E_DS_OPEN;
+  lua_getfield(L, idx, "buffering");
+  if (lua_type(L, -1) == LUA_TSTRING) {
+    const char *mode = lua_tostring(L, -1);
+    if (strcmp(mode, "full") == 0)
+      opts->buffering = _IOFBF;
+    else if (strcmp(mode, "line") == 0)
+      opts->buffering = _IOLBF;
+    else if (strcmp(mode, "none") == 0)
+      opts->buffering = _IONBF;
+    else
+      rc = ds_opt_bad(opts, "buffering");
   }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(opts, "buffering");
+  }
+  lua_pop(L, 1);
 
-  h = (struct lua_ds_handle *)malloc(sizeof(*h));
-  if (h == NULL)
-    return LUZ_E_DS_OPEN;
+  lua_getfield(L, idx, "encoding");
+  if (lua_type(L, -1) == LUA_TSTRING) {
+    opts->enc = luaz_codec_find(lua_tostring(L, -1));
+    if (opts->enc < 0)
+      rc = ds_opt_bad(opts, "encoding");
+  }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(opts, "encoding");
+  }
+  lua_pop(L, 1);
 
-  if (dsn_build_path(dsn, path, sizeof(path)) != 0) {
-    free(h);
-    return LUZ_E_DS_OPEN;
+  lua_getfield(L, idx, "internal");
+  if (lua_type(L, -1) == LUA_TSTRING) {
+    opts->internal = luaz_codec_find(lua_tostring(L, -1));
+    if (opts->internal < 0)
+      rc = ds_opt_bad(opts, "internal");
   }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(opts, "internal");
+  }
+  lua_pop(L, 1);
 
-  h->fp = fopen(path, fmode);
-  if (h->fp == NULL)
-    h->fp = fopen(path, fmode_rec);
-  if (h->fp == NULL)
-    h->fp = fopen(path, fmode_fb);
-  if (h->fp == NULL) {
-    free(h);
-    return LUZ_E_DS_OPEN;
+  lua_getfield(L, idx, "replacement");
+  if (lua_type(L, -1) == LUA_TSTRING) {
+    size_t n = 0;
+    const char *r = lua_tolstring(L, -1, &n);
+    if (n != 1 || (opts->internal == LUAZ_CODEC_UTF8 &&
+                   (unsigned char)r[0] >= 0x80))
+      rc = ds_opt_bad(opts, "replacement");
+    else
+      opts->repl = (unsigned char)r[0];
   }
-  h->mode = mode[0];
-  *out = h;
-  return 0;
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(opts, "replacement");
+  }
+  lua_pop(L, 1);
+  return rc;
 }
 
 /**
- * @brief Read bytes from a DDNAME stream.
+ * @brief Read one record from a type=record stream.
  *
- * @param h DS handle.
- * @param buf Output buffer.
- * @param len In/out: capacity on input, bytes read on output.
- * @return 0 on success, or LUZ_E_DS_READ on failure.
+ * @param h DS handle opened with record I/O.
+ * @param len Output record length.
+ * @return Record bytes (valid until the next read), or NULL at EOF/error.
  */
-int lua_ds_read(struct lua_ds_handle *h, void *buf, unsigned long *len)
+static const char *ds_read_record(struct lua_ds_handle *h, size_t *len)
 {
   size_t n;
-  if (h == NULL || h->fp == NULL || buf == NULL || len == NULL)
-    return LUZ_E_DS_READ;
-  if (h->mode != 'r')
-    return LUZ_E_DS_READ;
 
-  n = fread(buf, 1, (size_t)(*len), h->fp);
-  *len = (unsigned long)n;
-  return 0;
+  if (h->rbuf == NULL) {
+    h->rbuf = (char *)malloc((size_t)h->rcap);
+    if (h->rbuf == NULL)
+      return NULL;
+  }
+  n = fread(h->rbuf, 1, (size_t)h->rcap, h->fp);
+  if (n == 0 && (feof(h->fp) || ferror(h->fp)))
+    return NULL;
+  *len = n;
+  return h->rbuf;
 }
 
 /**
- * @brief Write bytes to a DDNAME stream.
+ * @brief Read a logical line from a stream handle's block scanner.
  *
- * @param h DS handle.
- * @param buf Input buffer.
- * @param len Number of bytes to write.
- * @return 0 on success, or LUZ_E_DS_WRITE on failure.
+ * Lines inside the current block are pushed straight from it; a line
+ * that straddles blocks is joined in a luaL_Buffer.
+ *
+ * @param L Lua state for buffer allocation.
+ * @param h DS handle with an active scanner.
+ * @param keepnl Nonzero to keep the trailing newline ("L" format).
+ * @return 1 and push line on success, 0 on EOF, -1 on error.
  */
-int lua_ds_write(struct lua_ds_handle *h, const void *buf, unsigned long len)
+static int ds_scan_line(lua_State *L, struct lua_ds_handle *h, int keepnl)
 {
-  size_t n;
-  if (h == NULL || h->fp == NULL || buf == NULL)
-    return LUZ_E_DS_WRITE;
-  if (!(h->mode == 'w' || h->mode == 'a'))
-    return LUZ_E_DS_WRITE;
-  if (len == 0)
-    return 0;
-  n = fwrite(buf, 1, (size_t)len, h->fp);
-  return (n == (size_t)len) ? 0 : LUZ_E_DS_WRITE;
+  const char *p = NULL;
+  size_t len = 0;
+  luaL_Buffer b;
+  int rc;
+
+  rc = luaz_lscan_next(&h->scan, &p, &len);
+  if (rc == LUAZ_LSCAN_LINE) {
+    lua_pushlstring(L, p, len + ((keepnl && h->scan.nl) ? 1 : 0));
+    return 1;
+  }
+  if (rc != LUAZ_LSCAN_PART)
+    return (rc < 0) ? -1 : 0;
+
+  luaL_buffinit(L, &b);
+  do {
+    luaL_addlstring(&b, p, len);
+    rc = luaz_lscan_next(&h->scan, &p, &len);
+  } while (rc == LUAZ_LSCAN_PART);
+  if (rc < 0) {
+    lua_pop(L, 1); /* buffer placeholder left by luaL_buffinit */
+    return -1;
+  }
+  if (rc == LUAZ_LSCAN_LINE) {
+    luaL_addlstring(&b, p, len);
+    if (keepnl && h->scan.nl)
+      luaL_addchar(&b, '\n');
+  }
+  luaL_pushresult(&b);
+  return 1;
 }
 
 /**
- * @brief Close a DDNAME stream and free the handle.
+ * @brief Convert the string on top of the stack to the internal encoding.
  *
- * @param h DS handle.
- * @return 0 on success, or LUZ_E_DS_CLOSE on failure.
+ * @param L Lua state.
+ * @param h DS handle with a read conversion.
+ * @return 1 with the top replaced, or -1 on invalid input (the string is
+ *         popped and h->cv_err/cv_bad are set).
  */
-int lua_ds_close(struct lua_ds_handle *h)
+static int ds_codec_top(lua_State *L, struct lua_ds_handle *h)
 {
-  if (h == NULL)
-    return LUZ_E_DS_CLOSE;
-  if (h->fp != NULL)
-    fclose(h->fp);
-  free(h);
-  return 0;
+  size_t len = 0;
+  const char *p = lua_tolstring(L, -1, &len);
+
+  if (luaz_codec_push(L, h->cv, p, len, &h->cv_bad) != 0) {
+    lua_pop(L, 1);
+    h->cv_err = 1;
+    return -1;
+  }
+  lua_replace(L, -2);
+  return 1;
 }
 
 /**
- * @brief Lua binding for ds.open_dd.
+ * @brief Read the next line or record from a handle.
  *
  * @param L Lua state.
- * @return 1 on success (handle), or 3 on failure (nil, message, code).
+ * @param h DS handle opened for reading.
+ * @param keepnl Nonzero to keep (records: append) the newline.
+ * @return 1 and push the line on success, 0 on EOF, -1 on error.
  */
-static int l_ds_open_dd(lua_State *L)
+static int ds_readline_handle(lua_State *L, struct lua_ds_handle *h,
+                              int keepnl)
 {
-  const char *ddname = luaL_checkstring(L, 1);
-  char mode[2];
-  struct lua_ds_handle *h = NULL;
-  struct lua_ds_ud *ud = NULL;
-  int rc;
+  const char *rec;
+  size_t len = 0;
+  int rc = 1;
 
-  /* Change note: add Lua bindings for DDNAME I/O.
-   * Problem: ds.open_dd was only available via C API or Lua stub.
-   * Expected effect: Lua scripts can open DDNAME datasets directly.
-   * Impact: os.remove/rename/tmpname now resolve to ds module stubs.
-   */
-  if (ds_mode_from_lua(L, 2, mode) != 0) {
-    lua_pushnil(L);
-    lua_pushstring(L, "LUZ30006 ds.open_dd invalid mode");
-    lua_pushinteger(L, LUZ_E_DS_OPEN);
-    return 3;
+  if (h->scan_on) {
+    rc = ds_scan_line(L, h, keepnl);
   }
-
-  rc = lua_ds_open_dd(ddname, mode, &h);
-  if (rc != 0 || h == NULL) {
-    lua_pushnil(L);
-    lua_pushfstring(L,
-                    "LUZ30006 ds.open_dd failed dd=%s errno=%d errno2=%d",
-                    ddname, errno, __errno2());
-    lua_pushinteger(L, LUZ_E_DS_OPEN);
-    return 3;
+  else {
+    rec = ds_read_record(h, &len);
+    if (rec == NULL)
+      return (h->rbuf == NULL || ferror(h->fp)) ? -1 : 0;
+    if (!keepnl) {
+      lua_pushlstring(L, rec, len);
+    }
+    else {
+      luaL_Buffer b;
+      luaL_buffinitsize(L, &b, len + 1);
+      luaL_addlstring(&b, rec, len);
+      luaL_addchar(&b, '\n');
+      luaL_pushresult(&b);
+    }
   }
-
-  ud = (struct lua_ds_ud *)lua_newuserdatauv(L, sizeof(*ud), 0);
-  ud->h = h;
-  luaL_setmetatable(L, g_ds_handle_mt);
-  return 1;
+  if (rc > 0 && h->cv != NULL)
+    return ds_codec_top(L, h);
+  return rc;
 }
 
 /**
- * @brief Lua binding for ds.open_dsn.
+ * @brief Fetch the next record or line as raw bytes.
+ *
+ * Lines inside the scanner block and records from the record buffer are
+ * returned in place; only a line that straddles blocks is joined and
+ * pushed as a Lua string (its bytes are then returned).
  *
  * @param L Lua state.
- * @return 1 on success (handle), or 3 on failure (nil, message, code).
+ * @param h DS handle opened for reading.
+ * @param out Output record bytes (valid until the next read).
+ * @param len Output record length.
+ * @return 1 in place, 2 when a joined string was pushed, 0 on EOF, or -1
+ *         on error.
  */
-static int l_ds_open_dsn(lua_State *L)
+static int ds_next_record(lua_State *L, struct lua_ds_handle *h,
+                          const char **out, size_t *len)
 {
-  const char *dsn = luaL_checkstring(L, 1);
-  char mode[2];
-  struct lua_ds_handle *h = NULL;
-  struct lua_ds_ud *ud = NULL;
   int rc;
 
-  /* Change note: add Lua binding for DSN-based dataset open.
-   * Problem: Lua scripts could only access datasets via DDNAME.
-   * Expected effect: scripts can open fully-qualified DSNs directly.
-   * Impact: ds.open_dsn enables DSN I/O without prior DD allocation.
-   */
-  if (ds_mode_from_lua(L, 2, mode) != 0) {
-    lua_pushnil(L);
-    lua_pushstring(L, "LUZ30006 ds.open_dsn invalid mode");
-    lua_pushinteger(L, LUZ_E_DS_OPEN);
-    return 3;
+  if (!h->scan_on) {
+    *out = ds_read_record(h, len);
+    if (*out == NULL)
+      return (h->rbuf == NULL || ferror(h->fp)) ? -1 : 0;
+    return 1;
   }
+  rc = luaz_lscan_next(&h->scan, out, len);
+  if (rc == LUAZ_LSCAN_LINE)
+    return 1;
+  if (rc != LUAZ_LSCAN_PART)
+    return (rc < 0) ? -1 : 0;
+  {
+    luaL_Buffer b;
+    luaL_buffinit(L, &b);
+    do {
+      luaL_addlstring(&b, *out, *len);
+      rc = luaz_lscan_next(&h->scan, out, len);
+    } while (rc == LUAZ_LSCAN_PART);
+    if (rc < 0) {
+      lua_pop(L, 1); /* buffer placeholder left by luaL_buffinit */
+      return -1;
+    }
+    if (rc == LUAZ_LSCAN_LINE)
+      luaL_addlstring(&b, *out, *len);
+    luaL_pushresult(&b);
+  }
+  *out = lua_tolstring(L, -1, len);
+  return 2;
+}
 
-  rc = lua_ds_open_dsn(dsn, mode, &h);
+/**
+ * @brief Return the read error state of a stream handle.
+ *
+ * Scanner handles report the scanner's flag: with read-ahead the stream
+ * belongs to the producer thread until close.
+ *
+ * @param h DS handle.
+ * @return Nonzero after a read error.
+ */
+static int ds_stream_error(struct lua_ds_handle *h)
+{
+  return h->scan_on ? h->scan.err : ferror(h->fp);
+}
+
+/**
+ * @brief Start an empty slab on the state's allocator.
+ *
+ * @param L Lua state.
+ * @param sb Slab.
+ */
+static void ds_slab_init(lua_State *L, struct ds_slab *sb)
+{
+  sb->allocf = lua_getallocf(L, &sb->ud);
+  sb->p = NULL;
+  sb->len = 0;
+  sb->cap = 0;
+}
+
+/**
+ * @brief Reserve room for need more bytes plus a terminating zero.
+ *
+ * The block comes from the state's lua_Alloc so that it can be handed to
+ * Lua as an external string; it doubles as it grows.
+ *
+ * @param sb Slab.
+ * @param need Bytes about to be appended.
+ * @return 0 on success, or -1 when the allocator fails.
+ */
+static int ds_slab_reserve(struct ds_slab *sb, size_t need)
+{
+  size_t want;
+  size_t cap;
+  char *p;
+
+  if (need > (size_t)-1 - sb->len - 1)
+    return -1;
+  want = sb->len + need + 1;
+  if (want <= sb->cap)
+    return 0;
+  cap = (sb->cap > want / 2) ? sb->cap * 2 : want;
+  if (cap < sb->cap)
+    cap = want;
+  p = (char *)sb->allocf(sb->ud, sb->p, sb->cap, cap);
+  if (p == NULL)
+    return -1;
+  sb->p = p;
+  sb->cap = cap;
+  return 0;
+}
+
+/**
+ * @brief Release a slab that was not handed to Lua.
+ *
+ * @param sb Slab.
+ */
+static void ds_slab_free(struct ds_slab *sb)
+{
+  if (sb->p != NULL)
+    sb->allocf(sb->ud, sb->p, sb->cap, 0);
+  sb->p = NULL;
+  sb->len = 0;
+  sb->cap = 0;
+}
+
+/* Arguments of the protected copy in ds_slab_copy(). */
+struct ds_slab_cvt {
+  const struct ds_slab *sb;
+  const struct luaz_codec *cv;
+  size_t *bad;
+  int rc;
+};
+
+/**
+ * @brief Protected body of ds_slab_copy().
+ *
+ * @param L Lua state (light userdata struct ds_slab_cvt at 1).
+ * @return 1 (the string), or 0 when the codec rejects the data.
+ */
+static int ds_slab_cvt_run(lua_State *L)
+{
+  struct ds_slab_cvt *c = (struct ds_slab_cvt *)lua_touserdata(L, 1);
+
+  if (c->cv != NULL)
+    c->rc = luaz_codec_push(L, c->cv, c->sb->p, c->sb->len, c->bad);
+  else
+    lua_pushlstring(L, c->sb->p, c->sb->len);
+  return (c->rc == 0) ? 1 : 0;
+}
+
+/**
+ * @brief Push a copy of the slab, converted by cv when given, and free it.
+ *
+ * The copy runs under lua_pcall() so the slab is released even when Lua
+ * raises a memory error; the caller re-raises the error object.
+ *
+ * @param L Lua state.
+ * @param sb Slab (empty on return).
+ * @param cv Codec, or NULL for a plain copy.
+ * @param bad Output offset of the first bad byte (codec only).
+ * @return LUA_OK with the string pushed, -1 when the codec rejects the
+ *         data (nothing pushed), or the lua_pcall() status with the error
+ *         object pushed.
+ */
+static int ds_slab_copy(lua_State *L, struct ds_slab *sb,
+                        const struct luaz_codec *cv, size_t *bad)
+{
+  struct ds_slab_cvt c;
+  int status;
+
+  c.sb = sb;
+  c.cv = cv;
+  c.bad = bad;
+  c.rc = 0;
+  lua_pushcfunction(L, ds_slab_cvt_run);
+  lua_pushlightuserdata(L, &c);
+  status = lua_pcall(L, 1, 1, 0);
+  ds_slab_free(sb);
+  if (status != LUA_OK)
+    return status;
+  if (c.rc != 0) {
+    lua_pop(L, 1);
+    return -1;
+  }
+  return LUA_OK;
+}
+
+/**
+ * @brief Push the slab as a Lua string and give up ownership of it.
+ *
+ * The block is trimmed to len + 1 and pushed with
+ * lua_pushexternalstring(), so the Lua string uses the read buffer
+ * itself instead of a copy. Lua frees the block on a memory error.
+ *
+ * @param L Lua state.
+ * @param sb Slab (empty on return).
+ */
+static void ds_slab_push(lua_State *L, struct ds_slab *sb)
+{
+  char *p;
+
+  if (sb->len == 0) {
+    ds_slab_free(sb);
+    lua_pushliteral(L, "");
+    return;
+  }
+  p = (char *)sb->allocf(sb->ud, sb->p, sb->cap, sb->len + 1);
+  if (p == NULL) {
+    /* The block could not be trimmed; Lua would free it with the wrong
+     * size, so fall back to a copy (the slab is freed if that raises). */
+    if (ds_slab_copy(L, sb, NULL, NULL) != LUA_OK)
+      lua_error(L);
+    return;
+  }
+  p[sb->len] = '\0';
+  sb->p = NULL;
+  sb->cap = 0;
+  lua_pushexternalstring(L, p, sb->len, sb->allocf, sb->ud);
+  sb->len = 0;
+}
+
+/**
+ * @brief Read the rest of a handle into a slab.
+ *
+ * Stream handles drain the scanner block, then read blksize chunks (from
+ * fldata() at open) straight into the slab; record handles join records
+ * with newlines.
+ *
+ * @param h DS handle opened for reading.
+ * @param sb Slab (initialized; may be presized).
+ * @return 0 on success, or -1 on a read or allocation error (slab freed).
+ */
+static int ds_read_slab(struct lua_ds_handle *h, struct ds_slab *sb)
+{
+  size_t chunk = DS_READ_CHUNK;
+  size_t n;
+
+  if (h->recio) {
+    const char *rec;
+    while ((rec = ds_read_record(h, &n)) != NULL) {
+      if (ds_slab_reserve(sb, n + 1) != 0) {
+        ds_slab_free(sb);
+        return -1;
+      }
+      memcpy(sb->p + sb->len, rec, n);
+      sb->len += n;
+      sb->p[sb->len++] = '\n';
+    }
+    if (h->rbuf == NULL || ferror(h->fp)) {
+      ds_slab_free(sb);
+      return -1;
+    }
+    return 0;
+  }
+  if (h->blksize > chunk)
+    chunk = (size_t)h->blksize;
+  do {
+    if (ds_slab_reserve(sb, chunk) != 0) {
+      ds_slab_free(sb);
+      return -1;
+    }
+    n = h->scan_on ? luaz_lscan_read(&h->scan, sb->p + sb->len, chunk)
+                   : fread(sb->p + sb->len, 1, chunk, h->fp);
+    sb->len += n;
+  } while (n == chunk);
+  if (ds_stream_error(h)) {
+    ds_slab_free(sb);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Read the rest of a handle into one string ("a" format).
+ *
+ * @param L Lua state.
+ * @param h DS handle opened for reading.
+ * @return 1 and push the data (possibly empty), or -1 on error.
+ */
+static int ds_read_all(lua_State *L, struct lua_ds_handle *h)
+{
+  struct ds_slab sb;
+
+  /* Change note: read "a" into one lua_Alloc block handed to Lua.
+   * Problem: the luaL_Buffer box grows by half and lives in a userdata
+   * until the result is pushed.
+   * Expected effect: the data is read straight into a doubling lua_Alloc
+   * block that becomes the string via lua_pushexternalstring().
+   * Impact: large reads hold one buffer, with no extra Lua objects.
+   */
+  ds_slab_init(L, &sb);
+  if (ds_read_slab(h, &sb) != 0)
+    return -1;
+  if (h->cv != NULL) {
+    int rc = ds_slab_copy(L, &sb, h->cv, &h->cv_bad);
+    if (rc > 0)
+      lua_error(L);
+    if (rc != 0) {
+      h->cv_err = 1;
+      return -1;
+    }
+    return 1;
+  }
+  ds_slab_push(L, &sb);
+  return 1;
+}
+
+/**
+ * @brief Read up to count bytes ("n" count format).
+ *
+ * @param L Lua state.
+ * @param h DS handle opened for reading.
+ * @param count Byte count.
+ * @return 1 and push the bytes, 0 at EOF, or -1 on error.
+ */
+static int ds_read_count(lua_State *L, struct lua_ds_handle *h, size_t count)
+{
+  luaL_Buffer b;
+  unsigned long n = (unsigned long)count;
+  char *p;
+
+  if (count == 0) {
+    int rc;
+    if (h->scan_on) {
+      rc = luaz_lscan_at_eof(&h->scan);
+    }
+    else {
+      int c = getc(h->fp);
+      rc = (c == EOF) ? (ferror(h->fp) ? -1 : 1) : 0;
+      if (c != EOF)
+        ungetc(c, h->fp);
+    }
+    if (rc != 0)
+      return (rc < 0) ? -1 : 0;
+    lua_pushliteral(L, "");
+    return 1;
+  }
+  p = luaL_buffinitsize(L, &b, count);
+  if (lua_ds_read(h, p, &n) != 0 || ds_stream_error(h)) {
+    lua_pop(L, 1);
+    return -1;
+  }
+  luaL_pushresultsize(&b, (size_t)n);
+  if (n == 0) {
+    lua_pop(L, 1);
+    return 0;
+  }
+  if (h->cv != NULL)
+    return ds_codec_top(L, h);
+  return 1;
+}
+
+/**
+ * @brief Push the results of a failed read (nil, message, code).
+ *
+ * @param L Lua state.
+ * @param h DS handle.
+ * @return 3.
+ */
+static int ds_read_fail(lua_State *L, struct lua_ds_handle *h)
+{
+  lua_pushnil(L);
+  if (h->cv_err) {
+    h->cv_err = 0;
+    lua_pushfstring(L, "LUZ30058 ds.read invalid or unmappable character "
+                       "encoding=%s byte=%I",
+                    luaz_codec_name(h->cv->from), (LUAI_UACINT)(h->cv_bad + 1));
+    lua_pushinteger(L, LUZ_E_CODEC);
+    return 3;
+  }
+  lua_pushfstring(L, "LUZ30007 ds.read failed errno=%d errno2=%d", errno,
+                  __errno2());
+  lua_pushinteger(L, LUZ_E_DS_READ);
+  return 3;
+}
+
+/**
+ * @brief Convert a string to write from the internal encoding.
+ *
+ * The converted string stays on the stack until the write is done.
+ *
+ * @param L Lua state.
+ * @param h DS handle opened for writing.
+ * @param s In/out string bytes.
+ * @param len In/out string length.
+ * @return Values pushed (0 without a conversion, 1 with one), or -1 on
+ *         invalid input (nothing pushed, h->cv_bad set).
+ */
+static int ds_codec_arg(lua_State *L, struct lua_ds_handle *h,
+                        const char **s, size_t *len)
+{
+  if (h->cv == NULL)
+    return 0;
+  if (luaz_codec_push(L, h->cv, *s, *len, &h->cv_bad) != 0)
+    return -1;
+  *s = lua_tolstring(L, -1, len);
+  return 1;
+}
+
+/**
+ * @brief Push the results of a write that failed in conversion.
+ *
+ * @param L Lua state.
+ * @param h DS handle.
+ * @param rec Record number for write_records, or 0.
+ * @return 3 (nil, message, code).
+ */
+static int ds_write_codec_fail(lua_State *L, struct lua_ds_handle *h,
+                               lua_Integer rec)
+{
+  lua_pushnil(L);
+  if (rec > 0)
+    lua_pushfstring(L, "LUZ30058 ds.write invalid or unmappable character "
+                       "encoding=%s record=%I byte=%I",
+                    luaz_codec_name(h->cv->from), (LUAI_UACINT)rec,
+                    (LUAI_UACINT)(h->cv_bad + 1));
+  else
+    lua_pushfstring(L, "LUZ30058 ds.write invalid or unmappable character "
+                       "encoding=%s byte=%I",
+                    luaz_codec_name(h->cv->from),
+                    (LUAI_UACINT)(h->cv_bad + 1));
+  lua_pushinteger(L, LUZ_E_CODEC);
+  return 3;
+}
+
+/**
+ * @brief Write one line or record to a handle.
+ *
+ * Stream handles get a trailing newline when missing; record handles
+ * write the bytes as one record (a trailing newline is dropped).
+ *
+ * @param h DS handle opened for writing.
+ * @param line Line bytes.
+ * @param len Line length.
+ * @return 0 on success, or LUZ_E_DS_WRITE on failure.
+ */
+static int ds_writeline_handle(struct lua_ds_handle *h, const char *line,
+                               size_t len)
+{
+  int rc;
+
+  if (h->recio) {
+    char blank;
+    if (len > 0 && line[len - 1] == '\n')
+      len--;
+    /* A 0-byte fwrite writes no record; store one blank instead, which
+     * RECFM=F pads to LRECL. */
+    if (len == 0) {
+      blank = (char)((h->cv != NULL) ? luaz_codec_space(h->cv->to) : ' ');
+      line = &blank;
+      len = 1;
+    }
+    if (fwrite(line, 1, len, h->fp) != len)
+      return LUZ_E_DS_WRITE;
+    return ferror(h->fp) ? LUZ_E_DS_WRITE : 0;
+  }
+  rc = lua_ds_write(h, line, (unsigned long)len);
+  if (rc == 0 && (len == 0 || line[len - 1] != '\n'))
+    rc = lua_ds_write(h, "\n", 1);
+  return rc;
+}
+
+/**
+ * @brief Close a DS userdata handle and clear its pointer.
+ *
+ * @param ud DS userdata wrapper.
+ * @return 0 on success, or LUZ_E_DS_CLOSE on failure.
+ */
+static int ds_ud_close(struct lua_ds_ud *ud)
+{
+  int rc;
+
+  if (ud == NULL || ud->h == NULL)
+    return LUZ_E_DS_CLOSE;
+  /* The handle is freed even when the close fails; never close it twice. */
+  rc = lua_ds_close(ud->h);
+  ud->h = NULL;
+  return (rc != 0) ? LUZ_E_DS_CLOSE : 0;
+}
+
+/**
+ * @brief Validate and return the DS handle from Lua userdata.
+ *
+ * @param L Lua state.
+ * @param idx Stack index.
+ * @return DS handle pointer or NULL if invalid/closed.
+ */
+static struct lua_ds_handle *ds_ud_check(lua_State *L, int idx)
+{
+  struct lua_ds_ud *ud = NULL;
+  if (L == NULL)
+    return NULL;
+  ud = (struct lua_ds_ud *)luaL_checkudata(L, idx, g_ds_handle_mt);
+  if (ud == NULL || ud->h == NULL)
+    return NULL;
+  return ud->h;
+}
+
+/**
+ * @brief Return whether the open-form cache is enabled (ds.opencache).
+ *
+ * @return 1 unless LUACFG sets ds.opencache to false/0.
+ */
+static int ds_ocache_enabled(void)
+{
+  const char *value = luaz_policy_get_raw("ds.opencache");
+
+  if (value == NULL || value[0] == '\0')
+    return 1;
+  return !(strcmp(value, "0") == 0 || value[0] == 'f' || value[0] == 'F');
+}
+
+/**
+ * @brief Find the probe that opened a DDNAME/DSN last time.
+ *
+ * @param kind 'D' for a DDNAME, 'N' for a DSN path.
+ * @param key Upper-case DDNAME or built DSN path.
+ * @param mode Open mode ('r', 'w' or 'a').
+ * @return Probe index, or -1 when not cached.
+ */
+static int ds_ocache_find(char kind, const char *key, char mode)
+{
+  int i;
+
+  if (!ds_ocache_enabled())
+    return -1;
+  for (i = 0; i < DS_OCACHE_SLOTS; i++) {
+    const ds_ocache_entry *e = &g_ds_ocache[i];
+    if (e->kind == kind && e->mode == mode && strcmp(e->key, key) == 0)
+      return (int)e->probe;
+  }
+  return -1;
+}
+
+/**
+ * @brief Remember the probe that opened a DDNAME/DSN.
+ *
+ * Existing entries are updated in place; new ones replace slots in
+ * round-robin order.
+ *
+ * @param kind 'D' for a DDNAME, 'N' for a DSN path.
+ * @param key Upper-case DDNAME or built DSN path.
+ * @param mode Open mode ('r', 'w' or 'a').
+ * @param probe Probe index that succeeded.
+ */
+static void ds_ocache_store(char kind, const char *key, char mode, int probe)
+{
+  ds_ocache_entry *e = NULL;
+  int i;
+
+  if (!ds_ocache_enabled() || strlen(key) >= sizeof(e->key))
+    return;
+  for (i = 0; i < DS_OCACHE_SLOTS; i++) {
+    if (g_ds_ocache[i].kind == kind && g_ds_ocache[i].mode == mode &&
+        strcmp(g_ds_ocache[i].key, key) == 0) {
+      e = &g_ds_ocache[i];
+      break;
+    }
+  }
+  if (e == NULL) {
+    e = &g_ds_ocache[g_ds_ocache_next];
+    g_ds_ocache_next = (g_ds_ocache_next + 1u) % DS_OCACHE_SLOTS;
+    e->kind = kind;
+    e->mode = mode;
+    strcpy(e->key, key);
+  }
+  e->probe = (unsigned char)probe;
+}
+
+/**
+ * @brief Map an open mode to its stream, record and FB80 fopen modes.
+ *
+ * @param mode Open mode ('r', 'w' or 'a').
+ * @return Row of DS_OPEN_MODES fopen modes, or NULL for a bad mode.
+ */
+static const char *const *ds_fmodes(char mode)
+{
+  static const char *const r_modes[DS_OPEN_MODES] = {
+      "rb", "rb,type=record", "rb,recfm=FB,lrecl=80"};
+  static const char *const w_modes[DS_OPEN_MODES] = {
+      "wb", "wb,type=record", "wb,recfm=FB,lrecl=80"};
+  static const char *const a_modes[DS_OPEN_MODES] = {
+      "ab", "ab,type=record", "ab,recfm=FB,lrecl=80"};
+
+  switch (mode) {
+  case 'r':
+    return r_modes;
+  case 'w':
+    return w_modes;
+  case 'a':
+    return a_modes;
+  default:
+    return NULL;
+  }
+}
+
+/**
+ * @brief Run the fopen probe chain, trying the cached probe first.
+ *
+ * Probe i opens path form (i % nforms) with fopen mode (i / nforms), which
+ * is the historical attempt order. A cached probe that no longer opens
+ * (for example after a DD was reallocated) falls back to the full chain.
+ *
+ * @param kind 'D' for a DDNAME, 'N' for a DSN path.
+ * @param key Cache key (upper-case DDNAME or DSN path).
+ * @param forms Path formats ("%s" gets key).
+ * @param nforms Number of path formats.
+ * @param fmodes fopen modes to try, in order.
+ * @param nmodes Number of fopen modes.
+ * @param mode Cache mode ('r', 'w' or 'a'; upper-case for record I/O).
+ * @return Open FILE pointer, or NULL when every probe failed.
+ */
+static FILE *ds_open_probe(char kind, const char *key,
+                           const char *const *forms, int nforms,
+                           const char *const *fmodes, int nmodes, char mode)
+{
+  char path[112];
+  int nprobes = nforms * nmodes;
+  int cached = ds_ocache_find(kind, key, mode);
+  FILE *fp = NULL;
+  int i;
+
+  g_ds_ostats[DS_OSTAT_OPENS]++;
+  if (cached >= 0 && cached < nprobes &&
+      snprintf(path, sizeof(path), forms[cached % nforms], key) > 0) {
+    g_ds_ostats[DS_OSTAT_PROBES]++;
+    fp = fopen(path, fmodes[cached / nforms]);
+    if (fp != NULL) {
+      g_ds_ostats[DS_OSTAT_HITS]++;
+      g_ds_ostats[DS_OSTAT_PROBES_SAVED] += (unsigned long)cached;
+      return fp;
+    }
+  }
+  g_ds_ostats[DS_OSTAT_MISSES]++;
+  for (i = 0; i < nprobes; i++) {
+    if (i == cached)
+      continue;
+    if (snprintf(path, sizeof(path), forms[i % nforms], key) <= 0)
+      continue;
+    g_ds_ostats[DS_OSTAT_PROBES]++;
+    fp = fopen(path, fmodes[i / nforms]);
+    if (fp != NULL) {
+      ds_ocache_store(kind, key, mode, i);
+      return fp;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Return the ds.bufmult policy multiplier.
+ *
+ * @return BLKSIZE multiplier (0 = keep the C runtime buffer).
+ */
+static unsigned long ds_bufmult(void)
+{
+  const char *value = luaz_policy_get_raw("ds.bufmult");
+  unsigned long mult;
+
+  if (value == NULL || value[0] == '\0')
+    return DS_BUFMULT_DEFAULT;
+  mult = strtoul(value, NULL, 10);
+  return (mult > DS_BUFMULT_MAX) ? DS_BUFMULT_MAX : mult;
+}
+
+/**
+ * @brief Apply open-time buffering to a fresh stream.
+ *
+ * The size is opts->bufsize, else BLKSIZE x ds.bufmult; setvbuf() must run
+ * before the first I/O on the stream. When a line scanner reads the stream
+ * the size goes to the scanner block and the stream keeps at most one
+ * BLKSIZE buffer, so records are not staged twice.
+ *
+ * @param fp Open FILE stream (no I/O done yet).
+ * @param info fldata() result, or NULL when unavailable.
+ * @param opts Open options (may be NULL).
+ * @param scan Nonzero when the stream is read through a line scanner.
+ * @return Buffer size in effect (0 = C runtime default).
+ */
+static unsigned long ds_apply_buffering(FILE *fp, const fldata_t *info,
+                                        const struct ds_open_opts *opts,
+                                        int scan)
+{
+  unsigned long size = (opts != NULL) ? opts->bufsize : 0;
+  unsigned long vsize;
+  int buffering = (opts != NULL) ? opts->buffering : DS_BUFFERING_DEFAULT;
+
+  if (size == 0 && info != NULL && info->__blksize > 0)
+    size = (unsigned long)info->__blksize * ds_bufmult();
+  if (size > DS_BUFSIZE_MAX)
+    size = DS_BUFSIZE_MAX;
+  vsize = size;
+  if (scan)
+    vsize = (info != NULL && info->__blksize > 0 &&
+             (unsigned long)info->__blksize < size)
+                ? (unsigned long)info->__blksize
+                : 0;
+  if (buffering == _IONBF) {
+    (void)setvbuf(fp, NULL, _IONBF, 0);
+    return scan ? size : 0;
+  }
+  if (vsize == 0 && (scan || buffering == DS_BUFFERING_DEFAULT))
+    return scan ? size : 0;
+  if (buffering == DS_BUFFERING_DEFAULT)
+    buffering = _IOFBF;
+  if (setvbuf(fp, NULL, buffering, (size_t)vsize) != 0 && !scan)
+    return 0;
+  return size;
+}
+
+/**
+ * @brief Allocate a handle around an opened stream.
+ *
+ * Record I/O handles size their record buffer from fldata() __maxreclen;
+ * stream buffering and the scanner block follow the bufsize option or
+ * BLKSIZE x ds.bufmult.
+ *
+ * @param fp Open FILE stream.
+ * @param mode Open mode ('r', 'w' or 'a').
+ * @param opts Open options (NULL = defaults).
+ * @return Handle, or NULL on allocation failure (fp is closed).
+ */
+static struct lua_ds_handle *ds_handle_new(FILE *fp, char mode,
+                                           const struct ds_open_opts *opts)
+{
+  struct lua_ds_handle *h;
+  fldata_t info;
+  int have_info;
+  int recio = (opts != NULL && opts->recio);
+  unsigned long bufsize;
+
+  h = (struct lua_ds_handle *)malloc(sizeof(*h));
+  if (h == NULL) {
+    fclose(fp);
+    return NULL;
+  }
+  h->fp = fp;
+  h->mode = mode;
+  h->recio = recio;
+  h->rbuf = NULL;
+  h->rcap = DS_LRECL_MAX;
+  h->scan_on = 0;
+  h->cv = NULL;
+  h->cv_err = 0;
+  h->cv_bad = 0;
+  have_info = (fldata(fp, NULL, &info) == 0);
+  h->blksize = (have_info && info.__blksize > 0)
+                   ? (unsigned long)info.__blksize
+                   : 0;
+  if (recio && have_info && info.__maxreclen > 0)
+    h->rcap = (unsigned long)info.__maxreclen;
+
+  /* Change note: size stream buffers from the dataset BLKSIZE.
+   * Problem: big PS scans used the C runtime default buffer regardless of
+   * BLKSIZE and issued small I/Os.
+   * Expected effect: one buffer holds several blocks (ds.bufmult).
+   * Impact: open options bufsize/buffering; LUACFG ds.bufmult. Scanned
+   * reads put that size in the scanner block and leave the stream one
+   * BLKSIZE, since every fread() of a block copied it out of a second
+   * buffer of the same size.
+   */
+  bufsize = ds_apply_buffering(fp, have_info ? &info : NULL, opts,
+                               mode == 'r' && !recio);
+
+  /* Change note: stream readers scan lines from a per-handle block.
+   * Problem: fgets into a 256-byte buffer took several calls and copies
+   * per long record.
+   * Expected effect: one large fread per block; lines are pushed straight
+   * from the block.
+   * Impact: all stream reads on the handle go through the scanner.
+   */
+  if (mode == 'r' && !recio) {
+    if (luaz_lscan_init(&h->scan, fp, (size_t)bufsize) != 0) {
+      fclose(fp);
+      free(h);
+      return NULL;
+    }
+    h->scan_on = 1;
+
+    /* Change note: optional read-ahead thread for sequential scans.
+     * Problem: jobs waited on dataset reads, then crunched records in Lua,
+     * with no overlap between the two.
+     * Expected effect: the next blocks are read while Lua processes lines.
+     * Impact: {readahead=N}; close/__gc stop and join the thread. A thread
+     * that cannot start (no POSIX(ON), no storage) fails the open with its
+     * errno instead of quietly leaving the handle synchronous.
+     */
+    if (opts != NULL && opts->readahead > 0 &&
+        luaz_lscan_readahead(&h->scan, opts->readahead) != 0) {
+      int err = errno;
+      lua_ds_close(h);
+      errno = err;
+      return NULL;
+    }
+  }
+
+  /* Change note: convert text between the dataset and Lua encodings.
+   * Problem: scripts that keep strings in UTF-8 had to convert every
+   * line read from or written to an EBCDIC dataset in Lua.
+   * Expected effect: {encoding=...} converts in C with a 256-byte table
+   * (plus UTF-8 coding) as lines and blocks move through the handle.
+   * Impact: read/lines/read_records/write paths and ds.slurp; fields()
+   * and the C API stay raw because binary fields must not be translated.
+   */
+  if (opts != NULL && opts->enc >= 0) {
+    struct luaz_codec cv;
+    int nl = luaz_codec_newline(opts->internal);
+    if (mode == 'r') {
+      luaz_codec_init(&cv, opts->enc, opts->internal, opts->repl);
+      luaz_codec_text(&cv, '\n', nl);
+    }
+    else {
+      luaz_codec_init(&cv, opts->internal, opts->enc, -1);
+      luaz_codec_text(&cv, nl, '\n');
+      if (opts->repl >= 0)
+        cv.repl = cv.map[opts->repl];
+    }
+    if (!cv.ident) {
+      h->cv = (struct luaz_codec *)malloc(sizeof(cv));
+      if (h->cv == NULL) {
+        lua_ds_close(h);
+        return NULL;
+      }
+      *h->cv = cv;
+    }
+  }
+  return h;
+}
+
+/**
+ * @brief Open a DDNAME with the probe chain for the requested options.
+ *
+ * @param ddname DDNAME string.
+ * @param mode Mode string ("r", "w", or "a").
+ * @param opts Open options (NULL = stream defaults).
+ * @param out Output handle pointer.
+ * @return 0 on success, or LUZ_E_DS_OPEN on failure.
+ */
+static int ds_open_dd_opts(const char *ddname, const char *mode,
+                           const struct ds_open_opts *opts,
+                           struct lua_ds_handle **out)
+{
+  static const char *const forms[DS_DD_FORMS] = {
+      "//DD:%s", "DD:%s", "dd:%s", "%s", "//%s"};
+  const char *const *fmodes;
+  char ddname_uc[9];
+  int recio = (opts != NULL && opts->recio);
+  FILE *fp;
+
+  if (out)
+    *out = 0;
+  if (!ddname_valid(ddname) || out == NULL || mode == NULL || mode[0] == '\0')
+    return LUZ_E_DS_OPEN;
+  fmodes = ds_fmodes(mode[0]);
+  if (fmodes == NULL)
+    return LUZ_E_DS_OPEN;
+  if (opts != NULL && opts->readahead > 0 && (recio || mode[0] != 'r'))
+    return LUZ_E_DS_OPEN;
+
+  /* Change note: normalize DDNAME to upper-case before fopen.
+   * Problem: mixed-case DDNAMEs can fail to resolve in DD: paths.
+   * Expected effect: DDNAME lookup is consistent for batch DDs.
+   * Impact: ds.open_dd accepts lower-case DDNAMEs.
+   */
+  if (ddname_copy_upper(ddname, ddname_uc, sizeof(ddname_uc)) != 0)
+    return LUZ_E_DS_OPEN;
+
+  /* Change note: try the path form and fopen mode that worked last time.
+   * Problem: reopening a DD walked up to 15 fopen attempts every time.
+   * Expected effect: repeated opens of a DD cost one fopen.
+   * Impact: per-process cache keyed by DDNAME and mode; ds.openstats().
+   */
+  if (recio)
+    fp = ds_open_probe('D', ddname_uc, forms, DS_DD_FORMS,
+                       fmodes + DS_FMODE_RECORD, 1,
+                       (char)toupper((unsigned char)mode[0]));
+  else
+    fp = ds_open_probe('D', ddname_uc, forms, DS_DD_FORMS, fmodes,
+                       DS_OPEN_MODES, mode[0]);
+  if (fp == NULL)
+    return LUZ_E_DS_OPEN;
+  *out = ds_handle_new(fp, mode[0], opts);
+  return (*out != NULL) ? 0 : LUZ_E_DS_OPEN;
+}
+
+/**
+ * @brief Open a DSN with the probe chain for the requested options.
+ *
+ * @param dsn Dataset name string (plain or fully formatted).
+ * @param mode Mode string ("r", "w", or "a").
+ * @param opts Open options (NULL = stream defaults).
+ * @param out Output handle pointer.
+ * @return 0 on success, or LUZ_E_DS_OPEN on failure.
+ */
+static int ds_open_dsn_opts(const char *dsn, const char *mode,
+                            const struct ds_open_opts *opts,
+                            struct lua_ds_handle **out)
+{
+  static const char *const forms[1] = {"%s"};
+  char path[96];
+  const char *const *fmodes;
+  int recio = (opts != NULL && opts->recio);
+  FILE *fp;
+
+  if (out)
+    *out = 0;
+  if (dsn == NULL || out == NULL || mode == NULL || mode[0] == '\0')
+    return LUZ_E_DS_OPEN;
+  fmodes = ds_fmodes(mode[0]);
+  if (fmodes == NULL)
+    return LUZ_E_DS_OPEN;
+  if (opts != NULL && opts->readahead > 0 && (recio || mode[0] != 'r'))
+    return LUZ_E_DS_OPEN;
+  if (dsn_build_path(dsn, path, sizeof(path)) != 0)
+    return LUZ_E_DS_OPEN;
+
+  if (recio)
+    fp = ds_open_probe('N', path, forms, 1, fmodes + DS_FMODE_RECORD, 1,
+                       (char)toupper((unsigned char)mode[0]));
+  else
+    fp = ds_open_probe('N', path, forms, 1, fmodes, DS_OPEN_MODES, mode[0]);
+  if (fp == NULL)
+    return LUZ_E_DS_OPEN;
+  *out = ds_handle_new(fp, mode[0], opts);
+  return (*out != NULL) ? 0 : LUZ_E_DS_OPEN;
+}
+
+/**
+ * @brief Open a DDNAME stream with the given mode.
+ *
+ * @param ddname DDNAME string.
+ * @param mode Mode string ("r", "w", or "a").
+ * @param out Output handle pointer.
+ * @return 0 on success, or LUZ_E_DS_OPEN on failure.
+ */
+int lua_ds_open_dd(const char *ddname, const char *mode, struct lua_ds_handle **out)
+{
+  return ds_open_dd_opts(ddname, mode, NULL, out);
+}
+
+/**
+ * @brief Open a DSN stream with the given mode.
+ *
+ * @param dsn Dataset name string (plain or fully formatted).
+ * @param mode Mode string ("r", "w", or "a").
+ * @param out Output handle pointer.
+ * @return 0 on success, or LUZ_E_DS_OPEN on failure.
+ */
+int lua_ds_open_dsn(const char *dsn, const char *mode, struct lua_ds_handle **out)
+{
+  return ds_open_dsn_opts(dsn, mode, NULL, out);
+}
+
+/**
+ * @brief Read bytes from a DDNAME stream.
+ *
+ * @param h DS handle.
+ * @param buf Output buffer.
+ * @param len In/out: capacity on input, bytes read on output.
+ * @return 0 on success, or LUZ_E_DS_READ on failure.
+ */
+int lua_ds_read(struct lua_ds_handle *h, void *buf, unsigned long *len)
+{
+  size_t n;
+  if (h == NULL || h->fp == NULL || buf == NULL || len == NULL)
+    return LUZ_E_DS_READ;
+  if (h->mode != 'r')
+    return LUZ_E_DS_READ;
+
+  if (h->scan_on) {
+    n = luaz_lscan_read(&h->scan, buf, (size_t)(*len));
+    *len = (unsigned long)n;
+    return h->scan.err ? LUZ_E_DS_READ : 0;
+  }
+  n = fread(buf, 1, (size_t)(*len), h->fp);
+  *len = (unsigned long)n;
+  return 0;
+}
+
+/**
+ * @brief Write bytes to a DDNAME stream.
+ *
+ * @param h DS handle.
+ * @param buf Input buffer.
+ * @param len Number of bytes to write.
+ * @return 0 on success, or LUZ_E_DS_WRITE on failure.
+ */
+int lua_ds_write(struct lua_ds_handle *h, const void *buf, unsigned long len)
+{
+  size_t n;
+  if (h == NULL || h->fp == NULL || buf == NULL)
+    return LUZ_E_DS_WRITE;
+  if (!(h->mode == 'w' || h->mode == 'a'))
+    return LUZ_E_DS_WRITE;
+  if (len == 0)
+    return 0;
+  n = fwrite(buf, 1, (size_t)len, h->fp);
+  return (n == (size_t)len) ? 0 : LUZ_E_DS_WRITE;
+}
+
+/**
+ * @brief Close a DDNAME stream and free the handle.
+ *
+ * @param h DS handle.
+ * @return 0 on success, or LUZ_E_DS_CLOSE on failure.
+ */
+int lua_ds_close(struct lua_ds_handle *h)
+{
+  int rc = 0;
+
+  if (h == NULL)
+    return LUZ_E_DS_CLOSE;
+  /* Stop the read-ahead thread before the stream goes away. */
+  if (h->scan_on)
+    luaz_lscan_free(&h->scan);
+  /* Change note: report fclose failures.
+   * Problem: the last buffered block is written by fclose; an out of
+   * space or I/O error there was dropped and writes looked complete.
+   * Expected effect: lua_ds_close returns LUZ_E_DS_CLOSE when fclose
+   * fails; the handle is freed either way.
+   * Impact: h:close(), ds.copy and ds.sort outputs report the failure.
+   */
+  if (h->fp != NULL && fclose(h->fp) != 0)
+    rc = LUZ_E_DS_CLOSE;
+  free(h->rbuf);
+  free(h->cv);
+  free(h);
+  return rc;
+}
+
+/**
+ * @brief Lua binding for ds.open_dd.
+ *
+ * @param L Lua state.
+ * @return 1 on success (handle), or 3 on failure (nil, message, code).
+ */
+static int l_ds_open_dd(lua_State *L)
+{
+  const char *ddname = luaL_checkstring(L, 1);
+  char mode[2];
+  struct ds_open_opts opts;
+  struct lua_ds_handle *h = NULL;
+  struct lua_ds_ud *ud = NULL;
+  int rc;
+
+  /* Change note: add Lua bindings for DDNAME I/O.
+   * Problem: ds.open_dd was only available via C API or Lua stub.
+   * Expected effect: Lua scripts can open DDNAME datasets directly.
+   * Impact: os.remove/rename/tmpname now resolve to ds module stubs.
+   */
+  if (ds_mode_from_lua(L, 2, mode) != 0)
+    return ds_push_bad_opt(L, 2, "ds.open_dd", "mode");
+  if (ds_opts_from_lua(L, 2, &opts) != 0)
+    return ds_push_bad_opt(L, 2, "ds.open_dd", opts.bad);
+  if (opts.readahead > 0 && mode[0] != 'r')
+    return ds_push_bad_opt(L, 2, "ds.open_dd", "readahead");
+
+  rc = ds_open_dd_opts(ddname, mode, &opts, &h);
+  if (rc != 0 || h == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L,
+                    "LUZ30006 ds.open_dd failed dd=%s errno=%d errno2=%d",
+                    ddname, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+
+  ud = (struct lua_ds_ud *)lua_newuserdatauv(L, sizeof(*ud), 0);
+  ud->h = h;
+  luaL_setmetatable(L, g_ds_handle_mt);
+  return 1;
+}
+
+/**
+ * @brief Lua binding for ds.open_dsn.
+ *
+ * @param L Lua state.
+ * @return 1 on success (handle), or 3 on failure (nil, message, code).
+ */
+static int l_ds_open_dsn(lua_State *L)
+{
+  const char *dsn = luaL_checkstring(L, 1);
+  char mode[2];
+  struct ds_open_opts opts;
+  struct lua_ds_handle *h = NULL;
+  struct lua_ds_ud *ud = NULL;
+  int rc;
+
+  /* Change note: add Lua binding for DSN-based dataset open.
+   * Problem: Lua scripts could only access datasets via DDNAME.
+   * Expected effect: scripts can open fully-qualified DSNs directly.
+   * Impact: ds.open_dsn enables DSN I/O without prior DD allocation.
+   */
+  if (ds_mode_from_lua(L, 2, mode) != 0)
+    return ds_push_bad_opt(L, 2, "ds.open_dsn", "mode");
+  if (ds_opts_from_lua(L, 2, &opts) != 0)
+    return ds_push_bad_opt(L, 2, "ds.open_dsn", opts.bad);
+  if (opts.readahead > 0 && mode[0] != 'r')
+    return ds_push_bad_opt(L, 2, "ds.open_dsn", "readahead");
+
+  rc = ds_open_dsn_opts(dsn, mode, &opts, &h);
+  if (rc != 0 || h == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L,
+                    "LUZ30006 ds.open_dsn failed dsn=%s errno=%d errno2=%d",
+                    dsn, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+
+  ud = (struct lua_ds_ud *)lua_newuserdatauv(L, sizeof(*ud), 0);
+  ud->h = h;
+  luaL_setmetatable(L, g_ds_handle_mt);
+  return 1;
+}
+
+/**
+ * @brief Return the DDNAME of a "DD:name" or "//DD:name" slurp or copy
+ *        target.
+ *
+ * @param name ds.slurp name argument.
+ * @return Pointer to the DDNAME, or NULL when name is a DSN.
+ */
+static const char *ds_slurp_ddname(const char *name)
+{
+  const char *p = name;
+
+  if (p[0] == '/' && p[1] == '/')
+    p += 2;
+  if (toupper((unsigned char)p[0]) == 'D' &&
+      toupper((unsigned char)p[1]) == 'D' && p[2] == ':')
+    return p + 3;
+  return NULL;
+}
+
+/**
+ * @brief Open a "DD:ddname" or DSN name with open options.
+ *
+ * @param name DDNAME (DD: prefix) or DSN.
+ * @param mode Mode string ("r", "w", or "a").
+ * @param opts Open options.
+ * @param out Output handle pointer.
+ * @return 0 on success, or LUZ_E_DS_OPEN on failure.
+ */
+static int ds_open_named(const char *name, const char *mode,
+                         const struct ds_open_opts *opts,
+                         struct lua_ds_handle **out)
+{
+  const char *dd = ds_slurp_ddname(name);
+
+  if (dd != NULL)
+    return ds_open_dd_opts(dd, mode, opts, out);
+  return ds_open_dsn_opts(name, mode, opts, out);
+}
+
+/**
+ * @brief Lua binding for ds.slurp(name [, opts]).
+ *
+ * name is "DD:ddname" (or "//DD:ddname") for a DDNAME, otherwise a DSN.
+ * opts takes the open options plus size, a byte estimate used to size the
+ * buffer in one allocation.
+ *
+ * @param L Lua state.
+ * @return 1 on success (string), or 3 on failure (nil, message, code).
+ */
+static int l_ds_slurp(lua_State *L)
+{
+  const char *name = luaL_checkstring(L, 1);
+  char mode[2] = {'r', '\0'};
+  struct ds_open_opts opts;
+  struct lua_ds_handle *h = NULL;
+  struct ds_slab sb;
+  lua_Integer hint = 0;
+  int rc;
+
+  rc = ds_opts_from_lua(L, 2, &opts);
+  if (lua_istable(L, 2)) {
+    lua_getfield(L, 2, "size");
+    if (lua_isinteger(L, -1))
+      hint = lua_tointeger(L, -1);
+    else if (!lua_isnil(L, -1))
+      rc = ds_opt_bad(&opts, "size");
+    lua_pop(L, 1);
+  }
+  if (hint < 0)
+    rc = ds_opt_bad(&opts, "size");
+  if (rc != 0)
+    return ds_push_bad_opt(L, 2, "ds.slurp", opts.bad);
+
+  rc = ds_open_named(name, mode, &opts, &h);
   if (rc != 0 || h == NULL) {
     lua_pushnil(L);
-    lua_pushfstring(L,
-                    "LUZ30006 ds.open_dsn failed dsn=%s errno=%d errno2=%d",
-                    dsn, errno, __errno2());
+    lua_pushfstring(L, "LUZ30006 ds.slurp open failed name=%s errno=%d errno2=%d",
+                    name, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+
+  ds_slab_init(L, &sb);
+  if (hint > 0 && (lua_Unsigned)hint < (lua_Unsigned)((size_t)-1 / 2))
+    (void)ds_slab_reserve(&sb, (size_t)hint);
+  rc = ds_read_slab(h, &sb);
+  if (rc == 0 && h->cv != NULL) {
+    size_t bad = 0;
+    rc = ds_slab_copy(L, &sb, h->cv, &bad);
+    if (rc > 0) {
+      lua_ds_close(h);
+      return lua_error(L);
+    }
+    if (rc != 0) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "LUZ30058 ds.slurp invalid or unmappable character "
+                         "name=%s encoding=%s byte=%I",
+                      name, luaz_codec_name(h->cv->from),
+                      (LUAI_UACINT)(bad + 1));
+      lua_pushinteger(L, LUZ_E_CODEC);
+      lua_ds_close(h);
+      return 3;
+    }
+    lua_ds_close(h);
+    return 1;
+  }
+  lua_ds_close(h);
+  if (rc != 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30007 ds.slurp read failed name=%s errno=%d errno2=%d",
+                    name, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
+  ds_slab_push(L, &sb);
+  return 1;
+}
+
+/* ds.copy state: open handles, the optional transcoding table, record
+ * reformatting and the counters returned to Lua. */
+struct ds_copy {
+  struct lua_ds_handle *src;
+  struct lua_ds_handle *dst;
+  const struct luaz_codec *cv;
+  unsigned char *buf;
+  size_t cap;
+  size_t lrecl;
+  int fixed;
+  int pad;
+  int trim;
+  int truncate;
+  lua_Integer records;
+  lua_Integer bytes;
+  int err;
+  size_t bad;
+  size_t toolong;
+};
+
+struct ds_copy_opts {
+  struct ds_open_opts open;
+  char mode[2];
+  int from;
+  int to;
+  lua_Integer lrecl;
+  int pad;
+  int trim;
+  int truncate;
+};
+
+/**
+ * @brief Parse ds.copy options.
+ *
+ * Takes the open options (type defaults to record) except encoding= and
+ * internal=, plus mode ("w" or "a" for the target), from/to encodings,
+ * lrecl, pad, trim and truncate.
+ *
+ * @param L Lua state.
+ * @param idx Stack index of the options table (may be none or nil).
+ * @param co Output options.
+ * @return 0 on success, or -1 on an invalid option.
+ */
+static int ds_copy_opts_from_lua(lua_State *L, int idx, struct ds_copy_opts *co)
+{
+  int rc;
+
+  co->mode[0] = 'w';
+  co->mode[1] = '\0';
+  co->from = -1;
+  co->to = -1;
+  co->lrecl = 0;
+  co->pad = -1;
+  co->trim = 0;
+  co->truncate = 0;
+  rc = ds_opts_from_lua(L, idx, &co->open);
+  co->open.recio = 1;
+  if (lua_isnoneornil(L, idx))
+    return rc;
+  if (!lua_istable(L, idx))
+    return -1;
+  /* from/to replace encoding= and internal=: there are no Lua strings. */
+  if (co->open.enc >= 0 || co->open.internal != LUAZ_CODEC_UTF8)
+    rc = ds_opt_bad(&co->open,
+                    co->open.enc >= 0 ? "encoding" : "internal");
+
+  lua_getfield(L, idx, "type");
+  if (lua_isstring(L, -1) && strcmp(lua_tostring(L, -1), "stream") == 0)
+    co->open.recio = 0;
+  lua_pop(L, 1);
+
+  lua_getfield(L, idx, "mode");
+  if (lua_type(L, -1) == LUA_TSTRING) {
+    const char *m = lua_tostring(L, -1);
+    if ((m[0] != 'w' && m[0] != 'a') || m[1] != '\0')
+      rc = ds_opt_bad(&co->open, "mode");
+    else
+      co->mode[0] = m[0];
+  }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(&co->open, "mode");
+  }
+  lua_pop(L, 1);
+
+  lua_getfield(L, idx, "from");
+  if (lua_type(L, -1) == LUA_TSTRING)
+    co->from = luaz_codec_find(lua_tostring(L, -1));
+  if (!lua_isnil(L, -1) && co->from < 0)
+    rc = ds_opt_bad(&co->open, "from");
+  lua_pop(L, 1);
+  lua_getfield(L, idx, "to");
+  if (lua_type(L, -1) == LUA_TSTRING)
+    co->to = luaz_codec_find(lua_tostring(L, -1));
+  if (!lua_isnil(L, -1) && co->to < 0)
+    rc = ds_opt_bad(&co->open, "to");
+  lua_pop(L, 1);
+  if ((co->from < 0) != (co->to < 0))
+    rc = ds_opt_bad(&co->open, co->from < 0 ? "from" : "to");
+
+  lua_getfield(L, idx, "lrecl");
+  if (lua_isinteger(L, -1)) {
+    co->lrecl = lua_tointeger(L, -1);
+    if (co->lrecl <= 0 || co->lrecl > (lua_Integer)DS_LRECL_MAX)
+      rc = ds_opt_bad(&co->open, "lrecl");
+  }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(&co->open, "lrecl");
+  }
+  lua_pop(L, 1);
+
+  lua_getfield(L, idx, "pad");
+  if (lua_type(L, -1) == LUA_TSTRING) {
+    size_t n = 0;
+    const char *p = lua_tolstring(L, -1, &n);
+    if (n != 1)
+      rc = ds_opt_bad(&co->open, "pad");
+    else
+      co->pad = (unsigned char)p[0];
+  }
+  else if (!lua_isnil(L, -1)) {
+    rc = ds_opt_bad(&co->open, "pad");
+  }
+  lua_pop(L, 1);
+
+  lua_getfield(L, idx, "trim");
+  co->trim = lua_toboolean(L, -1);
+  lua_pop(L, 1);
+  lua_getfield(L, idx, "truncate");
+  co->truncate = lua_toboolean(L, -1);
+  lua_pop(L, 1);
+
+  /* Reformatting works on records; a text stream has none to pad. */
+  if (!co->open.recio && (co->lrecl > 0 || co->pad >= 0 || co->trim))
+    rc = ds_opt_bad(&co->open, "type");
+  if (co->open.recio && co->open.readahead > 0)
+    rc = ds_opt_bad(&co->open, "readahead");
+  return rc;
+}
+
+/**
+ * @brief Make the ds.copy work buffer hold at least need bytes.
+ *
+ * @param c Copy state.
+ * @param need Bytes required.
+ * @return 0 on success, or -1 when malloc fails.
+ */
+static int ds_copy_reserve(struct ds_copy *c, size_t need)
+{
+  unsigned char *p;
+
+  if (need <= c->cap)
+    return 0;
+  p = (unsigned char *)realloc(c->buf, need);
+  if (p == NULL)
+    return -1;
+  c->buf = p;
+  c->cap = need;
+  return 0;
+}
+
+/**
+ * @brief Copy record by record: transcode, trim, truncate and pad.
+ *
+ * Each record is read with one fread and written with one fwrite; the C
+ * runtime blocks both sides, so the device I/O stays in whole blocks.
+ *
+ * @param c Copy state.
+ * @return 0 on success, or -1 with c->err set.
+ */
+static int ds_copy_records(struct ds_copy *c)
+{
+  const char *rec;
+  size_t n;
+
+  if (ds_copy_reserve(c, (size_t)c->src->rcap * 2 + c->lrecl) != 0) {
+    c->err = LUZ_E_DS_READ;
+    return -1;
+  }
+  while ((rec = ds_read_record(c->src, &n)) != NULL) {
+    const unsigned char *p = (const unsigned char *)rec;
+    size_t len = n;
+    if (c->cv != NULL) {
+      if (luaz_codec_run(c->cv, p, n, c->buf, &len, &c->bad) != 0) {
+        c->err = LUZ_E_CODEC;
+        return -1;
+      }
+      p = c->buf;
+    }
+    if (c->trim) {
+      while (len > 0 && p[len - 1] == (unsigned char)c->pad)
+        len--;
+    }
+    if (c->lrecl > 0 && len > c->lrecl) {
+      if (!c->truncate) {
+        c->err = LUZ_E_DS_WRITE;
+        c->toolong = len;
+        return -1;
+      }
+      len = c->lrecl;
+    }
+    if (c->fixed && len < c->lrecl) {
+      if (p != c->buf) {
+        memcpy(c->buf, p, len);
+        p = c->buf;
+      }
+      memset(c->buf + len, c->pad, c->lrecl - len);
+      len = c->lrecl;
+    }
+    if (fwrite(p, 1, len, c->dst->fp) != len && len > 0) {
+      c->err = LUZ_E_DS_WRITE;
+      return -1;
+    }
+    c->records++;
+    c->bytes += (lua_Integer)len;
+  }
+  if (c->src->rbuf == NULL || ferror(c->src->fp)) {
+    c->err = LUZ_E_DS_READ;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Copy a text stream in blksize chunks (at least 32 KiB).
+ *
+ * Lines are counted by their newlines; a UTF-8 sequence split by a chunk
+ * is carried into the next one.
+ *
+ * @param c Copy state.
+ * @return 0 on success, or -1 with c->err set.
+ */
+static int ds_copy_stream(struct ds_copy *c)
+{
+  size_t chunk = DS_READ_CHUNK;
+  size_t carry = 0;
+  unsigned char *in;
+  int last = '\n';
+  size_t n;
+
+  if (c->src->blksize > chunk)
+    chunk = (size_t)c->src->blksize;
+  in = (unsigned char *)malloc(chunk + 4);
+  if (in == NULL ||
+      (c->cv != NULL &&
+       ds_copy_reserve(c, luaz_codec_bound(c->cv, chunk + 4)) != 0)) {
+    free(in);
+    c->err = LUZ_E_DS_READ;
+    return -1;
+  }
+  do {
+    const unsigned char *p = in;
+    size_t len;
+    size_t keep = 0;
+    const unsigned char *q;
+    n = c->src->scan_on ? luaz_lscan_read(&c->src->scan, in + carry, chunk)
+                        : fread(in + carry, 1, chunk, c->src->fp);
+    len = carry + n;
+    if (c->cv != NULL) {
+      if (n == chunk)
+        keep = luaz_codec_partial(c->cv, in, len);
+      if (luaz_codec_run(c->cv, in, len - keep, c->buf, &len, &c->bad) != 0) {
+        /* Report the line and the byte within it. */
+        const unsigned char *bol = in;
+        for (q = in; (q = memchr(q, '\n', c->bad - (size_t)(q - in))) != NULL;
+             q++) {
+          c->records++;
+          bol = q + 1;
+        }
+        c->bad -= (size_t)(bol - in);
+        c->err = LUZ_E_CODEC;
+        free(in);
+        return -1;
+      }
+      p = c->buf;
+    }
+    if (len > 0) {
+      if (fwrite(p, 1, len, c->dst->fp) != len) {
+        c->err = LUZ_E_DS_WRITE;
+        free(in);
+        return -1;
+      }
+      for (q = p; (q = memchr(q, '\n', len - (size_t)(q - p))) != NULL; q++)
+        c->records++;
+      last = p[len - 1];
+      c->bytes += (lua_Integer)len;
+    }
+    if (keep > 0)
+      memmove(in, in + (carry + n - keep), keep);
+    carry = keep;
+  } while (n == chunk);
+  free(in);
+  if (ds_stream_error(c->src)) {
+    c->err = LUZ_E_DS_READ;
+    return -1;
+  }
+  if (last != '\n')
+    c->records++; /* the runtime ends the last line at close */
+  return 0;
+}
+
+/**
+ * @brief Lua binding for ds.copy(src, dst [, opts]).
+ *
+ * src and dst are "DD:ddname" or DSN names as in ds.slurp. Records are
+ * copied in C with optional transcoding (from/to) and reformatting
+ * (lrecl, pad, trim, truncate); type="stream" copies text in blocks.
+ *
+ * @param L Lua state.
+ * @return 2 (records, bytes) on success, or 3 on failure (nil, message,
+ *         code).
+ */
+static int l_ds_copy(lua_State *L)
+{
+  const char *src = luaL_checkstring(L, 1);
+  const char *dst = luaL_checkstring(L, 2);
+  struct ds_copy_opts co;
+  struct ds_open_opts wopts;
+  struct luaz_codec cv;
+  struct ds_copy c;
+  fldata_t info;
+  int rc;
+
+  if (ds_copy_opts_from_lua(L, 3, &co) != 0)
+    return ds_push_bad_opt(L, 3, "ds.copy", co.open.bad);
+  memset(&c, 0, sizeof(c));
+  wopts = co.open;
+  wopts.readahead = 0;
+  if (ds_open_named(src, "r", &co.open, &c.src) != 0 || c.src == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30006 ds.copy open failed name=%s errno=%d errno2=%d",
+                    src, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+  if (ds_open_named(dst, co.mode, &wopts, &c.dst) != 0 || c.dst == NULL) {
+    lua_ds_close(c.src);
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30006 ds.copy open failed name=%s errno=%d errno2=%d",
+                    dst, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+
+  /* Change note: copy datasets inside C.
+   * Problem: a readline/writeline loop in Lua paid a Lua string, two
+   * fwrite calls and interpreter work per record.
+   * Expected effect: one fread and one fwrite per record (or per block
+   * for streams), with transcoding and LRECL changes done in place.
+   * Impact: ds.copy; Lua CPU no longer grows with the record count.
+   */
+  if (co.from >= 0) {
+    luaz_codec_init(&cv, co.from, co.to, co.open.repl);
+    if (!co.open.recio)
+      luaz_codec_text(&cv, '\n', '\n');
+    if (!cv.ident)
+      c.cv = &cv;
+  }
+  c.pad = co.pad;
+  if (c.pad < 0)
+    c.pad = (co.to >= 0) ? luaz_codec_space(co.to) : ' ';
+  c.trim = co.trim;
+  c.truncate = co.truncate;
+  if (co.lrecl > 0) {
+    c.lrecl = (size_t)co.lrecl;
+    c.fixed = 1;
+  }
+  else if (co.open.recio && fldata(c.dst->fp, NULL, &info) == 0 &&
+           info.__maxreclen > 0) {
+    /* Fixed targets are padded to LRECL; longer records never fit. */
+    c.lrecl = (size_t)info.__maxreclen;
+    c.fixed = info.__recfmF ? 1 : 0;
+  }
+  rc = co.open.recio ? ds_copy_records(&c) : ds_copy_stream(&c);
+  free(c.buf);
+  lua_ds_close(c.src);
+  /* The last block is written at close; out of space shows up here. */
+  if (lua_ds_close(c.dst) != 0 && rc == 0) {
+    rc = -1;
+    c.err = LUZ_E_DS_CLOSE;
+  }
+  if (rc != 0) {
+    lua_pushnil(L);
+    if (c.err == LUZ_E_CODEC)
+      lua_pushfstring(L, "LUZ30058 ds.copy invalid or unmappable character "
+                         "record=%I byte=%I",
+                      (LUAI_UACINT)(c.records + 1), (LUAI_UACINT)(c.bad + 1));
+    else if (c.toolong > 0)
+      lua_pushfstring(L, "LUZ30008 ds.copy record=%I length=%I exceeds "
+                         "lrecl=%I",
+                      (LUAI_UACINT)(c.records + 1), (LUAI_UACINT)c.toolong,
+                      (LUAI_UACINT)c.lrecl);
+    else if (c.err == LUZ_E_DS_CLOSE)
+      lua_pushfstring(L, "LUZ30009 ds.copy close failed name=%s records=%I "
+                         "errno=%d errno2=%d",
+                      dst, (LUAI_UACINT)c.records, errno, __errno2());
+    else if (c.err == LUZ_E_DS_WRITE)
+      lua_pushfstring(L, "LUZ30008 ds.copy write failed name=%s record=%I "
+                         "errno=%d errno2=%d",
+                      dst, (LUAI_UACINT)(c.records + 1), errno, __errno2());
+    else
+      lua_pushfstring(L, "LUZ30007 ds.copy read failed name=%s record=%I "
+                         "errno=%d errno2=%d",
+                      src, (LUAI_UACINT)(c.records + 1), errno, __errno2());
+    lua_pushinteger(L, c.err);
+    return 3;
+  }
+  lua_pushinteger(L, c.records);
+  lua_pushinteger(L, c.bytes);
+  return 2;
+}
+
+/* ds.sort callback state: the input is closed before the output opens,
+ * so a dataset can be sorted onto itself. */
+struct ds_sort_io {
+  struct lua_ds_handle *in;
+  struct lua_ds_handle *out;
+  const char *output;
+  int out_failed;
+  char (*paths)[DS_SORT_PATH];
+  int npaths;
+  char spill[DS_SORT_PATH];
+};
+
+/**
+ * @brief Return the next ds.sort input record.
+ *
+ * @param ud ds_sort_io.
+ * @param p Output record pointer.
+ * @param n Output record length.
+ * @return 1 with a record, 0 at EOF, or -1 on a read error.
+ */
+static int ds_sort_read(void *ud, const char **p, size_t *n)
+{
+  struct ds_sort_io *io = (struct ds_sort_io *)ud;
+
+  *p = ds_read_record(io->in, n);
+  if (*p != NULL)
+    return 1;
+  return (io->in->rbuf == NULL || ferror(io->in->fp)) ? -1 : 0;
+}
+
+/**
+ * @brief Close the ds.sort input and open the output for records.
+ *
+ * @param io Callback state.
+ * @return 0 on success, or -1 when the output does not open.
+ */
+static int ds_sort_open_output(struct ds_sort_io *io)
+{
+  struct ds_open_opts opts;
+
+  memset(&opts, 0, sizeof(opts));
+  opts.recio = 1;
+  opts.buffering = DS_BUFFERING_DEFAULT;
+  opts.enc = -1;
+  opts.internal = LUAZ_CODEC_UTF8;
+  opts.repl = -1;
+  if (io->in != NULL) {
+    lua_ds_close(io->in);
+    io->in = NULL;
+  }
+  if (ds_open_named(io->output, "w", &opts, &io->out) != 0 || io->out == NULL) {
+    io->out = NULL;
+    io->out_failed = 1;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Write one ds.sort output record.
+ *
+ * @param ud ds_sort_io.
+ * @param p Record bytes.
+ * @param n Record length.
+ * @return 0 on success, or -1 on an open or write error.
+ */
+static int ds_sort_write(void *ud, const char *p, size_t n)
+{
+  struct ds_sort_io *io = (struct ds_sort_io *)ud;
+
+  if (io->out == NULL && ds_sort_open_output(io) != 0)
+    return -1;
+  if (fwrite(p, 1, n, io->out->fp) != n && n > 0)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Create or reopen the work dataset of a ds.sort run.
+ *
+ * New runs get a ds.tmpname DSN that does not open for reading, so an
+ * existing dataset is never overwritten.
+ *
+ * @param ud ds_sort_io.
+ * @param run Run number (0, 1, ... in creation order).
+ * @param create Nonzero to create the run.
+ * @param bytes Size of a new run.
+ * @return Open stream, or NULL on failure.
+ */
+static FILE *ds_sort_spill_open(void *ud, int run, int create,
+                                lua_Integer bytes)
+{
+  struct ds_sort_io *io = (struct ds_sort_io *)ud;
+  char dsn[64];
+  char mode[96];
+  long primary;
+  FILE *fp;
+  int i;
+
+  if (!create) {
+    strcpy(io->spill, io->paths[run]);
+    return fopen(io->paths[run], "rb");
+  }
+  if (run >= io->npaths) {
+    int cap = (io->npaths == 0) ? 16 : io->npaths * 2;
+    char(*x)[DS_SORT_PATH];
+    while (cap <= run)
+      cap *= 2;
+    x = (char(*)[DS_SORT_PATH])realloc(io->paths, (size_t)cap * DS_SORT_PATH);
+    if (x == NULL)
+      return NULL;
+    io->paths = x;
+    io->npaths = cap;
+  }
+  for (i = 0; i < DS_SORT_NAME_TRIES; i++) {
+    if (ds_tmpname_build(dsn, sizeof(dsn)) != 0 ||
+        dsn_build_path(dsn, io->spill, sizeof(io->spill)) != 0)
+      return NULL;
+    fp = fopen(io->spill, "rb");
+    if (fp == NULL)
+      break;
+    fclose(fp);
+  }
+  if (i == DS_SORT_NAME_TRIES)
+    return NULL;
+  /* Change note: size work datasets from the run.
+   * Problem: without space= a run took the site default primary, so a
+   * large sort failed with out of space on its first run.
+   * Expected effect: the run size is allocated up front; the secondary
+   * absorbs the few blocks the estimate misses.
+   * Impact: ds.sort work datasets; unused space is released at close.
+   */
+  primary = DS_SORT_PRIMARY_MAX;
+  if (bytes / DS_SORT_BLKSIZE < DS_SORT_PRIMARY_MAX)
+    primary = (long)(bytes / DS_SORT_BLKSIZE) + 1;
+  snprintf(mode, sizeof(mode), DS_SORT_WMODE, primary, primary / 8 + 1);
+  fp = fopen(io->spill, mode);
+  if (fp != NULL)
+    strcpy(io->paths[run], io->spill);
+  return fp;
+}
+
+/**
+ * @brief Delete the work dataset of a ds.sort run.
+ *
+ * @param ud ds_sort_io.
+ * @param run Run number.
+ */
+static void ds_sort_spill_remove(void *ud, int run)
+{
+  struct ds_sort_io *io = (struct ds_sort_io *)ud;
+
+  remove(io->paths[run]);
+}
+
+/**
+ * @brief Read a required dataset name option of ds.sort.
+ *
+ * @param L Lua state.
+ * @param key Option name ("input" or "output").
+ * @param opts Options; opts->bad names the first invalid key.
+ * @return Name, or NULL when missing or empty.
+ */
+static const char *ds_sort_field(lua_State *L, const char *key,
+                                 struct ds_open_opts *opts)
+{
+  const char *v;
+
+  lua_getfield(L, 1, key);
+  v = (lua_type(L, -1) == LUA_TSTRING) ? lua_tostring(L, -1) : NULL;
+  lua_pop(L, 1); /* the options table keeps the string alive */
+  if (v == NULL || v[0] == '\0') {
+    (void)ds_opt_bad(opts, key);
+    return NULL;
+  }
+  return v;
+}
+
+/**
+ * @brief Lua binding for ds.sort{input=, output=, keys=, memory=}.
+ *
+ * input and output are "DD:ddname" or DSN names as in ds.slurp; keys
+ * lists {pos=n, len=n [, order="A|D"]} fields; memory is the run arena
+ * size in bytes.
+ *
+ * @param L Lua state.
+ * @return 2 (records, work datasets) on success, or 3 on failure (nil,
+ *         message, code).
+ */
+static int l_ds_sort(lua_State *L)
+{
+  struct luaz_dssort s;
+  struct luaz_dssort_io cb;
+  struct ds_sort_io io;
+  struct ds_open_opts opts;
+  const char *input;
+  int kbad = 0;
+  int rc;
+
+  luaL_checktype(L, 1, LUA_TTABLE);
+  luaz_dssort_init(&s);
+  memset(&opts, 0, sizeof(opts));
+  memset(&io, 0, sizeof(io));
+  /* Change note: report bad ds.sort options as values.
+   * Problem: ds.sort raised Lua errors for options that ds.copy, ds.grep,
+   * ds.slurp and ds.members return as LUZ30006.
+   * Expected effect: one calling convention across the ds entry points.
+   * Impact: input/output/keys/memory failures return nil, message, code.
+   */
+  input = ds_sort_field(L, "input", &opts);
+  io.output = ds_sort_field(L, "output", &opts);
+  if (opts.bad != NULL)
+    return ds_push_bad_opt(L, 1, "ds.sort", opts.bad);
+  lua_getfield(L, 1, "keys");
+  if (luaz_dssort_keys(L, -1, &s, &kbad) != 0) {
+    if (kbad == 0)
+      return ds_push_bad_opt(L, 1, "ds.sort", "keys");
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30006 ds.sort invalid option keys[%d]", kbad);
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+  lua_pop(L, 1);
+  lua_getfield(L, 1, "memory");
+  if (!lua_isnil(L, -1)) {
+    int isnum = 0;
+    lua_Integer m = lua_tointegerx(L, -1, &isnum);
+    if (!isnum || m < (lua_Integer)LUAZ_DSSORT_MEMORY_MIN ||
+        m > (lua_Integer)LUAZ_DSSORT_MEMORY_MAX)
+      return ds_push_bad_opt(L, 1, "ds.sort", "memory");
+    s.memory = (size_t)m;
+  }
+  lua_pop(L, 1);
+
+  opts.recio = 1;
+  opts.buffering = DS_BUFFERING_DEFAULT;
+  opts.enc = -1;
+  opts.internal = LUAZ_CODEC_UTF8;
+  opts.repl = -1;
+  if (ds_open_named(input, "r", &opts, &io.in) != 0 || io.in == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30006 ds.sort open failed name=%s errno=%d errno2=%d",
+                    input, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+
+  cb.ud = &io;
+  cb.read = ds_sort_read;
+  cb.write = ds_sort_write;
+  cb.spill_open = ds_sort_spill_open;
+  cb.spill_remove = ds_sort_spill_remove;
+  rc = luaz_dssort_run(&s, &cb);
+  /* An empty input still replaces the output. */
+  if (rc == 0 && io.out == NULL && ds_sort_open_output(&io) != 0) {
+    rc = -1;
+    s.err = LUAZ_DSSORT_E_WRITE;
+  }
+  if (io.in != NULL)
+    lua_ds_close(io.in);
+  if (io.out != NULL && lua_ds_close(io.out) != 0 && rc == 0) {
+    rc = -1;
+    s.err = LUAZ_DSSORT_E_WRITE;
+  }
+  free(io.paths);
+  if (rc != 0) {
+    lua_pushnil(L);
+    if (io.out_failed) {
+      lua_pushfstring(L, "LUZ30006 ds.sort open failed name=%s errno=%d "
+                         "errno2=%d",
+                      io.output, errno, __errno2());
+      lua_pushinteger(L, LUZ_E_DS_OPEN);
+      return 3;
+    }
+    switch (s.err) {
+    case LUAZ_DSSORT_E_READ:
+      lua_pushfstring(L, "LUZ30007 ds.sort read failed name=%s record=%I "
+                         "errno=%d errno2=%d",
+                      input, (LUAI_UACINT)(s.records + 1), errno, __errno2());
+      lua_pushinteger(L, LUZ_E_DS_READ);
+      break;
+    case LUAZ_DSSORT_E_NOMEM:
+      lua_pushfstring(L, "LUZ30007 ds.sort out of memory memory=%I",
+                      (LUAI_UACINT)s.memory);
+      lua_pushinteger(L, LUZ_E_DS_READ);
+      break;
+    case LUAZ_DSSORT_E_SPILL:
+      lua_pushfstring(L, "LUZ30008 ds.sort work dataset failed name=%s "
+                         "errno=%d errno2=%d",
+                      io.spill, errno, __errno2());
+      lua_pushinteger(L, LUZ_E_DS_WRITE);
+      break;
+    default:
+      lua_pushfstring(L, "LUZ30008 ds.sort write failed name=%s record=%I "
+                         "errno=%d errno2=%d",
+                      io.output, (LUAI_UACINT)(s.written + 1), errno,
+                      __errno2());
+      lua_pushinteger(L, LUZ_E_DS_WRITE);
+      break;
+    }
+    return 3;
+  }
+  lua_pushinteger(L, s.written);
+  lua_pushinteger(L, (lua_Integer)s.runs);
+  return 2;
+}
+
+/* ds.grep state: the prepared needle (the required literal of a
+ * pattern), the Lua values it calls and the result tables it fills. */
+struct ds_grep {
+  lua_State *L;
+  struct lua_ds_handle *h;
+  struct luaz_dsgrep g;
+  int pattern; /* stack index of the pattern, or 0 for a literal */
+  int find;    /* stack index of string.find */
+  int recs;    /* stack index of the record number table */
+  int lines;   /* stack index of the line table, or 0 */
+  lua_Integer max;
+  lua_Integer hits;
+  lua_Integer lineno;
+  int raised;  /* string.find raised; the error is on the stack */
+};
+
+/**
+ * @brief Check one candidate line and store it when it matches.
+ *
+ * Literal candidates are hits; pattern candidates (lines holding the
+ * pattern's required literal) go through string.find first.
+ *
+ * @param ud ds_grep.
+ * @param lineno Record or line number.
+ * @param line Line bytes.
+ * @param n Line length.
+ * @return 0 to continue, 1 when max hits are stored, or -1 on an error.
+ */
+static int ds_grep_hit(void *ud, lua_Integer lineno, const char *line,
+                       size_t n)
+{
+  struct ds_grep *gs = (struct ds_grep *)ud;
+  lua_State *L = gs->L;
+
+  gs->lineno = lineno;
+  if (gs->pattern != 0) {
+    lua_pushvalue(L, gs->find);
+    lua_pushlstring(L, line, n);
+    lua_pushvalue(L, gs->pattern);
+    if (lua_pcall(L, 2, 1, 0) != LUA_OK) {
+      gs->raised = 1;
+      return -1;
+    }
+    if (lua_isnil(L, -1)) {
+      lua_pop(L, 1);
+      return 0;
+    }
+    lua_pop(L, 1);
+  }
+  gs->hits++;
+  lua_pushinteger(L, lineno);
+  lua_rawseti(L, gs->recs, gs->hits);
+  if (gs->lines != 0) {
+    if (gs->h->cv != NULL) {
+      if (luaz_codec_push(L, gs->h->cv, line, n, &gs->h->cv_bad) != 0) {
+        gs->h->cv_err = 1;
+        return -1;
+      }
+    }
+    else {
+      lua_pushlstring(L, line, n);
+    }
+    lua_rawseti(L, gs->lines, gs->hits);
+  }
+  return (gs->max > 0 && gs->hits >= gs->max) ? 1 : 0;
+}
+
+/**
+ * @brief Scan a text stream in blocks of complete lines.
+ *
+ * The buffer is a userdata on the Lua stack, so a memory error raised
+ * while a hit is stored cannot leak it; a line longer than the buffer
+ * doubles it.
+ *
+ * @param gs Scan state.
+ * @return 0 at EOF or after max hits, or -1 on an error.
+ */
+static int ds_grep_stream(struct ds_grep *gs)
+{
+  lua_State *L = gs->L;
+  struct lua_ds_handle *h = gs->h;
+  size_t cap = 2 * DS_READ_CHUNK;
+  size_t len = 0;
+  char *buf;
+  int slot;
+  int rc = 0;
+
+  if (h->blksize * 2 > cap)
+    cap = (size_t)h->blksize * 2;
+  buf = (char *)lua_newuserdatauv(L, cap, 0);
+  slot = lua_gettop(L);
+  for (;;) {
+    size_t want = cap - len;
+    size_t n = h->scan_on ? luaz_lscan_read(&h->scan, buf + len, want)
+                          : fread(buf + len, 1, want, h->fp);
+    int eof = (n < want);
+    size_t done = len + n;
+
+    len += n;
+    if (!eof) {
+      while (done > 0 && buf[done - 1] != '\n')
+        done--;
+    }
+    if (done > 0) {
+      rc = luaz_dsgrep_lines(&gs->g, buf, done, &gs->lineno, ds_grep_hit, gs);
+      if (rc != 0)
+        break;
+      memmove(buf, buf + done, len - done);
+      len -= done;
+    }
+    if (eof)
+      break;
+    if (done == 0) {
+      char *x;
+      if (cap > (size_t)-1 / 2) {
+        rc = -1;
+        break;
+      }
+      x = (char *)lua_newuserdatauv(L, cap * 2, 0);
+      memcpy(x, buf, len);
+      lua_replace(L, slot);
+      buf = x;
+      cap *= 2;
+    }
+  }
+  if (gs->raised)
+    return -1; /* keep the string.find error on top */
+  lua_settop(L, slot - 1);
+  if (rc < 0 || (rc == 0 && ds_stream_error(h)))
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Scan a record handle, one record per candidate.
+ *
+ * @param gs Scan state.
+ * @return 0 at EOF or after max hits, or -1 on an error.
+ */
+static int ds_grep_records(struct ds_grep *gs)
+{
+  struct lua_ds_handle *h = gs->h;
+  const char *rec;
+  size_t n;
+
+  while ((rec = ds_read_record(h, &n)) != NULL) {
+    int rc;
+    gs->lineno++;
+    if (luaz_dsgrep_find(&gs->g, rec, n) == NULL)
+      continue;
+    rc = ds_grep_hit(gs, gs->lineno, rec, n);
+    if (rc < 0)
+      return -1;
+    if (rc > 0)
+      return 0;
+  }
+  return (h->rbuf == NULL || ferror(h->fp)) ? -1 : 0;
+}
+
+/**
+ * @brief Lua binding for ds.grep(src, needle [, opts]).
+ *
+ * src is a "DD:ddname" or DSN name as in ds.slurp. needle is a literal,
+ * or a Lua pattern with pattern=true; opts also takes max, ignorecase,
+ * lines=false and the read open options.
+ *
+ * @param L Lua state.
+ * @return 2 (record numbers, lines) or 1 (record numbers, lines=false)
+ *         on success, or 3 on failure (nil, message, code).
+ */
+static int l_ds_grep(lua_State *L)
+{
+  const char *src = luaL_checkstring(L, 1);
+  size_t nlen;
+  const char *needle = luaL_checklstring(L, 2, &nlen);
+  struct ds_open_opts opts;
+  struct ds_grep gs;
+  struct lua_ds_ud *ud;
+  int fold = 0;
+  int want_lines = 1;
+  int rc = 0;
+  char lit[LUAZ_DSGREP_NEEDLE_MAX];
+
+  memset(&gs, 0, sizeof(gs));
+  gs.L = L;
+  if (ds_opts_from_lua(L, 3, &opts) != 0)
+    rc = -1;
+  if (lua_istable(L, 3)) {
+    lua_getfield(L, 3, "pattern");
+    if (lua_toboolean(L, -1))
+      gs.pattern = 2;
+    lua_pop(L, 1);
+    lua_getfield(L, 3, "ignorecase");
+    fold = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, 3, "lines");
+    if (!lua_isnil(L, -1))
+      want_lines = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, 3, "max");
+    if (lua_isinteger(L, -1) && lua_tointeger(L, -1) > 0)
+      gs.max = lua_tointeger(L, -1);
+    else if (!lua_isnil(L, -1))
+      rc = ds_opt_bad(&opts, "max");
+    lua_pop(L, 1);
+  }
+  else if (!lua_isnoneornil(L, 3)) {
+    rc = -1;
+  }
+  /* Patterns run on the raw bytes: no conversion or folding. */
+  if (gs.pattern != 0 && (fold || opts.enc >= 0))
+    rc = ds_opt_bad(&opts, "pattern");
+  if (rc != 0)
+    return ds_push_bad_opt(L, 3, "ds.grep", opts.bad);
+  if (gs.pattern == 0 && nlen > LUAZ_DSGREP_NEEDLE_MAX) {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30006 ds.grep invalid options");
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+
+  if (gs.pattern != 0) {
+    lua_getglobal(L, "string");
+    if (lua_istable(L, -1))
+      lua_getfield(L, -1, "find");
+    else
+      lua_pushnil(L);
+    if (!lua_isfunction(L, -1))
+      return luaL_error(L, "ds.grep pattern=true needs string.find");
+    gs.find = lua_gettop(L);
+    /* Reject a malformed pattern before the open, not only when some
+     * line holds its literal. */
+    lua_pushvalue(L, gs.find);
+    lua_pushliteral(L, "");
+    lua_pushvalue(L, gs.pattern);
+    if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+      const char *why = luaL_tolstring(L, -1, NULL);
+      lua_pushnil(L);
+      lua_pushfstring(L, "LUZ30006 ds.grep invalid pattern %s: %s", needle,
+                      why);
+      lua_pushinteger(L, LUZ_E_DS_OPEN);
+      return 3;
+    }
+    nlen = luaz_dsgrep_literal(needle, nlen, lit, sizeof(lit));
+    needle = lit;
+  }
+  else if (opts.enc >= 0) {
+    /* The needle is internal text; search for its dataset bytes. */
+    struct luaz_codec cv;
+    size_t bad = 0;
+    luaz_codec_init(&cv, opts.internal, opts.enc, -1);
+    luaz_codec_text(&cv, luaz_codec_newline(opts.internal), '\n');
+    if (luaz_codec_push(L, &cv, needle, nlen, &bad) != 0) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "LUZ30058 ds.grep invalid or unmappable character "
+                         "in needle byte=%I",
+                      (LUAI_UACINT)(bad + 1));
+      lua_pushinteger(L, LUZ_E_CODEC);
+      return 3;
+    }
+    needle = lua_tolstring(L, -1, &nlen);
+    if (nlen > LUAZ_DSGREP_NEEDLE_MAX) {
+      lua_pushnil(L);
+      lua_pushstring(L, "LUZ30006 ds.grep invalid options");
+      lua_pushinteger(L, LUZ_E_DS_OPEN);
+      return 3;
+    }
+  }
+  luaz_dsgrep_init(&gs.g, needle, nlen,
+                   !fold ? -1
+                   : (opts.enc >= 0) ? opts.enc
+                   : ('A' == 0xC1) ? LUAZ_CODEC_IBM1047
+                                   : LUAZ_CODEC_LATIN1);
+
+  lua_newtable(L);
+  gs.recs = lua_gettop(L);
+  if (want_lines) {
+    lua_newtable(L);
+    gs.lines = lua_gettop(L);
+  }
+  /* Change note: own the grep handle through a handle userdata.
+   * Problem: storing a hit can raise a memory error, which skipped the
+   * close and left the stream (and a read-ahead thread) behind.
+   * Expected effect: __gc closes the handle on any error path.
+   * Impact: ds.grep; the scan buffer is a userdata as well.
+   */
+  ud = (struct lua_ds_ud *)lua_newuserdatauv(L, sizeof(*ud), 0);
+  ud->h = NULL;
+  luaL_setmetatable(L, g_ds_handle_mt);
+  if (ds_open_named(src, "r", &opts, &ud->h) != 0 || ud->h == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30006 ds.grep open failed name=%s errno=%d errno2=%d",
+                    src, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+  gs.h = ud->h;
+  rc = gs.h->recio ? ds_grep_records(&gs) : ds_grep_stream(&gs);
+  if (rc != 0) {
+    int cv_err = gs.h->cv_err;
+    size_t bad = gs.h->cv_bad;
+    (void)ds_ud_close(ud);
+    if (gs.raised)
+      return lua_error(L);
+    lua_pushnil(L);
+    if (cv_err) {
+      lua_pushfstring(L, "LUZ30058 ds.grep invalid or unmappable character "
+                         "record=%I byte=%I",
+                      (LUAI_UACINT)gs.lineno, (LUAI_UACINT)(bad + 1));
+      lua_pushinteger(L, LUZ_E_CODEC);
+      return 3;
+    }
+    lua_pushfstring(L, "LUZ30007 ds.grep read failed name=%s record=%I "
+                       "errno=%d errno2=%d",
+                    src, (LUAI_UACINT)(gs.lineno + 1), errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
+  (void)ds_ud_close(ud);
+  lua_settop(L, want_lines ? gs.lines : gs.recs);
+  return want_lines ? 2 : 1;
+}
+
+/* Entries of one 256-byte directory block: (256 - 2) / 12. */
+#define DS_DIR_ENTRIES 21
+
+struct ds_dir_item {
+  struct luaz_pdsdir_entry e;
+  unsigned char user[62];
+};
+
+/* ds.members state: the open directory and the matching entries of the
+ * current block. */
+struct ds_dir {
+  const struct luaz_dsmem_ops *ops; /* registered reader, or NULL */
+  void *dir;
+  FILE *fp;
+  int open;
+  int eof;
+  int stats;
+  struct luaz_pdsdir_state st;
+  struct ds_dir_item items[DS_DIR_ENTRIES];
+  int n;
+  int next;
+  char pattern[64];
+};
+
+/**
+ * @brief Keep one directory entry when its name matches the pattern.
+ *
+ * @param ud ds_dir.
+ * @param e Directory entry (user data copied).
+ * @return 0 (continue).
+ */
+static int ds_dir_entry(void *ud, const struct luaz_pdsdir_entry *e)
+{
+  struct ds_dir *d = (struct ds_dir *)ud;
+  struct ds_dir_item *it;
+
+  if (d->n >= DS_DIR_ENTRIES || !luaz_dsmem_match(d->pattern, e->name))
+    return 0;
+  it = &d->items[d->n++];
+  it->e = *e;
+  memcpy(it->user, e->user, e->ulen);
+  it->e.user = it->user;
+  return 0;
+}
+
+/**
+ * @brief Open the directory of a "DD:ddname" or DSN name.
+ *
+ * Without registered hooks the PDS/PDSE is opened without a member as
+ * RECFM=U, which returns its 256-byte directory blocks (each library of
+ * a DD concatenation in order).
+ *
+ * @param d Reader state (pattern and stats already set).
+ * @param name DDNAME (DD: prefix) or DSN.
+ * @return 0 on success, or -1 on failure.
+ */
+static int ds_dir_open(struct ds_dir *d, const char *name)
+{
+  const char *dd = ds_slurp_ddname(name);
+  char path[96];
+
+  d->ops = luaz_dsmem_get_ops();
+  d->dir = NULL;
+  d->fp = NULL;
+  d->eof = 0;
+  d->n = 0;
+  d->next = 0;
+  luaz_pdsdir_init(&d->st);
+  if (d->ops != NULL) {
+    if (d->ops->open(name, &d->dir) != 0)
+      return -1;
+    d->open = 1;
+    return 0;
+  }
+  if (dd != NULL) {
+    char dd_uc[9];
+    if (ddname_copy_upper(dd, dd_uc, sizeof(dd_uc)) != 0)
+      return -1;
+    snprintf(path, sizeof(path), "//DD:%s", dd_uc);
+  }
+  else if (dsn_build_path(name, path, sizeof(path)) != 0) {
+    return -1;
+  }
+  d->fp = fopen(path, "rb,type=record,recfm=u,lrecl=256,blksize=256");
+  if (d->fp == NULL)
+    return -1;
+  d->open = 1;
+  return 0;
+}
+
+/**
+ * @brief Return the next matching entry, reading blocks as needed.
+ *
+ * @param d Open reader.
+ * @param out Entry (valid until the next call).
+ * @return 1 with an entry, 0 at the end of the directory, or -1 on a
+ *         read failure or a malformed block.
+ */
+static int ds_dir_next(struct ds_dir *d, const struct ds_dir_item **out)
+{
+  unsigned char blk[LUAZ_PDSDIR_BLKSIZE];
+
+  while (d->next >= d->n) {
+    unsigned long len = sizeof(blk);
+    if (d->eof)
+      return 0;
+    d->n = 0;
+    d->next = 0;
+    if (d->ops != NULL) {
+      if (d->ops->read(d->dir, blk, &len) != 0)
+        return -1;
+    }
+    else {
+      len = (unsigned long)fread(blk, 1, sizeof(blk), d->fp);
+      if (len == 0 && ferror(d->fp))
+        return -1;
+    }
+    if (len == 0) {
+      d->eof = 1;
+      return 0;
+    }
+    if (luaz_pdsdir_block(&d->st, blk, len, ds_dir_entry, d) < 0)
+      return -1;
+  }
+  *out = &d->items[d->next++];
+  return 1;
+}
+
+/**
+ * @brief Close the directory (once).
+ *
+ * @param d Reader state.
+ */
+static void ds_dir_close(struct ds_dir *d)
+{
+  if (!d->open)
+    return;
+  d->open = 0;
+  if (d->ops != NULL)
+    d->ops->close(d->dir);
+  else if (d->fp != NULL)
+    fclose(d->fp);
+}
+
+/**
+ * @brief Push one member: its name, or with stats a table of the name,
+ *        alias flag, library number and decoded ISPF statistics.
+ *
+ * A name already seen in an earlier library of a concatenation is
+ * skipped, as a member read would find the first one.
+ *
+ * @param L Lua state.
+ * @param d Reader state.
+ * @param it Entry.
+ * @param seen Stack index of the table of names seen.
+ * @return 1 when a value was pushed, or 0 for a skipped duplicate.
+ */
+static int ds_dir_push(lua_State *L, const struct ds_dir *d,
+                       const struct ds_dir_item *it, int seen)
+{
+  struct luaz_dsmem_stats st;
+
+  lua_pushstring(L, it->e.name);
+  if (it->e.concat > 0) {
+    lua_pushvalue(L, -1);
+    if (lua_rawget(L, seen) != LUA_TNIL) {
+      lua_pop(L, 2);
+      return 0;
+    }
+    lua_pop(L, 1);
+  }
+  lua_pushvalue(L, -1);
+  lua_pushboolean(L, 1);
+  lua_rawset(L, seen);
+  if (!d->stats)
+    return 1;
+
+  lua_createtable(L, 0, 12);
+  lua_insert(L, -2);
+  lua_setfield(L, -2, "name");
+  lua_pushboolean(L, it->e.alias);
+  lua_setfield(L, -2, "alias");
+  lua_pushinteger(L, (lua_Integer)it->e.concat + 1);
+  lua_setfield(L, -2, "lib");
+  if (luaz_dsmem_stats(&it->e, &st) == 0) {
+    lua_pushinteger(L, st.version);
+    lua_setfield(L, -2, "version");
+    lua_pushinteger(L, st.mod);
+    lua_setfield(L, -2, "mod");
+    lua_pushstring(L, st.created);
+    lua_setfield(L, -2, "created");
+    lua_pushstring(L, st.changed);
+    lua_setfield(L, -2, "changed");
+    lua_pushinteger(L, (lua_Integer)st.size);
+    lua_setfield(L, -2, "size");
+    lua_pushinteger(L, (lua_Integer)st.init);
+    lua_setfield(L, -2, "init");
+    lua_pushinteger(L, (lua_Integer)st.modified);
+    lua_setfield(L, -2, "modified");
+    lua_pushstring(L, st.user);
+    lua_setfield(L, -2, "user");
+    lua_pushboolean(L, st.sclm);
+    lua_setfield(L, -2, "sclm");
+  }
+  return 1;
+}
+
+/**
+ * @brief Lua iterator for ds.members(name, {iter=true}).
+ *
+ * @param L Lua state.
+ * @return 1 value (name or table) or 0 at the end; raises on error.
+ */
+static int l_ds_members_iter(lua_State *L)
+{
+  struct ds_dir *d = (struct ds_dir *)lua_touserdata(L, lua_upvalueindex(1));
+  const struct ds_dir_item *it;
+  int rc;
+
+  if (d == NULL || !d->open)
+    return 0;
+  while ((rc = ds_dir_next(d, &it)) > 0) {
+    if (ds_dir_push(L, d, it, lua_upvalueindex(2)))
+      return 1;
+  }
+  ds_dir_close(d);
+  if (rc < 0)
+    return luaL_error(L, "LUZ30007 ds.members directory read failed");
+  return 0;
+}
+
+/**
+ * @brief __gc for the ds.members reader state.
+ *
+ * @param L Lua state.
+ * @return 0 (ignored).
+ */
+static int l_ds_members_gc(lua_State *L)
+{
+  struct ds_dir *d = (struct ds_dir *)luaL_checkudata(L, 1, g_ds_members_mt);
+  ds_dir_close(d);
+  return 0;
+}
+
+/**
+ * @brief Lua binding for ds.members(name [, opts]).
+ *
+ * name is a "DD:ddname" or DSN name of a PDS/PDSE as in ds.slurp. opts
+ * takes pattern (ISPF '*' and '%'), stats=true for tables with ISPF
+ * statistics instead of names, and iter=true for an iterator.
+ *
+ * @param L Lua state.
+ * @return 1 (array or iterator) on success, or 3 on failure (nil,
+ *         message, code).
+ */
+static int l_ds_members(lua_State *L)
+{
+  const char *name = luaL_checkstring(L, 1);
+  struct ds_dir local;
+  struct ds_dir *d;
+  const struct ds_dir_item *it;
+  int iter = 0;
+  int rc = 0;
+  lua_Integer n = 0;
+
+  memset(&local, 0, sizeof(local));
+  if (lua_istable(L, 2)) {
+    lua_getfield(L, 2, "pattern");
+    if (lua_type(L, -1) == LUA_TSTRING) {
+      size_t len;
+      const char *pat = lua_tolstring(L, -1, &len);
+      if (len < sizeof(local.pattern))
+        memcpy(local.pattern, pat, len + 1);
+      else
+        rc = -1;
+    }
+    else if (!lua_isnil(L, -1)) {
+      rc = -1;
+    }
+    lua_pop(L, 1);
+    lua_getfield(L, 2, "stats");
+    local.stats = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, 2, "iter");
+    iter = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+  }
+  else if (!lua_isnoneornil(L, 2)) {
+    rc = -1;
+  }
+  if (rc != 0) {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30006 ds.members invalid options");
     lua_pushinteger(L, LUZ_E_DS_OPEN);
     return 3;
   }
 
-  ud = (struct lua_ds_ud *)lua_newuserdatauv(L, sizeof(*ud), 0);
-  ud->h = h;
-  luaL_setmetatable(L, g_ds_handle_mt);
+  /* Change note: read PDS/PDSE directories in C for member lists.
+   * Problem: listing members meant LISTDS ... MEMBERS through tso.cmd and
+   * parsing the captured text line by line.
+   * Expected effect: directory blocks are read with record I/O, parsed
+   * with PDSDIR, and ISPF statistics are decoded from the user data.
+   * Impact: ds.members; IOHOST registers a directory-of-files stand-in.
+   */
+  /* Change note: keep the reader state in a userdata in both modes.
+   * Problem: the array mode held it on the C stack, so a Lua memory error
+   * while building the list leaked the open directory stream.
+   * Expected effect: __gc closes the directory on any error path.
+   * Impact: ds.members array mode; the iterator already worked this way.
+   */
+  d = (struct ds_dir *)lua_newuserdatauv(L, sizeof(*d), 0);
+  *d = local;
+  luaL_setmetatable(L, g_ds_members_mt);
+  if (ds_dir_open(d, name) != 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30006 ds.members open failed name=%s errno=%d "
+                       "errno2=%d",
+                    name, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_OPEN);
+    return 3;
+  }
+  lua_newtable(L); /* names seen */
+  if (iter) {
+    lua_pushcclosure(L, l_ds_members_iter, 2);
+    return 1;
+  }
+
+  lua_newtable(L);
+  while ((rc = ds_dir_next(d, &it)) > 0) {
+    if (ds_dir_push(L, d, it, lua_gettop(L) - 1))
+      lua_rawseti(L, -2, ++n);
+  }
+  ds_dir_close(d);
+  if (rc < 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30007 ds.members directory read failed name=%s "
+                       "errno=%d errno2=%d",
+                    name, errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
   return 1;
 }
 
@@ -1024,14 +3733,9 @@ static int l_ds_handle_readline(lua_State *L)
     return 3;
   }
 
-  rc = ds_readline_stream(L, h->fp);
-  if (rc < 0) {
-    lua_pushnil(L);
-    lua_pushfstring(L, "LUZ30007 ds.read failed errno=%d errno2=%d",
-                    errno, __errno2());
-    lua_pushinteger(L, LUZ_E_DS_READ);
-    return 3;
-  }
+  rc = ds_readline_handle(L, h, 0);
+  if (rc < 0)
+    return ds_read_fail(L, h);
   return (rc == 0) ? 0 : 1;
 }
 
@@ -1051,9 +3755,12 @@ static int l_ds_lines_iter(lua_State *L)
   if (h == NULL || h->mode != 'r')
     return luaL_error(L, "LUZ30007 ds.read invalid handle");
 
-  rc = ds_readline_stream(L, h->fp);
-  if (rc < 0)
-    return luaL_error(L, "LUZ30007 ds.read failed");
+  rc = ds_readline_handle(L, h, 0);
+  if (rc < 0) {
+    ds_read_fail(L, h);
+    lua_pop(L, 1); /* raise the message, not the code */
+    return lua_error(L);
+  }
   return (rc == 0) ? 0 : 1;
 }
 
@@ -1096,9 +3803,9 @@ static int l_ds_handle_writeline(lua_State *L)
    * Expected effect: writeline behaves like file:write(line .. "\\n").
    * Impact: callers get one record per writeline by default.
    */
-  rc = lua_ds_write(h, line, (unsigned long)len);
-  if (rc == 0 && (len == 0 || line[len - 1] != '\n'))
-    rc = lua_ds_write(h, "\n", 1);
+  if (ds_codec_arg(L, h, &line, &len) < 0)
+    return ds_write_codec_fail(L, h, 0);
+  rc = ds_writeline_handle(h, line, len);
   if (rc != 0) {
     lua_pushnil(L);
     lua_pushfstring(L, "LUZ30008 ds.write failed errno=%d errno2=%d",
@@ -1110,6 +3817,282 @@ static int l_ds_handle_writeline(lua_State *L)
   return 1;
 }
 
+/**
+ * @brief Lua method: handle:read(fmt...).
+ *
+ * Formats follow io.read: "a" (rest of the dataset), "l" (line without
+ * newline, default), "L" (line with newline) and a byte count.
+ *
+ * @param L Lua state.
+ * @return One value per format (nil from the first EOF on), or 3 on error.
+ */
+static int l_ds_handle_read(lua_State *L)
+{
+  struct lua_ds_handle *h = ds_ud_check(L, 1);
+  int nargs = lua_gettop(L) - 1;
+  int first = 2;
+  int rc = 1;
+  int n;
+
+  if (h == NULL || h->mode != 'r') {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30007 ds.read invalid handle");
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
+  if (nargs == 0) {
+    lua_pushliteral(L, "l");
+    nargs = 1;
+  }
+  luaL_checkstack(L, nargs + LUA_MINSTACK, "too many arguments");
+
+  /* Change note: io-style read formats on ds handles.
+   * Problem: slurping a dataset took a Lua loop of readline + concat.
+   * Expected effect: read("a") is one C call with one growing buffer.
+   * Impact: handle:read supports "a", "l", "L" and byte counts.
+   */
+  for (n = first; nargs-- > 0 && rc > 0; n++) {
+    if (lua_type(L, n) == LUA_TNUMBER) {
+      lua_Integer count = luaL_checkinteger(L, n);
+      luaL_argcheck(L, count >= 0, n, "invalid count");
+      rc = ds_read_count(L, h, (size_t)count);
+    }
+    else {
+      const char *p = luaL_checkstring(L, n);
+      if (*p == '*')
+        p++;
+      switch (*p) {
+      case 'l':
+        rc = ds_readline_handle(L, h, 0);
+        break;
+      case 'L':
+        rc = ds_readline_handle(L, h, 1);
+        break;
+      case 'a':
+        rc = ds_read_all(L, h);
+        break;
+      default:
+        return luaL_argerror(L, n, "invalid format");
+      }
+    }
+  }
+  if (rc < 0)
+    return ds_read_fail(L, h);
+  if (rc == 0)
+    lua_pushnil(L);
+  return n - first;
+}
+
+/**
+ * @brief Lua method: handle:write(...).
+ *
+ * Writes each string or number argument with no newline and no flush
+ * (record handles: one record per argument).
+ *
+ * @param L Lua state.
+ * @return 1 (the handle) on success, or 3 on failure.
+ */
+static int l_ds_handle_write(lua_State *L)
+{
+  struct lua_ds_handle *h = ds_ud_check(L, 1);
+  int nargs = lua_gettop(L);
+  int arg;
+
+  if (h == NULL || (h->mode != 'w' && h->mode != 'a')) {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30008 ds.write invalid handle");
+    lua_pushinteger(L, LUZ_E_DS_WRITE);
+    return 3;
+  }
+  for (arg = 2; arg <= nargs; arg++) {
+    size_t len = 0;
+    const char *s = luaL_checklstring(L, arg, &len);
+    int pushed = ds_codec_arg(L, h, &s, &len);
+    int rc;
+    if (pushed < 0)
+      return ds_write_codec_fail(L, h, 0);
+    if (h->recio)
+      rc = ds_writeline_handle(h, s, len);
+    else
+      rc = lua_ds_write(h, s, (unsigned long)len);
+    lua_pop(L, pushed);
+    if (rc != 0) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "LUZ30008 ds.write failed errno=%d errno2=%d",
+                      errno, __errno2());
+      lua_pushinteger(L, LUZ_E_DS_WRITE);
+      return 3;
+    }
+  }
+  lua_settop(L, 1);
+  return 1;
+}
+
+/**
+ * @brief Lua method: handle:read_records(n).
+ *
+ * Reads up to n records (lines on stream handles) into one table
+ * preallocated for the batch. A failure after some records keeps them:
+ * the table and count are followed by the message and code.
+ *
+ * @param L Lua state.
+ * @return 2 (table, count), 0 at EOF, 3 on failure, or 4 (table, count,
+ *         message, code) on a failure partway through the batch.
+ */
+static int l_ds_handle_read_records(lua_State *L)
+{
+  struct lua_ds_handle *h = ds_ud_check(L, 1);
+  lua_Integer n = luaL_checkinteger(L, 2);
+  lua_Integer i;
+  int rc = 1;
+
+  if (h == NULL || h->mode != 'r') {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30007 ds.read invalid handle");
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
+  luaL_argcheck(L, n > 0, 2, "record count must be positive");
+
+  /* Change note: read a batch of records per Lua->C transition.
+   * Problem: readline costs one call and one buffer setup per record.
+   * Expected effect: one call and one table per n records.
+   * Impact: handle:read_records; use {type="record"} for exact records.
+   */
+  lua_createtable(L, (n < DS_BATCH_PREALLOC) ? (int)n : DS_BATCH_PREALLOC, 0);
+  for (i = 1; i <= n; i++) {
+    rc = ds_readline_handle(L, h, 0);
+    if (rc <= 0)
+      break;
+    lua_rawseti(L, -2, i);
+  }
+  if (rc < 0 && i == 1)
+    return ds_read_fail(L, h);
+  if (i == 1)
+    return 0;
+  lua_pushinteger(L, i - 1);
+  if (rc < 0) {
+    ds_read_fail(L, h);
+    lua_remove(L, -3); /* the nil of nil, message, code */
+    return 4;
+  }
+  return 2;
+}
+
+/**
+ * @brief Lua method: handle:fields(layout [, tbl]).
+ *
+ * Reads the next record and decodes it with a ds.layout or ds.copybook in
+ * one C pass, without a Lua string for the record itself.
+ *
+ * @param L Lua state.
+ * @return Field values or the filled table, nil at EOF, or 3 on failure.
+ */
+static int l_ds_handle_fields(lua_State *L)
+{
+  struct lua_ds_handle *h = ds_ud_check(L, 1);
+  const char *rec = NULL;
+  size_t len = 0;
+  int tidx = 0;
+  int copy;
+  int top;
+  int rc;
+  int n;
+
+  copy = luaz_dscopy_test(L, 2);
+  if (!copy)
+    luaz_dsrec_check(L, 2);
+  if (!lua_isnoneornil(L, 3)) {
+    luaL_checktype(L, 3, LUA_TTABLE);
+    tidx = 3;
+  }
+  if (h == NULL || h->mode != 'r') {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30007 ds.read invalid handle");
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
+  lua_settop(L, 3);
+  top = lua_gettop(L);
+  rc = ds_next_record(L, h, &rec, &len);
+  if (rc < 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "LUZ30007 ds.read failed errno=%d errno2=%d",
+                    errno, __errno2());
+    lua_pushinteger(L, LUZ_E_DS_READ);
+    return 3;
+  }
+  if (rc == 0) {
+    lua_pushnil(L);
+    return 1;
+  }
+  n = copy ? luaz_dscopy_decode(L, 2, rec, len, tidx)
+           : luaz_dsrec_decode(L, 2, rec, len, tidx);
+  if (rc == 2)
+    lua_remove(L, top + 1); /* joined line */
+  return n;
+}
+
+/**
+ * @brief Lua method: handle:write_records(tbl [, i [, j]]).
+ *
+ * Writes tbl[i..j] (default 1..#tbl), one record or line per element.
+ *
+ * @param L Lua state.
+ * @return 1 (records written), or 3 on failure.
+ */
+static int l_ds_handle_write_records(lua_State *L)
+{
+  struct lua_ds_handle *h = ds_ud_check(L, 1);
+  lua_Integer i;
+  lua_Integer j;
+  lua_Integer k;
+
+  luaL_checktype(L, 2, LUA_TTABLE);
+  i = luaL_optinteger(L, 3, 1);
+  j = luaL_opt(L, luaL_checkinteger, 4, luaL_len(L, 2));
+  if (h == NULL || (h->mode != 'w' && h->mode != 'a')) {
+    lua_pushnil(L);
+    lua_pushstring(L, "LUZ30008 ds.write invalid handle");
+    lua_pushinteger(L, LUZ_E_DS_WRITE);
+    return 3;
+  }
+  if (j < i) {
+    lua_pushinteger(L, 0);
+    return 1;
+  }
+  /* Stop on k == j: k + 1 would overflow when j is LUA_MAXINTEGER. */
+  for (k = i;; k++) {
+    size_t len = 0;
+    const char *rec;
+    int pushed;
+    lua_rawgeti(L, 2, k);
+    rec = lua_tolstring(L, -1, &len);
+    if (rec == NULL) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "LUZ30008 ds.write record %I is not a string",
+                      (LUAI_UACINT)k);
+      lua_pushinteger(L, LUZ_E_DS_WRITE);
+      return 3;
+    }
+    pushed = ds_codec_arg(L, h, &rec, &len);
+    if (pushed < 0)
+      return ds_write_codec_fail(L, h, k);
+    if (ds_writeline_handle(h, rec, len) != 0) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "LUZ30008 ds.write failed record=%I errno=%d errno2=%d",
+                      (LUAI_UACINT)k, errno, __errno2());
+      lua_pushinteger(L, LUZ_E_DS_WRITE);
+      return 3;
+    }
+    lua_pop(L, 1 + pushed);
+    if (k == j)
+      break;
+  }
+  lua_pushinteger(L, j - i + 1);
+  return 1;
+}
+
 /**
  * @brief Lua method: handle:close().
  *
@@ -1250,6 +4233,26 @@ static int l_ds_tmpname(lua_State *L)
   return 1;
 }
 
+/**
+ * @brief Lua binding for ds.openstats([reset]).
+ *
+ * @param L Lua state.
+ * @return 1 (table of open-form cache counters).
+ */
+static int l_ds_openstats(lua_State *L)
+{
+  int i;
+
+  lua_createtable(L, 0, DS_OSTAT_COUNT);
+  for (i = 0; i < DS_OSTAT_COUNT; i++) {
+    lua_pushinteger(L, (lua_Integer)g_ds_ostats[i]);
+    lua_setfield(L, -2, g_ds_ostat_names[i]);
+  }
+  if (lua_toboolean(L, 1))
+    memset(g_ds_ostats, 0, sizeof(g_ds_ostats));
+  return 1;
+}
+
 /**
  * @brief Lua module entrypoint for ds.
  *
@@ -1261,17 +4264,33 @@ int luaopen_ds(lua_State *L)
   luaL_Reg ds_funcs[] = {
       {"open_dd", l_ds_open_dd},
       {"open_dsn", l_ds_open_dsn},
+      {"slurp", l_ds_slurp},
+      {"copy", l_ds_copy},
+      {"sort", l_ds_sort},
+      {"grep", l_ds_grep},
+      {"members", l_ds_members},
+      {"layout", luaz_dsrec_l_layout},
+      {"copybook", luaz_dscopy_l_copybook},
+      {"decimal", luaz_dsdec_l_decimal},
+      {"unpack_decimal", luaz_dsdec_l_unpack},
+      {"decimal_sum", luaz_dsdec_l_sum},
       {"member", l_ds_member},
       {"info", l_ds_info},
       {"remove", l_ds_remove},
       {"rename", l_ds_rename},
       {"tmpname", l_ds_tmpname},
+      {"openstats", l_ds_openstats},
       {NULL, NULL},
   };
   luaL_Reg ds_handle_funcs[] = {
       {"readline", l_ds_handle_readline},
       {"lines", l_ds_handle_lines},
       {"writeline", l_ds_handle_writeline},
+      {"read", l_ds_handle_read},
+      {"write", l_ds_handle_write},
+      {"read_records", l_ds_handle_read_records},
+      {"write_records", l_ds_handle_write_records},
+      {"fields", l_ds_handle_fields},
       {"close", l_ds_handle_close},
       {"__gc", l_ds_handle_gc},
       {NULL, NULL},
@@ -1283,6 +4302,15 @@ int luaopen_ds(lua_State *L)
   luaL_setfuncs(L, ds_handle_funcs, 0);
   lua_pop(L, 1);
 
+  luaL_newmetatable(L, g_ds_members_mt);
+  lua_pushcfunction(L, l_ds_members_gc);
+  lua_setfield(L, -2, "__gc");
+  lua_pop(L, 1);
+
+  luaz_dsrec_open(L);
+  luaz_dscopy_open(L);
+  luaz_dsdec_open(L);
+
   luaL_newlib(L, ds_funcs);
   return 1;
 }
@@ -0,0 +1,1050 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO COBOL copybook parser and record decoder (ds.copybook).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | dscopy_node | struct | One data item of the plan |
+ * | dscopy_plan | struct | Copybook userdata body |
+ * | dscopy_tok | struct | Token (pointer, length) |
+ * | dscopy_lex | struct | Tokenizer state over cleaned source |
+ * | dscopy_pic | struct | Parsed PICTURE string |
+ * | dscopy_clean | function | Strip sequence areas and comments |
+ * | dscopy_next | function | Read the next token |
+ * | dscopy_kw | function | Case-insensitive keyword match |
+ * | dscopy_is_clause | function | Test for a clause keyword |
+ * | dscopy_usage | function | Map a USAGE word |
+ * | dscopy_parse_pic | function | Parse a PICTURE string |
+ * | dscopy_name_eq | function | Compare data names (case, '-'/'_') |
+ * | dscopy_push_name | function | Push a data name in the selected style |
+ * | dscopy_elem | function | Size and type an elementary item |
+ * | dscopy_entry | function | Compile one data description entry |
+ * | dscopy_layout | function | Compute offsets and sizes of a subtree |
+ * | dscopy_subtable | function | Reuse or create a nested table |
+ * | dscopy_decode_group | function | Decode the children of a group |
+ * | dscopy_check | function | Check a copybook argument |
+ * | l_dscopy_decode | function | Lua copybook:decode(record [, tbl]) |
+ * | l_dscopy_reclen | function | Lua copybook:reclen() / #copybook |
+ * | dscopy_list | function | Append plan entries for a subtree |
+ * | l_dscopy_fields | function | Lua copybook:fields() (plan listing) |
+ * | luaz_dscopy_test | function | Test whether a stack slot is a copybook |
+ * | luaz_dscopy_decode | function | Decode one record with a copybook plan |
+ * | luaz_dscopy_l_copybook | function | Lua ds.copybook(text [, opts]) |
+ * | luaz_dscopy_open | function | Register the copybook metatable |
+ *
+ * Supported subset: levels 01-49 and 77 (66 and 88 are skipped), PIC
+ * X/A/9/S/V with repeat counts (edited pictures decode as text), USAGE
+ * DISPLAY, COMP/COMP-4/COMP-5/BINARY and COMP-3/PACKED-DECIMAL (also
+ * inherited from a group), fixed OCCURS, REDEFINES and FILLER. VALUE,
+ * JUSTIFIED, BLANK WHEN ZERO, INDEXED BY and KEY IS are accepted and
+ * ignored. SIGN, SYNCHRONIZED, OCCURS DEPENDING ON, COMP-1/COMP-2 and
+ * PIC P are rejected, because they change offsets or values in ways the
+ * plan does not model.
+ *
+ * Platform Requirements:
+ * - Source text uses the native character set; record bytes are decoded
+ *   by DSREC and need no translation for numeric items.
+ */
+#include "DSCOPY"
+#include "DSREC"
+
+#include "LAUXLIB"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DSCOPY_LEVELS 50
+#define DSCOPY_TOKS 128
+#define DSCOPY_EXTENT_MAX 16777216ul
+
+#define DSCOPY_U_NONE 0
+#define DSCOPY_U_DISPLAY 1
+#define DSCOPY_U_BINARY 2
+#define DSCOPY_U_PACKED 3
+#define DSCOPY_U_BAD (-1)
+
+struct dscopy_node {
+  int name;
+  int level;
+  int end;
+  int group;
+  int occurs;
+  int redef;
+  int usage;
+  int haspic;
+  size_t off;
+  size_t size;
+  struct luaz_dsrec_field f;
+};
+
+struct dscopy_plan {
+  int nnodes;
+  int root;
+  size_t reclen;
+  struct dscopy_node node[1];
+};
+
+struct dscopy_tok {
+  const char *p;
+  size_t n;
+};
+
+struct dscopy_lex {
+  const char *p;
+  const char *end;
+  int period;
+};
+
+struct dscopy_pic {
+  int alnum;
+  int digits;
+  int scale;
+  int sign;
+  size_t len;
+};
+
+/**
+ * @brief Copy source text without sequence areas and comments.
+ *
+ * Fixed format keeps columns 8-72 and drops lines with '*' or '/' in
+ * column 7; free format keeps whole lines. "*>" starts a comment in both.
+ *
+ * @param L Lua state (the cleaned text is pushed).
+ * @param s Source text.
+ * @param n Source length.
+ * @param fixed Nonzero for fixed format.
+ */
+static void dscopy_clean(lua_State *L, const char *s, size_t n, int fixed)
+{
+  luaL_Buffer b;
+  const char *end = s + n;
+
+  luaL_buffinit(L, &b);
+  while (s < end) {
+    const char *eol = (const char *)memchr(s, '\n', (size_t)(end - s));
+    const char *lend = (eol != NULL) ? eol : end;
+    const char *p = s;
+    const char *q;
+
+    if (lend > p && lend[-1] == '\r')
+      lend--;
+    if (fixed) {
+      if (lend - p <= 6 || p[6] == '*' || p[6] == '/') {
+        p = lend;
+      }
+      else {
+        p += 7;
+        if (lend - p > 65)
+          lend = p + 65;
+      }
+    }
+    for (q = p; q + 1 < lend; q++) {
+      if (q[0] == '*' && q[1] == '>') {
+        lend = q;
+        break;
+      }
+    }
+    luaL_addlstring(&b, p, (size_t)(lend - p));
+    luaL_addchar(&b, ' ');
+    s = (eol != NULL) ? eol + 1 : end;
+  }
+  luaL_pushresult(&b);
+}
+
+/**
+ * @brief Read the next token.
+ *
+ * Separators are blanks, commas and semicolons; quoted literals are one
+ * token. A period followed by a blank (or the end) ends the entry and sets
+ * lx->period.
+ *
+ * @param lx Tokenizer state.
+ * @param t Output token (length 0 for a lone period).
+ * @return 1 when a token or period was read, 0 at the end of the text.
+ */
+static int dscopy_next(struct dscopy_lex *lx, struct dscopy_tok *t)
+{
+  const char *p = lx->p;
+
+  lx->period = 0;
+  while (p < lx->end &&
+         (isspace((unsigned char)*p) || *p == ',' || *p == ';'))
+    p++;
+  if (p >= lx->end) {
+    lx->p = p;
+    return 0;
+  }
+  t->p = p;
+  if (*p == '\'' || *p == '"') {
+    char q = *p++;
+    while (p < lx->end) {
+      if (*p == q && (p + 1 >= lx->end || p[1] != q)) {
+        p++;
+        break;
+      }
+      p += (*p == q) ? 2 : 1;
+    }
+  }
+  else {
+    while (p < lx->end && !isspace((unsigned char)*p) && *p != ',' &&
+           *p != ';')
+      p++;
+  }
+  t->n = (size_t)(p - t->p);
+  if (t->n > 0 && t->p[t->n - 1] == '.' &&
+      (p >= lx->end || isspace((unsigned char)*p))) {
+    t->n--;
+    lx->period = 1;
+  }
+  lx->p = p;
+  return 1;
+}
+
+/**
+ * @brief Case-insensitive keyword match.
+ *
+ * @param t Token.
+ * @param kw Upper-case keyword.
+ * @return Nonzero when the token is the keyword.
+ */
+static int dscopy_kw(const struct dscopy_tok *t, const char *kw)
+{
+  size_t i;
+
+  for (i = 0; i < t->n; i++) {
+    if (kw[i] == '\0' || toupper((unsigned char)t->p[i]) != kw[i])
+      return 0;
+  }
+  return kw[i] == '\0';
+}
+
+/**
+ * @brief Map a USAGE word.
+ *
+ * @param t Token.
+ * @return DSCOPY_U_* value, DSCOPY_U_NONE when t is not a usage word, or
+ *         DSCOPY_U_BAD for an unsupported usage.
+ */
+static int dscopy_usage(const struct dscopy_tok *t)
+{
+  static const char *const binary[] = {
+      "COMP", "COMP-4", "COMP-5", "BINARY", "COMPUTATIONAL",
+      "COMPUTATIONAL-4", "COMPUTATIONAL-5", NULL};
+  static const char *const packed[] = {"COMP-3", "COMPUTATIONAL-3",
+                                       "PACKED-DECIMAL", NULL};
+  static const char *const bad[] = {
+      "COMP-1", "COMP-2", "COMPUTATIONAL-1", "COMPUTATIONAL-2", "NATIONAL",
+      "INDEX", "POINTER", "DISPLAY-1", NULL};
+  int i;
+
+  if (dscopy_kw(t, "DISPLAY"))
+    return DSCOPY_U_DISPLAY;
+  for (i = 0; binary[i] != NULL; i++) {
+    if (dscopy_kw(t, binary[i]))
+      return DSCOPY_U_BINARY;
+  }
+  for (i = 0; packed[i] != NULL; i++) {
+    if (dscopy_kw(t, packed[i]))
+      return DSCOPY_U_PACKED;
+  }
+  for (i = 0; bad[i] != NULL; i++) {
+    if (dscopy_kw(t, bad[i]))
+      return DSCOPY_U_BAD;
+  }
+  return DSCOPY_U_NONE;
+}
+
+/**
+ * @brief Test for a word that starts a clause (so it is not a data name).
+ *
+ * @param t Token.
+ * @return Nonzero for a clause keyword or usage word.
+ */
+static int dscopy_is_clause(const struct dscopy_tok *t)
+{
+  static const char *const kws[] = {
+      "PIC", "PICTURE", "USAGE", "OCCURS", "REDEFINES", "VALUE", "VALUES",
+      "SIGN", "SYNC", "SYNCHRONIZED", "JUST", "JUSTIFIED", "BLANK",
+      "INDEXED", "ASCENDING", "DESCENDING", "GLOBAL", "EXTERNAL", NULL};
+  int i;
+
+  for (i = 0; kws[i] != NULL; i++) {
+    if (dscopy_kw(t, kws[i]))
+      return 1;
+  }
+  return dscopy_usage(t) != DSCOPY_U_NONE;
+}
+
+/**
+ * @brief Parse a PICTURE string.
+ *
+ * @param t PICTURE token.
+ * @param pic Output.
+ * @return 0 on success, or -1 for an unsupported or malformed picture.
+ */
+static int dscopy_parse_pic(const struct dscopy_tok *t, struct dscopy_pic *pic)
+{
+  size_t i = 0;
+  int after_v = 0;
+  size_t edited = 0;
+
+  memset(pic, 0, sizeof(*pic));
+  while (i < t->n) {
+    int c = toupper((unsigned char)t->p[i++]);
+    size_t count = 1;
+
+    if (i < t->n && t->p[i] == '(') {
+      count = 0;
+      i++;
+      while (i < t->n && isdigit((unsigned char)t->p[i])) {
+        count = count * 10 + (size_t)(t->p[i] - '0');
+        if (count > DSCOPY_EXTENT_MAX)
+          return -1;
+        i++;
+      }
+      if (i >= t->n || t->p[i] != ')' || count == 0)
+        return -1;
+      i++;
+    }
+    switch (c) {
+    case 'S':
+      if (pic->sign || pic->digits > 0 || count != 1)
+        return -1;
+      pic->sign = 1;
+      break;
+    case 'V':
+      if (after_v || count != 1)
+        return -1;
+      after_v = 1;
+      break;
+    case '9':
+      pic->digits += (int)count;
+      if (after_v)
+        pic->scale += (int)count;
+      break;
+    case 'X':
+    case 'A':
+      pic->alnum = 1;
+      edited += count;
+      break;
+    case 'P':
+      return -1;
+    default:
+      edited += count;
+      break;
+    }
+  }
+  if (edited > 0) {
+    /* Alphanumeric or numeric-edited: text of one byte per symbol. */
+    if (pic->sign)
+      return -1;
+    pic->alnum = 1;
+    pic->len = edited + (size_t)pic->digits;
+    return 0;
+  }
+  if (pic->digits == 0)
+    return -1;
+  pic->len = (size_t)pic->digits;
+  return 0;
+}
+
+/**
+ * @brief Compare two data names ignoring case and '-' versus '_'.
+ *
+ * @param a First name.
+ * @param an First length.
+ * @param b Second name.
+ * @param bn Second length.
+ * @return Nonzero when equal.
+ */
+static int dscopy_name_eq(const char *a, size_t an, const char *b, size_t bn)
+{
+  size_t i;
+
+  if (an != bn)
+    return 0;
+  for (i = 0; i < an; i++) {
+    int x = toupper((unsigned char)a[i]);
+    int y = toupper((unsigned char)b[i]);
+    if (x == '_')
+      x = '-';
+    if (y == '_')
+      y = '-';
+    if (x != y)
+      return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Push a data name, as written or in Lua style.
+ *
+ * @param L Lua state.
+ * @param t Name token.
+ * @param lua_style Nonzero for lower case with '_' for '-'.
+ */
+static void dscopy_push_name(lua_State *L, const struct dscopy_tok *t,
+                             int lua_style)
+{
+  luaL_Buffer b;
+  size_t i;
+
+  if (!lua_style) {
+    lua_pushlstring(L, t->p, t->n);
+    return;
+  }
+  luaL_buffinit(L, &b);
+  for (i = 0; i < t->n; i++) {
+    int c = (unsigned char)t->p[i];
+    luaL_addchar(&b, (char)(c == '-' ? '_' : tolower(c)));
+  }
+  luaL_pushresult(&b);
+}
+
+/**
+ * @brief Size and type an elementary item from its picture and usage.
+ *
+ * @param L Lua state (errors are raised).
+ * @param nd Item.
+ * @param pic Parsed picture.
+ * @param trim Nonzero to trim trailing blanks of text items.
+ * @param entry Entry number (for messages).
+ */
+static void dscopy_elem(lua_State *L, struct dscopy_node *nd,
+                        const struct dscopy_pic *pic, int trim, int entry)
+{
+  struct luaz_dsrec_field *f = &nd->f;
+
+  f->scale = pic->scale;
+  f->sign = pic->sign;
+  if (pic->alnum) {
+    if (nd->usage != DSCOPY_U_NONE && nd->usage != DSCOPY_U_DISPLAY)
+      luaL_error(L, "ds.copybook entry %d: text PIC with a numeric USAGE",
+                 entry);
+    f->type = LUAZ_DSREC_STRING;
+    f->trim = trim;
+    f->len = pic->len;
+  }
+  else if (nd->usage == DSCOPY_U_PACKED) {
+    f->type = LUAZ_DSREC_PACKED;
+    f->len = (size_t)pic->digits / 2 + 1;
+  }
+  else if (nd->usage == DSCOPY_U_BINARY) {
+    f->type = LUAZ_DSREC_BINARY;
+    f->len = (pic->digits <= 4) ? 2 : (pic->digits <= 9) ? 4 : 8;
+    if (pic->digits > 18)
+      f->len = 0;
+  }
+  else {
+    f->type = LUAZ_DSREC_ZONED;
+    f->len = (size_t)pic->digits;
+  }
+  if (f->len == 0 ||
+      (f->type == LUAZ_DSREC_PACKED && f->len > LUAZ_DSREC_PACKED_MAX) ||
+      (f->type == LUAZ_DSREC_ZONED && f->len > LUAZ_DSREC_ZONED_MAX))
+    luaL_error(L, "ds.copybook entry %d: too many digits", entry);
+  nd->size = f->len;
+}
+
+/**
+ * @brief Compile one data description entry.
+ *
+ * @param L Lua state (errors are raised).
+ * @param cb Plan being built.
+ * @param t Entry tokens (without the period).
+ * @param nt Token count.
+ * @param names Absolute index of the name table.
+ * @param stk Open item stack (node indexes).
+ * @param depth In/out: stack depth.
+ * @param opt_trim Nonzero to trim text items.
+ * @param opt_lua Nonzero for Lua-style names.
+ * @param entry Entry number (for messages).
+ */
+static void dscopy_entry(lua_State *L, struct dscopy_plan *cb,
+                         const struct dscopy_tok *t, int nt, int names,
+                         int *stk, int *depth, int opt_trim, int opt_lua,
+                         int entry)
+{
+  struct dscopy_node *nd;
+  struct dscopy_pic pic;
+  const struct dscopy_tok *redef = NULL;
+  int level = 0;
+  int parent = -1;
+  int k;
+  int i = 1;
+  size_t j;
+
+  for (j = 0; j < t[0].n; j++) {
+    if (!isdigit((unsigned char)t[0].p[j]) || level > 99)
+      luaL_error(L, "ds.copybook entry %d: level number expected", entry);
+    level = level * 10 + (t[0].p[j] - '0');
+  }
+  if (t[0].n == 0)
+    luaL_error(L, "ds.copybook entry %d: level number expected", entry);
+  if (level == 66 || level == 88)
+    return;
+  if (level == 77)
+    level = 1;
+  if (level < 1 || level > 49)
+    luaL_error(L, "ds.copybook entry %d: unsupported level %d", entry, level);
+
+  while (*depth > 0 && (level == 1 || cb->node[stk[*depth - 1]].level >= level)) {
+    (*depth)--;
+    cb->node[stk[*depth]].end = cb->nnodes;
+  }
+  if (level > 1) {
+    if (*depth == 0)
+      luaL_error(L, "ds.copybook entry %d: level %d outside a record", entry,
+                 level);
+    parent = stk[*depth - 1];
+    if (cb->node[parent].haspic)
+      luaL_error(L, "ds.copybook entry %d: parent item has a PIC", entry);
+    cb->node[parent].group = 1;
+  }
+
+  k = cb->nnodes++;
+  nd = &cb->node[k];
+  memset(nd, 0, sizeof(*nd));
+  nd->level = level;
+  nd->occurs = 1;
+  nd->redef = -1;
+  nd->end = k + 1;
+  nd->usage = (parent >= 0) ? cb->node[parent].usage : DSCOPY_U_NONE;
+  if (nt > 1 && !dscopy_is_clause(&t[1])) {
+    if (!dscopy_kw(&t[1], "FILLER")) {
+      dscopy_push_name(L, &t[1], opt_lua);
+      nd->name = (int)lua_rawlen(L, names) + 1;
+      lua_rawseti(L, names, nd->name);
+    }
+    i = 2;
+  }
+
+  memset(&pic, 0, sizeof(pic));
+  while (i < nt) {
+    const struct dscopy_tok *w = &t[i++];
+    int u = dscopy_usage(w);
+
+    if (dscopy_kw(w, "PIC") || dscopy_kw(w, "PICTURE")) {
+      if (i < nt && dscopy_kw(&t[i], "IS"))
+        i++;
+      if (i >= nt || dscopy_parse_pic(&t[i], &pic) != 0)
+        luaL_error(L, "ds.copybook entry %d: unsupported PIC", entry);
+      nd->haspic = 1;
+      i++;
+    }
+    else if (dscopy_kw(w, "USAGE")) {
+      if (i < nt && dscopy_kw(&t[i], "IS"))
+        i++;
+      u = (i < nt) ? dscopy_usage(&t[i]) : DSCOPY_U_NONE;
+      if (u <= DSCOPY_U_NONE)
+        luaL_error(L, "ds.copybook entry %d: unsupported USAGE", entry);
+      nd->usage = u;
+      i++;
+    }
+    else if (u == DSCOPY_U_BAD) {
+      luaL_error(L, "ds.copybook entry %d: unsupported USAGE %s", entry,
+                 lua_pushlstring(L, w->p, w->n));
+    }
+    else if (u != DSCOPY_U_NONE) {
+      nd->usage = u;
+    }
+    else if (dscopy_kw(w, "OCCURS")) {
+      long n = 0;
+      if (i >= nt)
+        luaL_error(L, "ds.copybook entry %d: OCCURS count expected", entry);
+      for (j = 0; j < t[i].n; j++) {
+        if (!isdigit((unsigned char)t[i].p[j]) || n > 99999)
+          luaL_error(L, "ds.copybook entry %d: OCCURS count expected", entry);
+        n = n * 10 + (t[i].p[j] - '0');
+      }
+      if (n < 1)
+        luaL_error(L, "ds.copybook entry %d: OCCURS count expected", entry);
+      nd->occurs = (int)n;
+      i++;
+      if (i < nt && dscopy_kw(&t[i], "TIMES"))
+        i++;
+      if (i < nt && (dscopy_kw(&t[i], "TO") || dscopy_kw(&t[i], "DEPENDING")))
+        luaL_error(L, "ds.copybook entry %d: OCCURS DEPENDING ON is not "
+                      "supported", entry);
+    }
+    else if (dscopy_kw(w, "REDEFINES")) {
+      if (i >= nt)
+        luaL_error(L, "ds.copybook entry %d: REDEFINES name expected", entry);
+      redef = &t[i++];
+    }
+    else if (dscopy_kw(w, "VALUE") || dscopy_kw(w, "VALUES")) {
+      if (i < nt && (dscopy_kw(&t[i], "IS") || dscopy_kw(&t[i], "ARE")))
+        i++;
+      if (i < nt && dscopy_kw(&t[i], "ALL"))
+        i++;
+      i++;
+    }
+    else if (dscopy_kw(w, "JUST") || dscopy_kw(w, "JUSTIFIED")) {
+      if (i < nt && dscopy_kw(&t[i], "RIGHT"))
+        i++;
+    }
+    else if (dscopy_kw(w, "BLANK")) {
+      if (i < nt && dscopy_kw(&t[i], "WHEN"))
+        i++;
+      i++;
+    }
+    else if (dscopy_kw(w, "GLOBAL") || dscopy_kw(w, "EXTERNAL")) {
+      continue;
+    }
+    else if (dscopy_kw(w, "INDEXED") || dscopy_kw(w, "ASCENDING") ||
+             dscopy_kw(w, "DESCENDING")) {
+      /* Index and key names carry no storage. */
+      while (i < nt && !dscopy_is_clause(&t[i]))
+        i++;
+    }
+    else {
+      luaL_error(L, "ds.copybook entry %d: unsupported clause %s", entry,
+                 lua_pushlstring(L, w->p, w->n));
+    }
+  }
+
+  if (redef != NULL && parent >= 0) {
+    int c = parent + 1;
+    while (c < k) {
+      if (cb->node[c].name > 0) {
+        size_t n = 0;
+        const char *s;
+        lua_rawgeti(L, names, cb->node[c].name);
+        s = lua_tolstring(L, -1, &n);
+        lua_pop(L, 1);
+        if (dscopy_name_eq(s, n, redef->p, redef->n))
+          nd->redef = c;
+      }
+      c = cb->node[c].end;
+    }
+    if (nd->redef < 0)
+      luaL_error(L, "ds.copybook entry %d: REDEFINES target not found", entry);
+    while (cb->node[nd->redef].redef >= 0)
+      nd->redef = cb->node[nd->redef].redef;
+  }
+  if (nd->haspic)
+    dscopy_elem(L, nd, &pic, opt_trim, entry);
+  stk[(*depth)++] = k;
+}
+
+/**
+ * @brief Compute offsets (relative to the parent element) and sizes.
+ *
+ * @param L Lua state (errors are raised).
+ * @param cb Plan.
+ * @param n Item index.
+ */
+static void dscopy_layout(lua_State *L, struct dscopy_plan *cb, int n)
+{
+  struct dscopy_node *nd = &cb->node[n];
+  size_t cursor = 0;
+  size_t extent = 0;
+  int c;
+
+  if (!nd->group) {
+    if (!nd->haspic)
+      luaL_error(L, "ds.copybook: elementary item without PIC");
+    return;
+  }
+  for (c = n + 1; c < nd->end; c = cb->node[c].end) {
+    struct dscopy_node *ch = &cb->node[c];
+    size_t ext;
+    dscopy_layout(L, cb, c);
+    ch->off = (ch->redef >= 0) ? cb->node[ch->redef].off : cursor;
+    /* Test before multiplying: with a 32-bit size_t, size x OCCURS 99999
+     * can wrap below the limit. off never exceeds the limit here. */
+    if (ch->size > (DSCOPY_EXTENT_MAX - ch->off) / (size_t)ch->occurs)
+      luaL_error(L, "ds.copybook: record larger than %d bytes",
+                 (int)DSCOPY_EXTENT_MAX);
+    ext = ch->off + ch->size * (size_t)ch->occurs;
+    if (ch->redef < 0)
+      cursor = ext;
+    if (ext > extent)
+      extent = ext;
+  }
+  nd->size = (cursor > extent) ? cursor : extent;
+}
+
+/**
+ * @brief Push the table stored under the key on top of the stack in t,
+ *        creating it when missing.
+ *
+ * @param L Lua state (key on top; replaced by the table).
+ * @param t Absolute index of the parent table.
+ * @param narr Array size hint for a new table.
+ */
+static void dscopy_subtable(lua_State *L, int t, int narr)
+{
+  lua_pushvalue(L, -1);
+  if (lua_rawget(L, t) == LUA_TTABLE) {
+    lua_remove(L, -2);
+    return;
+  }
+  lua_pop(L, 1);
+  lua_createtable(L, narr, narr > 0 ? 0 : 4);
+  lua_pushvalue(L, -2);
+  lua_pushvalue(L, -2);
+  lua_rawset(L, t);
+  lua_remove(L, -2);
+}
+
+/**
+ * @brief Decode the children of a group element into a table.
+ *
+ * @param L Lua state.
+ * @param cb Plan.
+ * @param g Group index (or -1 for a single root item).
+ * @param names Absolute index of the name table.
+ * @param rec Record bytes.
+ * @param len Record length.
+ * @param base Offset of the group element in the record.
+ * @param t Absolute index of the target table.
+ */
+static void dscopy_decode_group(lua_State *L, const struct dscopy_plan *cb,
+                                int g, int names, const char *rec, size_t len,
+                                size_t base, int t)
+{
+  int first = (g >= 0) ? g + 1 : cb->root;
+  int last = (g >= 0) ? cb->node[g].end : cb->root + 1;
+  int c;
+
+  luaL_checkstack(L, 6, "copybook nesting too deep");
+  for (c = first; c < last; c = cb->node[c].end) {
+    const struct dscopy_node *ch = &cb->node[c];
+    size_t at = base + ch->off;
+    int i;
+
+    if (ch->name == 0) {
+      /* FILLER: groups are flattened into the parent, text is skipped. */
+      if (ch->group && ch->occurs == 1)
+        dscopy_decode_group(L, cb, c, names, rec, len, at, t);
+      continue;
+    }
+    lua_rawgeti(L, names, ch->name);
+    if (ch->occurs > 1) {
+      int arr;
+      dscopy_subtable(L, t, ch->occurs);
+      arr = lua_gettop(L);
+      for (i = 0; i < ch->occurs; i++) {
+        size_t el = at + (size_t)i * ch->size;
+        if (ch->group) {
+          lua_pushinteger(L, i + 1);
+          dscopy_subtable(L, arr, 0);
+          dscopy_decode_group(L, cb, c, names, rec, len, el, lua_gettop(L));
+          lua_pop(L, 1);
+        }
+        else {
+          struct luaz_dsrec_field f = ch->f;
+          f.off = el;
+          luaz_dsrec_push_value(L, &f, rec, len);
+          lua_rawseti(L, arr, i + 1);
+        }
+      }
+      lua_pop(L, 1);
+    }
+    else if (ch->group) {
+      dscopy_subtable(L, t, 0);
+      dscopy_decode_group(L, cb, c, names, rec, len, at, lua_gettop(L));
+      lua_pop(L, 1);
+    }
+    else {
+      struct luaz_dsrec_field f = ch->f;
+      f.off = at;
+      luaz_dsrec_push_value(L, &f, rec, len);
+      lua_rawset(L, t);
+    }
+  }
+}
+
+/**
+ * @brief Check that a stack slot holds a copybook.
+ *
+ * @param L Lua state.
+ * @param idx Stack index.
+ * @return Plan (raises a Lua error otherwise).
+ */
+static struct dscopy_plan *dscopy_check(lua_State *L, int idx)
+{
+  return (struct dscopy_plan *)luaL_checkudata(L, idx, LUAZ_DSCOPY_MT);
+}
+
+int luaz_dscopy_test(lua_State *L, int idx)
+{
+  return luaL_testudata(L, idx, LUAZ_DSCOPY_MT) != NULL;
+}
+
+int luaz_dscopy_decode(lua_State *L, int cidx, const char *rec, size_t len,
+                       int tidx)
+{
+  const struct dscopy_plan *cb =
+      (const struct dscopy_plan *)lua_touserdata(L, cidx);
+  const struct dscopy_node *root = &cb->node[cb->root];
+  int names;
+  int t;
+
+  cidx = lua_absindex(L, cidx);
+  if (tidx == 0)
+    lua_createtable(L, 0, 8);
+  else
+    lua_pushvalue(L, tidx);
+  t = lua_gettop(L);
+  lua_getiuservalue(L, cidx, 1);
+  names = lua_gettop(L);
+  if (root->group && root->occurs == 1)
+    dscopy_decode_group(L, cb, cb->root, names, rec, len, 0, t);
+  else
+    dscopy_decode_group(L, cb, -1, names, rec, len, 0, t);
+  lua_pop(L, 1);
+  return 1;
+}
+
+/**
+ * @brief Lua method: copybook:decode(record [, tbl]).
+ *
+ * @param L Lua state.
+ * @return 1 (table).
+ */
+static int l_dscopy_decode(lua_State *L)
+{
+  size_t len = 0;
+  const char *rec;
+
+  dscopy_check(L, 1);
+  rec = luaL_checklstring(L, 2, &len);
+  if (!lua_isnoneornil(L, 3)) {
+    luaL_checktype(L, 3, LUA_TTABLE);
+    return luaz_dscopy_decode(L, 1, rec, len, 3);
+  }
+  return luaz_dscopy_decode(L, 1, rec, len, 0);
+}
+
+/**
+ * @brief Lua method: copybook:reclen() and #copybook.
+ *
+ * @param L Lua state.
+ * @return 1 (record length in bytes).
+ */
+static int l_dscopy_reclen(lua_State *L)
+{
+  lua_pushinteger(L, (lua_Integer)dscopy_check(L, 1)->reclen);
+  return 1;
+}
+
+/**
+ * @brief Append plan entries for an item and its subtree.
+ *
+ * @param L Lua state (result table at out, name table at names).
+ * @param cb Plan.
+ * @param n Item index.
+ * @param base Offset of the enclosing element.
+ * @param names Absolute index of the name table.
+ * @param out Absolute index of the result array.
+ */
+static void dscopy_list(lua_State *L, const struct dscopy_plan *cb, int n,
+                        size_t base, int names, int out)
+{
+  static const char *const types[] = {"string", "number", "zoned", "packed",
+                                      "binary"};
+  const struct dscopy_node *nd = &cb->node[n];
+  size_t off = base + nd->off;
+  int c;
+
+  luaL_checkstack(L, 4, "copybook nesting too deep");
+  lua_createtable(L, 0, 7);
+  lua_pushinteger(L, nd->level);
+  lua_setfield(L, -2, "level");
+  if (nd->name > 0) {
+    lua_rawgeti(L, names, nd->name);
+    lua_setfield(L, -2, "name");
+  }
+  lua_pushinteger(L, (lua_Integer)off + 1);
+  lua_setfield(L, -2, "offset");
+  lua_pushinteger(L, (lua_Integer)nd->size);
+  lua_setfield(L, -2, "size");
+  lua_pushinteger(L, nd->occurs);
+  lua_setfield(L, -2, "occurs");
+  lua_pushstring(L, nd->group ? "group" : types[nd->f.type]);
+  lua_setfield(L, -2, "type");
+  if (!nd->group && nd->f.type != LUAZ_DSREC_STRING) {
+    lua_pushinteger(L, nd->f.scale);
+    lua_setfield(L, -2, "scale");
+  }
+  lua_rawseti(L, out, (lua_Integer)lua_rawlen(L, out) + 1);
+  for (c = n + 1; c < nd->end; c = cb->node[c].end)
+    dscopy_list(L, cb, c, off, names, out);
+}
+
+/**
+ * @brief Lua method: copybook:fields() -> array describing every item.
+ *
+ * Each entry has level, name (absent for FILLER), offset (1-based, first
+ * occurrence), size (one occurrence), occurs and type ("group",
+ * "string", "zoned", "packed" or "binary"), plus scale for numbers.
+ *
+ * @param L Lua state.
+ * @return 1 (table).
+ */
+static int l_dscopy_fields(lua_State *L)
+{
+  struct dscopy_plan *cb = dscopy_check(L, 1);
+
+  lua_settop(L, 1);
+  lua_createtable(L, cb->nnodes, 0);
+  lua_getiuservalue(L, 1, 1);
+  dscopy_list(L, cb, cb->root, 0, 3, 2);
+  lua_pop(L, 1);
+  return 1;
+}
+
+int luaz_dscopy_l_copybook(lua_State *L)
+{
+  size_t n = 0;
+  const char *src = luaL_checklstring(L, 1, &n);
+  const char *record = NULL;
+  struct dscopy_plan *cb;
+  struct dscopy_lex lx;
+  struct dscopy_tok toks[DSCOPY_TOKS];
+  int stk[DSCOPY_LEVELS];
+  int depth = 0;
+  int fixed = 1;
+  int opt_trim = 0;
+  int opt_lua = 0;
+  int opt_dec = 0;
+  int cap = 1;
+  int names;
+  int nt = 0;
+  int entry = 0;
+  int i;
+  size_t len;
+  const char *text;
+
+  if (!lua_isnoneornil(L, 2)) {
+    const char *fmt;
+    const char *style;
+    luaL_checktype(L, 2, LUA_TTABLE);
+    lua_getfield(L, 2, "format");
+    fmt = lua_tostring(L, -1);
+    if (fmt != NULL && strcmp(fmt, "free") == 0)
+      fixed = 0;
+    else if (!lua_isnil(L, -1) && (fmt == NULL || strcmp(fmt, "fixed") != 0))
+      luaL_argerror(L, 2, "format must be \"fixed\" or \"free\"");
+    lua_getfield(L, 2, "names");
+    style = lua_tostring(L, -1);
+    if (style != NULL && strcmp(style, "lua") == 0)
+      opt_lua = 1;
+    else if (!lua_isnil(L, -1) && (style == NULL || strcmp(style, "cobol") != 0))
+      luaL_argerror(L, 2, "names must be \"cobol\" or \"lua\"");
+    lua_getfield(L, 2, "trim");
+    opt_trim = lua_toboolean(L, -1);
+    lua_getfield(L, 2, "decimal");
+    opt_dec = lua_toboolean(L, -1);
+    lua_settop(L, 2);
+    lua_getfield(L, 2, "record");
+    record = lua_tostring(L, 3);
+  }
+  else {
+    lua_settop(L, 2);
+    lua_pushnil(L);
+  }
+
+  /* Change note: compile COBOL copybooks into a C decode plan.
+   * Problem: COBOL data (packed, zoned, binary) needed per-byte Lua code.
+   * Expected effect: one parse, then records decode in C into tables.
+   * Impact: ds.copybook, copybook:decode and handle:fields(copybook).
+   */
+  dscopy_clean(L, src, n, fixed);
+  text = lua_tolstring(L, -1, &len);
+  for (i = 0; i < (int)len; i++) {
+    if (text[i] == '.')
+      cap++;
+  }
+  cb = (struct dscopy_plan *)lua_newuserdatauv(
+      L, offsetof(struct dscopy_plan, node) +
+             (size_t)cap * sizeof(struct dscopy_node), 1);
+  cb->nnodes = 0;
+  cb->root = 0;
+  cb->reclen = 0;
+  luaL_setmetatable(L, LUAZ_DSCOPY_MT);
+  lua_newtable(L);
+  lua_pushvalue(L, -1);
+  lua_setiuservalue(L, -3, 1);
+  names = lua_gettop(L);
+
+  lx.p = text;
+  lx.end = text + len;
+  for (;;) {
+    struct dscopy_tok t;
+    int more = dscopy_next(&lx, &t);
+    if (more && t.n > 0) {
+      if (nt >= DSCOPY_TOKS)
+        luaL_error(L, "ds.copybook entry %d: too many words", entry + 1);
+      toks[nt++] = t;
+    }
+    if ((!more || lx.period) && nt > 0) {
+      entry++;
+      if (cb->nnodes >= cap)
+        luaL_error(L, "ds.copybook entry %d: too many items", entry);
+      dscopy_entry(L, cb, toks, nt, names, stk, &depth, opt_trim, opt_lua,
+                   entry);
+      nt = 0;
+    }
+    if (!more)
+      break;
+  }
+  while (depth > 0) {
+    depth--;
+    cb->node[stk[depth]].end = cb->nnodes;
+  }
+  if (cb->nnodes == 0)
+    luaL_error(L, "ds.copybook: no data items");
+  for (i = 0; opt_dec && i < cb->nnodes; i++) {
+    if (!cb->node[i].group && cb->node[i].f.type != LUAZ_DSREC_STRING)
+      cb->node[i].f.dec = 1;
+  }
+
+  cb->root = -1;
+  for (i = 0; i < cb->nnodes; i = cb->node[i].end) {
+    size_t nlen = 0;
+    const char *s = NULL;
+    if (cb->node[i].name > 0) {
+      lua_rawgeti(L, names, cb->node[i].name);
+      s = lua_tolstring(L, -1, &nlen);
+      lua_pop(L, 1);
+    }
+    if (record == NULL ||
+        (s != NULL && dscopy_name_eq(s, nlen, record, strlen(record)))) {
+      cb->root = i;
+      break;
+    }
+  }
+  if (cb->root < 0)
+    luaL_error(L, "ds.copybook: record %s not found", record);
+  dscopy_layout(L, cb, cb->root);
+  if (cb->node[cb->root].size >
+      DSCOPY_EXTENT_MAX / (size_t)cb->node[cb->root].occurs)
+    luaL_error(L, "ds.copybook: record larger than %d bytes",
+               (int)DSCOPY_EXTENT_MAX);
+  cb->reclen = cb->node[cb->root].size * (size_t)cb->node[cb->root].occurs;
+  lua_pop(L, 1);
+  return 1;
+}
+
+void luaz_dscopy_open(lua_State *L)
+{
+  luaL_Reg funcs[] = {
+      {"decode", l_dscopy_decode},
+      {"reclen", l_dscopy_reclen},
+      {"fields", l_dscopy_fields},
+      {"__len", l_dscopy_reclen},
+      {NULL, NULL},
+  };
+
+  luaL_newmetatable(L, LUAZ_DSCOPY_MT);
+  lua_pushvalue(L, -1);
+  lua_setfield(L, -2, "__index");
+  luaL_setfuncs(L, funcs, 0);
+  lua_pop(L, 1);
+}
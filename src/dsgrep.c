@@ -0,0 +1,352 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO substring scanning of dataset blocks (ds.grep).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | dsgrep_upper | function | Upper-case one ISO-8859-1 byte |
+ * | dsgrep_fold_table | function | Build the fold table of a code page |
+ * | dsgrep_find_fold | function | Horspool search through the fold table |
+ * | dsgrep_set_end | function | Find the end of a pattern set |
+ * | dsgrep_flush | function | End the current literal run of a pattern |
+ * | luaz_dsgrep_init | function | Prepare a literal needle |
+ * | luaz_dsgrep_find | function | Find the needle in a byte range |
+ * | luaz_dsgrep_lines | function | Report the lines of a block that match |
+ * | luaz_dsgrep_literal | function | Longest literal a Lua pattern requires |
+ *
+ * Platform Requirements:
+ * - Lines end with the native '\n' (NL 0x15 under EBCDIC text streams).
+ * - Pattern syntax characters are the native '%', '[', '.' and so on,
+ *   as in the Lua string library.
+ */
+#include "DSGREP"
+#include "CODEC"
+
+#include <ctype.h>
+#include <string.h>
+
+/**
+ * @brief Upper-case one ISO-8859-1 byte (a-z and the accented letters
+ *        0xE0..0xFE except the division sign).
+ *
+ * @param c Byte.
+ * @return Upper-case byte.
+ */
+static unsigned char dsgrep_upper(unsigned char c)
+{
+  if (c >= 0x61 && c <= 0x7A)
+    return (unsigned char)(c - 0x20);
+  if (c >= 0xE0 && c <= 0xFE && c != 0xF7)
+    return (unsigned char)(c - 0x20);
+  return c;
+}
+
+/**
+ * @brief Build the fold table of a code page: every byte maps to the
+ *        upper-case letter of the same code page.
+ *
+ * Single-byte code pages go through ISO-8859-1 with the codec tables;
+ * UTF-8 folds ASCII letters only.
+ *
+ * @param cp Codec id.
+ * @param out Fold table.
+ * @return 0 on success, or -1 for an invalid id.
+ */
+static int dsgrep_fold_table(int cp, unsigned char *out)
+{
+  struct luaz_codec to_l1;
+  struct luaz_codec from_l1;
+  int i;
+
+  if (cp == LUAZ_CODEC_UTF8) {
+    for (i = 0; i < 256; i++)
+      out[i] = (i < 0x80) ? dsgrep_upper((unsigned char)i) : (unsigned char)i;
+    return 0;
+  }
+  if (luaz_codec_init(&to_l1, cp, LUAZ_CODEC_LATIN1, -1) != 0 ||
+      luaz_codec_init(&from_l1, LUAZ_CODEC_LATIN1, cp, -1) != 0)
+    return -1;
+  for (i = 0; i < 256; i++)
+    out[i] = from_l1.map[dsgrep_upper(to_l1.map[i])];
+  return 0;
+}
+
+/**
+ * @brief Horspool search comparing text bytes through the fold table.
+ *
+ * @param g Prepared needle (folded, len >= 1).
+ * @param p Bytes to search.
+ * @param n Length.
+ * @return Start of the match, or NULL.
+ */
+static const char *dsgrep_find_fold(const struct luaz_dsgrep *g,
+                                    const unsigned char *p, size_t n)
+{
+  size_t m = g->len;
+  size_t i = 0;
+
+  while (i + m <= n) {
+    size_t j = m;
+    while (j > 0 && g->ftab[p[i + j - 1]] == g->needle[j - 1])
+      j--;
+    if (j == 0)
+      return (const char *)(p + i);
+    i += g->shift[p[i + m - 1]];
+  }
+  return NULL;
+}
+
+int luaz_dsgrep_init(struct luaz_dsgrep *g, const char *needle, size_t n,
+                     int fold_cp)
+{
+  size_t i;
+
+  if (n > LUAZ_DSGREP_NEEDLE_MAX)
+    return -1;
+  g->len = n;
+  g->fold = (fold_cp >= 0);
+  if (g->fold) {
+    if (dsgrep_fold_table(fold_cp, g->ftab) != 0)
+      return -1;
+  }
+  else {
+    for (i = 0; i < 256; i++)
+      g->ftab[i] = (unsigned char)i;
+  }
+  for (i = 0; i < n; i++)
+    g->needle[i] = g->ftab[(unsigned char)needle[i]];
+
+  /* Shifts are indexed by the raw text byte: every byte that folds to a
+   * needle byte gets that byte's shift. */
+  for (i = 0; i < 256; i++)
+    g->shift[i] = (n > 0) ? n : 1;
+  if (n > 1) {
+    size_t last[256];
+    for (i = 0; i < 256; i++)
+      last[i] = n;
+    for (i = 0; i + 1 < n; i++)
+      last[g->needle[i]] = n - 1 - i;
+    for (i = 0; i < 256; i++)
+      g->shift[i] = last[g->ftab[i]];
+  }
+  return 0;
+}
+
+const char *luaz_dsgrep_find(const struct luaz_dsgrep *g, const char *p,
+                             size_t n)
+{
+  const unsigned char *s = (const unsigned char *)p;
+  size_t m = g->len;
+  size_t i;
+
+  if (m == 0)
+    return p;
+  if (m > n)
+    return NULL;
+  if (g->fold)
+    return dsgrep_find_fold(g, s, n);
+  if (m == 1)
+    return (const char *)memchr(p, g->needle[0], n);
+  /* Horspool: skip on the last byte of the window until it equals the
+   * needle's last byte, then compare the rest. */
+  i = 0;
+  while (i + m <= n) {
+    unsigned char c = s[i + m - 1];
+    while (c != g->needle[m - 1]) {
+      i += g->shift[c];
+      if (i + m > n)
+        return NULL;
+      c = s[i + m - 1];
+    }
+    if (memcmp(s + i, g->needle, m - 1) == 0)
+      return (const char *)(s + i);
+    i += g->shift[c];
+  }
+  return NULL;
+}
+
+int luaz_dsgrep_lines(const struct luaz_dsgrep *g, const char *p, size_t n,
+                      lua_Integer *lineno, luaz_dsgrep_hit_fn hit, void *ud)
+{
+  const char *end = p + n;
+  const char *pos = p;
+
+  /* Change note: search whole blocks, count lines only up to a match.
+   * Problem: lines() plus string.find made a Lua string of every record
+   * even when almost none matched.
+   * Expected effect: the needle is searched across the block; lines
+   * without a match are counted with memchr and never copied.
+   * Impact: ds.grep; only matching lines reach the callback.
+   */
+  while (pos < end) {
+    const char *m = luaz_dsgrep_find(g, pos, (size_t)(end - pos));
+    const char *bol = pos;
+    const char *eol;
+    const char *q;
+    int rc;
+
+    if (m == NULL)
+      break;
+    /* Count the lines skipped before the match; the last newline before
+     * it starts the matching line. */
+    for (q = pos; (q = (const char *)memchr(q, '\n', (size_t)(m - q))) != NULL;
+         q++) {
+      (*lineno)++;
+      bol = q + 1;
+    }
+    eol = (const char *)memchr(m, '\n', (size_t)(end - m));
+    if (eol == NULL)
+      eol = end;
+    if (g->len > 0 && (size_t)(eol - m) < g->len) {
+      /* The match crossed a newline; resume on the next line. */
+      pos = (eol < end) ? eol : end;
+      if (pos < end) {
+        (*lineno)++;
+        pos++;
+      }
+      continue;
+    }
+    (*lineno)++;
+    rc = hit(ud, *lineno, bol, (size_t)(eol - bol));
+    if (rc != 0)
+      return rc;
+    pos = (eol < end) ? eol + 1 : end;
+  }
+  /* Count the rest; a last line without a newline still counts. */
+  while (pos < end) {
+    const char *q = (const char *)memchr(pos, '\n', (size_t)(end - pos));
+    (*lineno)++;
+    if (q == NULL)
+      break;
+    pos = q + 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Return the index after the set that starts at pat[i] ('['),
+ *        with the end rule of the string library's classEnd.
+ *
+ * @param pat Pattern.
+ * @param n Pattern length.
+ * @param i Index of '['.
+ * @return Index after ']', or 0 for a malformed set.
+ */
+static size_t dsgrep_set_end(const char *pat, size_t n, size_t i)
+{
+  size_t j = i + 1;
+
+  if (i >= n || pat[i] != '[')
+    return 0;
+  if (j < n && pat[j] == '^')
+    j++;
+  do {
+    if (j >= n)
+      return 0;
+    if (pat[j++] == '%') {
+      if (j >= n)
+        return 0;
+      j++;
+    }
+  } while (j < n && pat[j] != ']');
+  return (j < n) ? j + 1 : 0;
+}
+
+/**
+ * @brief End the current literal run and keep it when it is the longest.
+ *
+ * @param run Current run.
+ * @param rlen Current run length (reset to 0).
+ * @param out Longest run so far.
+ * @param best Longest run length.
+ */
+static void dsgrep_flush(const char *run, size_t *rlen, char *out,
+                         size_t *best)
+{
+  if (*rlen > *best) {
+    memcpy(out, run, *rlen);
+    *best = *rlen;
+  }
+  *rlen = 0;
+}
+
+size_t luaz_dsgrep_literal(const char *pat, size_t n, char *out, size_t cap)
+{
+  char run[LUAZ_DSGREP_NEEDLE_MAX];
+  size_t rlen = 0;
+  size_t best = 0;
+  size_t i = 0;
+
+  if (cap > sizeof(run))
+    cap = sizeof(run);
+  if (n > 0 && pat[0] == '^')
+    i = 1;
+  while (i < n) {
+    int lit = -1; /* the item's byte, or -1 for a class */
+    char c = pat[i];
+    size_t j;
+
+    if (c == '(' || c == ')') {
+      dsgrep_flush(run, &rlen, out, &best);
+      i++;
+      continue;
+    }
+    if (c == '$' && i + 1 == n)
+      break;
+    if (c == '%') {
+      char d;
+      if (i + 1 >= n)
+        break;
+      d = pat[i + 1];
+      if (d == 'b' || d == 'f') {
+        /* Balance and frontier items match no fixed text. */
+        dsgrep_flush(run, &rlen, out, &best);
+        if (d == 'b') {
+          i += 4;
+        }
+        else {
+          i = dsgrep_set_end(pat, n, i + 2);
+          if (i == 0)
+            break;
+        }
+        continue;
+      }
+      if (!isalnum((unsigned char)d))
+        lit = (unsigned char)d;
+      j = i + 2;
+    }
+    else if (c == '[') {
+      j = dsgrep_set_end(pat, n, i);
+      if (j == 0)
+        break;
+    }
+    else if (c == '.') {
+      j = i + 1;
+    }
+    else {
+      lit = (unsigned char)c;
+      j = i + 1;
+    }
+
+    if (j < n && (pat[j] == '*' || pat[j] == '?' || pat[j] == '-')) {
+      /* Optional item: the run cannot continue across it. */
+      dsgrep_flush(run, &rlen, out, &best);
+      i = j + 1;
+      continue;
+    }
+    if (lit < 0)
+      dsgrep_flush(run, &rlen, out, &best);
+    else if (rlen < cap)
+      run[rlen++] = (char)lit;
+    if (j < n && pat[j] == '+') {
+      /* One occurrence is required; the repeats end the run. */
+      dsgrep_flush(run, &rlen, out, &best);
+      j++;
+    }
+    i = j;
+  }
+  dsgrep_flush(run, &rlen, out, &best);
+  return best;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO PDS/PDSE member enumeration helpers (ds.members).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | dsmem_bcd | function | Decode one packed byte of two digits |
+ * | dsmem_date | function | Decode a packed 0CYYDDDF date |
+ * | luaz_dsmem_set_ops | function | Register a directory block reader |
+ * | luaz_dsmem_get_ops | function | Return the registered reader or NULL |
+ * | luaz_dsmem_stats | function | Decode ISPF statistics from user data |
+ * | luaz_dsmem_match | function | Match a member name against a pattern |
+ *
+ * Platform Requirements:
+ * - Pure byte decoding; no I/O.
+ * - The user id is returned as stored (EBCDIC on z/OS).
+ */
+#include "DSMEM"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+static struct luaz_dsmem_ops g_dsmem_ops;
+static int g_dsmem_ops_set;
+
+/**
+ * @brief Decode one packed byte holding two decimal digits.
+ *
+ * @param b Byte.
+ * @return 0..99, or -1 for a nibble above 9.
+ */
+static int dsmem_bcd(unsigned char b)
+{
+  if ((b >> 4) > 9 || (b & 0x0Fu) > 9)
+    return -1;
+  return (b >> 4) * 10 + (b & 0x0F);
+}
+
+/**
+ * @brief Decode a packed 0CYYDDDF date into YYYY/MM/DD.
+ *
+ * @param p Four date bytes (century, YY, DD, DF).
+ * @param out Output buffer (11 bytes).
+ * @return 0 on success, or -1 for an invalid date.
+ */
+static int dsmem_date(const unsigned char *p, char *out)
+{
+  static const int mdays[12] = {31, 28, 31, 30, 31, 30,
+                                31, 31, 30, 31, 30, 31};
+  int yy = dsmem_bcd(p[1]);
+  int dd = dsmem_bcd(p[2]);
+  int year;
+  int day;
+  int month;
+
+  if (p[0] > 9 || yy < 0 || dd < 0 || (p[3] >> 4) > 9 ||
+      ((p[3] & 0x0Fu) != 0x0Fu && (p[3] & 0x0Fu) != 0x0Cu))
+    return -1;
+  year = 1900 + p[0] * 100 + yy;
+  day = dd * 10 + (p[3] >> 4);
+  for (month = 0; month < 12; month++) {
+    int n = mdays[month];
+    if (month == 1 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+      n++;
+    if (day <= n)
+      break;
+    day -= n;
+  }
+  if (day < 1 || month == 12)
+    return -1;
+  sprintf(out, "%04d/%02d/%02d", year, month + 1, day);
+  return 0;
+}
+
+void luaz_dsmem_set_ops(const struct luaz_dsmem_ops *ops)
+{
+  if (ops == NULL || ops->open == NULL || ops->read == NULL ||
+      ops->close == NULL) {
+    g_dsmem_ops_set = 0;
+    return;
+  }
+  g_dsmem_ops = *ops;
+  g_dsmem_ops_set = 1;
+}
+
+const struct luaz_dsmem_ops *luaz_dsmem_get_ops(void)
+{
+  return g_dsmem_ops_set ? &g_dsmem_ops : NULL;
+}
+
+int luaz_dsmem_stats(const struct luaz_pdsdir_entry *e,
+                     struct luaz_dsmem_stats *st)
+{
+  const unsigned char *u;
+  int ss;
+  int hh;
+  int mm;
+  int i;
+
+  if (e == NULL || st == NULL || e->user == NULL ||
+      e->ulen < LUAZ_DSMEM_ISPF_LEN)
+    return -1;
+  u = e->user;
+  ss = dsmem_bcd(u[3]);
+  hh = dsmem_bcd(u[12]);
+  mm = dsmem_bcd(u[13]);
+  if (ss < 0 || ss > 59 || hh < 0 || hh > 23 || mm < 0 || mm > 59)
+    return -1;
+  if (dsmem_date(u + 4, st->created) != 0 ||
+      dsmem_date(u + 8, st->changed) != 0)
+    return -1;
+  sprintf(st->changed + 10, " %02d:%02d:%02d", hh, mm, ss);
+  st->version = u[0];
+  st->mod = u[1];
+  st->sclm = (u[2] & LUAZ_DSMEM_SCLM) ? 1 : 0;
+  if ((u[2] & LUAZ_DSMEM_EXT) && e->ulen >= LUAZ_DSMEM_ISPF_EXT_LEN) {
+    /* Extended statistics: line counts above 65535 in fullwords. */
+    st->size = ((long)u[28] << 24) | ((long)u[29] << 16) |
+               ((long)u[30] << 8) | (long)u[31];
+    st->init = ((long)u[32] << 24) | ((long)u[33] << 16) |
+               ((long)u[34] << 8) | (long)u[35];
+    st->modified = ((long)u[36] << 24) | ((long)u[37] << 16) |
+                   ((long)u[38] << 8) | (long)u[39];
+  }
+  else {
+    st->size = ((long)u[14] << 8) | (long)u[15];
+    st->init = ((long)u[16] << 8) | (long)u[17];
+    st->modified = ((long)u[18] << 8) | (long)u[19];
+  }
+  memcpy(st->user, u + 20, 8);
+  st->user[8] = '\0';
+  for (i = 7; i >= 0 && (st->user[i] == ' ' || st->user[i] == '\0'); i--)
+    st->user[i] = '\0';
+  return 0;
+}
+
+int luaz_dsmem_match(const char *pattern, const char *name)
+{
+  const char *star = NULL;
+  const char *back = NULL;
+
+  if (pattern == NULL || pattern[0] == '\0')
+    return 1;
+  /* Greedy '*' with one backtrack point, as in glob matchers. */
+  while (*name != '\0') {
+    if (*pattern == '*') {
+      star = ++pattern;
+      back = name;
+    }
+    else if (*pattern == '%' ||
+             toupper((unsigned char)*pattern) ==
+                 toupper((unsigned char)*name)) {
+      pattern++;
+      name++;
+    }
+    else if (star != NULL) {
+      pattern = star;
+      name = ++back;
+    }
+    else {
+      return 0;
+    }
+  }
+  while (*pattern == '*')
+    pattern++;
+  return (*pattern == '\0') ? 1 : 0;
+}
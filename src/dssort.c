@@ -0,0 +1,797 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO external merge sort of dataset records (ds.sort).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | dssort_item | struct | Arena entry (key prefix, data offset, length) |
+ * | dssort_arena | struct | Run arena: items up, record bytes down |
+ * | dssort_src | struct | Merge source reading one work dataset |
+ * | dssort_spec_int | function | Read an integer key of a key spec |
+ * | dssort_prefix | function | Build the 8-byte key prefix of a record |
+ * | dssort_cmp_key | function | Compare one key of two records |
+ * | dssort_cmp | function | Compare all keys of two records |
+ * | dssort_radix | function | LSD radix sort of items by prefix |
+ * | dssort_merge_sort | function | Stable merge sort of items by full key |
+ * | dssort_sort | function | Sort the arena items |
+ * | dssort_arena_add | function | Append a record to the arena |
+ * | dssort_put | function | Write one length-prefixed work record |
+ * | dssort_spill | function | Write the sorted arena as a run |
+ * | dssort_src_next | function | Load the next record of a merge source |
+ * | dssort_less | function | Heap order of two merge sources |
+ * | dssort_sift | function | Restore the heap below a slot |
+ * | dssort_merge | function | Merge runs into a run or the output |
+ * | dssort_remove | function | Delete a list of work datasets |
+ * | luaz_dssort_init | function | Reset a sort to the defaults |
+ * | luaz_dssort_keys | function | Compile a Lua key list |
+ * | luaz_dssort_run | function | Sort input records into the output |
+ *
+ * Platform Requirements:
+ * - Work datasets are binary streams of <length><bytes> records with the
+ *   record count kept in memory, so padding the C runtime adds after the
+ *   last record (FB work datasets) is never read.
+ */
+#include "DSSORT"
+
+#include "LAUXLIB"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Segments of equal prefixes shorter than this use insertion sort. */
+#define DSSORT_INSERT_MAX 12
+/* Largest record length (and key end) of a z/OS dataset. */
+#define DSSORT_LRECL_MAX 32760
+
+struct dssort_item {
+  uint64_t prefix;
+  uint32_t off;
+  uint32_t len;
+};
+
+/* Items grow up from base; record bytes grow down from base + size. The
+ * space between holds the radix/merge scratch copy of the items. */
+struct dssort_arena {
+  unsigned char *base;
+  size_t size;
+  struct dssort_item *items;
+  size_t count;
+  size_t low;
+};
+
+struct dssort_src {
+  FILE *fp;
+  lua_Integer left;
+  unsigned char *buf;
+  size_t cap;
+  size_t len;
+  uint64_t prefix;
+};
+
+struct dssort_run {
+  int id;
+  lua_Integer count;
+  lua_Integer bytes; /* length prefixes included */
+};
+
+/**
+ * @brief Read an integer key of a key spec.
+ *
+ * @param L Lua state.
+ * @param key Key name.
+ * @return Value, or 0 when missing or not positive.
+ */
+static lua_Integer dssort_spec_int(lua_State *L, const char *key)
+{
+  lua_Integer v;
+  int isnum = 0;
+
+  lua_getfield(L, -1, key);
+  v = lua_tointegerx(L, -1, &isnum);
+  lua_pop(L, 1);
+  return (isnum && v >= 1) ? v : 0;
+}
+
+/**
+ * @brief Build the 8-byte prefix of a record's concatenated keys.
+ *
+ * Descending key bytes are complemented and missing bytes are 0x00, so
+ * comparing prefixes as integers agrees with dssort_cmp().
+ *
+ * @param s Sort.
+ * @param p Record bytes.
+ * @param n Record length.
+ * @return Prefix, first key byte most significant.
+ */
+static uint64_t dssort_prefix(const struct luaz_dssort *s,
+                              const unsigned char *p, size_t n)
+{
+  uint64_t v = 0;
+  int got = 0;
+  int k;
+
+  for (k = 0; k < s->nkeys && got < 8; k++) {
+    const struct luaz_dssort_key *key = &s->keys[k];
+    unsigned char flip = key->desc ? 0xFF : 0x00;
+    size_t j;
+    for (j = 0; j < key->len && got < 8; j++, got++) {
+      size_t at = key->off + j;
+      v = (v << 8) | (uint64_t)((at < n ? p[at] : 0x00) ^ flip);
+    }
+  }
+  return v << (8 * (8 - got));
+}
+
+/**
+ * @brief Compare one key of two records (missing bytes are 0x00).
+ *
+ * @param key Key.
+ * @param a First record.
+ * @param an First record length.
+ * @param b Second record.
+ * @param bn Second record length.
+ * @return <0, 0 or >0 in sort order.
+ */
+static int dssort_cmp_key(const struct luaz_dssort_key *key,
+                          const unsigned char *a, size_t an,
+                          const unsigned char *b, size_t bn)
+{
+  size_t la = (an > key->off) ? an - key->off : 0;
+  size_t lb = (bn > key->off) ? bn - key->off : 0;
+  size_t m;
+  int c = 0;
+
+  if (la > key->len)
+    la = key->len;
+  if (lb > key->len)
+    lb = key->len;
+  m = (la < lb) ? la : lb;
+  if (m > 0)
+    c = memcmp(a + key->off, b + key->off, m);
+  if (c == 0 && la != lb) {
+    /* The longer side is greater unless its extra bytes are all 0x00. */
+    const unsigned char *q = (la > lb) ? a + key->off + m : b + key->off + m;
+    size_t r = ((la > lb) ? la : lb) - m;
+    while (r > 0 && *q == 0x00) {
+      q++;
+      r--;
+    }
+    if (r > 0)
+      c = (la > lb) ? 1 : -1;
+  }
+  return key->desc ? -c : c;
+}
+
+/**
+ * @brief Compare all keys of two records.
+ *
+ * @param s Sort.
+ * @param a First record.
+ * @param an First record length.
+ * @param b Second record.
+ * @param bn Second record length.
+ * @return <0, 0 or >0 in sort order.
+ */
+static int dssort_cmp(const struct luaz_dssort *s, const unsigned char *a,
+                      size_t an, const unsigned char *b, size_t bn)
+{
+  int k;
+
+  for (k = 0; k < s->nkeys; k++) {
+    int c = dssort_cmp_key(&s->keys[k], a, an, b, bn);
+    if (c != 0)
+      return c;
+  }
+  return 0;
+}
+
+/**
+ * @brief Stable LSD radix sort of items by prefix, one byte per pass.
+ *
+ * All eight histograms come from one scan; a byte that is the same in
+ * every item (short keys, common leading bytes) costs no pass.
+ *
+ * @param a Items.
+ * @param t Scratch of the same size.
+ * @param n Item count.
+ */
+static void dssort_radix(struct dssort_item *a, struct dssort_item *t,
+                         size_t n)
+{
+  uint32_t hist[8][256];
+  struct dssort_item *from = a;
+  struct dssort_item *to = t;
+  size_t i;
+  int b;
+
+  memset(hist, 0, sizeof(hist));
+  for (i = 0; i < n; i++) {
+    uint64_t v = a[i].prefix;
+    for (b = 0; b < 8; b++)
+      hist[b][(v >> (8 * b)) & 0xFF]++;
+  }
+  for (b = 0; b < 8; b++) {
+    uint32_t sum = 0;
+    int c;
+    if (hist[b][(a[0].prefix >> (8 * b)) & 0xFF] == (uint32_t)n)
+      continue;
+    for (c = 0; c < 256; c++) {
+      uint32_t h = hist[b][c];
+      hist[b][c] = sum;
+      sum += h;
+    }
+    for (i = 0; i < n; i++)
+      to[hist[b][(from[i].prefix >> (8 * b)) & 0xFF]++] = from[i];
+    {
+      struct dssort_item *x = from;
+      from = to;
+      to = x;
+    }
+  }
+  if (from != a)
+    memcpy(a, from, n * sizeof(*a));
+}
+
+/**
+ * @brief Stable merge sort of items by their full keys.
+ *
+ * @param s Sort.
+ * @param base Arena base (record bytes are at base + off).
+ * @param a Items.
+ * @param t Scratch of the same size.
+ * @param n Item count.
+ */
+static void dssort_merge_sort(const struct luaz_dssort *s,
+                              const unsigned char *base,
+                              struct dssort_item *a, struct dssort_item *t,
+                              size_t n)
+{
+  size_t mid;
+  size_t i;
+  size_t j;
+  size_t k;
+
+  if (n <= DSSORT_INSERT_MAX) {
+    for (i = 1; i < n; i++) {
+      struct dssort_item x = a[i];
+      for (j = i; j > 0 &&
+                  dssort_cmp(s, base + a[j - 1].off, a[j - 1].len,
+                             base + x.off, x.len) > 0;
+           j--)
+        a[j] = a[j - 1];
+      a[j] = x;
+    }
+    return;
+  }
+  mid = n / 2;
+  dssort_merge_sort(s, base, a, t, mid);
+  dssort_merge_sort(s, base, a + mid, t + mid, n - mid);
+  memcpy(t, a, n * sizeof(*a));
+  i = 0;
+  j = mid;
+  k = 0;
+  while (i < mid && j < n) {
+    if (dssort_cmp(s, base + t[j].off, t[j].len, base + t[i].off,
+                   t[i].len) < 0)
+      a[k++] = t[j++];
+    else
+      a[k++] = t[i++];
+  }
+  while (i < mid)
+    a[k++] = t[i++];
+  while (j < n)
+    a[k++] = t[j++];
+}
+
+/**
+ * @brief Sort the arena items: radix on the prefix, then full keys for
+ *        items whose prefixes tie when the keys are longer than 8 bytes.
+ *
+ * @param s Sort.
+ * @param ar Arena.
+ */
+static void dssort_sort(const struct luaz_dssort *s, struct dssort_arena *ar)
+{
+  struct dssort_item *a = ar->items;
+  struct dssort_item *t = a + ar->count;
+  size_t i;
+
+  if (ar->count < 2)
+    return;
+  dssort_radix(a, t, ar->count);
+  if (s->keylen <= 8)
+    return;
+  i = 0;
+  while (i < ar->count) {
+    size_t j = i + 1;
+    while (j < ar->count && a[j].prefix == a[i].prefix)
+      j++;
+    if (j - i > 1)
+      dssort_merge_sort(s, ar->base, a + i, t, j - i);
+    i = j;
+  }
+}
+
+/**
+ * @brief Append a record to the arena.
+ *
+ * Room is kept for the record, its item and one scratch item per item.
+ *
+ * @param s Sort.
+ * @param ar Arena.
+ * @param p Record bytes.
+ * @param n Record length.
+ * @return 0 when added, or 1 when the arena is full.
+ */
+static int dssort_arena_add(const struct luaz_dssort *s,
+                            struct dssort_arena *ar, const char *p, size_t n)
+{
+  size_t items = (ar->count + 1) * 2 * sizeof(struct dssort_item);
+  struct dssort_item *it;
+
+  if (items > ar->low || ar->low - items < n)
+    return 1;
+  ar->low -= n;
+  memcpy(ar->base + ar->low, p, n);
+  it = &ar->items[ar->count++];
+  it->prefix = dssort_prefix(s, ar->base + ar->low, n);
+  it->off = (uint32_t)ar->low;
+  it->len = (uint32_t)n;
+  return 0;
+}
+
+/**
+ * @brief Write one work record: a 4-byte native length, then the bytes.
+ *
+ * @param fp Work dataset.
+ * @param p Record bytes.
+ * @param n Record length.
+ * @return 0 on success, or -1 on a write error.
+ */
+static int dssort_put(FILE *fp, const unsigned char *p, size_t n)
+{
+  uint32_t len = (uint32_t)n;
+
+  if (fwrite(&len, sizeof(len), 1, fp) != 1)
+    return -1;
+  if (n > 0 && fwrite(p, 1, n, fp) != n)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Sort the arena, write it to a new work dataset and empty it.
+ *
+ * @param s Sort.
+ * @param io Callbacks.
+ * @param ar Arena.
+ * @param run Output: the new run.
+ * @return 0 on success, or -1 with s->err set.
+ */
+static int dssort_spill(struct luaz_dssort *s, const struct luaz_dssort_io *io,
+                        struct dssort_arena *ar, struct dssort_run *run)
+{
+  FILE *fp;
+  size_t i;
+  int rc = 0;
+
+  dssort_sort(s, ar);
+  run->id = s->runs;
+  run->count = (lua_Integer)ar->count;
+  run->bytes = (lua_Integer)(ar->size - ar->low) +
+               (lua_Integer)ar->count * (lua_Integer)sizeof(uint32_t);
+  fp = io->spill_open(io->ud, run->id, 1, run->bytes);
+  if (fp == NULL) {
+    s->err = LUAZ_DSSORT_E_SPILL;
+    return -1;
+  }
+  s->runs++;
+  for (i = 0; i < ar->count && rc == 0; i++)
+    rc = dssort_put(fp, ar->base + ar->items[i].off, ar->items[i].len);
+  if (fclose(fp) != 0 || rc != 0) {
+    io->spill_remove(io->ud, run->id);
+    s->err = LUAZ_DSSORT_E_SPILL;
+    return -1;
+  }
+  ar->count = 0;
+  ar->low = ar->size;
+  return 0;
+}
+
+/**
+ * @brief Load the next record of a merge source.
+ *
+ * @param s Sort.
+ * @param r Source.
+ * @return 1 with a record loaded, 0 at the end of the run, or -1 on a
+ *         read or allocation error.
+ */
+static int dssort_src_next(const struct luaz_dssort *s, struct dssort_src *r)
+{
+  uint32_t len;
+
+  if (r->left == 0)
+    return 0;
+  if (fread(&len, sizeof(len), 1, r->fp) != 1)
+    return -1;
+  if (len > r->cap) {
+    unsigned char *p = (unsigned char *)realloc(r->buf, len);
+    if (p == NULL)
+      return -1;
+    r->buf = p;
+    r->cap = len;
+  }
+  if (len > 0 && fread(r->buf, 1, len, r->fp) != len)
+    return -1;
+  r->len = len;
+  r->prefix = dssort_prefix(s, r->buf, len);
+  r->left--;
+  return 1;
+}
+
+/**
+ * @brief Heap order of two merge sources; ties go to the earlier run.
+ *
+ * @param s Sort.
+ * @param src Sources.
+ * @param i First source index.
+ * @param j Second source index.
+ * @return Nonzero when source i comes first.
+ */
+static int dssort_less(const struct luaz_dssort *s,
+                       const struct dssort_src *src, int i, int j)
+{
+  int c;
+
+  if (src[i].prefix != src[j].prefix)
+    return src[i].prefix < src[j].prefix;
+  if (s->keylen > 8) {
+    c = dssort_cmp(s, src[i].buf, src[i].len, src[j].buf, src[j].len);
+    if (c != 0)
+      return c < 0;
+  }
+  return i < j;
+}
+
+/**
+ * @brief Restore the heap order below slot at.
+ *
+ * @param s Sort.
+ * @param src Sources.
+ * @param heap Heap of source indexes.
+ * @param n Heap size.
+ * @param at Slot to sift down.
+ */
+static void dssort_sift(const struct luaz_dssort *s,
+                        const struct dssort_src *src, int *heap, int n, int at)
+{
+  int x = heap[at];
+
+  for (;;) {
+    int c = 2 * at + 1;
+    if (c >= n)
+      break;
+    if (c + 1 < n && dssort_less(s, src, heap[c + 1], heap[c]))
+      c++;
+    if (!dssort_less(s, src, heap[c], x))
+      break;
+    heap[at] = heap[c];
+    at = c;
+  }
+  heap[at] = x;
+}
+
+/**
+ * @brief Merge k runs into a new run (out non-NULL) or the output.
+ *
+ * The merged work datasets are removed after a successful merge.
+ *
+ * @param s Sort.
+ * @param io Callbacks.
+ * @param runs Runs, in input order.
+ * @param k Run count (2..LUAZ_DSSORT_MERGE_MAX).
+ * @param out New run, or NULL to write the output.
+ * @return 0 on success, or -1 with s->err set.
+ */
+static int dssort_merge(struct luaz_dssort *s, const struct luaz_dssort_io *io,
+                        const struct dssort_run *runs, int k,
+                        struct dssort_run *out)
+{
+  struct dssort_src src[LUAZ_DSSORT_MERGE_MAX];
+  int heap[LUAZ_DSSORT_MERGE_MAX];
+  FILE *ofp = NULL;
+  int n = 0;
+  int rc = 0;
+  int i;
+
+  memset(src, 0, sizeof(src));
+  for (i = 0; i < k && rc == 0; i++) {
+    src[i].left = runs[i].count;
+    src[i].fp = io->spill_open(io->ud, runs[i].id, 0, 0);
+    if (src[i].fp == NULL) {
+      s->err = LUAZ_DSSORT_E_SPILL;
+      rc = -1;
+    }
+  }
+  if (rc == 0 && out != NULL) {
+    out->id = s->runs;
+    out->count = 0;
+    out->bytes = 0;
+    for (i = 0; i < k; i++)
+      out->bytes += runs[i].bytes;
+    ofp = io->spill_open(io->ud, out->id, 1, out->bytes);
+    if (ofp == NULL) {
+      s->err = LUAZ_DSSORT_E_SPILL;
+      rc = -1;
+    }
+    else {
+      s->runs++;
+    }
+  }
+  for (i = 0; i < k && rc == 0; i++) {
+    int got = dssort_src_next(s, &src[i]);
+    if (got < 0) {
+      s->err = LUAZ_DSSORT_E_SPILL;
+      rc = -1;
+    }
+    else if (got > 0) {
+      heap[n++] = i;
+    }
+  }
+  for (i = n / 2 - 1; i >= 0 && rc == 0; i--)
+    dssort_sift(s, src, heap, n, i);
+
+  while (n > 0 && rc == 0) {
+    struct dssort_src *r = &src[heap[0]];
+    int got;
+    if (ofp != NULL) {
+      if (dssort_put(ofp, r->buf, r->len) != 0) {
+        s->err = LUAZ_DSSORT_E_SPILL;
+        rc = -1;
+        break;
+      }
+      out->count++;
+    }
+    else {
+      if (io->write(io->ud, (const char *)r->buf, r->len) != 0) {
+        s->err = LUAZ_DSSORT_E_WRITE;
+        rc = -1;
+        break;
+      }
+      s->written++;
+    }
+    got = dssort_src_next(s, r);
+    if (got < 0) {
+      s->err = LUAZ_DSSORT_E_SPILL;
+      rc = -1;
+      break;
+    }
+    if (got == 0)
+      heap[0] = heap[--n];
+    if (n > 0)
+      dssort_sift(s, src, heap, n, 0);
+  }
+
+  for (i = 0; i < k; i++) {
+    if (src[i].fp != NULL)
+      fclose(src[i].fp);
+    free(src[i].buf);
+  }
+  if (ofp != NULL && fclose(ofp) != 0 && rc == 0) {
+    s->err = LUAZ_DSSORT_E_SPILL;
+    rc = -1;
+  }
+  if (ofp != NULL && rc != 0)
+    io->spill_remove(io->ud, out->id);
+  if (rc == 0) {
+    for (i = 0; i < k; i++)
+      io->spill_remove(io->ud, runs[i].id);
+  }
+  return rc;
+}
+
+/**
+ * @brief Delete a list of work datasets.
+ *
+ * @param io Callbacks.
+ * @param runs Runs.
+ * @param n Run count.
+ */
+static void dssort_remove(const struct luaz_dssort_io *io,
+                          const struct dssort_run *runs, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    io->spill_remove(io->ud, runs[i].id);
+}
+
+void luaz_dssort_init(struct luaz_dssort *s)
+{
+  memset(s, 0, sizeof(*s));
+  s->memory = LUAZ_DSSORT_MEMORY_DEFAULT;
+}
+
+int luaz_dssort_keys(lua_State *L, int idx, struct luaz_dssort *s,
+                     int *bad)
+{
+  lua_Integer n;
+  int i;
+
+  *bad = 0;
+  idx = lua_absindex(L, idx);
+  if (!lua_istable(L, idx))
+    return -1;
+  n = (lua_Integer)lua_rawlen(L, idx);
+  if (n < 1 || n > LUAZ_DSSORT_KEYS_MAX)
+    return -1;
+  s->nkeys = 0;
+  s->keylen = 0;
+  for (i = 1; i <= (int)n; i++) {
+    struct luaz_dssort_key *key = &s->keys[i - 1];
+    lua_Integer pos;
+    lua_Integer len;
+    const char *order;
+
+    *bad = i;
+    lua_rawgeti(L, idx, i);
+    if (!lua_istable(L, -1)) {
+      lua_pop(L, 1);
+      return -1;
+    }
+    pos = dssort_spec_int(L, "pos");
+    len = dssort_spec_int(L, "len");
+    if (pos == 0 || len == 0 || pos > DSSORT_LRECL_MAX ||
+        len > DSSORT_LRECL_MAX || pos + len - 1 > DSSORT_LRECL_MAX) {
+      lua_pop(L, 1);
+      return -1;
+    }
+    lua_getfield(L, -1, "order");
+    order = lua_tostring(L, -1);
+    if (order != NULL && strcmp(order, "A") != 0 && strcmp(order, "D") != 0) {
+      lua_pop(L, 2);
+      return -1;
+    }
+    key->off = (size_t)pos - 1;
+    key->len = (size_t)len;
+    key->desc = (order != NULL && order[0] == 'D');
+    lua_pop(L, 2);
+    s->keylen += key->len;
+    s->nkeys++;
+  }
+  *bad = 0;
+  return 0;
+}
+
+int luaz_dssort_run(struct luaz_dssort *s, const struct luaz_dssort_io *io)
+{
+  struct dssort_arena ar;
+  struct dssort_run *runs = NULL;
+  int nruns = 0;
+  int cap = 0;
+  const char *p;
+  size_t n;
+  int rc;
+
+  s->records = 0;
+  s->written = 0;
+  s->runs = 0;
+  s->err = 0;
+  memset(&ar, 0, sizeof(ar));
+  ar.size = s->memory;
+  ar.base = (unsigned char *)malloc(ar.size);
+  if (ar.base == NULL) {
+    s->err = LUAZ_DSSORT_E_NOMEM;
+    return -1;
+  }
+  ar.items = (struct dssort_item *)ar.base;
+  ar.low = ar.size;
+
+  while ((rc = io->read(io->ud, &p, &n)) > 0) {
+    s->records++;
+    if (dssort_arena_add(s, &ar, p, n) == 0)
+      continue;
+    if (ar.count == 0) {
+      s->err = LUAZ_DSSORT_E_NOMEM; /* one record larger than the arena */
+      goto fail;
+    }
+    if (nruns == cap) {
+      int ncap = (cap == 0) ? 16 : cap * 2;
+      struct dssort_run *x =
+          (struct dssort_run *)realloc(runs, (size_t)ncap * sizeof(*runs));
+      if (x == NULL) {
+        s->err = LUAZ_DSSORT_E_NOMEM;
+        goto fail;
+      }
+      runs = x;
+      cap = ncap;
+    }
+    if (dssort_spill(s, io, &ar, &runs[nruns]) != 0)
+      goto fail;
+    nruns++;
+    if (dssort_arena_add(s, &ar, p, n) != 0) {
+      s->err = LUAZ_DSSORT_E_NOMEM;
+      goto fail;
+    }
+  }
+  if (rc < 0) {
+    s->err = LUAZ_DSSORT_E_READ;
+    goto fail;
+  }
+
+  /* Change note: sort in one arena and merge spilled runs with a heap.
+   * Problem: sorting an extract with table.sort needs every record as a
+   * Lua string plus the table, so large extracts exhaust the region.
+   * Expected effect: memory stays at the arena size plus the merge
+   * buffers; the rest of the data lives in work datasets.
+   * Impact: ds.sort; work datasets are created only when the arena fills.
+   */
+  if (nruns == 0) {
+    size_t i;
+    dssort_sort(s, &ar);
+    for (i = 0; i < ar.count; i++) {
+      if (io->write(io->ud, (const char *)ar.base + ar.items[i].off,
+                    ar.items[i].len) != 0) {
+        s->err = LUAZ_DSSORT_E_WRITE;
+        goto fail;
+      }
+      s->written++;
+    }
+    free(ar.base);
+    return 0;
+  }
+  /* The arena always holds the record that overflowed the last run. */
+  if (nruns == cap) {
+    struct dssort_run *x =
+        (struct dssort_run *)realloc(runs, (size_t)(cap + 1) * sizeof(*runs));
+    if (x == NULL) {
+      s->err = LUAZ_DSSORT_E_NOMEM;
+      goto fail;
+    }
+    runs = x;
+    cap++;
+  }
+  if (dssort_spill(s, io, &ar, &runs[nruns]) != 0)
+    goto fail;
+  nruns++;
+  free(ar.base);
+  ar.base = NULL;
+
+  /* Merge consecutive groups into runs until one heap pass remains; the
+   * merged run takes the group's place, so ties keep input order. */
+  while (nruns > LUAZ_DSSORT_MERGE_MAX) {
+    int i;
+    int m = 0;
+    for (i = 0; i < nruns; i += LUAZ_DSSORT_MERGE_MAX) {
+      int k = nruns - i;
+      struct dssort_run merged;
+      if (k > LUAZ_DSSORT_MERGE_MAX)
+        k = LUAZ_DSSORT_MERGE_MAX;
+      if (k == 1) {
+        runs[m++] = runs[i];
+        continue;
+      }
+      if (dssort_merge(s, io, runs + i, k, &merged) != 0) {
+        dssort_remove(io, runs, m);
+        dssort_remove(io, runs + i, nruns - i);
+        free(runs);
+        return -1;
+      }
+      runs[m++] = merged;
+    }
+    nruns = m;
+  }
+  if (dssort_merge(s, io, runs, nruns, NULL) != 0)
+    goto fail;
+  free(runs);
+  return 0;
+
+fail:
+  free(ar.base);
+  dssort_remove(io, runs, nruns);
+  free(runs);
+  return -1;
+}
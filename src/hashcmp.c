@@ -9,13 +9,12 @@
  *   - Runs under z/OS LE (31-bit is fine).
  *   - Uses DDNAME-based dataset access (no USS paths).
  *   - Hashes raw dataset bytes (EBCDIC as stored).
+ *   - CRC32 table lives in CRC32 (shared with the LUAPATH bytecode cache).
  *
  * Objects in this file:
  * +-------------------+----------------------------------------------+
  * | Object            | Description                                  |
  * +-------------------+----------------------------------------------+
- * | crc32_init_table  | Initialize CRC32 table                       |
- * | crc32_update      | Update CRC32 with bytes                      |
  * | hash_stream       | Compute CRC32 for an input stream            |
  * | read_hash_line    | Read CRC32 line from HASHIN DD               |
  * | write_hash_line   | Write CRC32 line to HASHOUT DD               |
@@ -29,6 +28,8 @@
 #include <string.h>
 #include <errno.h>
 
+#include "CRC32"
+
 #define LUZ40010 "LUZ40010 invalid arguments"
 #define LUZ40011 "LUZ40011 unable to open source member"
 #define LUZ40012 "LUZ40012 hash member missing or unreadable"
@@ -37,44 +38,13 @@
 #define LUZ40015 "LUZ40015 hash record format invalid"
 #define LUZ40016 "LUZ40016 object member missing"
 
-static uint32_t crc32_table[256];
-static int crc32_table_ready = 0;
-
-static void crc32_init_table(void) {
-  uint32_t i;
-  for (i = 0; i < 256; i++) {
-    uint32_t c = i;
-    int j;
-    for (j = 0; j < 8; j++) {
-      if (c & 1) {
-        c = 0xEDB88320u ^ (c >> 1);
-      } else {
-        c = c >> 1;
-      }
-    }
-    crc32_table[i] = c;
-  }
-  crc32_table_ready = 1;
-}
-
-static uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len) {
-  size_t i;
-  if (!crc32_table_ready) {
-    crc32_init_table();
-  }
-  for (i = 0; i < len; i++) {
-    crc = crc32_table[(crc ^ buf[i]) & 0xFFu] ^ (crc >> 8);
-  }
-  return crc;
-}
-
 static int hash_stream(FILE *fp, uint32_t *out_crc) {
   uint8_t buf[4096];
   size_t n;
   uint32_t crc = 0xFFFFFFFFu;
 
   while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
-    crc = crc32_update(crc, buf, n);
+    crc = luaz_crc32_update(crc, buf, n);
   }
   if (ferror(fp)) {
     return -1;
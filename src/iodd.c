@@ -6,15 +6,29 @@
  * Object Table:
  * | Object | Kind | Purpose |
  * |--------|------|---------|
+ * | iodd_open_member | function | Open //DD:<dd>(<member>) with a mode |
+ * | luaz_dd_open | function | Open a LUAPATH member (binary if compressed) |
+ * | luaz_member_open | function | Open a LUAPATH member for block reads |
+ * | luaz_stream_read | function | Read the next block of a member stream |
+ * | luaz_stream_close | function | Close a member stream |
+ * | luaz_member_list | function | Read LUAPATH directories (all concatenations) |
+ * | luaz_bc_read_alloc | function | Read a bytecode cache member |
+ * | luaz_bc_write | function | Write a bytecode cache member |
+ * | luaz_bundle_read_alloc | function | Read the application bundle DD |
  * | luaz_io_dd_register | function | Register DDNAME-based LUAPATH hooks |
  */
 #include "IODD"
+#include "LZMEM"
+#include "PDSDIR"
 #include "PLATFORM"
 #include "POLICY"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#define IODD_READ_CHUNK 4096u
+
 /**
  * @brief Read a full stream into a caller buffer or count required size.
  *
@@ -55,20 +69,96 @@ static int read_stream(FILE *fp, char *buf, unsigned long *len)
 }
 
 /**
- * @brief Open a LUAPATH DDNAME member for reading.
+ * @brief Read a full stream into a growable heap buffer in one pass.
  *
- * @param member Member name in the LUAPATH concatenation.
+ * The buffer is allocated with malloc() and always keeps one spare byte
+ * after the data so callers can NUL-terminate it.
+ *
+ * @param fp Open file stream to read.
+ * @param out Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on read/allocation failure.
+ */
+static int read_stream_alloc(FILE *fp, char **out, unsigned long *len)
+{
+  char *buf = NULL;
+  size_t cap = 0;
+  size_t total = 0;
+  size_t n;
+
+  if (out == NULL || len == NULL)
+    return -1;
+  *out = NULL;
+  *len = 0;
+
+  for (;;) {
+    if (total + 1 >= cap) {
+      size_t next = (cap == 0) ? IODD_READ_CHUNK : cap * 2;
+      char *nbuf;
+      if (next <= cap) {
+        free(buf);
+        return -1;
+      }
+      nbuf = (char *)realloc(buf, next);
+      if (nbuf == NULL) {
+        free(buf);
+        return -1;
+      }
+      buf = nbuf;
+      cap = next;
+    }
+    n = fread(buf + total, 1, cap - total - 1, fp);
+    if (n == 0) {
+      if (ferror(fp)) {
+        free(buf);
+        return -1;
+      }
+      break;
+    }
+    total += n;
+  }
+
+  *out = buf;
+  *len = (unsigned long)total;
+  return 0;
+}
+
+/**
+ * @brief Open a member of a DDNAME concatenation.
+ *
+ * @param ddname DDNAME of the library.
+ * @param member Member name.
+ * @param mode fopen() mode string.
  * @param out Output FILE pointer on success.
  * @return 0 on success, or -1 on failure.
  */
-static int luaz_dd_open(const char *member, FILE **out)
+static int iodd_open_member(const char *ddname, const char *member,
+                            const char *mode, FILE **out)
 {
   char path[128];
-  const char *ddname = NULL;
   int rc;
 
-  if (out == NULL || member == NULL)
+  if (out == NULL || member == NULL || ddname == NULL)
     return -1;
+  rc = snprintf(path, sizeof(path), "//DD:%s(%s)", ddname, member);
+  if (rc <= 0 || (size_t)rc >= sizeof(path))
+    return -1;
+
+  *out = fopen(path, mode);
+  return (*out == NULL) ? -1 : 0;
+}
+
+/**
+ * @brief Open a LUAPATH DDNAME member for reading.
+ *
+ * @param member Member name in the LUAPATH concatenation.
+ * @param out Output FILE pointer on success.
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_dd_open(const char *member, FILE **out)
+{
+  const char *ddname = NULL;
+  int c;
 
   /* Change note: allow LUAPATH DDNAME override via LUACFG.
    * Problem: LUAPATH DDNAME was hardcoded in DDNAME I/O helpers.
@@ -78,12 +168,25 @@ static int luaz_dd_open(const char *member, FILE **out)
   ddname = luaz_policy_get_raw("luapath.dd");
   if (ddname == NULL || ddname[0] == '\0')
     ddname = "LUAPATH";
-  rc = snprintf(path, sizeof(path), "//DD:%s(%s)", ddname, member);
-  if (rc <= 0 || (size_t)rc >= sizeof(path))
+  if (iodd_open_member(ddname, member, "r", out) != 0)
     return -1;
 
-  *out = fopen(path, "r");
-  return (*out == NULL) ? -1 : 0;
+  /* Change note: read compressed members as a byte stream.
+   * Problem: text mode inserts newlines at record boundaries and would
+   * corrupt the compressed blocks.
+   * Expected effect: members starting with the LZMEM magic byte are
+   * reopened in binary mode; source members stay in text mode.
+   * Impact: one extra open only for compressed members.
+   */
+  c = getc(*out);
+  if (c != LUAZ_LZM_MAGIC0) {
+    if (c != EOF)
+      ungetc(c, *out);
+    return 0;
+  }
+  fclose(*out);
+  *out = NULL;
+  return iodd_open_member(ddname, member, "rb", out);
 }
 
 /**
@@ -129,6 +232,249 @@ static int luaz_member_read(const char *member, char *buf, unsigned long *len)
   return rc;
 }
 
+/**
+ * @brief Read a LUAPATH member into a heap buffer with one open and read.
+ *
+ * @param member Member name to read.
+ * @param buf Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_member_read_alloc(const char *member, char **buf,
+                                  unsigned long *len)
+{
+  FILE *fp = NULL;
+  int rc;
+
+  if (member == NULL)
+    return -1;
+  /* Change note: read LUAPATH members in a single pass.
+   * Problem: loaders probed the size by reading the member, then opened
+   * and read it again for the data.
+   * Expected effect: one open/read/close per module load.
+   * Impact: LUAPATH dataset I/O and open calls per require are halved.
+   */
+  if (luaz_dd_open(member, &fp) != 0)
+    return -1;
+
+  rc = read_stream_alloc(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Open a LUAPATH member as a stream for block reads.
+ *
+ * @param member Member name to open.
+ * @param stream Output stream handle (FILE pointer).
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_member_open(const char *member, void **stream)
+{
+  FILE *fp = NULL;
+
+  if (member == NULL || stream == NULL)
+    return -1;
+  /* Change note: stream LUAPATH members into lua_load.
+   * Problem: loadfile held the whole member (plus a shebang copy) in
+   * memory before parsing.
+   * Expected effect: the loader reads one block at a time.
+   * Impact: peak loader memory is one block regardless of member size.
+   */
+  if (luaz_dd_open(member, &fp) != 0)
+    return -1;
+  *stream = fp;
+  return 0;
+}
+
+/**
+ * @brief Read the next block from a member stream.
+ *
+ * @param stream Stream handle from luaz_member_open.
+ * @param buf Output buffer.
+ * @param len In/out: capacity on input, bytes read on output (0 at end).
+ * @return 0 on success, or -1 on read failure.
+ */
+static int luaz_stream_read(void *stream, char *buf, unsigned long *len)
+{
+  FILE *fp = (FILE *)stream;
+  size_t n;
+
+  if (fp == NULL || buf == NULL || len == NULL)
+    return -1;
+  n = fread(buf, 1, (size_t)*len, fp);
+  if (n < (size_t)*len && ferror(fp))
+    return -1;
+  *len = (unsigned long)n;
+  return 0;
+}
+
+/**
+ * @brief Close a member stream.
+ *
+ * @param stream Stream handle from luaz_member_open.
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_stream_close(void *stream)
+{
+  if (stream == NULL)
+    return -1;
+  return (fclose((FILE *)stream) == 0) ? 0 : -1;
+}
+
+typedef struct iodd_list_ctx {
+  int (*cb)(void *ud, const char *member, int concat);
+  void *ud;
+} iodd_list_ctx;
+
+/**
+ * @brief Forward one directory entry to the member-list callback.
+ *
+ * @param ud List context.
+ * @param e Directory entry.
+ * @return Callback result (nonzero stops the directory read).
+ */
+static int iodd_list_entry(void *ud, const struct luaz_pdsdir_entry *e)
+{
+  iodd_list_ctx *ctx = (iodd_list_ctx *)ud;
+  return ctx->cb(ctx->ud, e->name, e->concat);
+}
+
+/**
+ * @brief List LUAPATH members by reading the directories of the DD.
+ *
+ * Opening the DDNAME without a member as RECFM=U returns the 256-byte
+ * directory blocks of each concatenated PDS/PDSE in order.
+ *
+ * @param cb Callback per member (name, 0-based concatenation index).
+ * @param ud Callback context.
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_member_list(int (*cb)(void *ud, const char *member,
+                                      int concat),
+                            void *ud)
+{
+  char path[32];
+  unsigned char blk[LUAZ_PDSDIR_BLKSIZE];
+  struct luaz_pdsdir_state st;
+  iodd_list_ctx ctx;
+  const char *ddname;
+  FILE *fp;
+  size_t n;
+  int rc = 0;
+
+  if (cb == NULL)
+    return -1;
+  ddname = luaz_policy_get_raw("luapath.dd");
+  if (ddname == NULL || ddname[0] == '\0')
+    ddname = "LUAPATH";
+  if (snprintf(path, sizeof(path), "//DD:%s", ddname) >= (int)sizeof(path))
+    return -1;
+  fp = fopen(path, "rb,type=record,recfm=u,lrecl=256,blksize=256");
+  if (fp == NULL)
+    return -1;
+
+  ctx.cb = cb;
+  ctx.ud = ud;
+  luaz_pdsdir_init(&st);
+  while ((n = fread(blk, 1, sizeof(blk), fp)) > 0) {
+    rc = luaz_pdsdir_block(&st, blk, (unsigned long)n, iodd_list_entry, &ctx);
+    if (rc != 0)
+      break;
+  }
+  if (ferror(fp))
+    rc = -1;
+  fclose(fp);
+  return (rc == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Read a bytecode cache member (luabc.dd) into a heap buffer.
+ *
+ * @param member Member name to read.
+ * @param buf Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure (including missing member).
+ */
+static int luaz_bc_read_alloc(const char *member, char **buf,
+                              unsigned long *len)
+{
+  FILE *fp = NULL;
+  int rc;
+
+  if (iodd_open_member(luaz_policy_get_raw("luabc.dd"), member, "rb",
+                       &fp) != 0)
+    return -1;
+  rc = read_stream_alloc(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Replace a bytecode cache member (luabc.dd) with new contents.
+ *
+ * @param member Member name to write.
+ * @param buf Member contents.
+ * @param len Number of bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_bc_write(const char *member, const char *buf,
+                         unsigned long len)
+{
+  FILE *fp = NULL;
+  size_t n;
+
+  if (buf == NULL)
+    return -1;
+  if (iodd_open_member(luaz_policy_get_raw("luabc.dd"), member, "wb",
+                       &fp) != 0)
+    return -1;
+  n = fwrite(buf, 1, (size_t)len, fp);
+  if (fclose(fp) != 0 || n != (size_t)len)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Read the application bundle (luabundle.dd) in one pass.
+ *
+ * @param buf Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int luaz_bundle_read_alloc(char **buf, unsigned long *len)
+{
+  char path[32];
+  FILE *fp;
+  int rc;
+
+  rc = snprintf(path, sizeof(path), "//DD:%s",
+                luaz_policy_get_raw("luabundle.dd"));
+  if (rc <= 0 || (size_t)rc >= sizeof(path))
+    return -1;
+  fp = fopen(path, "rb");
+  if (fp == NULL)
+    return -1;
+  rc = read_stream_alloc(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Check whether a policy boolean is set to a true literal.
+ *
+ * @param key Policy key.
+ * @return 1 when true/1, 0 otherwise.
+ */
+static int iodd_policy_true(const char *key)
+{
+  const char *value = luaz_policy_get_raw(key);
+
+  if (value == NULL)
+    return 0;
+  return (strcmp(value, "1") == 0 || value[0] == 't' || value[0] == 'T');
+}
+
 /**
  * @brief Register DDNAME-based LUAPATH hooks with the platform layer.
  *
@@ -140,5 +486,29 @@ int luaz_io_dd_register(void)
   memset(&ops, 0, sizeof(ops));
   ops.luapath_read_luamap = luaz_luamap_read;
   ops.luapath_read_member = luaz_member_read;
+  ops.luapath_read_member_alloc = luaz_member_read_alloc;
+  ops.luapath_list_members = luaz_member_list;
+  ops.luapath_open_member = luaz_member_open;
+  ops.luapath_read_stream = luaz_stream_read;
+  ops.luapath_close_stream = luaz_stream_close;
+  /* Change note: optional bytecode cache DD for require.
+   * Problem: every run recompiled the same LUAPATH modules from source.
+   * Expected effect: luabc.dd enables cache reads; luabc.write=true also
+   * writes freshly compiled modules back.
+   * Impact: policy must be loaded before this registration call.
+   */
+  if (luaz_policy_get_raw("luabc.dd") != NULL) {
+    ops.luabc_read_member_alloc = luaz_bc_read_alloc;
+    if (iodd_policy_true("luabc.write"))
+      ops.luabc_write_member = luaz_bc_write;
+  }
+  /* Change note: optional application bundle DD for require.
+   * Problem: applications of many members paid one open per module.
+   * Expected effect: luabundle.dd names a sequential dataset holding the
+   * whole application, read once per run.
+   * Impact: policy must be loaded before this registration call.
+   */
+  if (luaz_policy_get_raw("luabundle.dd") != NULL)
+    ops.luabundle_read_alloc = luaz_bundle_read_alloc;
   return luaz_platform_set_ops(&ops);
 }
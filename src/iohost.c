@@ -0,0 +1,703 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO host-filesystem stand-in for DDNAME I/O (off-host benchmarks).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | host_lib_dir | function | Map DDNAME + concatenation index to a directory |
+ * | host_open_member | function | Open a member, searching the concatenation |
+ * | host_list_members | function | List members of every concatenated directory |
+ * | host_read_alloc | function | Read a stream into a growable heap buffer |
+ * | host_read | function | Read a stream into a caller buffer or size it |
+ * | host_member_open | function | Open a LUAPATH member for block reads |
+ * | host_stream_read | function | Read the next block of a member stream |
+ * | host_stream_close | function | Close a member stream |
+ * | host_bundle_read_alloc | function | Read the bundle stand-in file |
+ * | host_dir | struct | Directory stand-in state for ds.members |
+ * | host_dir_load | function | Load the sorted member names of a library |
+ * | host_dir_stats | function | Encode ISPF statistics from file metadata |
+ * | host_dir_open | function | Open a library directory stand-in |
+ * | host_dir_read | function | Build the next 256-byte directory block |
+ * | host_dir_close | function | Close a directory stand-in |
+ * | luaz_io_host_register | function | Register directory-backed LUAPATH hooks |
+ *
+ * Platform Requirements:
+ * - POSIX-style paths; not linked into LUAEXEC/LUACMD on z/OS.
+ * - Mirrors IODD semantics so LUAPATH/LUABC logic runs unchanged.
+ * - Concatenation: <root>/<DD> is a single library; otherwise
+ *   <root>/<DD>.1, <root>/<DD>.2, ... are searched in order.
+ * - ds.members: "DD:<DD>" or a DSN names a library directory the same
+ *   way; directory blocks carry ISPF statistics built from the files
+ *   (mtime, line count, user IOHOST).
+ */
+#include "IOHOST"
+#include "DSMEM"
+#include "PLATFORM"
+#include "POLICY"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define IOHOST_READ_CHUNK 4096u
+
+static char g_root[512];
+
+/**
+ * @brief Return the LUAPATH DDNAME (luapath.dd or LUAPATH).
+ *
+ * @return DDNAME string.
+ */
+static const char *host_luapath_dd(void)
+{
+  const char *ddname = luaz_policy_get_raw("luapath.dd");
+  return (ddname == NULL || ddname[0] == '\0') ? "LUAPATH" : ddname;
+}
+
+/**
+ * @brief Map a DDNAME and concatenation index to a library directory.
+ *
+ * @param ddname DDNAME.
+ * @param concat 0-based concatenation index.
+ * @param out Output path buffer.
+ * @param cap Output buffer capacity.
+ * @return 0 when the directory exists, or -1 past the last library.
+ */
+static int host_lib_dir(const char *ddname, int concat, char *out,
+                        size_t cap)
+{
+  struct stat sb;
+  int rc;
+
+  if (ddname == NULL)
+    return -1;
+  rc = snprintf(out, cap, "%s/%s", g_root, ddname);
+  if (rc <= 0 || (size_t)rc >= cap)
+    return -1;
+  if (stat(out, &sb) == 0 && S_ISDIR(sb.st_mode))
+    return (concat == 0) ? 0 : -1;
+  rc = snprintf(out, cap, "%s/%s.%d", g_root, ddname, concat + 1);
+  if (rc <= 0 || (size_t)rc >= cap)
+    return -1;
+  if (stat(out, &sb) == 0 && S_ISDIR(sb.st_mode))
+    return 0;
+  return -1;
+}
+
+/**
+ * @brief Open a stand-in library member (first library holding it wins).
+ *
+ * Writes always go to the first library of the DDNAME.
+ *
+ * @param ddname DDNAME (directory name under the root).
+ * @param member Member name (file name).
+ * @param mode fopen() mode string.
+ * @param out Output FILE pointer on success.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_open_member(const char *ddname, const char *member,
+                            const char *mode, FILE **out)
+{
+  char dir[1024];
+  char path[1100];
+  int concat;
+  int rc;
+
+  if (out == NULL || ddname == NULL || member == NULL)
+    return -1;
+  *out = NULL;
+  for (concat = 0; host_lib_dir(ddname, concat, dir, sizeof(dir)) == 0;
+       concat++) {
+    rc = snprintf(path, sizeof(path), "%s/%s", dir, member);
+    if (rc <= 0 || (size_t)rc >= sizeof(path))
+      return -1;
+    *out = fopen(path, mode);
+    if (*out != NULL || mode[0] != 'r')
+      break;
+  }
+  return (*out == NULL) ? -1 : 0;
+}
+
+/**
+ * @brief List members of each concatenated LUAPATH stand-in directory.
+ *
+ * @param cb Callback per member (name, 0-based concatenation index).
+ * @param ud Callback context.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_list_members(int (*cb)(void *ud, const char *member,
+                                       int concat),
+                             void *ud)
+{
+  char dir[1024];
+  int concat;
+
+  if (cb == NULL)
+    return -1;
+  for (concat = 0;
+       host_lib_dir(host_luapath_dd(), concat, dir, sizeof(dir)) == 0;
+       concat++) {
+    DIR *d = opendir(dir);
+    struct dirent *de;
+    if (d == NULL)
+      return -1;
+    while ((de = readdir(d)) != NULL) {
+      if (de->d_name[0] == '.' || strlen(de->d_name) > 8)
+        continue;
+      if (cb(ud, de->d_name, concat) != 0) {
+        closedir(d);
+        return -1;
+      }
+    }
+    closedir(d);
+  }
+  return (concat == 0) ? -1 : 0;
+}
+
+/**
+ * @brief Read a full stream into a growable heap buffer.
+ *
+ * @param fp Open stream.
+ * @param out Output buffer (caller frees; one spare byte after data).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_read_alloc(FILE *fp, char **out, unsigned long *len)
+{
+  char *buf = NULL;
+  size_t cap = 0;
+  size_t total = 0;
+  size_t n;
+
+  if (out == NULL || len == NULL)
+    return -1;
+  *out = NULL;
+  *len = 0;
+  for (;;) {
+    if (total + 1 >= cap) {
+      size_t next = (cap == 0) ? IOHOST_READ_CHUNK : cap * 2;
+      char *nbuf = (char *)realloc(buf, next);
+      if (nbuf == NULL) {
+        free(buf);
+        return -1;
+      }
+      buf = nbuf;
+      cap = next;
+    }
+    n = fread(buf + total, 1, cap - total - 1, fp);
+    if (n == 0) {
+      if (ferror(fp)) {
+        free(buf);
+        return -1;
+      }
+      break;
+    }
+    total += n;
+  }
+  *out = buf;
+  *len = (unsigned long)total;
+  return 0;
+}
+
+/**
+ * @brief Read a full stream into a caller buffer or count its size.
+ *
+ * @param fp Open stream.
+ * @param buf Output buffer or NULL to only compute length.
+ * @param len In/out length: capacity on input, bytes read on output.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_read(FILE *fp, char *buf, unsigned long *len)
+{
+  char *tmp = NULL;
+  unsigned long n = 0;
+
+  if (len == NULL || host_read_alloc(fp, &tmp, &n) != 0)
+    return -1;
+  if (buf != NULL) {
+    if (n > *len) {
+      free(tmp);
+      return -1;
+    }
+    memcpy(buf, tmp, (size_t)n);
+  }
+  free(tmp);
+  *len = n;
+  return 0;
+}
+
+/**
+ * @brief Read LUAMAP from the LUAPATH stand-in directory.
+ *
+ * @param buf Output buffer or NULL to only compute length.
+ * @param len In/out length: capacity on input, bytes read on output.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_luamap_read(char *buf, unsigned long *len)
+{
+  FILE *fp = NULL;
+  int rc;
+
+  if (host_open_member(host_luapath_dd(), "LUAMAP", "r", &fp) != 0)
+    return -1;
+  rc = host_read(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Read a LUAPATH stand-in member into a caller buffer.
+ *
+ * @param member Member name.
+ * @param buf Output buffer or NULL to only compute length.
+ * @param len In/out length: capacity on input, bytes read on output.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_member_read(const char *member, char *buf,
+                            unsigned long *len)
+{
+  FILE *fp = NULL;
+  int rc;
+
+  if (host_open_member(host_luapath_dd(), member, "r", &fp) != 0)
+    return -1;
+  rc = host_read(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Read a LUAPATH stand-in member into a heap buffer.
+ *
+ * @param member Member name.
+ * @param buf Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_member_read_alloc(const char *member, char **buf,
+                                  unsigned long *len)
+{
+  FILE *fp = NULL;
+  int rc;
+
+  if (host_open_member(host_luapath_dd(), member, "r", &fp) != 0)
+    return -1;
+  rc = host_read_alloc(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Open a LUAPATH stand-in member as a stream for block reads.
+ *
+ * @param member Member name.
+ * @param stream Output stream handle (FILE pointer).
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_member_open(const char *member, void **stream)
+{
+  FILE *fp = NULL;
+
+  if (stream == NULL)
+    return -1;
+  if (host_open_member(host_luapath_dd(), member, "r", &fp) != 0)
+    return -1;
+  *stream = fp;
+  return 0;
+}
+
+/**
+ * @brief Read the next block from a member stream.
+ *
+ * @param stream Stream handle from host_member_open.
+ * @param buf Output buffer.
+ * @param len In/out: capacity on input, bytes read on output (0 at end).
+ * @return 0 on success, or -1 on read failure.
+ */
+static int host_stream_read(void *stream, char *buf, unsigned long *len)
+{
+  FILE *fp = (FILE *)stream;
+  size_t n;
+
+  if (fp == NULL || buf == NULL || len == NULL)
+    return -1;
+  n = fread(buf, 1, (size_t)*len, fp);
+  if (n < (size_t)*len && ferror(fp))
+    return -1;
+  *len = (unsigned long)n;
+  return 0;
+}
+
+/**
+ * @brief Close a member stream.
+ *
+ * @param stream Stream handle from host_member_open.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_stream_close(void *stream)
+{
+  if (stream == NULL)
+    return -1;
+  return (fclose((FILE *)stream) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Read a bytecode cache stand-in member (luabc.dd).
+ *
+ * @param member Member name.
+ * @param buf Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_bc_read_alloc(const char *member, char **buf,
+                              unsigned long *len)
+{
+  FILE *fp = NULL;
+  int rc;
+
+  if (host_open_member(luaz_policy_get_raw("luabc.dd"), member, "rb",
+                       &fp) != 0)
+    return -1;
+  rc = host_read_alloc(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+/**
+ * @brief Replace a bytecode cache stand-in member (luabc.dd).
+ *
+ * @param member Member name.
+ * @param buf Member contents.
+ * @param len Number of bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_bc_write(const char *member, const char *buf,
+                         unsigned long len)
+{
+  FILE *fp = NULL;
+  size_t n;
+
+  if (buf == NULL)
+    return -1;
+  if (host_open_member(luaz_policy_get_raw("luabc.dd"), member, "wb",
+                       &fp) != 0)
+    return -1;
+  n = fwrite(buf, 1, (size_t)len, fp);
+  if (fclose(fp) != 0 || n != (size_t)len)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Read the application bundle stand-in file <root>/<luabundle.dd>.
+ *
+ * @param buf Output buffer pointer (caller frees).
+ * @param len Output length in bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_bundle_read_alloc(char **buf, unsigned long *len)
+{
+  char path[1100];
+  FILE *fp;
+  int rc;
+
+  rc = snprintf(path, sizeof(path), "%s/%s", g_root,
+                luaz_policy_get_raw("luabundle.dd"));
+  if (rc <= 0 || (size_t)rc >= sizeof(path))
+    return -1;
+  fp = fopen(path, "rb");
+  if (fp == NULL)
+    return -1;
+  rc = host_read_alloc(fp, buf, len);
+  fclose(fp);
+  return rc;
+}
+
+struct host_dir {
+  char name[64];    /* DDNAME or DSN: the library directory name */
+  int concat;       /* current library */
+  int done;         /* no library left */
+  char path[1024];  /* current library directory */
+  char (*names)[9]; /* sorted member names of the current library */
+  size_t count;
+  size_t next;
+};
+
+static int host_dir_cmp(const void *a, const void *b)
+{
+  return strcmp((const char *)a, (const char *)b);
+}
+
+/**
+ * @brief Load the sorted member names of library hd->concat.
+ *
+ * @param hd Directory state.
+ * @return 0 on success, 1 past the last library, or -1 on failure.
+ */
+static int host_dir_load(struct host_dir *hd)
+{
+  DIR *d;
+  struct dirent *de;
+  size_t cap = 0;
+
+  free(hd->names);
+  hd->names = NULL;
+  hd->count = 0;
+  hd->next = 0;
+  if (host_lib_dir(hd->name, hd->concat, hd->path, sizeof(hd->path)) != 0)
+    return 1;
+  d = opendir(hd->path);
+  if (d == NULL)
+    return -1;
+  while ((de = readdir(d)) != NULL) {
+    if (de->d_name[0] == '.' || strlen(de->d_name) > 8)
+      continue;
+    if (hd->count == cap) {
+      size_t ncap = (cap == 0) ? 64 : cap * 2;
+      char(*n)[9] = (char(*)[9])realloc(hd->names, ncap * sizeof(*n));
+      if (n == NULL) {
+        closedir(d);
+        return -1;
+      }
+      hd->names = n;
+      cap = ncap;
+    }
+    strcpy(hd->names[hd->count++], de->d_name);
+  }
+  closedir(d);
+  if (hd->count > 1)
+    qsort(hd->names, hd->count, sizeof(*hd->names), host_dir_cmp);
+  return 0;
+}
+
+/**
+ * @brief Encode ISPF statistics for a member file: version 01.00,
+ *        created and changed at the file mtime, the line count as
+ *        current and initial size, user IOHOST.
+ *
+ * @param path Member file.
+ * @param u User data output (LUAZ_DSMEM_ISPF_EXT_LEN bytes).
+ * @return User data length in bytes (30, or 40 above 65535 lines).
+ */
+static int host_dir_stats(const char *path, unsigned char *u)
+{
+  struct stat sb;
+  struct tm tmv;
+  time_t mt = 0;
+  unsigned long lines = 0;
+  unsigned long half;
+  int last = '\n';
+  int yd;
+  int len = LUAZ_DSMEM_ISPF_LEN;
+  FILE *fp;
+
+  if (stat(path, &sb) == 0)
+    mt = sb.st_mtime;
+  fp = fopen(path, "rb");
+  if (fp != NULL) {
+    char buf[IOHOST_READ_CHUNK];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+      size_t i;
+      for (i = 0; i < n; i++)
+        lines += (buf[i] == '\n');
+      last = (unsigned char)buf[n - 1];
+    }
+    fclose(fp);
+  }
+  if (last != '\n')
+    lines++;
+  localtime_r(&mt, &tmv);
+
+  memset(u, 0, LUAZ_DSMEM_ISPF_EXT_LEN);
+  u[0] = 1;
+#define HOST_BCD(v) (unsigned char)((((v) / 10) << 4) | ((v) % 10))
+  u[3] = HOST_BCD(tmv.tm_sec % 60);
+  yd = tmv.tm_yday + 1;
+  u[4] = (unsigned char)(tmv.tm_year / 100);
+  u[5] = HOST_BCD(tmv.tm_year % 100);
+  u[6] = (unsigned char)(((yd / 100) << 4) | ((yd / 10) % 10));
+  u[7] = (unsigned char)(((yd % 10) << 4) | 0x0F);
+  memcpy(u + 8, u + 4, 4);
+  u[12] = HOST_BCD(tmv.tm_hour);
+  u[13] = HOST_BCD(tmv.tm_min);
+#undef HOST_BCD
+  half = (lines > 65535ul) ? 65535ul : lines;
+  u[14] = u[16] = (unsigned char)(half >> 8);
+  u[15] = u[17] = (unsigned char)half;
+  memcpy(u + 20, "IOHOST  ", 8);
+  if (lines > 65535ul) {
+    u[2] = LUAZ_DSMEM_EXT;
+    u[28] = u[32] = (unsigned char)(lines >> 24);
+    u[29] = u[33] = (unsigned char)(lines >> 16);
+    u[30] = u[34] = (unsigned char)(lines >> 8);
+    u[31] = u[35] = (unsigned char)lines;
+    len = LUAZ_DSMEM_ISPF_EXT_LEN;
+  }
+  return len;
+}
+
+/**
+ * @brief Open the directory stand-in of "DD:ddname" or a DSN.
+ *
+ * @param name Name as passed to ds.members.
+ * @param dir Output state.
+ * @return 0 on success, or -1 when no library exists.
+ */
+static int host_dir_open(const char *name, void **dir)
+{
+  struct host_dir *hd;
+  const char *p = name;
+  size_t i = 0;
+
+  if (name == NULL || dir == NULL)
+    return -1;
+  if (p[0] == '/' && p[1] == '/')
+    p += 2;
+  if (toupper((unsigned char)p[0]) == 'D' &&
+      toupper((unsigned char)p[1]) == 'D' && p[2] == ':')
+    p += 3;
+  hd = (struct host_dir *)calloc(1, sizeof(*hd));
+  if (hd == NULL)
+    return -1;
+  for (; *p != '\0' && i + 1 < sizeof(hd->name); p++) {
+    if (*p != '\'')
+      hd->name[i++] = *p;
+  }
+  if (host_dir_load(hd) != 0) {
+    free(hd->names);
+    free(hd);
+    return -1;
+  }
+  *dir = hd;
+  return 0;
+}
+
+/**
+ * @brief Build the next directory block: sorted entries with ISPF user
+ *        data, and an end marker after each library.
+ *
+ * @param dir State from host_dir_open.
+ * @param blk Block output.
+ * @param len In: capacity (at least 256); out: 256, or 0 at the end.
+ * @return 0 on success, or -1 on failure.
+ */
+static int host_dir_read(void *dir, unsigned char *blk, unsigned long *len)
+{
+  struct host_dir *hd = (struct host_dir *)dir;
+  unsigned long off = 2;
+  int rc;
+
+  if (hd == NULL || blk == NULL || len == NULL ||
+      *len < LUAZ_PDSDIR_BLKSIZE)
+    return -1;
+  if (hd->done) {
+    *len = 0;
+    return 0;
+  }
+  memset(blk, 0, LUAZ_PDSDIR_BLKSIZE);
+  for (;;) {
+    if (hd->next < hd->count) {
+      unsigned char user[LUAZ_DSMEM_ISPF_EXT_LEN];
+      char path[1100];
+      size_t nl = strlen(hd->names[hd->next]);
+      int ulen;
+      if (off + 12 + LUAZ_DSMEM_ISPF_EXT_LEN > LUAZ_PDSDIR_BLKSIZE)
+        break;
+      snprintf(path, sizeof(path), "%s/%s", hd->path, hd->names[hd->next]);
+      ulen = host_dir_stats(path, user);
+      memset(blk + off, ' ', 8);
+      memcpy(blk + off, hd->names[hd->next], nl);
+      blk[off + 8] = (unsigned char)(hd->next >> 16);
+      blk[off + 9] = (unsigned char)(hd->next >> 8);
+      blk[off + 10] = (unsigned char)(hd->next + 1);
+      blk[off + 11] = (unsigned char)(ulen / 2);
+      memcpy(blk + off + 12, user, (size_t)ulen);
+      off += 12 + (unsigned long)ulen;
+      hd->next++;
+      continue;
+    }
+    if (off + 12 > LUAZ_PDSDIR_BLKSIZE)
+      break;
+    /* End of this library's directory; the next library starts in a
+     * new block, as in a DD concatenation. */
+    memset(blk + off, 0xFF, 8);
+    off += 12;
+    hd->concat++;
+    rc = host_dir_load(hd);
+    if (rc < 0)
+      return -1;
+    hd->done = (rc > 0);
+    break;
+  }
+  blk[0] = (unsigned char)(off >> 8);
+  blk[1] = (unsigned char)off;
+  *len = LUAZ_PDSDIR_BLKSIZE;
+  return 0;
+}
+
+/**
+ * @brief Close a directory stand-in.
+ *
+ * @param dir State from host_dir_open.
+ * @return 0.
+ */
+static int host_dir_close(void *dir)
+{
+  struct host_dir *hd = (struct host_dir *)dir;
+
+  if (hd != NULL) {
+    free(hd->names);
+    free(hd);
+  }
+  return 0;
+}
+
+/**
+ * @brief Register directory-backed LUAPATH hooks with the platform layer
+ *        and the ds.members directory stand-in.
+ *
+ * @param root Root directory of the stand-in libraries.
+ * @return 0 on success, or nonzero on failure.
+ */
+int luaz_io_host_register(const char *root)
+{
+  struct luaz_platform_ops ops;
+  struct luaz_dsmem_ops dops;
+  const char *wr;
+  int rc;
+
+  if (root == NULL || root[0] == '\0')
+    return -1;
+  rc = snprintf(g_root, sizeof(g_root), "%s", root);
+  if (rc <= 0 || (size_t)rc >= sizeof(g_root))
+    return -1;
+
+  memset(&ops, 0, sizeof(ops));
+  ops.luapath_read_luamap = host_luamap_read;
+  ops.luapath_read_member = host_member_read;
+  ops.luapath_read_member_alloc = host_member_read_alloc;
+  ops.luapath_list_members = host_list_members;
+  ops.luapath_open_member = host_member_open;
+  ops.luapath_read_stream = host_stream_read;
+  ops.luapath_close_stream = host_stream_close;
+  if (luaz_policy_get_raw("luabc.dd") != NULL) {
+    ops.luabc_read_member_alloc = host_bc_read_alloc;
+    wr = luaz_policy_get_raw("luabc.write");
+    if (wr != NULL && (strcmp(wr, "1") == 0 || wr[0] == 't' || wr[0] == 'T'))
+      ops.luabc_write_member = host_bc_write;
+  }
+  if (luaz_policy_get_raw("luabundle.dd") != NULL)
+    ops.luabundle_read_alloc = host_bundle_read_alloc;
+  dops.open = host_dir_open;
+  dops.read = host_dir_read;
+  dops.close = host_dir_close;
+  luaz_dsmem_set_ops(&dops);
+  return luaz_platform_set_ops(&ops);
+}
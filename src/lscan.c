@@ -0,0 +1,376 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO block-buffered line scanner for dataset streams.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | lscan_ra | struct | Read-ahead ring shared with the producer |
+ * | lscan_producer | function | Read-ahead thread body |
+ * | lscan_ra_take | function | Hand the next filled ring block to the scanner |
+ * | lscan_ra_stop | function | Stop and join the producer, free the ring |
+ * | lscan_fill | function | Refill the block buffer with one fread |
+ * | luaz_lscan_init | function | Attach a scanner to a stream |
+ * | luaz_lscan_free | function | Release the block buffer |
+ * | luaz_lscan_find_nl | function | Word-at-a-time newline search |
+ * | luaz_lscan_next | function | Return the next line or line segment |
+ * | luaz_lscan_read | function | Read bytes through the block buffer |
+ * | luaz_lscan_at_eof | function | Test for end of data |
+ * | luaz_lscan_readahead | function | Start a read-ahead producer thread |
+ *
+ * Platform Requirements:
+ * - Portable C; also built off-host for tests/bench/lscanbench.c.
+ * - The newline byte is the compiler's '\n' (0x15 in EBCDIC text).
+ * - Read-ahead uses POSIX threads: LE POSIX(ON) on z/OS, -lpthread
+ *   off-host.
+ */
+#if defined(__MVS__) && !defined(_UNIX03_THREADS)
+#define _UNIX03_THREADS
+#endif
+
+#include "LSCAN"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Word-at-a-time search: a word w has a zero byte when
+ * (w - ONES) & ~w & HIGHS is nonzero; XOR with the repeated newline turns
+ * newline bytes into zero bytes. */
+#define LSCAN_ONES ((size_t)-1 / 0xFFu)
+#define LSCAN_HIGHS (LSCAN_ONES * 0x80u)
+#define LSCAN_HAS_ZERO(w) (((w) - LSCAN_ONES) & ~(w) & LSCAN_HIGHS)
+
+/* Read-ahead ring: slots [head, head + held + count) are owned by the
+ * scanner (held) or filled and waiting (count); the producer fills tail. */
+struct lscan_ra {
+  pthread_mutex_t mu;
+  pthread_cond_t cv_full;
+  pthread_cond_t cv_free;
+  pthread_t th;
+  FILE *fp;
+  size_t cap;
+  int nslots;
+  char *slot[LUAZ_LSCAN_RA_MAX + 1];
+  size_t slot_len[LUAZ_LSCAN_RA_MAX + 1];
+  int head;
+  int tail;
+  int count;
+  int held;
+  int stop;
+  int done;
+  int err;
+};
+
+/**
+ * @brief Read-ahead thread body: fill free ring slots until EOF or stop.
+ *
+ * @param arg Ring (struct lscan_ra *).
+ * @return NULL.
+ */
+static void *lscan_producer(void *arg)
+{
+  struct lscan_ra *ra = (struct lscan_ra *)arg;
+
+  for (;;) {
+    int idx;
+    size_t n;
+
+    pthread_mutex_lock(&ra->mu);
+    while (!ra->stop && ra->count + ra->held >= ra->nslots)
+      pthread_cond_wait(&ra->cv_free, &ra->mu);
+    if (ra->stop) {
+      pthread_mutex_unlock(&ra->mu);
+      break;
+    }
+    idx = ra->tail;
+    pthread_mutex_unlock(&ra->mu);
+
+    n = fread(ra->slot[idx], 1, ra->cap, ra->fp);
+
+    pthread_mutex_lock(&ra->mu);
+    ra->slot_len[idx] = n;
+    if (n > 0) {
+      ra->tail = (ra->tail + 1) % ra->nslots;
+      ra->count++;
+    }
+    if (n < ra->cap) {
+      ra->done = 1;
+      ra->err = ferror(ra->fp) ? 1 : 0;
+    }
+    pthread_cond_signal(&ra->cv_full);
+    pthread_mutex_unlock(&ra->mu);
+    if (n < ra->cap)
+      break;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Release the scanner's block and take the next filled one.
+ *
+ * @param s Scanner state with read-ahead.
+ * @return Number of bytes now buffered (0 at EOF or on error).
+ */
+static size_t lscan_ra_take(struct luaz_lscan *s)
+{
+  struct lscan_ra *ra = (struct lscan_ra *)s->ra;
+  size_t n = 0;
+
+  pthread_mutex_lock(&ra->mu);
+  if (ra->held) {
+    ra->held = 0;
+    ra->head = (ra->head + 1) % ra->nslots;
+    pthread_cond_signal(&ra->cv_free);
+  }
+  while (ra->count == 0 && !ra->done)
+    pthread_cond_wait(&ra->cv_full, &ra->mu);
+  if (ra->count > 0) {
+    s->blk = ra->slot[ra->head];
+    n = ra->slot_len[ra->head];
+    ra->count--;
+    ra->held = 1;
+  }
+  if (ra->count == 0 && ra->done) {
+    s->eof = !ra->err;
+    s->err = ra->err;
+  }
+  pthread_mutex_unlock(&ra->mu);
+  s->len = n;
+  return n;
+}
+
+/**
+ * @brief Stop and join the producer thread and free the ring.
+ *
+ * @param s Scanner state with read-ahead.
+ */
+static void lscan_ra_stop(struct luaz_lscan *s)
+{
+  struct lscan_ra *ra = (struct lscan_ra *)s->ra;
+  int i;
+
+  pthread_mutex_lock(&ra->mu);
+  ra->stop = 1;
+  pthread_cond_broadcast(&ra->cv_free);
+  pthread_mutex_unlock(&ra->mu);
+  pthread_join(ra->th, NULL);
+  pthread_cond_destroy(&ra->cv_full);
+  pthread_cond_destroy(&ra->cv_free);
+  pthread_mutex_destroy(&ra->mu);
+  for (i = 0; i < ra->nslots; i++)
+    free(ra->slot[i]);
+  free(ra);
+  s->ra = NULL;
+  s->blk = NULL;
+}
+
+/**
+ * @brief Refill the block buffer with one fread (or from the ring).
+ *
+ * @param s Scanner state (block fully consumed).
+ * @return Number of bytes now buffered (0 at EOF or on error).
+ */
+static size_t lscan_fill(struct luaz_lscan *s)
+{
+  size_t n;
+
+  s->pos = 0;
+  s->len = 0;
+  if (s->ra != NULL)
+    return lscan_ra_take(s);
+  if (s->eof || s->err)
+    return 0;
+  n = fread(s->blk, 1, s->cap, s->fp);
+  if (n < s->cap) {
+    if (ferror(s->fp))
+      s->err = 1;
+    else
+      s->eof = 1;
+  }
+  s->len = n;
+  return n;
+}
+
+int luaz_lscan_init(struct luaz_lscan *s, FILE *fp, size_t cap)
+{
+  if (s == NULL || fp == NULL)
+    return -1;
+  if (cap == 0)
+    cap = LUAZ_LSCAN_BLOCK_DEFAULT;
+  if (cap < LUAZ_LSCAN_BLOCK_MIN)
+    cap = LUAZ_LSCAN_BLOCK_MIN;
+  memset(s, 0, sizeof(*s));
+  s->blk = (char *)malloc(cap);
+  if (s->blk == NULL)
+    return -1;
+  s->fp = fp;
+  s->cap = cap;
+  return 0;
+}
+
+void luaz_lscan_free(struct luaz_lscan *s)
+{
+  if (s == NULL)
+    return;
+  if (s->ra != NULL)
+    lscan_ra_stop(s);
+  free(s->blk);
+  s->blk = NULL;
+  s->cap = 0;
+  s->pos = 0;
+  s->len = 0;
+}
+
+const char *luaz_lscan_find_nl(const char *p, size_t n)
+{
+  const size_t pat = LSCAN_ONES * (unsigned char)'\n';
+  const char *end = p + n;
+
+  while (p < end && ((size_t)p & (sizeof(size_t) - 1)) != 0) {
+    if (*p == '\n')
+      return p;
+    p++;
+  }
+  while ((size_t)(end - p) >= sizeof(size_t)) {
+    size_t w;
+    memcpy(&w, p, sizeof(w));
+    w ^= pat;
+    if (LSCAN_HAS_ZERO(w))
+      break;
+    p += sizeof(size_t);
+  }
+  while (p < end) {
+    if (*p == '\n')
+      return p;
+    p++;
+  }
+  return NULL;
+}
+
+int luaz_lscan_next(struct luaz_lscan *s, const char **out, size_t *len)
+{
+  const char *start;
+  const char *nl;
+  size_t avail;
+
+  if (s->pos >= s->len && lscan_fill(s) == 0)
+    return s->err ? -1 : LUAZ_LSCAN_EOF;
+  start = s->blk + s->pos;
+  avail = s->len - s->pos;
+  nl = luaz_lscan_find_nl(start, avail);
+  *out = start;
+  if (nl != NULL) {
+    *len = (size_t)(nl - start);
+    s->pos += *len + 1;
+    s->nl = 1;
+    return LUAZ_LSCAN_LINE;
+  }
+  *len = avail;
+  s->pos = s->len;
+  s->nl = 0;
+  /* A short block means the stream ended: the unterminated tail is the
+   * last line. */
+  if (s->eof)
+    return LUAZ_LSCAN_LINE;
+  return LUAZ_LSCAN_PART;
+}
+
+size_t luaz_lscan_read(struct luaz_lscan *s, void *dst, size_t n)
+{
+  char *d = (char *)dst;
+  size_t done = 0;
+  size_t avail = s->len - s->pos;
+
+  if (avail > 0) {
+    size_t k = (avail < n) ? avail : n;
+    memcpy(d, s->blk + s->pos, k);
+    s->pos += k;
+    done = k;
+  }
+  if (done == n || s->eof || s->err)
+    return done;
+  /* Large reads bypass the block (synchronous mode only); small ones
+   * refill it. */
+  if (s->ra == NULL && n - done >= s->cap) {
+    size_t got = fread(d + done, 1, n - done, s->fp);
+    if (got < n - done) {
+      if (ferror(s->fp))
+        s->err = 1;
+      else
+        s->eof = 1;
+    }
+    return done + got;
+  }
+  while (done < n && lscan_fill(s) > 0) {
+    size_t k = s->len;
+    if (k > n - done)
+      k = n - done;
+    memcpy(d + done, s->blk, k);
+    s->pos = k;
+    done += k;
+  }
+  return done;
+}
+
+int luaz_lscan_readahead(struct luaz_lscan *s, int nblocks)
+{
+  struct lscan_ra *ra;
+  int i;
+  int rc;
+
+  if (s == NULL || s->ra != NULL || s->blk == NULL || nblocks < 1 ||
+      nblocks > LUAZ_LSCAN_RA_MAX || s->len != 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  ra = (struct lscan_ra *)calloc(1, sizeof(*ra));
+  if (ra == NULL) {
+    errno = ENOMEM;
+    return -1;
+  }
+  ra->fp = s->fp;
+  ra->cap = s->cap;
+  ra->nslots = nblocks + 1;
+  /* The scanner's own block becomes slot 0. */
+  ra->slot[0] = s->blk;
+  for (i = 1; i < ra->nslots; i++) {
+    ra->slot[i] = (char *)malloc(s->cap);
+    if (ra->slot[i] == NULL)
+      break;
+  }
+  rc = (i < ra->nslots) ? ENOMEM : pthread_mutex_init(&ra->mu, NULL);
+  if (rc != 0) {
+    while (--i > 0)
+      free(ra->slot[i]);
+    free(ra);
+    errno = rc;
+    return -1;
+  }
+  pthread_cond_init(&ra->cv_full, NULL);
+  pthread_cond_init(&ra->cv_free, NULL);
+  rc = pthread_create(&ra->th, NULL, lscan_producer, ra);
+  if (rc != 0) {
+    pthread_cond_destroy(&ra->cv_full);
+    pthread_cond_destroy(&ra->cv_free);
+    pthread_mutex_destroy(&ra->mu);
+    for (i = 1; i < ra->nslots; i++)
+      free(ra->slot[i]);
+    free(ra);
+    errno = rc;
+    return -1;
+  }
+  s->ra = ra;
+  return 0;
+}
+
+int luaz_lscan_at_eof(struct luaz_lscan *s)
+{
+  if (s->pos < s->len)
+    return 0;
+  if (lscan_fill(s) > 0)
+    return 0;
+  return s->err ? -1 : 1;
+}
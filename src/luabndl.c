@@ -0,0 +1,371 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Purpose:
+ *   Application bundle packer. Reads a module list, loads each module
+ *   source (optionally compiling it to bytecode) and writes one bundle
+ *   image for the luabundle.dd searcher.
+ *
+ * Usage:
+ *   LUABNDL [-c] [-s] <list> <out>
+ *     -c  store lua_dump output instead of source
+ *     -s  strip debug information (with -c)
+ *   On z/OS: PARM='/-c //DD:SYSIN //DD:BUNDLE'.
+ *   List lines: "<module.name> <path>"; blank lines and lines starting
+ *   with '*' or '#' are ignored. <path> is any fopen() name, for example
+ *   //DD:APPSRC(MAIN) or //'HLQ.APP.LUA(MAIN)'.
+ *
+ * Platform requirements:
+ *   - Runs under z/OS LE (31-bit is fine) or off-host.
+ *   - Names and sources are stored as read (EBCDIC on z/OS); pack the
+ *     bundle on the platform that runs it.
+ *   - Bytecode (-c) is produced by the linked Lua core, so it matches
+ *     LUAEXEC built from the same sources.
+ *
+ * Objects in this file:
+ * +-------------------+----------------------------------------------+
+ * | Object            | Description                                  |
+ * +-------------------+----------------------------------------------+
+ * | bndl_module       | Module list entry with its loaded blob       |
+ * | bndl_read_file    | Read a module file (text or precompiled)     |
+ * | bndl_dump_writer  | lua_Writer appending to a growable buffer    |
+ * | bndl_compile      | Compile source to bytecode via lua_dump      |
+ * | bndl_parse_list   | Parse the module list                        |
+ * | main              | Packer entrypoint                            |
+ * +-------------------+----------------------------------------------+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "BUNDLE"
+#include "LUA"
+#include "LAUXLIB"
+
+#define LUZ40020 "LUZ40020 invalid arguments"
+#define LUZ40021 "LUZ40021 unable to read module list"
+#define LUZ40022 "LUZ40022 unable to read module source"
+#define LUZ40023 "LUZ40023 module compile failed"
+#define LUZ40024 "LUZ40024 unable to build bundle"
+#define LUZ40025 "LUZ40025 unable to write bundle"
+#define LUZ40026 "LUZ40026 bundle written"
+
+#define BNDL_LINE_MAX 512u
+#define BNDL_READ_CHUNK 4096u
+
+typedef struct bndl_module {
+  char *name;
+  char *path;
+  char *data;
+  unsigned long len;
+} bndl_module;
+
+typedef struct bndl_buf {
+  char *b;
+  size_t n;
+  size_t cap;
+} bndl_buf;
+
+/**
+ * @brief Append bytes to a growable buffer.
+ *
+ * @param buf Buffer.
+ * @param p Bytes to append.
+ * @param n Number of bytes.
+ * @return 0 on success, or -1 on allocation failure.
+ */
+static int bndl_append(bndl_buf *buf, const void *p, size_t n)
+{
+  if (buf->n + n > buf->cap) {
+    size_t next = (buf->cap == 0) ? BNDL_READ_CHUNK : buf->cap * 2;
+    char *nb;
+    while (next < buf->n + n)
+      next *= 2;
+    nb = (char *)realloc(buf->b, next);
+    if (nb == NULL)
+      return -1;
+    buf->b = nb;
+    buf->cap = next;
+  }
+  memcpy(buf->b + buf->n, p, n);
+  buf->n += n;
+  return 0;
+}
+
+/**
+ * @brief Read a module file into a heap buffer.
+ *
+ * Precompiled chunks (first byte ESC) are read in binary mode; sources
+ * are read in text mode so record datasets yield newline-ended lines.
+ *
+ * @param path fopen() name.
+ * @param out Output buffer (caller frees).
+ * @param len Output length.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bndl_read_file(const char *path, char **out, unsigned long *len)
+{
+  bndl_buf buf = {NULL, 0, 0};
+  char tmp[BNDL_READ_CHUNK];
+  FILE *fp;
+  int c;
+  size_t n;
+
+  fp = fopen(path, "rb");
+  if (fp == NULL)
+    return -1;
+  c = getc(fp);
+  if (c != LUA_SIGNATURE[0]) {
+    fclose(fp);
+    fp = fopen(path, "r");
+    if (fp == NULL)
+      return -1;
+  }
+  else {
+    char ch = (char)c;
+    if (bndl_append(&buf, &ch, 1) != 0) {
+      fclose(fp);
+      return -1;
+    }
+  }
+  while ((n = fread(tmp, 1, sizeof(tmp), fp)) > 0) {
+    if (bndl_append(&buf, tmp, n) != 0) {
+      free(buf.b);
+      fclose(fp);
+      return -1;
+    }
+  }
+  if (ferror(fp)) {
+    free(buf.b);
+    fclose(fp);
+    return -1;
+  }
+  fclose(fp);
+  *out = buf.b;
+  *len = (unsigned long)buf.n;
+  return 0;
+}
+
+static int bndl_dump_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+  (void)L;
+  return bndl_append((bndl_buf *)ud, p, sz);
+}
+
+/**
+ * @brief Replace a module source with its lua_dump output.
+ *
+ * The chunk name matches the one the bundle searcher uses (module name).
+ *
+ * @param L Lua state.
+ * @param m Module (data replaced on success).
+ * @param strip Nonzero to strip debug information.
+ * @return 0 on success, or -1 on compile/dump failure.
+ */
+static int bndl_compile(lua_State *L, bndl_module *m, int strip)
+{
+  bndl_buf buf = {NULL, 0, 0};
+
+  if (m->len > 0 && m->data[0] == LUA_SIGNATURE[0])
+    return 0;  /* already precompiled */
+  if (luaL_loadbufferx(L, m->data, (size_t)m->len, m->name, "t") !=
+      LUA_OK) {
+    fprintf(stderr, "%s: %s\n", LUZ40023, lua_tostring(L, -1));
+    lua_pop(L, 1);
+    return -1;
+  }
+  if (lua_dump(L, bndl_dump_writer, &buf, strip) != 0) {
+    fprintf(stderr, "%s: %s (lua_dump)\n", LUZ40023, m->name);
+    lua_pop(L, 1);
+    free(buf.b);
+    return -1;
+  }
+  lua_pop(L, 1);
+  free(m->data);
+  m->data = buf.b;
+  m->len = (unsigned long)buf.n;
+  return 0;
+}
+
+/**
+ * @brief Duplicate a token into a NUL-terminated heap string.
+ */
+static char *bndl_strndup(const char *s, size_t n)
+{
+  char *p = (char *)malloc(n + 1);
+  if (p == NULL)
+    return NULL;
+  memcpy(p, s, n);
+  p[n] = '\0';
+  return p;
+}
+
+/**
+ * @brief Parse the module list into an array of modules.
+ *
+ * @param path fopen() name of the list.
+ * @param out Output module array (caller frees).
+ * @param count Output number of modules.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bndl_parse_list(const char *path, bndl_module **out,
+                           unsigned long *count)
+{
+  char line[BNDL_LINE_MAX];
+  bndl_module *mods = NULL;
+  unsigned long n = 0;
+  unsigned long cap = 0;
+  FILE *fp;
+
+  fp = fopen(path, "r");
+  if (fp == NULL)
+    return -1;
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    char *p = line;
+    char *name;
+    char *file;
+    size_t nlen;
+    size_t flen;
+
+    while (*p != '\0' && isspace((unsigned char)*p))
+      p++;
+    if (*p == '\0' || *p == '*' || *p == '#')
+      continue;
+    name = p;
+    while (*p != '\0' && !isspace((unsigned char)*p))
+      p++;
+    nlen = (size_t)(p - name);
+    while (*p != '\0' && isspace((unsigned char)*p))
+      p++;
+    file = p;
+    while (*p != '\0' && !isspace((unsigned char)*p))
+      p++;
+    flen = (size_t)(p - file);
+    if (flen == 0) {
+      fclose(fp);
+      free(mods);
+      return -1;
+    }
+    if (n == cap) {
+      unsigned long next = (cap == 0) ? 64 : cap * 2;
+      bndl_module *nm = (bndl_module *)realloc(mods, next * sizeof(*mods));
+      if (nm == NULL) {
+        fclose(fp);
+        free(mods);
+        return -1;
+      }
+      mods = nm;
+      cap = next;
+    }
+    memset(&mods[n], 0, sizeof(mods[n]));
+    mods[n].name = bndl_strndup(name, nlen);
+    mods[n].path = bndl_strndup(file, flen);
+    if (mods[n].name == NULL || mods[n].path == NULL) {
+      fclose(fp);
+      free(mods);
+      return -1;
+    }
+    n++;
+  }
+  fclose(fp);
+  *out = mods;
+  *count = n;
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *list = NULL;
+  const char *outp = NULL;
+  int compile = 0;
+  int strip = 0;
+  bndl_module *mods = NULL;
+  struct luaz_bundle_item *items = NULL;
+  unsigned long count = 0;
+  unsigned long i;
+  char *img = NULL;
+  unsigned long img_len = 0;
+  lua_State *L = NULL;
+  FILE *fp;
+  int rc = 8;
+  int a;
+
+  for (a = 1; a < argc; a++) {
+    if (strcmp(argv[a], "-c") == 0)
+      compile = 1;
+    else if (strcmp(argv[a], "-s") == 0)
+      strip = 1;
+    else if (list == NULL)
+      list = argv[a];
+    else if (outp == NULL)
+      outp = argv[a];
+    else
+      break;
+  }
+  if (list == NULL || outp == NULL || a < argc) {
+    fprintf(stderr, "%s: LUABNDL [-c] [-s] <list> <out>\n", LUZ40020);
+    return 8;
+  }
+
+  if (bndl_parse_list(list, &mods, &count) != 0) {
+    fprintf(stderr, "%s: %s\n", LUZ40021, list);
+    return 8;
+  }
+  if (compile) {
+    L = luaL_newstate();
+    if (L == NULL)
+      goto done;
+  }
+  items = (struct luaz_bundle_item *)calloc(count > 0 ? count : 1,
+                                            sizeof(*items));
+  if (items == NULL)
+    goto done;
+  for (i = 0; i < count; i++) {
+    if (bndl_read_file(mods[i].path, &mods[i].data, &mods[i].len) != 0) {
+      fprintf(stderr, "%s: %s (%s)\n", LUZ40022, mods[i].path,
+              mods[i].name);
+      goto done;
+    }
+    if (compile && bndl_compile(L, &mods[i], strip) != 0)
+      goto done;
+    items[i].name = mods[i].name;
+    items[i].data = mods[i].data;
+    items[i].len = mods[i].len;
+  }
+
+  if (luaz_bundle_build(items, count, &img, &img_len) != 0) {
+    fprintf(stderr, "%s: duplicate or empty module name\n", LUZ40024);
+    goto done;
+  }
+  fp = fopen(outp, "wb");
+  if (fp == NULL) {
+    fprintf(stderr, "%s: %s\n", LUZ40025, outp);
+    goto done;
+  }
+  if (fwrite(img, 1, (size_t)img_len, fp) != (size_t)img_len) {
+    fclose(fp);
+    fprintf(stderr, "%s: %s\n", LUZ40025, outp);
+    goto done;
+  }
+  if (fclose(fp) != 0) {
+    fprintf(stderr, "%s: %s\n", LUZ40025, outp);
+    goto done;
+  }
+  printf("%s modules=%lu bytes=%lu\n", LUZ40026, count, img_len);
+  rc = 0;
+
+done:
+  if (L != NULL)
+    lua_close(L);
+  free(img);
+  free(items);
+  for (i = 0; i < count; i++) {
+    free(mods[i].name);
+    free(mods[i].path);
+    free(mods[i].data);
+  }
+  free(mods);
+  return rc;
+}
@@ -19,7 +19,15 @@
  * | luaexec_publish_config | function | Publish LUAZ_CONFIG table |
  * | luaexec_copy_ddname | function | Normalize DDNAME from config |
  * | luaexec_run_line | function | Run LUAEXEC for LUACMD (TSO path) |
+ * | luain_reader | type | LUAIN record reader state for lua_load |
+ * | luain_read_record | function | lua_Reader yielding one LUAIN record |
  * | lua_tso_luain_load | function | Load LUAIN with VB/FB80 record support |
+ * | luaexec_preload_ent | type | Preload manifest entry (name, member) |
+ * | luaexec_preload_cmp | function | Order manifest entries by directory |
+ * | luaexec_preload_set | function | Store a chunk in package.preload |
+ * | luaexec_preload_member | function | Compile one LUAPATH member for preload |
+ * | luaexec_preload_max | function | Read the luapreload.max manifest limit |
+ * | luaexec_preload | function | Compile modules listed in the preload manifest |
  *
  * Platform Requirements:
  * - LE: required (C runtime).
@@ -28,6 +36,7 @@
  * - DDNAME I/O: script input via `DD:LUAIN`.
  */
 #include "IODD"
+#include "PATH"
 #include "LUA"
 #include "LAUXLIB"
 #include "LUALIB"
@@ -45,6 +54,7 @@
 
 extern int luaopen_tso(lua_State *L);
 extern int luaopen_ds(lua_State *L);
+extern int luaopen_codec(lua_State *L);
 
 typedef struct luaexec_parm {
   const char *dsn;
@@ -378,11 +388,52 @@ static void luaexec_close_luaout(void)
   g_luaout_fp = NULL;
 }
 
+/**
+ * @brief LUAIN record reader state for lua_load.
+ */
+typedef struct luain_reader {
+  FILE *fp;
+  char *rec;
+  size_t rec_cap;
+  int err;
+} luain_reader;
+
+/**
+ * @brief lua_Reader returning one trimmed, newline-terminated LUAIN record.
+ *
+ * @param L Lua state (unused).
+ * @param ud luain_reader state.
+ * @param size Output block size.
+ * @return Record text, or NULL at end of input or on read error.
+ */
+static const char *luain_read_record(lua_State *L, void *ud, size_t *size)
+{
+  luain_reader *rd = (luain_reader *)ud;
+  size_t n;
+
+  (void)L;
+  n = fread(rd->rec, 1u, rd->rec_cap, rd->fp);
+  if (n == 0) {
+    if (ferror(rd->fp))
+      rd->err = 1;
+    return NULL;
+  }
+  while (n > 0 &&
+         (rd->rec[n - 1] == ' ' || rd->rec[n - 1] == '\0' ||
+          rd->rec[n - 1] == '\r' || rd->rec[n - 1] == '\n')) {
+    n--;
+  }
+  rd->rec[n++] = '\n';
+  *size = n;
+  return rd->rec;
+}
+
 /**
  * @brief Load Lua chunk from DD:LUAIN with VB/FB80 record support.
  *
- * This loader reads LUAIN using record I/O where possible and builds
- * a newline-delimited buffer so fixed records (FB80) are handled.
+ * This loader reads LUAIN using record I/O where possible and feeds each
+ * record, trimmed and newline-terminated, to the parser so fixed records
+ * (FB80) are handled.
  *
  * @param L Lua state.
  * @param script DD:LUAIN path string.
@@ -390,14 +441,9 @@ static void luaexec_close_luaout(void)
  */
 static int lua_tso_luain_load(lua_State *L, const char *script)
 {
-  FILE *fp = NULL;
   char path[32];
-  char *rec = NULL;
-  char *chunk = NULL;
-  size_t rec_cap = 32760u;
-  size_t chunk_len = 0;
-  size_t chunk_cap = 0;
-  int rc = LUA_ERRFILE;
+  luain_reader rd;
+  int rc;
 
   if (script == NULL || script[0] == '\0') {
     lua_pushstring(L, "LUAIN script path is empty");
@@ -411,68 +457,256 @@ static int lua_tso_luain_load(lua_State *L, const char *script)
   /* Change note: add LUAIN record loader for FB80/VB support.
    * Problem: luaL_loadfile on DD:LUAIN is byte-stream oriented and does not
    * reliably handle fixed-length records supplied by JCL (FB80).
-   * Expected effect: build a newline-delimited buffer using record I/O so
+   * Expected effect: feed newline-terminated records using record I/O so
    * LUAIN works for VB and FB80 datasets.
    * Impact: LUAEXEC loads from DD:LUAIN using fread record I/O when possible.
    * Ref: src/luaexec.md#luain-record-io
    */
-  fp = fopen(path, "rb,type=record");
-  if (fp == NULL)
-    fp = fopen(path, "rb,recfm=FB,lrecl=80");
-  if (fp == NULL)
+  memset(&rd, 0, sizeof(rd));
+  rd.fp = fopen(path, "rb,type=record");
+  if (rd.fp == NULL)
+    rd.fp = fopen(path, "rb,recfm=FB,lrecl=80");
+  if (rd.fp == NULL)
     return luaL_loadfile(L, path);
 
-  rec = (char *)malloc(rec_cap);
-  if (rec == NULL) {
-    fclose(fp);
+  /* Change note: stream LUAIN records into lua_load.
+   * Problem: the whole script was assembled in a realloc-doubled buffer
+   * before parsing, costing O(log n) reallocs and a full copy.
+   * Expected effect: the parser pulls one record at a time.
+   * Impact: loader memory stays at one record (plus the newline byte).
+   */
+  rd.rec_cap = 32760u;
+  rd.rec = (char *)malloc(rd.rec_cap + 1u);
+  if (rd.rec == NULL) {
+    fclose(rd.fp);
     lua_pushstring(L, "LUAIN record buffer alloc failed");
     return LUA_ERRMEM;
   }
 
-  while (1) {
-    size_t n = fread(rec, 1u, rec_cap, fp);
-    if (n == 0) {
-      if (ferror(fp)) {
-        rc = LUA_ERRFILE;
-        lua_pushstring(L, "LUAIN record read failed");
-        goto cleanup;
-      }
-      break;
+  rc = lua_load(L, luain_read_record, &rd, path, NULL);
+  if (rd.err) {
+    lua_pop(L, 1);  /* drop the chunk or the load error */
+    lua_pushstring(L, "LUAIN record read failed");
+    rc = LUA_ERRFILE;
+  }
+
+  free(rd.rec);
+  fclose(rd.fp);
+  return rc;
+}
+
+/* Manifest size: luapreload.max entries (default LUAEXEC_PRELOAD_MAX,
+ * at most LUAEXEC_PRELOAD_LIMIT). */
+#define LUAEXEC_PRELOAD_MAX 1024ul
+#define LUAEXEC_PRELOAD_LIMIT 65535ul
+
+/**
+ * @brief One module listed in the preload manifest.
+ */
+typedef struct luaexec_preload_ent {
+  const char *name;
+  char member[9];
+  int concat;
+  unsigned long seq;
+} luaexec_preload_ent;
+
+/**
+ * @brief qsort comparator: LUAPATH concatenation, then member name.
+ *
+ * PDS directories are kept in member-name order, so this is the order in
+ * which the members sit in each library's directory.
+ */
+static int luaexec_preload_cmp(const void *a, const void *b)
+{
+  const luaexec_preload_ent *x = (const luaexec_preload_ent *)a;
+  const luaexec_preload_ent *y = (const luaexec_preload_ent *)b;
+  int rc;
+
+  if (x->concat != y->concat)
+    return (x->concat < y->concat) ? -1 : 1;
+  rc = strcmp(x->member, y->member);
+  if (rc != 0)
+    return rc;
+  return (x->seq < y->seq) ? -1 : (x->seq > y->seq);
+}
+
+/**
+ * @brief Store the chunk on top of the stack as package.preload[name].
+ *
+ * @param L Lua state (chunk on top; popped).
+ * @param name Module name.
+ */
+static void luaexec_preload_set(lua_State *L, const char *name)
+{
+  luaL_getsubtable(L, LUA_REGISTRYINDEX, LUA_PRELOAD_TABLE);
+  lua_insert(L, -2);
+  lua_setfield(L, -2, name);
+  lua_pop(L, 1);
+}
+
+/**
+ * @brief Compile one LUAPATH member and install it in package.preload.
+ *
+ * Compiles through luaz_path_load_chunk(), the bytecode cache probe and
+ * write-back that require uses.
+ *
+ * @param L Lua state.
+ * @param e Manifest entry with a resolved member.
+ * @return 0 on success, or -1 with an error message pushed.
+ */
+static int luaexec_preload_member(lua_State *L, const luaexec_preload_ent *e)
+{
+  char *buf = NULL;
+  unsigned long buflen = 0;
+  int status;
+
+  if (luaz_path_load_alloc(e->name, e->member, &buf, &buflen) != 0 ||
+      buflen == 0) {
+    free(buf);
+    lua_pushfstring(L, "LUZ47003 LUAPATH load failed for '%s'", e->name);
+    return -1;
+  }
+  status = luaz_path_load_chunk(L, e->member, buf, buflen);
+  free(buf);
+  if (status != LUA_OK)
+    return -1;
+  luaexec_preload_set(L, e->name);
+  return 0;
+}
+
+/**
+ * @brief Return the luapreload.max manifest limit.
+ *
+ * @return Entry limit (1..LUAEXEC_PRELOAD_LIMIT).
+ */
+static unsigned long luaexec_preload_max(void)
+{
+  const char *value = luaz_policy_get_raw("luapreload.max");
+  unsigned long max;
+
+  if (value == NULL || value[0] == '\0')
+    return LUAEXEC_PRELOAD_MAX;
+  max = strtoul(value, NULL, 10);
+  if (max == 0)
+    return LUAEXEC_PRELOAD_MAX;
+  return (max > LUAEXEC_PRELOAD_LIMIT) ? LUAEXEC_PRELOAD_LIMIT : max;
+}
+
+/**
+ * @brief Compile the modules named by the preload manifest.
+ *
+ * The manifest is the LUAPATH member named by luapreload.member: one
+ * module name per line (first token; blank lines and lines starting with
+ * '*' or '#' are ignored). Modules found in the application bundle are
+ * taken from it; the rest are resolved through LUAMAP, sorted into
+ * directory order and read in one sweep. Each chunk is stored in
+ * package.preload, so require() runs it without dataset I/O.
+ *
+ * @param L Lua state with the standard libraries open.
+ * @param manifest Manifest member name (empty or NULL: nothing to do).
+ * @return 0 on success, or -1 with an error message pushed.
+ */
+static int luaexec_preload(lua_State *L, const char *manifest)
+{
+  luaexec_preload_ent *ents = NULL;
+  unsigned long max = luaexec_preload_max();
+  unsigned long count = 0;
+  unsigned long i;
+  char *buf = NULL;
+  unsigned long len = 0;
+  char *text = NULL;
+  char *p;
+  char *next;
+  int rc = -1;
+
+  if (manifest == NULL || manifest[0] == '\0')
+    return 0;
+  if (luaz_path_load_alloc(manifest, manifest, &buf, &len) != 0) {
+    free(buf);
+    lua_pushfstring(L, "manifest member %s not readable", manifest);
+    return -1;
+  }
+  ents = (luaexec_preload_ent *)calloc(max, sizeof(*ents));
+  if (ents == NULL) {
+    free(buf);
+    lua_pushstring(L, "preload table alloc failed");
+    return -1;
+  }
+
+  /* Split the manifest in place; names point into text. */
+  text = (char *)malloc((size_t)len + 1u);
+  if (text == NULL) {
+    lua_pushstring(L, "preload manifest alloc failed");
+    goto done;
+  }
+  memcpy(text, buf, (size_t)len);
+  text[len] = '\0';
+  for (p = text; p != NULL; p = next) {
+    char *line = p;
+    char *tok;
+    next = strchr(p, '\n');
+    if (next != NULL)
+      *next++ = '\0';
+    tok = line;
+    while (*tok != '\0' && isspace((unsigned char)*tok))
+      tok++;
+    if (*tok == '\0' || *tok == '*' || *tok == '#')
+      continue;
+    line = tok;
+    while (*tok != '\0' && !isspace((unsigned char)*tok))
+      tok++;
+    *tok = '\0';
+    if (count == max) {
+      lua_pushfstring(L, "manifest %s lists more than %d modules; raise "
+                         "luapreload.max",
+                      manifest, (int)max);
+      goto done;
     }
-    while (n > 0 &&
-           (rec[n - 1] == ' ' || rec[n - 1] == '\0' ||
-            rec[n - 1] == '\r' || rec[n - 1] == '\n')) {
-      n--;
+    ents[count].name = line;
+    ents[count].seq = count;
+    count++;
+  }
+
+  /* Bundle entries are already in storage; LUAPATH ones get a member. */
+  for (i = 0; i < count; i++) {
+    luaexec_preload_ent *e = &ents[i];
+    unsigned long mlen = sizeof(e->member);
+    const char *data = NULL;
+    unsigned long dlen = 0;
+    int brc = luaz_path_bundle_find(e->name, &data, &dlen);
+
+    if (brc == 1) {
+      if (luaL_loadbufferx(L, data, (size_t)dlen, e->name, NULL) != LUA_OK)
+        goto done;
+      luaexec_preload_set(L, e->name);
+      e->name = NULL;
+      continue;
     }
-    if (chunk_len + n + 1u > chunk_cap) {
-      size_t new_cap = chunk_cap ? chunk_cap * 2u : 1024u;
-      while (new_cap < chunk_len + n + 1u)
-        new_cap *= 2u;
-      chunk = (char *)realloc(chunk, new_cap);
-      if (chunk == NULL) {
-        rc = LUA_ERRMEM;
-        lua_pushstring(L, "LUAIN chunk alloc failed");
-        goto cleanup;
-      }
-      chunk_cap = new_cap;
+    if (brc != 0 && brc != -1) {
+      lua_pushfstring(L, "LUZ47005 application bundle invalid for '%s'",
+                      e->name);
+      goto done;
     }
-    if (n > 0) {
-      memcpy(chunk + chunk_len, rec, n);
-      chunk_len += n;
+    if (luaz_path_resolve(e->name, e->member, &mlen) != 0 || mlen == 0 ||
+        mlen > 8) {
+      lua_pushfstring(L, "LUZ47002 LUAMAP entry not found for '%s'",
+                      e->name);
+      goto done;
     }
-    chunk[chunk_len++] = '\n';
+    if (luaz_path_member_exists(e->member, &e->concat) != 1)
+      e->concat = 0;
   }
-
-  if (chunk_len == 0) {
-    rc = luaL_loadbuffer(L, "", 0, path);
-  } else {
-    rc = luaL_loadbuffer(L, chunk, chunk_len, path);
+  qsort(ents, (size_t)count, sizeof(*ents), luaexec_preload_cmp);
+  for (i = 0; i < count; i++) {
+    if (ents[i].name != NULL && luaexec_preload_member(L, &ents[i]) != 0)
+      goto done;
   }
+  rc = 0;
 
-cleanup:
-  free(chunk);
-  free(rec);
-  fclose(fp);
+done:
+  free(ents);
+  free(text);
+  free(buf);
   return rc;
 }
 
@@ -498,6 +732,7 @@ static int luaexec_run(int argc, char **argv, const char *mode)
   const char *run_mode = mode;
   const char *cfg_luain = NULL;
   const char *cfg_luaout = NULL;
+  const char *cfg_preload = NULL;
   char luain_ddname[9];
   char luaout_ddname[9];
   char luain_path[32];
@@ -557,6 +792,13 @@ static int luaexec_run(int argc, char **argv, const char *mode)
    */
   luaL_requiref(L, "ds", luaopen_ds, 1);
   lua_pop(L, 1);
+  /* Change note: preload codec module for character set conversion.
+   * Problem: scripts had no way to convert between EBCDIC and UTF-8.
+   * Expected effect: codec.convert is available like tso and ds.
+   * Impact: codec is available through package.loaded and as a global.
+   */
+  luaL_requiref(L, "codec", luaopen_codec, 1);
+  lua_pop(L, 1);
   lua_pushstring(L, run_mode);
   lua_setglobal(L, "LUAZ_MODE");
   luaexec_publish_config(L);
@@ -570,6 +812,22 @@ static int luaexec_run(int argc, char **argv, const char *mode)
   luaexec_redirect_luaout(L, luaout_ddname);
   luaexec_bind_luaout_stdout(L);
 
+  /* Change note: compile the preload manifest before LUAIN.
+   * Problem: each require() resolved its member lazily, scattering
+   * LUAPATH I/O over the whole run.
+   * Expected effect: listed modules are read in directory order in one
+   * sweep and served from package.preload.
+   * Impact: only when luapreload.member is set; a bad entry fails the run.
+   */
+  cfg_preload = luaz_policy_get_raw("luapreload.member");
+  if (luaexec_preload(L, cfg_preload) != 0) {
+    const char *msg = lua_tostring(L, -1);
+    printf("LUZ30057 LUAEXEC preload failed: %s\n", msg ? msg : "?");
+    luaexec_close_luaout();
+    lua_close(L);
+    return 8;
+  }
+
   if (lua_tso_luain_load(L, script) != LUA_OK) {
     const char *msg = lua_tostring(L, -1);
     if (msg)
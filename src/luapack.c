@@ -0,0 +1,200 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Purpose:
+ *   Compressed LUAPATH member packer. Reads a Lua source (or lua_dump)
+ *   member and writes it in the LZMEM format that the LUAPATH loader
+ *   decodes transparently; -d reverses the transformation.
+ *
+ * Usage:
+ *   LUAPACK [-d] [-b <bytes>] <in> <out>
+ *     -d  unpack a compressed member back to its text
+ *     -b  block size in bytes (default 65536, at most 1048576)
+ *   On z/OS: PARM='/-b 65536 //DD:SRC(BIGTAB) //DD:PACKED(BIGTAB)'.
+ *   <in>/<out> are any fopen() names.
+ *
+ * Platform requirements:
+ *   - Runs under z/OS LE (31-bit is fine) or off-host.
+ *   - Sources are read in text mode (one line per record) and compressed
+ *     as read, so pack on the platform that runs the member.
+ *   - Compressed members are written in binary mode; RECFM=VB or U
+ *     libraries avoid FB padding (padding is ignored on load).
+ *
+ * Objects in this file:
+ * +-------------------+----------------------------------------------+
+ * | Object            | Description                                  |
+ * +-------------------+----------------------------------------------+
+ * | pack_read_file    | Read the input member into a heap buffer     |
+ * | pack_write_file   | Write the output member                      |
+ * | main              | Packer entrypoint                            |
+ * +-------------------+----------------------------------------------+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LZMEM"
+
+#define LUZ40030 "LUZ40030 invalid arguments"
+#define LUZ40031 "LUZ40031 unable to read input member"
+#define LUZ40032 "LUZ40032 compressed member invalid"
+#define LUZ40033 "LUZ40033 unable to write output member"
+#define LUZ40034 "LUZ40034 member written"
+
+#define PACK_READ_CHUNK 4096u
+
+/**
+ * @brief Read a member into a heap buffer.
+ *
+ * Precompiled chunks (first byte ESC) and compressed members are read in
+ * binary mode; sources are read in text mode so record datasets yield
+ * newline-ended lines.
+ *
+ * @param path fopen() name.
+ * @param out Output buffer (caller frees).
+ * @param len Output length.
+ * @return 0 on success, or -1 on failure.
+ */
+static int pack_read_file(const char *path, char **out, unsigned long *len)
+{
+  char *buf = NULL;
+  size_t n = 0;
+  size_t cap = 0;
+  size_t got;
+  FILE *fp;
+  int c;
+
+  fp = fopen(path, "rb");
+  if (fp == NULL)
+    return -1;
+  c = getc(fp);
+  if (c != EOF && c != 0x1B && c != LUAZ_LZM_MAGIC0) {
+    fclose(fp);
+    fp = fopen(path, "r");
+    if (fp == NULL)
+      return -1;
+  }
+  else if (c != EOF) {
+    ungetc(c, fp);
+  }
+  for (;;) {
+    if (cap - n < PACK_READ_CHUNK) {
+      size_t next = (cap == 0) ? PACK_READ_CHUNK * 4u : cap * 2u;
+      char *nb = (char *)realloc(buf, next);
+      if (nb == NULL) {
+        free(buf);
+        fclose(fp);
+        return -1;
+      }
+      buf = nb;
+      cap = next;
+    }
+    got = fread(buf + n, 1, cap - n, fp);
+    n += got;
+    if (got == 0)
+      break;
+  }
+  if (ferror(fp)) {
+    free(buf);
+    fclose(fp);
+    return -1;
+  }
+  fclose(fp);
+  *out = buf;
+  *len = (unsigned long)n;
+  return 0;
+}
+
+/**
+ * @brief Write the output member.
+ *
+ * @param path fopen() name.
+ * @param mode fopen() mode ("wb" for compressed, "w" for text).
+ * @param data Bytes to write.
+ * @param len Number of bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int pack_write_file(const char *path, const char *mode,
+                           const char *data, unsigned long len)
+{
+  FILE *fp = fopen(path, mode);
+  int rc;
+
+  if (fp == NULL)
+    return -1;
+  rc = (fwrite(data, 1, (size_t)len, fp) == (size_t)len) ? 0 : -1;
+  if (fclose(fp) != 0)
+    rc = -1;
+  return rc;
+}
+
+int main(int argc, char **argv)
+{
+  const char *inp = NULL;
+  const char *outp = NULL;
+  unsigned long block = 0;
+  int unpack = 0;
+  char *in = NULL;
+  char *out = NULL;
+  unsigned long in_len = 0;
+  unsigned long out_len = 0;
+  int rc = 8;
+  int a;
+
+  for (a = 1; a < argc; a++) {
+    if (strcmp(argv[a], "-d") == 0) {
+      unpack = 1;
+    }
+    else if (strcmp(argv[a], "-b") == 0 && a + 1 < argc) {
+      char *end = NULL;
+      block = strtoul(argv[++a], &end, 10);
+      if (end == NULL || *end != '\0' || block == 0 ||
+          block > LUAZ_LZM_BLOCK_MAX)
+        break;
+    }
+    else if (inp == NULL) {
+      inp = argv[a];
+    }
+    else if (outp == NULL) {
+      outp = argv[a];
+    }
+    else {
+      break;
+    }
+  }
+  if (inp == NULL || outp == NULL || a < argc) {
+    fprintf(stderr, "%s: LUAPACK [-d] [-b <bytes>] <in> <out>\n", LUZ40030);
+    return 8;
+  }
+
+  if (pack_read_file(inp, &in, &in_len) != 0) {
+    fprintf(stderr, "%s: %s\n", LUZ40031, inp);
+    return 8;
+  }
+  if (unpack) {
+    if (luaz_lzm_decode(in, in_len, &out, &out_len) != 0) {
+      fprintf(stderr, "%s: %s\n", LUZ40032, inp);
+      goto done;
+    }
+  }
+  else if (luaz_lzm_parse(in, in_len, NULL) != 0) {
+    fprintf(stderr, "%s: %s is already compressed\n", LUZ40030, inp);
+    goto done;
+  }
+  else if (luaz_lzm_encode(in, in_len, block, &out, &out_len) != 0) {
+    fprintf(stderr, "%s: %s\n", LUZ40032, inp);
+    goto done;
+  }
+  if (pack_write_file(outp, unpack ? "w" : "wb", out, out_len) != 0) {
+    fprintf(stderr, "%s: %s\n", LUZ40033, outp);
+    goto done;
+  }
+  printf("%s in=%lu out=%lu\n", LUZ40034, in_len, out_len);
+  rc = 0;
+
+done:
+  free(in);
+  free(out);
+  return rc;
+}
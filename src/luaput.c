@@ -6,12 +6,18 @@
  * Object Table:
  * | Object | Kind | Purpose |
  * |--------|------|---------|
- * | main | function | Validate LUAMAP lookup and LUAPATH member reads |
+ * | expect_load_alloc | function | Check single-pass member load |
+ * | expect_stream | function | Check block-by-block member reads |
+ * | expect_stat | function | Check a LUAPATH counter value by name |
+ * | expect_lzm | function | Check the compressed member codec round trip |
+ * | main | function | Validate LUAMAP lookup, LUAPATH member reads and index |
  */
 #include "IODD"
+#include "LZMEM"
 #include "PATH"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static int expect_resolve(const char *name, const char *expect)
@@ -41,6 +47,86 @@ static int expect_load(const char *name, const char *member)
   return 1;
 }
 
+static int expect_load_alloc(const char *name, const char *member)
+{
+  char *buf = NULL;
+  unsigned long len = 0;
+  int ok;
+  if (luaz_path_load_alloc(name, member, &buf, &len) != 0 || buf == NULL)
+    return 0;
+  buf[len] = '\0';
+  ok = (len > 0 && strstr(buf, "return") != NULL);
+  free(buf);
+  return ok;
+}
+
+static int expect_stream(const char *name, const char *member)
+{
+  void *stream = NULL;
+  char blk[16];
+  char text[128];
+  unsigned long total = 0;
+  int ok = 1;
+  if (luaz_path_open(name, member, &stream) != 0 || stream == NULL)
+    return 0;
+  for (;;) {
+    unsigned long n = sizeof(blk);
+    if (luaz_path_read(stream, blk, &n) != 0) {
+      ok = 0;
+      break;
+    }
+    if (n == 0)
+      break;
+    if (total + n >= sizeof(text)) {
+      ok = 0;
+      break;
+    }
+    memcpy(text + total, blk, (size_t)n);
+    total += n;
+  }
+  luaz_path_close(stream);
+  text[total] = '\0';
+  return ok && total > 0 && strstr(text, "return") != NULL;
+}
+
+static int expect_stat(const char *name, unsigned long expect)
+{
+  int i;
+  for (i = 0; i < luaz_path_stat_count(); i++) {
+    const char *stat = luaz_path_stat_name(i);
+    if (stat != NULL && strcmp(stat, name) == 0)
+      return luaz_path_stat_value(i) == expect;
+  }
+  return 0;
+}
+
+static int expect_lzm(void)
+{
+  char text[512];
+  char *img = NULL;
+  char *back = NULL;
+  unsigned long img_len = 0;
+  unsigned long back_len = 0;
+  unsigned long len = 0;
+  int ok;
+  int i;
+  for (i = 0; i < 16; i++)
+    len += (unsigned long)sprintf(text + len, "t[%d] = 'row %d'\n", i, i);
+  if (luaz_lzm_parse(text, len, NULL) != 0 ||
+      luaz_lzm_encode(text, len, 64, &img, &img_len) != 0)
+    return 0;
+  ok = (img_len < len && luaz_lzm_parse(img, img_len, NULL) == 1 &&
+        luaz_lzm_decode(img, img_len, &back, &back_len) == 0 &&
+        back_len == len && memcmp(back, text, (size_t)len) == 0);
+  free(back);
+  if (ok) {
+    img[img_len - 1] ^= 0x01;  /* payload damage must be detected */
+    ok = (luaz_lzm_decode(img, img_len, &back, &back_len) != 0);
+  }
+  free(img);
+  return ok;
+}
+
 int main(void)
 {
   if (luaz_io_dd_register() != 0) {
@@ -49,17 +135,51 @@ int main(void)
   }
 
   if (!expect_resolve("short", "SHORT") ||
-      !expect_load("short", "SHORT")) {
+      !expect_load("short", "SHORT") ||
+      !expect_load_alloc("short", "SHORT")) {
     puts("LUZ00003 LUAPATH UT short name failed");
     return 8;
   }
 
   if (!expect_resolve("very.long.name", "VLONG01") ||
-      !expect_load("very.long.name", "VLONG01")) {
+      !expect_load("very.long.name", "VLONG01") ||
+      !expect_load_alloc("very.long.name", "VLONG01") ||
+      !expect_stream("very.long.name", "VLONG01")) {
     puts("LUZ00003 LUAPATH UT long name failed");
     return 8;
   }
 
+  /* LUAMAP is parsed once; repeated and missing lookups use the index. */
+  if (!expect_resolve("other.long.name", "OLONG01") ||
+      expect_resolve("missing.long.name", "NONE")) {
+    puts("LUZ00003 LUAPATH UT LUAMAP index lookup failed");
+    return 8;
+  }
+  if (!expect_stat("luamap_loads", 1) || !expect_stat("luamap_hits", 2) ||
+      !expect_stat("luamap_misses", 1)) {
+    puts("LUZ00003 LUAPATH UT LUAMAP index counters failed");
+    return 8;
+  }
+
+  /* LUAPATH directories are read once; absent members are not opened. */
+  if (luaz_path_member_exists("VLONG01", NULL) != 1 ||
+      luaz_path_member_exists("NOSUCH", NULL) != 0 ||
+      expect_load_alloc("nosuch", "NOSUCH") ||
+      expect_stream("nosuch", "NOSUCH")) {
+    puts("LUZ00003 LUAPATH UT member index lookup failed");
+    return 8;
+  }
+  if (!expect_stat("dir_loads", 1) || !expect_stat("dir_probes_saved", 2) ||
+      !expect_stat("stream_opens", 1)) {
+    puts("LUZ00003 LUAPATH UT member index counters failed");
+    return 8;
+  }
+
+  if (!expect_lzm()) {
+    puts("LUZ00003 LUAPATH UT compressed member codec failed");
+    return 8;
+  }
+
   puts("LUZ00002 LUAPATH UT OK");
   return 0;
 }
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO compressed member codec (LZ4 block format, fixed-size blocks).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | lzm_get_u32 | function | Fetch a big-endian 32-bit field |
+ * | lzm_put_u32 | function | Store a big-endian 32-bit field |
+ * | lzm_read32 | function | Load 4 bytes for match hashing/compare |
+ * | lzm_hash | function | Hash 4 bytes into the match table |
+ * | lzm_put_len | function | Emit an LZ4 length extension |
+ * | lzm_emit | function | Emit one LZ4 sequence |
+ * | luaz_lzm_parse | function | Recognise and parse a member header |
+ * | luaz_lzm_block_decode | function | Decompress one LZ4 block |
+ * | luaz_lzm_block_encode | function | Compress one LZ4 block |
+ * | luaz_lzm_decode | function | Decompress a whole member image |
+ * | luaz_lzm_encode | function | Compress a buffer into a member image |
+ *
+ * Platform Requirements:
+ * - Pure byte handling; no I/O. Output is byte-identical on every
+ *   platform, payload bytes are not translated.
+ * - The encoder keeps a 4096-entry match table on the stack.
+ */
+#include "LZMEM"
+#include "CRC32"
+#include "ERRORS"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LZM_MINMATCH 4u
+#define LZM_LAST_LITERALS 5u
+#define LZM_MFLIMIT 12u
+#define LZM_MAX_OFFSET 65535u
+#define LZM_HASH_LOG 12
+#define LZM_HASH_SIZE (1u << LZM_HASH_LOG)
+
+static const unsigned char g_lzm_magic[4] = {LUAZ_LZM_MAGIC0, 'L', 'Z', 'M'};
+
+static unsigned long lzm_get_u32(const unsigned char *p)
+{
+  return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+         ((unsigned long)p[2] << 8) | (unsigned long)p[3];
+}
+
+static void lzm_put_u32(unsigned char *p, unsigned long v)
+{
+  p[0] = (unsigned char)((v >> 24) & 0xFFu);
+  p[1] = (unsigned char)((v >> 16) & 0xFFu);
+  p[2] = (unsigned char)((v >> 8) & 0xFFu);
+  p[3] = (unsigned char)(v & 0xFFu);
+}
+
+static unsigned long lzm_read32(const unsigned char *p)
+{
+  return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+         ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static unsigned int lzm_hash(unsigned long v)
+{
+  return (unsigned int)(((v * 2654435761ul) & 0xFFFFFFFFul) >>
+                        (32 - LZM_HASH_LOG));
+}
+
+/**
+ * @brief Emit the 255-run extension of an LZ4 length field.
+ *
+ * @param op In/out output cursor.
+ * @param n Length minus the 15 held in the token.
+ */
+static void lzm_put_len(unsigned char **op, unsigned long n)
+{
+  while (n >= 255u) {
+    *(*op)++ = 255u;
+    n -= 255u;
+  }
+  *(*op)++ = (unsigned char)n;
+}
+
+/**
+ * @brief Emit one LZ4 sequence (literals, then an optional match).
+ *
+ * @param op In/out output cursor.
+ * @param oend End of the output buffer.
+ * @param lit Literal bytes.
+ * @param lit_len Number of literals.
+ * @param off Match offset (ignored when mlen is 0).
+ * @param mlen Match length (0 for the final literal-only sequence).
+ * @return 0 on success, or -1 when the output does not fit.
+ */
+static int lzm_emit(unsigned char **op, const unsigned char *oend,
+                    const unsigned char *lit, unsigned long lit_len,
+                    unsigned long off, unsigned long mlen)
+{
+  unsigned long need = 1u + lit_len + lit_len / 255u + 1u;
+  unsigned char *token = *op;
+  unsigned long mcode = (mlen > 0) ? mlen - LZM_MINMATCH : 0;
+
+  if (mlen > 0)
+    need += 2u + mcode / 255u + 1u;
+  if (need > (unsigned long)(oend - *op))
+    return -1;
+  (*op)++;
+  if (lit_len >= 15u) {
+    *token = 0xF0u;
+    lzm_put_len(op, lit_len - 15u);
+  }
+  else {
+    *token = (unsigned char)(lit_len << 4);
+  }
+  memcpy(*op, lit, (size_t)lit_len);
+  *op += lit_len;
+  if (mlen == 0)
+    return 0;
+  *(*op)++ = (unsigned char)(off & 0xFFu);
+  *(*op)++ = (unsigned char)((off >> 8) & 0xFFu);
+  if (mcode >= 15u) {
+    *token |= 0x0Fu;
+    lzm_put_len(op, mcode - 15u);
+  }
+  else {
+    *token |= (unsigned char)mcode;
+  }
+  return 0;
+}
+
+int luaz_lzm_parse(const void *buf, unsigned long len,
+                   struct luaz_lzm_hdr *hdr)
+{
+  const unsigned char *p = (const unsigned char *)buf;
+  unsigned long block;
+
+  if (p == NULL || len == 0 || p[0] != LUAZ_LZM_MAGIC0)
+    return 0;
+  if (len < LUAZ_LZM_HDR_LEN ||
+      memcmp(p, g_lzm_magic, sizeof(g_lzm_magic)) != 0)
+    return LUZ_E_LZM;
+  block = lzm_get_u32(p + 8);
+  if (block == 0 || block > LUAZ_LZM_BLOCK_MAX)
+    return LUZ_E_LZM;
+  if (hdr != NULL) {
+    hdr->raw_len = lzm_get_u32(p + 4);
+    hdr->block_size = block;
+    hdr->crc = lzm_get_u32(p + 12);
+  }
+  return 1;
+}
+
+int luaz_lzm_block_decode(const unsigned char *src, unsigned long src_len,
+                          unsigned char *dst, unsigned long dst_len)
+{
+  const unsigned char *ip = src;
+  const unsigned char *iend = src + src_len;
+  unsigned char *op = dst;
+  unsigned char *oend = dst + dst_len;
+
+  if (src == NULL || dst == NULL || src_len == 0)
+    return LUZ_E_LZM;
+  for (;;) {
+    unsigned int token;
+    unsigned long n;
+    unsigned long off;
+    unsigned int b;
+
+    token = *ip++;
+    n = token >> 4;
+    if (n == 15u) {
+      do {
+        if (ip >= iend)
+          return LUZ_E_LZM;
+        b = *ip++;
+        n += b;
+      } while (b == 255u);
+    }
+    if (n > (unsigned long)(iend - ip) || n > (unsigned long)(oend - op))
+      return LUZ_E_LZM;
+    memcpy(op, ip, (size_t)n);
+    ip += n;
+    op += n;
+    if (ip == iend)
+      break;  /* final literal-only sequence */
+
+    if (iend - ip < 2)
+      return LUZ_E_LZM;
+    off = (unsigned long)ip[0] | ((unsigned long)ip[1] << 8);
+    ip += 2;
+    if (off == 0 || off > (unsigned long)(op - dst))
+      return LUZ_E_LZM;
+    n = token & 0x0Fu;
+    if (n == 15u) {
+      do {
+        if (ip >= iend)
+          return LUZ_E_LZM;
+        b = *ip++;
+        n += b;
+      } while (b == 255u);
+    }
+    n += LZM_MINMATCH;
+    if (n > (unsigned long)(oend - op))
+      return LUZ_E_LZM;
+    if (off >= n) {
+      memcpy(op, op - off, (size_t)n);
+      op += n;
+    }
+    else {
+      const unsigned char *m = op - off;
+      while (n-- > 0)
+        *op++ = *m++;  /* overlapping run */
+    }
+    if (ip >= iend)
+      return LUZ_E_LZM;
+  }
+  return (op == oend) ? 0 : LUZ_E_LZM;
+}
+
+unsigned long luaz_lzm_block_encode(const unsigned char *src,
+                                    unsigned long src_len,
+                                    unsigned char *dst,
+                                    unsigned long dst_cap)
+{
+  unsigned long table[LZM_HASH_SIZE];
+  const unsigned char *ip = src;
+  const unsigned char *anchor = src;
+  const unsigned char *iend = src + src_len;
+  unsigned char *op = dst;
+  const unsigned char *oend = dst + dst_cap;
+
+  if (src == NULL || dst == NULL || src_len == 0)
+    return 0;
+  memset(table, 0, sizeof(table));
+  if (src_len > LZM_MFLIMIT) {
+    const unsigned char *mflimit = iend - LZM_MFLIMIT;
+    const unsigned char *matchlimit = iend - LZM_LAST_LITERALS;
+
+    while (ip < mflimit) {
+      unsigned long seq = lzm_read32(ip);
+      unsigned int h = lzm_hash(seq);
+      unsigned long ref = table[h];
+      const unsigned char *match;
+      unsigned long mlen;
+
+      /* table holds position + 1; 0 means empty */
+      table[h] = (unsigned long)(ip - src) + 1u;
+      if (ref == 0 ||
+          (unsigned long)(ip - src) - (ref - 1u) > LZM_MAX_OFFSET ||
+          lzm_read32(src + ref - 1u) != seq) {
+        ip++;
+        continue;
+      }
+      match = src + ref - 1u;
+      while (ip > anchor && match > src && ip[-1] == match[-1]) {
+        ip--;
+        match--;
+      }
+      mlen = LZM_MINMATCH;
+      while (ip + mlen < matchlimit && ip[mlen] == match[mlen])
+        mlen++;
+      if (lzm_emit(&op, oend, anchor, (unsigned long)(ip - anchor),
+                   (unsigned long)(ip - match), mlen) != 0)
+        return 0;
+      ip += mlen;
+      anchor = ip;
+      if (ip < mflimit)
+        table[lzm_hash(lzm_read32(ip - 2))] = (unsigned long)(ip - 2 - src) + 1u;
+    }
+  }
+  if (lzm_emit(&op, oend, anchor, (unsigned long)(iend - anchor), 0, 0) != 0)
+    return 0;
+  return (unsigned long)(op - dst);
+}
+
+int luaz_lzm_decode(const void *buf, unsigned long len, char **out,
+                    unsigned long *out_len)
+{
+  const unsigned char *p = (const unsigned char *)buf;
+  struct luaz_lzm_hdr hdr;
+  unsigned long pos = LUAZ_LZM_HDR_LEN;
+  unsigned long done = 0;
+  unsigned char *raw;
+
+  if (out == NULL || out_len == NULL)
+    return LUZ_E_LZM;
+  *out = NULL;
+  *out_len = 0;
+  if (luaz_lzm_parse(buf, len, &hdr) != 1)
+    return LUZ_E_LZM;
+  raw = (unsigned char *)malloc((size_t)hdr.raw_len + 1u);
+  if (raw == NULL)
+    return LUZ_E_LZM;
+
+  while (done < hdr.raw_len) {
+    unsigned long rlen = hdr.raw_len - done;
+    unsigned long word;
+    unsigned long plen;
+
+    if (rlen > hdr.block_size)
+      rlen = hdr.block_size;
+    if (len - pos < LUAZ_LZM_BLOCK_HDR_LEN)
+      goto bad;
+    word = lzm_get_u32(p + pos);
+    pos += LUAZ_LZM_BLOCK_HDR_LEN;
+    plen = word & ~LUAZ_LZM_STORED;
+    if (plen > len - pos)
+      goto bad;
+    if ((word & LUAZ_LZM_STORED) != 0) {
+      if (plen != rlen)
+        goto bad;
+      memcpy(raw + done, p + pos, (size_t)rlen);
+    }
+    else if (luaz_lzm_block_decode(p + pos, plen, raw + done, rlen) != 0) {
+      goto bad;
+    }
+    pos += plen;
+    done += rlen;
+  }
+  if ((unsigned long)luaz_crc32(raw, (size_t)hdr.raw_len) != hdr.crc)
+    goto bad;
+  raw[hdr.raw_len] = '\0';
+  *out = (char *)raw;
+  *out_len = hdr.raw_len;
+  return 0;
+
+bad:
+  free(raw);
+  return LUZ_E_LZM;
+}
+
+int luaz_lzm_encode(const void *buf, unsigned long len,
+                    unsigned long block_size, char **out,
+                    unsigned long *out_len)
+{
+  const unsigned char *src = (const unsigned char *)buf;
+  unsigned long nblocks;
+  unsigned long cap;
+  unsigned long pos = LUAZ_LZM_HDR_LEN;
+  unsigned long done = 0;
+  unsigned char *img;
+
+  if (out == NULL || out_len == NULL || (src == NULL && len > 0))
+    return LUZ_E_LZM;
+  *out = NULL;
+  *out_len = 0;
+  if (block_size == 0)
+    block_size = LUAZ_LZM_BLOCK_DEFAULT;
+  if (block_size > LUAZ_LZM_BLOCK_MAX || len > 0x7FFFFFFFul)
+    return LUZ_E_LZM;
+  nblocks = (len + block_size - 1u) / block_size;
+  cap = LUAZ_LZM_HDR_LEN + nblocks * LUAZ_LZM_BLOCK_HDR_LEN + len;
+  img = (unsigned char *)malloc((size_t)cap);
+  if (img == NULL)
+    return LUZ_E_LZM;
+
+  memcpy(img, g_lzm_magic, sizeof(g_lzm_magic));
+  lzm_put_u32(img + 4, len);
+  lzm_put_u32(img + 8, block_size);
+  lzm_put_u32(img + 12, (unsigned long)luaz_crc32(src, (size_t)len));
+  while (done < len) {
+    unsigned long rlen = len - done;
+    unsigned long plen;
+
+    if (rlen > block_size)
+      rlen = block_size;
+    /* Keep a block only when it is smaller than the raw bytes. */
+    plen = luaz_lzm_block_encode(src + done, rlen,
+                                 img + pos + LUAZ_LZM_BLOCK_HDR_LEN,
+                                 rlen - 1u);
+    if (plen == 0) {
+      memcpy(img + pos + LUAZ_LZM_BLOCK_HDR_LEN, src + done, (size_t)rlen);
+      lzm_put_u32(img + pos, rlen | LUAZ_LZM_STORED);
+      plen = rlen;
+    }
+    else {
+      lzm_put_u32(img + pos, plen);
+    }
+    pos += LUAZ_LZM_BLOCK_HDR_LEN + plen;
+    done += rlen;
+  }
+  *out = (char *)img;
+  *out_len = pos;
+  return 0;
+}
@@ -6,23 +6,188 @@
  * Object Table:
  * | Object | Kind | Purpose |
  * |--------|------|---------|
+ * | luaz_luamap_slot | struct | Open-addressing slot of the LUAMAP index |
+ * | luamap_hash | function | FNV-1a hash for LUAMAP module names |
+ * | luamap_free | function | Release the LUAMAP index |
+ * | luamap_insert | function | Insert a LUAMAP entry (first match wins) |
+ * | luamap_find | function | Find a LUAMAP entry by module name |
+ * | luamap_build | function | Parse LUAMAP text into the index |
+ * | luamap_ensure | function | Load LUAMAP once and build the index |
+ * | luaz_dir_slot | struct | Open-addressing slot of the LUAPATH member index |
+ * | dir_find | function | Find a member in the directory index |
+ * | dir_insert | function | Insert a member (first concatenation wins) |
+ * | dir_ensure | function | Read LUAPATH directories once into the index |
+ * | luaz_path_member_exists | function | Check a member against the index |
  * | luaz_path_lookup | function | Map long module name to member via LUAMAP |
  * | luaz_path_load | function | Load module source from LUAPATH |
+ * | luaz_path_load_alloc | function | Load module source in one read pass |
+ * | luaz_path_open | function | Open a LUAPATH member for block reads |
+ * | luaz_path_read | function | Read the next block of an open member |
+ * | luaz_path_close | function | Close an open member stream |
+ * | luaz_path_stream | struct | Member stream with optional block decoder |
+ * | stream_read_exact | function | Read exactly n bytes from a raw stream |
+ * | stream_next_block | function | Decode the next compressed block |
+ * | lzm_unpack | function | Replace a compressed image with its raw text |
+ * | bc_put_u32 | function | Store a big-endian 32-bit header field |
+ * | bc_get_u32 | function | Fetch a big-endian 32-bit header field |
+ * | bundle_free | function | Release the mounted application bundle |
+ * | bundle_ensure | function | Read and validate the bundle once |
+ * | luaz_path_bundle_find | function | Look up a module in the bundle |
+ * | luaz_path_bc_get | function | Fetch validated bytecode from the cache DD |
+ * | luaz_path_bc_put | function | Store bytecode in the cache DD |
+ * | luaz_path_bc_writable | function | Report whether cache write-back is on |
+ * | luaz_path_invalidate | function | Drop cached LUAMAP and member indexes |
+ * | luaz_path_reset | function | Drop cached LUAMAP index and counters |
+ * | luaz_path_stat_count | function | Return number of LUAPATH counters |
+ * | luaz_path_stat_name | function | Get LUAPATH counter name by index |
+ * | luaz_path_stat_value | function | Get LUAPATH counter value by index |
  */
+#include "BUNDLE"
+#include "CRC32"
 #include "ERRORS"
+#include "LZMEM"
 #include "PATH"
 
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* LUAMAP index state: 0 = not loaded, 1 = loaded, -1 = LUAMAP unavailable. */
+#define LUAMAP_UNLOADED 0
+#define LUAMAP_LOADED 1
+#define LUAMAP_MISSING (-1)
+
+typedef struct luaz_luamap_slot {
+  const char *name;
+  size_t name_len;
+  unsigned long hash;
+  char member[9];
+  unsigned char mlen;
+} luaz_luamap_slot;
+
+typedef struct luaz_luamap_index {
+  char *text;
+  luaz_luamap_slot *slots;
+  size_t cap;
+  size_t count;
+  int state;
+} luaz_luamap_index;
+
+/* LUAPATH member index: directory entries of the whole concatenation. */
+typedef struct luaz_dir_slot {
+  unsigned long hash;
+  int concat;
+  unsigned char mlen;
+  char member[9];
+} luaz_dir_slot;
+
+typedef struct luaz_dir_index {
+  luaz_dir_slot *slots;
+  size_t cap;
+  size_t count;
+  int state;
+} luaz_dir_index;
+
+/* Member stream: raw platform stream plus a block decoder for compressed
+ * members; head[] holds the bytes peeked at open for plain members. */
+typedef struct luaz_path_stream {
+  void *raw;
+  int lzm;
+  unsigned char head[LUAZ_LZM_HDR_LEN];
+  unsigned long head_len;
+  unsigned long head_pos;
+  struct luaz_lzm_hdr hdr;
+  unsigned char *in;
+  unsigned char *out;
+  unsigned long out_len;
+  unsigned long out_pos;
+  unsigned long done;
+  uint32_t crc;
+} luaz_path_stream;
+
+/* Application bundle (luabundle.dd): image read once, TOC view over it. */
+typedef struct luaz_bundle_state {
+  char *image;
+  struct luaz_bundle view;
+  int state;
+} luaz_bundle_state;
+
+enum {
+  PATH_STAT_LUAMAP_LOADS = 0,
+  PATH_STAT_LUAMAP_ENTRIES,
+  PATH_STAT_LUAMAP_LOOKUPS,
+  PATH_STAT_LUAMAP_HITS,
+  PATH_STAT_LUAMAP_MISSES,
+  PATH_STAT_BC_HITS,
+  PATH_STAT_BC_MISSES,
+  PATH_STAT_BC_STALE,
+  PATH_STAT_BC_WRITES,
+  PATH_STAT_DIR_LOADS,
+  PATH_STAT_DIR_MEMBERS,
+  PATH_STAT_DIR_PROBES_SAVED,
+  PATH_STAT_STREAM_OPENS,
+  PATH_STAT_BUNDLE_LOADS,
+  PATH_STAT_BUNDLE_ENTRIES,
+  PATH_STAT_BUNDLE_HITS,
+  PATH_STAT_BUNDLE_MISSES,
+  PATH_STAT_LZM_LOADS,
+  PATH_STAT_LZM_BYTES_IN,
+  PATH_STAT_LZM_BYTES_OUT,
+  PATH_STAT_COUNT
+};
+
+static const char *const g_stat_names[PATH_STAT_COUNT] = {
+  "luamap_loads",
+  "luamap_entries",
+  "luamap_lookups",
+  "luamap_hits",
+  "luamap_misses",
+  "bc_hits",
+  "bc_misses",
+  "bc_stale",
+  "bc_writes",
+  "dir_loads",
+  "dir_members",
+  "dir_probes_saved",
+  "stream_opens",
+  "bundle_loads",
+  "bundle_entries",
+  "bundle_hits",
+  "bundle_misses",
+  "lzm_loads",
+  "lzm_bytes_in",
+  "lzm_bytes_out"
+};
+
+/* Bundle state values reuse the LUAMAP ones; BUNDLE_BAD = invalid image. */
+#define BUNDLE_BAD (-2)
+
+/* Bytecode cache member layout: 20-byte header followed by lua_dump
+ * output. Header fields are big-endian: magic, source CRC32, source
+ * length, payload length, payload CRC32. The payload length lets readers
+ * ignore record padding when the cache DD is RECFM=FB; the payload CRC32
+ * keeps a torn or overwritten member away from lundump. */
+#define LUABC_HDR_LEN 20u
+static const unsigned char g_bc_magic[4] = {'L', 'Z', 'B', 'C'};
+
 static struct luaz_path_ops g_ops;
+static luaz_luamap_index g_luamap;
+static luaz_dir_index g_dir;
+static luaz_bundle_state g_bundle;
+static unsigned long g_stats[PATH_STAT_COUNT];
 
 int luaz_path_set_ops(const struct luaz_path_ops *ops)
 {
   if (ops == NULL)
     return LUZ_E_PATH_LOOKUP;
   g_ops = *ops;
+  /* Change note: tie the LUAMAP index to the registered LUAPATH hooks.
+   * Problem: a cached index could outlive the LUAPATH it was read from.
+   * Expected effect: each hook registration (one per Lua state) starts
+   * with an empty index that is filled on the first long-name lookup.
+   * Impact: LUAMAP is read at most once per LUAEXEC run.
+   */
+  luaz_path_reset();
   return 0;
 }
 
@@ -34,32 +199,122 @@ static void trim_spaces(char **start, char **end)
     (*end)--;
 }
 
-int luaz_path_lookup(const char *modname, char *member, unsigned long *len)
+/**
+ * @brief Hash a module name for the LUAMAP index (FNV-1a, 32-bit).
+ *
+ * @param name Module name bytes.
+ * @param len Module name length.
+ * @return Hash value.
+ */
+static unsigned long luamap_hash(const char *name, size_t len)
 {
-  unsigned long blen = 0;
-  char *buf;
-  char *p;
-  char *line;
+  unsigned long h = 2166136261UL;
+  size_t i;
 
-  if (modname == NULL || member == NULL || len == NULL)
-    return LUZ_E_PATH_LOOKUP;
-  if (g_ops.luamap_read == NULL)
-    return LUZ_E_PATH_LOOKUP;
+  for (i = 0; i < len; i++) {
+    h ^= (unsigned char)name[i];
+    h = (h * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return h;
+}
 
-  if (g_ops.luamap_read(NULL, &blen) != 0 || blen == 0)
-    return LUZ_E_PATH_LOOKUP;
+/**
+ * @brief Release the LUAMAP index and mark it as not loaded.
+ */
+static void luamap_free(void)
+{
+  free(g_luamap.slots);
+  free(g_luamap.text);
+  memset(&g_luamap, 0, sizeof(g_luamap));
+}
 
-  buf = (char *)malloc(blen + 1);
-  if (buf == NULL)
-    return LUZ_E_PATH_LOOKUP;
+/**
+ * @brief Find the index slot for a module name.
+ *
+ * @param name Module name bytes.
+ * @param len Module name length.
+ * @param hash Precomputed hash of the name.
+ * @return Matching slot, or the empty slot that ends the probe sequence.
+ */
+static luaz_luamap_slot *luamap_find(const char *name, size_t len,
+                                     unsigned long hash)
+{
+  size_t mask = g_luamap.cap - 1;
+  size_t i = (size_t)hash & mask;
 
-  if (g_ops.luamap_read(buf, &blen) != 0) {
-    free(buf);
-    return LUZ_E_PATH_LOOKUP;
+  while (g_luamap.slots[i].name != NULL) {
+    luaz_luamap_slot *slot = &g_luamap.slots[i];
+    if (slot->hash == hash && slot->name_len == len &&
+        memcmp(slot->name, name, len) == 0)
+      return slot;
+    i = (i + 1) & mask;
   }
-  buf[blen] = '\0';
+  return &g_luamap.slots[i];
+}
 
-  p = buf;
+/**
+ * @brief Insert one LUAMAP entry; later duplicates are ignored.
+ *
+ * @param name Module name (points into the retained LUAMAP text).
+ * @param len Module name length.
+ * @param member Member name bytes.
+ * @param mlen Member name length (0 or >8 marks an invalid mapping).
+ */
+static void luamap_insert(const char *name, size_t len, const char *member,
+                          size_t mlen)
+{
+  unsigned long hash = luamap_hash(name, len);
+  luaz_luamap_slot *slot = luamap_find(name, len, hash);
+
+  /* First match in LUAMAP wins, as with the former linear scan. */
+  if (slot->name != NULL)
+    return;
+  slot->name = name;
+  slot->name_len = len;
+  slot->hash = hash;
+  if (mlen == 0 || mlen > 8) {
+    slot->mlen = 0;
+    slot->member[0] = '\0';
+  }
+  else {
+    memcpy(slot->member, member, mlen);
+    slot->member[mlen] = '\0';
+    slot->mlen = (unsigned char)mlen;
+  }
+  g_luamap.count++;
+}
+
+/**
+ * @brief Parse LUAMAP text into the open-addressing index.
+ *
+ * The text buffer is retained; module names point into it.
+ *
+ * @param text NUL-terminated LUAMAP text (modified in place).
+ * @param len Text length in bytes.
+ * @return 0 on success, or -1 on allocation failure.
+ */
+static int luamap_build(char *text, unsigned long len)
+{
+  size_t lines = 1;
+  size_t cap = 16;
+  unsigned long i;
+  char *p;
+  char *line;
+
+  for (i = 0; i < len; i++) {
+    if (text[i] == '\n')
+      lines++;
+  }
+  /* Keep the load factor at or below 1/2 so probe runs stay short. */
+  while (cap < lines * 2)
+    cap <<= 1;
+  g_luamap.slots = (luaz_luamap_slot *)calloc(cap, sizeof(luaz_luamap_slot));
+  if (g_luamap.slots == NULL)
+    return -1;
+  g_luamap.cap = cap;
+  g_luamap.count = 0;
+
+  p = text;
   while ((line = p) != NULL) {
     char *nl = strchr(p, '\n');
     char *start;
@@ -90,41 +345,526 @@ int luaz_path_lookup(const char *modname, char *member, unsigned long *len)
       char *rend = end;
       trim_spaces(&lstart, &lend);
       trim_spaces(&rstart, &rend);
-      if ((size_t)(lend - lstart) == strlen(modname) &&
-          memcmp(lstart, modname, (size_t)(lend - lstart)) == 0) {
-        unsigned long mlen = (unsigned long)(rend - rstart);
-        if (mlen == 0 || mlen > 8) {
-          free(buf);
-          return LUZ_E_PATH_LOOKUP;
-        }
-        if (*len <= mlen) {
-          free(buf);
-          return LUZ_E_PATH_LOOKUP;
-        }
-        memcpy(member, rstart, mlen);
-        member[mlen] = '\0';
-        *len = mlen;
-        free(buf);
-        return 0;
-      }
+      *lend = '\0';
+      luamap_insert(lstart, (size_t)(lend - lstart), rstart,
+                    (size_t)(rend - rstart));
     }
   }
+  return 0;
+}
 
-  free(buf);
-  return LUZ_E_PATH_LOOKUP;
+/**
+ * @brief Release the member index and mark it as not loaded.
+ */
+static void dir_free(void)
+{
+  free(g_dir.slots);
+  memset(&g_dir, 0, sizeof(g_dir));
+}
+
+/**
+ * @brief Find the index slot for a member name.
+ *
+ * @param member Member name bytes.
+ * @param mlen Member name length (1..8).
+ * @param hash Precomputed hash of the name.
+ * @return Matching slot, or the empty slot that ends the probe sequence.
+ */
+static luaz_dir_slot *dir_find(const char *member, size_t mlen,
+                               unsigned long hash)
+{
+  size_t mask = g_dir.cap - 1;
+  size_t i = (size_t)hash & mask;
+
+  while (g_dir.slots[i].mlen != 0) {
+    if (g_dir.slots[i].hash == hash && g_dir.slots[i].mlen == mlen &&
+        memcmp(g_dir.slots[i].member, member, mlen) == 0)
+      return &g_dir.slots[i];
+    i = (i + 1) & mask;
+  }
+  return &g_dir.slots[i];
+}
+
+/**
+ * @brief Insert a member; the first concatenation holding it wins.
+ *
+ * Member-list callback for the path ops; grows the table as needed.
+ *
+ * @param ud Unused.
+ * @param member Member name.
+ * @param concat 0-based concatenation index.
+ * @return 0 to continue, or -1 on allocation failure.
+ */
+static int dir_insert(void *ud, const char *member, int concat)
+{
+  size_t mlen;
+  unsigned long hash;
+  luaz_dir_slot *slot;
+
+  (void)ud;
+  if (member == NULL)
+    return 0;
+  mlen = strlen(member);
+  if (mlen == 0 || mlen > 8)
+    return 0;
+  if ((g_dir.count + 1) * 2 > g_dir.cap) {
+    luaz_dir_slot *old = g_dir.slots;
+    size_t ocap = g_dir.cap;
+    size_t i;
+    size_t ncap = (ocap == 0) ? 256 : ocap * 2;
+    g_dir.slots = (luaz_dir_slot *)calloc(ncap, sizeof(luaz_dir_slot));
+    if (g_dir.slots == NULL) {
+      g_dir.slots = old;
+      return -1;
+    }
+    g_dir.cap = ncap;
+    for (i = 0; i < ocap; i++) {
+      if (old[i].mlen != 0)
+        *dir_find(old[i].member, old[i].mlen, old[i].hash) = old[i];
+    }
+    free(old);
+  }
+  hash = luamap_hash(member, mlen);
+  slot = dir_find(member, mlen, hash);
+  if (slot->mlen != 0)
+    return 0;
+  memcpy(slot->member, member, mlen);
+  slot->member[mlen] = '\0';
+  slot->mlen = (unsigned char)mlen;
+  slot->hash = hash;
+  slot->concat = concat;
+  g_dir.count++;
+  return 0;
+}
+
+/**
+ * @brief Read the LUAPATH directories once and build the member index.
+ *
+ * @return 0 when the index is available, or -1 when member existence
+ *         must be discovered by opening the member.
+ */
+static int dir_ensure(void)
+{
+  if (g_dir.state == LUAMAP_LOADED)
+    return 0;
+  if (g_dir.state == LUAMAP_MISSING)
+    return -1;
+  /* Change note: index LUAPATH directories instead of probing members.
+   * Problem: each require miss was discovered by a failing open of
+   * //DD:LUAPATH(member), a full concatenation search per candidate.
+   * Expected effect: one directory pass per Lua state; absent members
+   * are rejected from memory.
+   * Impact: members added to LUAPATH during a run are not seen until
+   * luaz_path_reset; without a directory hook loads probe as before.
+   */
+  g_dir.state = LUAMAP_MISSING;
+  if (g_ops.member_list == NULL)
+    return -1;
+  g_stats[PATH_STAT_DIR_LOADS]++;
+  if (g_ops.member_list(dir_insert, NULL) != 0 || g_dir.count == 0) {
+    dir_free();
+    g_dir.state = LUAMAP_MISSING;
+    return -1;
+  }
+  g_dir.state = LUAMAP_LOADED;
+  g_stats[PATH_STAT_DIR_MEMBERS] = (unsigned long)g_dir.count;
+  return 0;
+}
+
+/**
+ * @brief Check whether a member exists in the LUAPATH concatenation.
+ *
+ * @param member Member name.
+ * @param concat Output 0-based concatenation index (may be NULL).
+ * @return 1 if present, 0 if absent, -1 if no directory index is available.
+ */
+int luaz_path_member_exists(const char *member, int *concat)
+{
+  const luaz_dir_slot *slot;
+  size_t mlen;
+
+  if (member == NULL)
+    return 0;
+  if (dir_ensure() != 0)
+    return -1;
+  mlen = strlen(member);
+  if (mlen == 0 || mlen > 8)
+    return 0;
+  slot = dir_find(member, mlen, luamap_hash(member, mlen));
+  if (slot->mlen == 0)
+    return 0;
+  if (concat != NULL)
+    *concat = slot->concat;
+  return 1;
+}
+
+/**
+ * @brief Reject a member load from the index without opening LUAPATH.
+ *
+ * @param member Member name.
+ * @return 1 when the index proves the member absent, 0 otherwise.
+ */
+static int dir_absent(const char *member)
+{
+  if (luaz_path_member_exists(member, NULL) != 0)
+    return 0;
+  g_stats[PATH_STAT_DIR_PROBES_SAVED]++;
+  return 1;
+}
+
+/**
+ * @brief Load LUAMAP once and build the in-memory index.
+ *
+ * @return 0 when the index is available, or -1 when LUAMAP is unavailable.
+ */
+static int luamap_ensure(void)
+{
+  unsigned long blen = 0;
+  char *buf;
+
+  if (g_luamap.state == LUAMAP_LOADED)
+    return 0;
+  if (g_luamap.state == LUAMAP_MISSING)
+    return -1;
+  if (g_ops.luamap_read == NULL && g_ops.member_read_alloc == NULL)
+    return -1;
+
+  /* Change note: parse LUAMAP once into a hashed index.
+   * Problem: every long-name require re-read and line-scanned LUAMAP.
+   * Expected effect: LUAMAP is read and parsed once per Lua state; later
+   * lookups are served from an open-addressing hash table.
+   * Impact: LUAMAP edits during a run are not seen until luaz_path_reset.
+   */
+  g_luamap.state = LUAMAP_MISSING;
+  if (dir_absent("LUAMAP"))
+    return -1;
+  g_stats[PATH_STAT_LUAMAP_LOADS]++;
+  if (g_ops.member_read_alloc != NULL) {
+    buf = NULL;
+    if (g_ops.member_read_alloc("LUAMAP", &buf, &blen) != 0 || blen == 0) {
+      free(buf);
+      return -1;
+    }
+  }
+  else {
+    if (g_ops.luamap_read(NULL, &blen) != 0 || blen == 0)
+      return -1;
+
+    buf = (char *)malloc(blen + 1);
+    if (buf == NULL)
+      return -1;
+
+    if (g_ops.luamap_read(buf, &blen) != 0) {
+      free(buf);
+      return -1;
+    }
+  }
+  buf[blen] = '\0';
+
+  g_luamap.text = buf;
+  if (luamap_build(buf, blen) != 0) {
+    luamap_free();
+    g_luamap.state = LUAMAP_MISSING;
+    return -1;
+  }
+  g_luamap.state = LUAMAP_LOADED;
+  g_stats[PATH_STAT_LUAMAP_ENTRIES] = (unsigned long)g_luamap.count;
+  return 0;
+}
+
+int luaz_path_lookup(const char *modname, char *member, unsigned long *len)
+{
+  const luaz_luamap_slot *slot;
+  size_t nlen;
+
+  if (modname == NULL || member == NULL || len == NULL)
+    return LUZ_E_PATH_LOOKUP;
+  if (luamap_ensure() != 0)
+    return LUZ_E_PATH_LOOKUP;
+
+  g_stats[PATH_STAT_LUAMAP_LOOKUPS]++;
+  nlen = strlen(modname);
+  slot = luamap_find(modname, nlen, luamap_hash(modname, nlen));
+  if (slot->name == NULL) {
+    g_stats[PATH_STAT_LUAMAP_MISSES]++;
+    return LUZ_E_PATH_LOOKUP;
+  }
+  g_stats[PATH_STAT_LUAMAP_HITS]++;
+  if (slot->mlen == 0)
+    return LUZ_E_PATH_LOOKUP;
+  if (*len <= slot->mlen)
+    return LUZ_E_PATH_LOOKUP;
+  memcpy(member, slot->member, (size_t)slot->mlen + 1);
+  *len = slot->mlen;
+  return 0;
+}
+
+/**
+ * @brief Replace a compressed member image with its decoded text.
+ *
+ * @param buf In/out member buffer (freed and replaced when compressed).
+ * @param len In/out member length.
+ * @return 0 when the buffer is plain or was decoded, or LUZ_E_PATH_LOAD.
+ */
+static int lzm_unpack(char **buf, unsigned long *len)
+{
+  char *raw = NULL;
+  unsigned long raw_len = 0;
+  int rc = luaz_lzm_parse(*buf, *len, NULL);
+
+  if (rc == 0)
+    return 0;
+  if (rc != 1 || luaz_lzm_decode(*buf, *len, &raw, &raw_len) != 0)
+    return LUZ_E_PATH_LOAD;
+  g_stats[PATH_STAT_LZM_LOADS]++;
+  g_stats[PATH_STAT_LZM_BYTES_IN] += *len;
+  g_stats[PATH_STAT_LZM_BYTES_OUT] += raw_len;
+  free(*buf);
+  *buf = raw;
+  *len = raw_len;
+  return 0;
 }
 
 int luaz_path_load(const char *modname, const char *member,
                    char *buf, unsigned long *len)
 {
-  (void)modname;
+  char *tmp = NULL;
+  unsigned long tlen = 0;
+
   if (member == NULL || len == NULL)
     return LUZ_E_PATH_LOAD;
+  /* Change note: serve the sized read from the decoded member.
+   * Problem: the size probe would report the compressed length of a
+   * compressed member and the copy would return compressed bytes.
+   * Expected effect: both calls see the decoded source text.
+   * Impact: one read pass per call when member_read_alloc is available.
+   */
+  if (g_ops.member_read_alloc != NULL) {
+    if (luaz_path_load_alloc(modname, member, &tmp, &tlen) != 0)
+      return LUZ_E_PATH_LOAD;
+    if (buf != NULL) {
+      if (tlen > *len) {
+        free(tmp);
+        return LUZ_E_PATH_LOAD;
+      }
+      memcpy(buf, tmp, (size_t)tlen);
+    }
+    free(tmp);
+    *len = tlen;
+    return 0;
+  }
   if (g_ops.member_read == NULL)
     return LUZ_E_PATH_LOAD;
+  if (dir_absent(member))
+    return LUZ_E_PATH_LOAD;
   return g_ops.member_read(member, buf, len);
 }
 
+int luaz_path_load_alloc(const char *modname, const char *member,
+                         char **buf, unsigned long *len)
+{
+  (void)modname;
+  if (member == NULL || buf == NULL || len == NULL)
+    return LUZ_E_PATH_LOAD;
+  *buf = NULL;
+  *len = 0;
+  if (g_ops.member_read_alloc == NULL)
+    return LUZ_E_PATH_LOAD;
+  if (dir_absent(member))
+    return LUZ_E_PATH_LOAD;
+  if (g_ops.member_read_alloc(member, buf, len) != 0 ||
+      lzm_unpack(buf, len) != 0) {
+    free(*buf);
+    *buf = NULL;
+    *len = 0;
+    return LUZ_E_PATH_LOAD;
+  }
+  return 0;
+}
+
+/**
+ * @brief Read exactly n bytes from a raw member stream.
+ *
+ * @param raw Platform stream handle.
+ * @param buf Output buffer.
+ * @param n Number of bytes wanted.
+ * @param got Output bytes read (less than n only at end of member).
+ * @return 0 on success, or LUZ_E_PATH_LOAD on read failure.
+ */
+static int stream_read_exact(void *raw, unsigned char *buf, unsigned long n,
+                             unsigned long *got)
+{
+  unsigned long total = 0;
+
+  while (total < n) {
+    unsigned long chunk = n - total;
+    if (g_ops.stream_read(raw, (char *)buf + total, &chunk) != 0)
+      return LUZ_E_PATH_LOAD;
+    if (chunk == 0)
+      break;
+    total += chunk;
+  }
+  *got = total;
+  return 0;
+}
+
+/**
+ * @brief Read and decode the next block of a compressed member.
+ *
+ * @param s Member stream in compressed mode.
+ * @return 0 on success (out_len 0 at end), or LUZ_E_PATH_LOAD.
+ */
+static int stream_next_block(luaz_path_stream *s)
+{
+  unsigned char word[LUAZ_LZM_BLOCK_HDR_LEN];
+  unsigned long rlen = s->hdr.raw_len - s->done;
+  unsigned long plen;
+  unsigned long got = 0;
+
+  s->out_len = 0;
+  s->out_pos = 0;
+  if (rlen == 0) {
+    /* end of member: the decoded text must match the header CRC32 */
+    return ((unsigned long)(s->crc ^ 0xFFFFFFFFu) == s->hdr.crc)
+               ? 0
+               : LUZ_E_PATH_LOAD;
+  }
+  if (rlen > s->hdr.block_size)
+    rlen = s->hdr.block_size;
+  if (stream_read_exact(s->raw, word, sizeof(word), &got) != 0 ||
+      got != sizeof(word))
+    return LUZ_E_PATH_LOAD;
+  plen = ((unsigned long)word[0] << 24 | (unsigned long)word[1] << 16 |
+          (unsigned long)word[2] << 8 | (unsigned long)word[3]);
+  if ((plen & ~LUAZ_LZM_STORED) > rlen)
+    return LUZ_E_PATH_LOAD;
+  if ((plen & LUAZ_LZM_STORED) != 0) {
+    plen &= ~LUAZ_LZM_STORED;
+    if (plen != rlen ||
+        stream_read_exact(s->raw, s->out, plen, &got) != 0 || got != plen)
+      return LUZ_E_PATH_LOAD;
+  }
+  else if (stream_read_exact(s->raw, s->in, plen, &got) != 0 ||
+           got != plen ||
+           luaz_lzm_block_decode(s->in, plen, s->out, rlen) != 0) {
+    return LUZ_E_PATH_LOAD;
+  }
+  g_stats[PATH_STAT_LZM_BYTES_IN] += LUAZ_LZM_BLOCK_HDR_LEN + plen;
+  g_stats[PATH_STAT_LZM_BYTES_OUT] += rlen;
+  s->crc = luaz_crc32_update(s->crc, s->out, (size_t)rlen);
+  s->done += rlen;
+  s->out_len = rlen;
+  return 0;
+}
+
+int luaz_path_open(const char *modname, const char *member, void **stream)
+{
+  luaz_path_stream *s = NULL;
+  void *raw = NULL;
+  int rc;
+
+  (void)modname;
+  if (member == NULL || stream == NULL)
+    return LUZ_E_PATH_LOAD;
+  *stream = NULL;
+  if (g_ops.member_open == NULL || g_ops.stream_read == NULL)
+    return LUZ_E_PATH_LOAD;
+  if (dir_absent(member))
+    return LUZ_E_PATH_LOAD;
+  if (g_ops.member_open(member, &raw) != 0 || raw == NULL)
+    return LUZ_E_PATH_LOAD;
+  s = (luaz_path_stream *)calloc(1, sizeof(*s));
+  if (s == NULL)
+    goto fail;
+  s->raw = raw;
+
+  /* Change note: decode compressed members block by block.
+   * Problem: large generated modules moved their full source size from
+   * disk on every load.
+   * Expected effect: the parser reads decoded text while only the
+   * compressed blocks are read from the member.
+   * Impact: one block of raw and one of decoded text held per stream.
+   */
+  if (stream_read_exact(raw, s->head, LUAZ_LZM_HDR_LEN, &s->head_len) != 0)
+    goto fail;
+  rc = luaz_lzm_parse(s->head, s->head_len, &s->hdr);
+  if (rc == 1) {
+    s->lzm = 1;
+    s->in = (unsigned char *)malloc((size_t)s->hdr.block_size);
+    s->out = (unsigned char *)malloc((size_t)s->hdr.block_size);
+    s->crc = 0xFFFFFFFFu;
+    if (s->in == NULL || s->out == NULL)
+      goto fail;
+    g_stats[PATH_STAT_LZM_LOADS]++;
+    g_stats[PATH_STAT_LZM_BYTES_IN] += LUAZ_LZM_HDR_LEN;
+  }
+  else if (rc != 0) {
+    goto fail;
+  }
+  g_stats[PATH_STAT_STREAM_OPENS]++;
+  *stream = s;
+  return 0;
+
+fail:
+  if (s != NULL) {
+    free(s->in);
+    free(s->out);
+    free(s);
+  }
+  if (g_ops.stream_close != NULL)
+    (void)g_ops.stream_close(raw);
+  return LUZ_E_PATH_LOAD;
+}
+
+int luaz_path_read(void *stream, char *buf, unsigned long *len)
+{
+  luaz_path_stream *s = (luaz_path_stream *)stream;
+  unsigned long n;
+
+  if (s == NULL || buf == NULL || len == NULL || g_ops.stream_read == NULL)
+    return LUZ_E_PATH_LOAD;
+  if (s->lzm) {
+    if (s->out_pos == s->out_len && stream_next_block(s) != 0) {
+      *len = 0;
+      return LUZ_E_PATH_LOAD;
+    }
+    n = s->out_len - s->out_pos;
+    if (n > *len)
+      n = *len;
+    memcpy(buf, s->out + s->out_pos, (size_t)n);
+    s->out_pos += n;
+    *len = n;
+    return 0;
+  }
+  if (s->head_pos < s->head_len) {
+    n = s->head_len - s->head_pos;
+    if (n > *len)
+      n = *len;
+    memcpy(buf, s->head + s->head_pos, (size_t)n);
+    s->head_pos += n;
+    *len = n;
+    return 0;
+  }
+  if (g_ops.stream_read(s->raw, buf, len) != 0) {
+    *len = 0;
+    return LUZ_E_PATH_LOAD;
+  }
+  return 0;
+}
+
+void luaz_path_close(void *stream)
+{
+  luaz_path_stream *s = (luaz_path_stream *)stream;
+
+  if (s == NULL)
+    return;
+  if (g_ops.stream_close != NULL)
+    (void)g_ops.stream_close(s->raw);
+  free(s->in);
+  free(s->out);
+  free(s);
+}
+
 int luaz_path_resolve(const char *modname, char *member, unsigned long *len)
 {
   size_t nlen;
@@ -163,3 +903,224 @@ int luaz_path_resolve(const char *modname, char *member, unsigned long *len)
   member[*len] = '\0';
   return 0;
 }
+
+/**
+ * @brief Release the mounted bundle image and mark it as not loaded.
+ */
+static void bundle_free(void)
+{
+  free(g_bundle.image);
+  memset(&g_bundle, 0, sizeof(g_bundle));
+}
+
+/**
+ * @brief Read and validate the application bundle on first use.
+ *
+ * @return 1 when a bundle is mounted, 0 when none is configured, or
+ *         LUZ_E_BUNDLE when the image is unreadable or malformed.
+ */
+static int bundle_ensure(void)
+{
+  unsigned long len = 0;
+
+  if (g_bundle.state == LUAMAP_LOADED)
+    return 1;
+  if (g_bundle.state == LUAMAP_MISSING)
+    return 0;
+  if (g_bundle.state == BUNDLE_BAD)
+    return LUZ_E_BUNDLE;
+  if (g_ops.bundle_read_alloc == NULL) {
+    g_bundle.state = LUAMAP_MISSING;
+    return 0;
+  }
+
+  /* Change note: mount the application bundle with one open/read.
+   * Problem: an application of many members cost a directory lookup and
+   * an open per module.
+   * Expected effect: the whole bundle is read once per Lua state and
+   * modules are sliced from memory via the sorted TOC.
+   * Impact: bundle modules need no LUAMAP entry or LUAPATH member.
+   */
+  g_stats[PATH_STAT_BUNDLE_LOADS]++;
+  if (g_ops.bundle_read_alloc(&g_bundle.image, &len) != 0 ||
+      luaz_bundle_open(&g_bundle.view, g_bundle.image, len) != 0) {
+    free(g_bundle.image);
+    g_bundle.image = NULL;
+    g_bundle.state = BUNDLE_BAD;
+    return LUZ_E_BUNDLE;
+  }
+  g_bundle.state = LUAMAP_LOADED;
+  g_stats[PATH_STAT_BUNDLE_ENTRIES] = g_bundle.view.count;
+  return 1;
+}
+
+int luaz_path_bundle_find(const char *modname, const char **data,
+                          unsigned long *len)
+{
+  int rc;
+
+  if (modname == NULL || data == NULL || len == NULL)
+    return -1;
+  *data = NULL;
+  *len = 0;
+  rc = bundle_ensure();
+  if (rc == 0)
+    return -1;
+  if (rc != 1)
+    return LUZ_E_BUNDLE;
+  rc = luaz_bundle_find(&g_bundle.view, modname, data, len);
+  if (rc == 1) {
+    g_stats[PATH_STAT_BUNDLE_HITS]++;
+    return 1;
+  }
+  if (rc == 0) {
+    g_stats[PATH_STAT_BUNDLE_MISSES]++;
+    return 0;
+  }
+  return LUZ_E_BUNDLE;
+}
+
+static void bc_put_u32(unsigned char *p, uint32_t v)
+{
+  p[0] = (unsigned char)((v >> 24) & 0xFFu);
+  p[1] = (unsigned char)((v >> 16) & 0xFFu);
+  p[2] = (unsigned char)((v >> 8) & 0xFFu);
+  p[3] = (unsigned char)(v & 0xFFu);
+}
+
+static uint32_t bc_get_u32(const unsigned char *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/**
+ * @brief Fetch bytecode for a member from the cache DD.
+ *
+ * The entry is accepted only when its header matches the CRC32 and
+ * length of the current source text and the CRC32 of its payload;
+ * anything else counts as stale.
+ *
+ * @param member Resolved member name.
+ * @param src Module source text.
+ * @param srclen Source length in bytes.
+ * @param code Output payload (malloc'd, caller frees; NULL on miss).
+ * @param codelen Output payload length.
+ * @return 0 on hit, or LUZ_E_PATH_LOAD on miss/disabled cache.
+ */
+int luaz_path_bc_get(const char *member, const char *src,
+                     unsigned long srclen, char **code,
+                     unsigned long *codelen)
+{
+  char *buf = NULL;
+  unsigned long len = 0;
+  const unsigned char *hdr;
+  uint32_t payload;
+
+  if (member == NULL || src == NULL || code == NULL || codelen == NULL)
+    return LUZ_E_PATH_LOAD;
+  *code = NULL;
+  *codelen = 0;
+  if (g_ops.bc_read_alloc == NULL)
+    return LUZ_E_PATH_LOAD;
+
+  if (g_ops.bc_read_alloc(member, &buf, &len) != 0 || buf == NULL) {
+    free(buf);
+    g_stats[PATH_STAT_BC_MISSES]++;
+    return LUZ_E_PATH_LOAD;
+  }
+  hdr = (const unsigned char *)buf;
+  payload = (len >= LUABC_HDR_LEN) ? bc_get_u32(hdr + 12) : 0;
+  if (len < LUABC_HDR_LEN || memcmp(hdr, g_bc_magic, 4) != 0 ||
+      bc_get_u32(hdr + 4) != luaz_crc32(src, (size_t)srclen) ||
+      bc_get_u32(hdr + 8) != (uint32_t)srclen || payload == 0 ||
+      payload > len - LUABC_HDR_LEN ||
+      bc_get_u32(hdr + 16) !=
+          luaz_crc32(buf + LUABC_HDR_LEN, (size_t)payload)) {
+    free(buf);
+    g_stats[PATH_STAT_BC_MISSES]++;
+    g_stats[PATH_STAT_BC_STALE]++;
+    return LUZ_E_PATH_LOAD;
+  }
+  memmove(buf, buf + LUABC_HDR_LEN, (size_t)payload);
+  *code = buf;
+  *codelen = (unsigned long)payload;
+  g_stats[PATH_STAT_BC_HITS]++;
+  return 0;
+}
+
+/**
+ * @brief Store bytecode for a member in the cache DD.
+ *
+ * @param member Resolved member name.
+ * @param src Module source text the bytecode was compiled from.
+ * @param srclen Source length in bytes.
+ * @param code lua_dump output.
+ * @param codelen lua_dump output length.
+ * @return 0 on success, or LUZ_E_PATH_LOAD on failure/disabled write-back.
+ */
+int luaz_path_bc_put(const char *member, const char *src,
+                     unsigned long srclen, const char *code,
+                     unsigned long codelen)
+{
+  unsigned char *buf;
+  int rc;
+
+  if (member == NULL || src == NULL || code == NULL || codelen == 0)
+    return LUZ_E_PATH_LOAD;
+  if (g_ops.bc_write == NULL)
+    return LUZ_E_PATH_LOAD;
+  buf = (unsigned char *)malloc((size_t)codelen + LUABC_HDR_LEN);
+  if (buf == NULL)
+    return LUZ_E_PATH_LOAD;
+  memcpy(buf, g_bc_magic, 4);
+  bc_put_u32(buf + 4, luaz_crc32(src, (size_t)srclen));
+  bc_put_u32(buf + 8, (uint32_t)srclen);
+  bc_put_u32(buf + 12, (uint32_t)codelen);
+  bc_put_u32(buf + 16, luaz_crc32(code, (size_t)codelen));
+  memcpy(buf + LUABC_HDR_LEN, code, (size_t)codelen);
+  rc = g_ops.bc_write(member, (const char *)buf,
+                      codelen + LUABC_HDR_LEN);
+  free(buf);
+  if (rc != 0)
+    return LUZ_E_PATH_LOAD;
+  g_stats[PATH_STAT_BC_WRITES]++;
+  return 0;
+}
+
+int luaz_path_bc_writable(void)
+{
+  return (g_ops.bc_write != NULL) ? 1 : 0;
+}
+
+void luaz_path_invalidate(void)
+{
+  luamap_free();
+  dir_free();
+  bundle_free();
+}
+
+void luaz_path_reset(void)
+{
+  luaz_path_invalidate();
+  memset(g_stats, 0, sizeof(g_stats));
+}
+
+int luaz_path_stat_count(void)
+{
+  return PATH_STAT_COUNT;
+}
+
+const char *luaz_path_stat_name(int index)
+{
+  if (index < 0 || index >= PATH_STAT_COUNT)
+    return NULL;
+  return g_stat_names[index];
+}
+
+unsigned long luaz_path_stat_value(int index)
+{
+  if (index < 0 || index >= PATH_STAT_COUNT)
+    return 0;
+  return g_stats[index];
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Lua/TSO PDS/PDSE directory block parser.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | luaz_pdsdir_init | function | Reset parser state |
+ * | luaz_pdsdir_block | function | Parse one 256-byte directory block |
+ *
+ * Platform Requirements:
+ * - Pure byte parsing; no I/O. Callers read directory blocks with
+ *   fopen(..., "rb,type=record,recfm=u") on z/OS.
+ * - Member names are returned as stored (EBCDIC on z/OS).
+ */
+#include "PDSDIR"
+
+#include <string.h>
+
+void luaz_pdsdir_init(struct luaz_pdsdir_state *st)
+{
+  if (st == NULL)
+    return;
+  st->concat = 0;
+  st->ended = 0;
+}
+
+int luaz_pdsdir_block(struct luaz_pdsdir_state *st, const unsigned char *blk,
+                      unsigned long len, luaz_pdsdir_cb cb, void *ud)
+{
+  struct luaz_pdsdir_entry e;
+  unsigned long used;
+  unsigned long off = 2;
+
+  if (st == NULL || blk == NULL || len < 2)
+    return -1;
+  /* First halfword: bytes used in this block, including itself. */
+  used = ((unsigned long)blk[0] << 8) | (unsigned long)blk[1];
+  if (used < 2)
+    return 0;  /* unused (never written) directory block */
+  if (used > len)
+    return -1;
+
+  while (off + 12 <= used) {
+    const unsigned char *p = blk + off;
+    unsigned long elen;
+    int i;
+
+    if (memcmp(p, "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 8) == 0) {
+      /* Every marker ends one dataset, including an empty library whose
+       * directory is the marker alone. */
+      st->concat++;
+      st->ended = 1;
+      return 0;
+    }
+    elen = 12u + 2u * (unsigned long)(p[11] & 0x1Fu);
+    if (off + elen > used)
+      return -1;
+    st->ended = 0;
+
+    memcpy(e.name, p, 8);
+    e.name[8] = '\0';
+    for (i = 7; i >= 0 && (e.name[i] == ' ' || e.name[i] == '\0'); i--)
+      e.name[i] = '\0';
+    memcpy(e.ttr, p + 8, 3);
+    e.alias = (unsigned char)((p[11] & 0x80u) ? 1 : 0);
+    e.ulen = (unsigned char)(2u * (p[11] & 0x1Fu));
+    e.user = p + 12;
+    e.concat = st->concat;
+    if (cb != NULL && cb(ud, &e) != 0)
+      return 1;
+    off += elen;
+  }
+  return 0;
+}
@@ -28,6 +28,65 @@ static int luaz_member_read(const char *member, char *buf, unsigned long *len)
   return g_ops.luapath_read_member(member, buf, len);
 }
 
+static int luaz_member_read_alloc(const char *member, char **buf,
+                                  unsigned long *len)
+{
+  if (g_ops.luapath_read_member_alloc == 0)
+    return -1;
+  return g_ops.luapath_read_member_alloc(member, buf, len);
+}
+
+static int luaz_bc_read_alloc(const char *member, char **buf,
+                              unsigned long *len)
+{
+  if (g_ops.luabc_read_member_alloc == 0)
+    return -1;
+  return g_ops.luabc_read_member_alloc(member, buf, len);
+}
+
+static int luaz_bc_write(const char *member, const char *buf,
+                         unsigned long len)
+{
+  if (g_ops.luabc_write_member == 0)
+    return -1;
+  return g_ops.luabc_write_member(member, buf, len);
+}
+
+static int luaz_member_list(luaz_path_member_cb cb, void *ud)
+{
+  if (g_ops.luapath_list_members == 0)
+    return -1;
+  return g_ops.luapath_list_members(cb, ud);
+}
+
+static int luaz_member_open(const char *member, void **stream)
+{
+  if (g_ops.luapath_open_member == 0)
+    return -1;
+  return g_ops.luapath_open_member(member, stream);
+}
+
+static int luaz_stream_read(void *stream, char *buf, unsigned long *len)
+{
+  if (g_ops.luapath_read_stream == 0)
+    return -1;
+  return g_ops.luapath_read_stream(stream, buf, len);
+}
+
+static int luaz_stream_close(void *stream)
+{
+  if (g_ops.luapath_close_stream == 0)
+    return -1;
+  return g_ops.luapath_close_stream(stream);
+}
+
+static int luaz_bundle_read_alloc(char **buf, unsigned long *len)
+{
+  if (g_ops.luabundle_read_alloc == 0)
+    return -1;
+  return g_ops.luabundle_read_alloc(buf, len);
+}
+
 int luaz_platform_set_ops(const struct luaz_platform_ops *ops)
 {
   if (ops == 0)
@@ -37,6 +96,32 @@ int luaz_platform_set_ops(const struct luaz_platform_ops *ops)
   if (g_ops.luapath_read_luamap != 0 && g_ops.luapath_read_member != 0) {
     g_path_ops.luamap_read = luaz_luamap_read;
     g_path_ops.member_read = luaz_member_read;
+    g_path_ops.member_read_alloc = (g_ops.luapath_read_member_alloc != 0)
+                                       ? luaz_member_read_alloc
+                                       : 0;
+    g_path_ops.bc_read_alloc = (g_ops.luabc_read_member_alloc != 0)
+                                   ? luaz_bc_read_alloc
+                                   : 0;
+    g_path_ops.bc_write = (g_ops.luabc_write_member != 0)
+                              ? luaz_bc_write
+                              : 0;
+    g_path_ops.member_list = (g_ops.luapath_list_members != 0)
+                                 ? luaz_member_list
+                                 : 0;
+    if (g_ops.luapath_open_member != 0 && g_ops.luapath_read_stream != 0 &&
+        g_ops.luapath_close_stream != 0) {
+      g_path_ops.member_open = luaz_member_open;
+      g_path_ops.stream_read = luaz_stream_read;
+      g_path_ops.stream_close = luaz_stream_close;
+    }
+    else {
+      g_path_ops.member_open = 0;
+      g_path_ops.stream_read = 0;
+      g_path_ops.stream_close = 0;
+    }
+    g_path_ops.bundle_read_alloc = (g_ops.luabundle_read_alloc != 0)
+                                       ? luaz_bundle_read_alloc
+                                       : 0;
     (void)luaz_path_set_ops(&g_path_ops);
   }
 
@@ -47,9 +47,16 @@ static luaz_policy_entry g_policy[] = {
   {"tso.rexx.exec", "", 0},
   {"tso.rexx.dd", "", 0},
   {"luapath.dd", "", 0},
+  {"luabc.dd", "", 0},
+  {"luabc.write", "", 0},
+  {"luabundle.dd", "", 0},
   {"luain.dd", "", 0},
   {"luaout.dd", "", 0},
   {"luaconf.member", "", 0},
+  {"luapreload.member", "", 0},
+  {"luapreload.max", "", 0},
+  {"ds.opencache", "", 0},
+  {"ds.bufmult", "", 0},
   {"tls.keyring", "", 0},
   {"tls.pkcs11.token", "", 0},
   {"tls.profile", "", 0}
@@ -268,16 +275,23 @@ static int policy_validate_value(const char *key, const char *value)
     return policy_is_allow_mode(value);
   if (policy_stricmp(key, "trace.level") == 0)
     return policy_is_trace_level(value);
-  if (policy_stricmp(key, "limits.output.lines") == 0)
+  if (policy_stricmp(key, "limits.output.lines") == 0 ||
+      policy_stricmp(key, "luapreload.max") == 0 ||
+      policy_stricmp(key, "ds.bufmult") == 0)
     return policy_is_number(value);
-  if (policy_stricmp(key, "tso.cmd.capture.default") == 0)
+  if (policy_stricmp(key, "tso.cmd.capture.default") == 0 ||
+      policy_stricmp(key, "luabc.write") == 0 ||
+      policy_stricmp(key, "ds.opencache") == 0)
     return policy_is_bool(value);
   if (policy_stricmp(key, "tso.rexx.exec") == 0 ||
       policy_stricmp(key, "tso.rexx.dd") == 0 ||
       policy_stricmp(key, "luapath.dd") == 0 ||
+      policy_stricmp(key, "luabc.dd") == 0 ||
+      policy_stricmp(key, "luabundle.dd") == 0 ||
       policy_stricmp(key, "luain.dd") == 0 ||
       policy_stricmp(key, "luaout.dd") == 0 ||
-      policy_stricmp(key, "luaconf.member") == 0)
+      policy_stricmp(key, "luaconf.member") == 0 ||
+      policy_stricmp(key, "luapreload.member") == 0)
     return policy_is_ddname(value);
   return 1;
 }
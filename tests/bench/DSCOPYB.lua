@@ -0,0 +1,85 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- z/OS benchmark: dataset copy with a Lua readline/writeline loop versus
+-- ds.copy (records, FB to VB with trim, text stream). Run by
+-- jcl/BDSCOPY.jcl.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fill | function | Write the FB80 source records |
+-- | lua_copy | function | Copy with a readline/writeline loop |
+-- | timed | function | Run a copy and return CPU ms and counts |
+-- | main | function | Run the cases and print timings |
+local ds = require("ds")
+
+local RECORDS = 200000
+
+local function fill()
+  local h, msg = ds.open_dd("BENCHIN", { mode = "w", type = "record" })
+  if not h then
+    return nil, msg
+  end
+  local batch = {}
+  for i = 1, RECORDS do
+    batch[#batch + 1] = string.format("%08d CUSTOMER %-40s", i, "NAME " .. i)
+      .. string.rep(" ", 80)
+    batch[#batch] = batch[#batch]:sub(1, 80)
+    if #batch == 1000 then
+      h:write_records(batch)
+      batch = {}
+    end
+  end
+  h:write_records(batch)
+  h:close()
+  return true
+end
+
+local function lua_copy()
+  local src = assert(ds.open_dd("BENCHIN", { mode = "r", type = "record" }))
+  local dst = assert(ds.open_dd("BENCHOUT", { mode = "w", type = "record" }))
+  local n, bytes = 0, 0
+  for line in src:lines() do
+    dst:writeline(line)
+    n = n + 1
+    bytes = bytes + #line
+  end
+  src:close()
+  dst:close()
+  return n, bytes
+end
+
+local function timed(f)
+  local t0 = os.clock()
+  local n, bytes = f()
+  return (os.clock() - t0) * 1000, n, bytes
+end
+
+local function main()
+  local ok, msg = fill()
+  if not ok then
+    print("LUZ00005 DSCOPYB failed: " .. tostring(msg))
+    return 8
+  end
+  local cases = {
+    { "lua_loop", lua_copy },
+    { "copy_records", function()
+      return ds.copy("DD:BENCHIN", "DD:BENCHOUT") end },
+    { "copy_trim_vb", function()
+      return ds.copy("DD:BENCHIN", "DD:BENCHOUT", { trim = true }) end },
+    { "copy_stream", function()
+      return ds.copy("DD:BENCHIN", "DD:BENCHOUT", { type = "stream" }) end },
+  }
+  for _, c in ipairs(cases) do
+    local ms, n, bytes = timed(c[2])
+    if not n then
+      print("LUZ00005 DSCOPYB failed: " .. c[1] .. " " .. tostring(bytes))
+      return 8
+    end
+    print(string.format("DSCOPYB case=%s records=%d bytes=%d cpu_ms=%.1f",
+      c[1], n, bytes, ms))
+  end
+  return 0
+end
+
+return main()
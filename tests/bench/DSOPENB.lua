@@ -0,0 +1,49 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- z/OS benchmark: open/close latency of ds.open_dd with and without the
+-- open-form cache (ds.opencache). Run by jcl/BDSOPEN.jcl.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | bench_dd | function | Time N open/close pairs of one DD |
+-- | main | function | Run the DDs and print timings and counters |
+local ds = require("ds")
+
+local ITERS = 2000
+
+local function bench_dd(ddname, mode)
+  local t0 = os.clock()
+  for _ = 1, ITERS do
+    local h, msg = ds.open_dd(ddname, mode)
+    if not h then
+      return nil, msg or ("open " .. ddname)
+    end
+    h:close()
+  end
+  return (os.clock() - t0) * 1000000.0 / ITERS
+end
+
+local function main()
+  local cases = {
+    { "BENCHPS", "r" },
+    { "BENCHFB", "a" },
+  }
+  ds.openstats(true)
+  for _, c in ipairs(cases) do
+    local us, err = bench_dd(c[1], c[2])
+    if not us then
+      print("LUZ00005 DSOPENB failed: " .. err)
+      return 8
+    end
+    print(string.format("DSOPENB dd=%s mode=%s iters=%d us_per_open=%.1f",
+      c[1], c[2], ITERS, us))
+  end
+  local s = ds.openstats()
+  print(string.format(
+    "DSOPENB opens=%d hits=%d misses=%d probes=%d probes_saved=%d",
+    s.opens, s.hits, s.misses, s.probes, s.probes_saved))
+  return 0
+end
+
+return main()
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: require with and without the LUABC bytecode cache.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_write_file | function | Write a stand-in member or config file |
+ * | bench_gen_module | function | Generate a synthetic LUAPATH module |
+ * | bench_run | function | Time N require() calls in fresh Lua states |
+ * | main | function | Run source/cold/warm phases and print timings |
+ *
+ * Platform Requirements:
+ * - Host build only (POSIX mkdir/clock_gettime); see scripts/host_bench.sh.
+ * - Uses the IOHOST stand-in: <root>/LUAPATH and <root>/LUABC directories.
+ */
+#include "IOHOST"
+#include "PATH"
+#include "POLICY"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define BENCH_MODULE "BENCHMOD"
+
+/**
+ * @brief Write a stand-in member or config file.
+ *
+ * @param path File path.
+ * @param text File contents.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_write_file(const char *path, const char *text)
+{
+  FILE *fp = fopen(path, "w");
+  int rc;
+
+  if (fp == NULL)
+    return -1;
+  rc = (fputs(text, fp) < 0) ? -1 : 0;
+  if (fclose(fp) != 0)
+    rc = -1;
+  return rc;
+}
+
+/**
+ * @brief Generate a synthetic module with many small functions.
+ *
+ * @param path Member file path.
+ * @param nfuncs Number of functions to emit.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_gen_module(const char *path, int nfuncs)
+{
+  FILE *fp = fopen(path, "w");
+  int i;
+
+  if (fp == NULL)
+    return -1;
+  fprintf(fp, "local M = {}\n");
+  for (i = 0; i < nfuncs; i++) {
+    fprintf(fp,
+            "function M.f%d(a, b)\n"
+            "  local t = { a, b, %d }\n"
+            "  if a > b then return t[1] * %d + #t else\n"
+            "    return string.format('%%d:%%d', b, %d) end\n"
+            "end\n",
+            i, i, i, i);
+  }
+  fprintf(fp, "return M\n");
+  return (fclose(fp) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Time N require() calls, each in a fresh Lua state.
+ *
+ * @param root Stand-in root directory.
+ * @param cfg LUACFG-style config file to load first.
+ * @param iters Number of iterations.
+ * @param out_ms Output elapsed milliseconds.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_run(const char *root, const char *cfg, int iters,
+                     double *out_ms)
+{
+  struct timespec t0;
+  struct timespec t1;
+  int i;
+
+  if (luaz_policy_load(cfg) != 0 || luaz_io_host_register(root) != 0)
+    return -1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (i = 0; i < iters; i++) {
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    lua_getglobal(L, "require");
+    lua_pushstring(L, BENCH_MODULE);
+    if (lua_pcall(L, 1, 1, 0) != LUA_OK) {
+      fprintf(stderr, "require failed: %s\n", lua_tostring(L, -1));
+      lua_close(L);
+      return -1;
+    }
+    lua_close(L);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  *out_ms = (double)(t1.tv_sec - t0.tv_sec) * 1000.0 +
+            (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+  return 0;
+}
+
+/**
+ * @brief Print one phase line with LUAPATH cache counters.
+ *
+ * @param phase Phase label.
+ * @param iters Iterations run.
+ * @param ms Elapsed milliseconds.
+ */
+static void bench_report(const char *phase, int iters, double ms)
+{
+  int i;
+
+  printf("%-6s iters=%d total_ms=%.1f per_require_us=%.1f", phase, iters,
+         ms, ms * 1000.0 / (double)iters);
+  for (i = 0; i < luaz_path_stat_count(); i++) {
+    const char *name = luaz_path_stat_name(i);
+    if (name != NULL && strncmp(name, "bc_", 3) == 0)
+      printf(" %s=%lu", name, luaz_path_stat_value(i));
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  char path[1024];
+  char cfg_off[1024];
+  char cfg_on[1024];
+  const char *root;
+  int iters;
+  int nfuncs;
+  double ms = 0.0;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: bcbench <root> [iters] [functions]\n");
+    return 8;
+  }
+  root = argv[1];
+  iters = (argc > 2) ? atoi(argv[2]) : 200;
+  nfuncs = (argc > 3) ? atoi(argv[3]) : 400;
+  if (iters <= 0 || nfuncs <= 0)
+    return 8;
+
+  snprintf(path, sizeof(path), "%s/LUAPATH", root);
+  (void)mkdir(root, 0755);
+  (void)mkdir(path, 0755);
+  snprintf(path, sizeof(path), "%s/LUABC", root);
+  (void)mkdir(path, 0755);
+  snprintf(path, sizeof(path), "%s/LUABC/%s", root, BENCH_MODULE);
+  (void)remove(path);
+  snprintf(path, sizeof(path), "%s/LUAPATH/%s", root, BENCH_MODULE);
+  snprintf(cfg_off, sizeof(cfg_off), "%s/LUACFG.OFF", root);
+  snprintf(cfg_on, sizeof(cfg_on), "%s/LUACFG.ON", root);
+  if (bench_gen_module(path, nfuncs) != 0 ||
+      bench_write_file(cfg_off, "# no bytecode cache\n") != 0 ||
+      bench_write_file(cfg_on, "luabc.dd = LUABC\nluabc.write = true\n") != 0) {
+    fprintf(stderr, "cannot prepare %s\n", root);
+    return 12;
+  }
+
+  if (bench_run(root, cfg_off, iters, &ms) != 0)
+    return 12;
+  bench_report("source", iters, ms);
+  if (bench_run(root, cfg_on, 1, &ms) != 0)
+    return 12;
+  bench_report("cold", 1, ms);
+  if (bench_run(root, cfg_on, iters, &ms) != 0)
+    return 12;
+  bench_report("warm", iters, ms);
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: require an application from LUAPATH members vs a
+ * single application bundle (luabundle.dd).
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_write_file | function | Write a stand-in member, bundle or config |
+ * | bench_gen_source | function | Generate the source of one small module |
+ * | bench_run | function | Time N runs that require every module |
+ * | main | function | Prepare members + bundle and print timings |
+ *
+ * Platform Requirements:
+ * - Host build only (POSIX mkdir/clock_gettime); see scripts/host_bench.sh.
+ * - Uses the IOHOST stand-in: <root>/LUAPATH directory, <root>/APPBNDL file.
+ */
+#include "BUNDLE"
+#include "IOHOST"
+#include "PATH"
+#include "POLICY"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define BENCH_SRC_MAX 256
+
+/**
+ * @brief Write a stand-in member, bundle or config file.
+ *
+ * @param path File path.
+ * @param data File contents.
+ * @param len Number of bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_write_file(const char *path, const char *data,
+                            unsigned long len)
+{
+  FILE *fp = fopen(path, "wb");
+  int rc;
+
+  if (fp == NULL)
+    return -1;
+  rc = (fwrite(data, 1, (size_t)len, fp) == (size_t)len) ? 0 : -1;
+  if (fclose(fp) != 0)
+    rc = -1;
+  return rc;
+}
+
+/**
+ * @brief Generate the source of one small module.
+ *
+ * @param buf Output buffer (BENCH_SRC_MAX bytes).
+ * @param i Module index.
+ * @return Source length.
+ */
+static unsigned long bench_gen_source(char *buf, int i)
+{
+  int n = snprintf(buf, BENCH_SRC_MAX,
+                   "local M = { id = %d }\n"
+                   "function M.f(a) return a * %d + M.id end\n"
+                   "return M\n",
+                   i, i + 1);
+  return (n > 0) ? (unsigned long)n : 0;
+}
+
+/**
+ * @brief Time N runs, each requiring every module in a fresh Lua state.
+ *
+ * @param root Stand-in root directory.
+ * @param cfg LUACFG-style config file to load first.
+ * @param fmt Module name format ("%s" gets the index).
+ * @param nmods Number of modules.
+ * @param iters Number of iterations.
+ * @param out_ms Output elapsed milliseconds.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_run(const char *root, const char *cfg, const char *fmt,
+                     int nmods, int iters, double *out_ms)
+{
+  struct timespec t0;
+  struct timespec t1;
+  char name[64];
+  int i;
+  int m;
+
+  if (luaz_policy_load(cfg) != 0 || luaz_io_host_register(root) != 0)
+    return -1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (i = 0; i < iters; i++) {
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    for (m = 0; m < nmods; m++) {
+      snprintf(name, sizeof(name), fmt, m);
+      lua_getglobal(L, "require");
+      lua_pushstring(L, name);
+      if (lua_pcall(L, 1, 1, 0) != LUA_OK) {
+        fprintf(stderr, "require %s failed: %s\n", name,
+                lua_tostring(L, -1));
+        lua_close(L);
+        return -1;
+      }
+      lua_pop(L, 1);
+    }
+    lua_close(L);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  *out_ms = (double)(t1.tv_sec - t0.tv_sec) * 1000.0 +
+            (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+  return 0;
+}
+
+/**
+ * @brief Print one phase line with directory and bundle counters.
+ *
+ * @param phase Phase label.
+ * @param iters Iterations run.
+ * @param ms Elapsed milliseconds.
+ */
+static void bench_report(const char *phase, int iters, double ms)
+{
+  int i;
+
+  printf("%-7s iters=%d total_ms=%.1f per_run_ms=%.2f", phase, iters, ms,
+         ms / (double)iters);
+  for (i = 0; i < luaz_path_stat_count(); i++) {
+    const char *name = luaz_path_stat_name(i);
+    if (name != NULL && (strcmp(name, "dir_loads") == 0 ||
+                         strncmp(name, "bundle_", 7) == 0))
+      printf(" %s=%lu", name, luaz_path_stat_value(i));
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  char path[1024];
+  char cfg_mem[1024];
+  char cfg_bnd[1024];
+  struct luaz_bundle_item *items;
+  char *srcs;
+  char *img = NULL;
+  unsigned long img_len = 0;
+  const char *root;
+  int iters;
+  int nmods;
+  int m;
+  double ms = 0.0;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: bndlbench <root> [iters] [modules]\n");
+    return 8;
+  }
+  root = argv[1];
+  iters = (argc > 2) ? atoi(argv[2]) : 20;
+  nmods = (argc > 3) ? atoi(argv[3]) : 300;
+  if (iters <= 0 || nmods <= 0 || nmods > 9999)
+    return 8;
+
+  (void)mkdir(root, 0755);
+  snprintf(path, sizeof(path), "%s/LUAPATH", root);
+  (void)mkdir(path, 0755);
+  items = (struct luaz_bundle_item *)calloc((size_t)nmods, sizeof(*items));
+  srcs = (char *)malloc((size_t)nmods * (BENCH_SRC_MAX + 16));
+  if (items == NULL || srcs == NULL)
+    return 12;
+
+  /* Same sources twice: members BM0000.. and bundle names app.mod0000.. */
+  for (m = 0; m < nmods; m++) {
+    char *src = srcs + (size_t)m * (BENCH_SRC_MAX + 16);
+    char *name = src + BENCH_SRC_MAX;
+    unsigned long len = bench_gen_source(src, m);
+
+    snprintf(path, sizeof(path), "%s/LUAPATH/BM%04d", root, m);
+    if (bench_write_file(path, src, len) != 0)
+      return 12;
+    snprintf(name, 16, "app.mod%04d", m);
+    items[m].name = name;
+    items[m].data = src;
+    items[m].len = len;
+  }
+  snprintf(path, sizeof(path), "%s/APPBNDL", root);
+  snprintf(cfg_mem, sizeof(cfg_mem), "%s/LUACFG.MEM", root);
+  snprintf(cfg_bnd, sizeof(cfg_bnd), "%s/LUACFG.BND", root);
+  if (luaz_bundle_build(items, (unsigned long)nmods, &img, &img_len) != 0 ||
+      bench_write_file(path, img, img_len) != 0 ||
+      bench_write_file(cfg_mem, "# LUAPATH members\n", 18) != 0 ||
+      bench_write_file(cfg_bnd, "luabundle.dd = APPBNDL\n", 23) != 0) {
+    fprintf(stderr, "cannot prepare %s\n", root);
+    return 12;
+  }
+  free(img);
+
+  if (bench_run(root, cfg_mem, "BM%04d", nmods, iters, &ms) != 0)
+    return 12;
+  bench_report("members", iters, ms);
+  if (bench_run(root, cfg_bnd, "app.mod%04d", nmods, iters, &ms) != 0)
+    return 12;
+  bench_report("bundle", iters, ms);
+  free(items);
+  free(srcs);
+  return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: codec.convert throughput between IBM-1047, ISO8859-1
+ * and UTF-8 versus a string.gsub translation table in Lua.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_push_text | function | Push IBM-1047 text with some accented letters |
+ * | main | function | Build the text, check and time the conversions |
+ *
+ * Platform Requirements:
+ * - Host build only; see scripts/host_bench.sh.
+ */
+#include "CODEC"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *g_script =
+    "local codec, text = ...\n"
+    "local mb = #text / (1024 * 1024)\n"
+    "local function timed(f)\n"
+    "  local t0 = os.clock()\n"
+    "  local v = f()\n"
+    "  return v, (os.clock() - t0)\n"
+    "end\n"
+    "local l1, t_map = timed(function()\n"
+    "  return codec.convert(text, 'IBM-1047', 'ISO8859-1') end)\n"
+    "local u8, t_enc = timed(function()\n"
+    "  return codec.convert(text, 'IBM-1047', 'UTF-8') end)\n"
+    "local back, t_dec = timed(function()\n"
+    "  return codec.convert(u8, 'UTF-8', 'IBM-1047') end)\n"
+    "assert(back == text, 'round trip')\n"
+    "local tbl = {}\n"
+    "local all = {}\n"
+    "for i = 0, 255 do all[#all + 1] = string.char(i) end\n"
+    "local map = codec.convert(table.concat(all), 'IBM-1047', 'ISO8859-1')\n"
+    "for i = 0, 255 do tbl[string.char(i)] = map:sub(i + 1, i + 1) end\n"
+    "local g, t_gsub = timed(function() return (text:gsub('.', tbl)) end)\n"
+    "assert(g == l1, 'gsub table mismatch')\n"
+    "local function rate(t) return t > 0 and mb / t or 0 end\n"
+    "print(string.format('bytes=%d utf8_bytes=%d', #text, #u8))\n"
+    "print(string.format('map_mbs=%.0f encode_mbs=%.0f decode_mbs=%.0f "
+    "gsub_mbs=%.1f',\n"
+    "  rate(t_map), rate(t_enc), rate(t_dec), rate(t_gsub)))\n";
+
+/**
+ * @brief Push IBM-1047 text: 80-byte lines of letters, digits and blanks
+ *        with an accented letter in every fourth line, ended by NL.
+ *
+ * @param L Lua state.
+ * @param size Text size in bytes.
+ */
+static void bench_push_text(lua_State *L, size_t size)
+{
+  /* IBM-1047 "A".."I", "J".."R", "S".."Z", "0".."9" and blank. */
+  static const unsigned char alpha[] = {
+      0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xD1,
+      0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xE2, 0xE3,
+      0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xF0, 0xF1, 0xF2, 0xF3,
+      0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0x40, 0x40};
+  luaL_Buffer b;
+  unsigned char *p = (unsigned char *)luaL_buffinitsize(L, &b, size);
+  size_t i;
+
+  for (i = 0; i < size; i++) {
+    size_t col = i % 80;
+    size_t line = i / 80;
+    if (col == 79)
+      p[i] = 0x15;
+    else if (line % 4 == 0 && col == 40)
+      p[i] = 0x51; /* e-acute */
+    else
+      p[i] = alpha[(i * 7 + line) % sizeof(alpha)];
+  }
+  luaL_pushresultsize(&b, size);
+}
+
+int main(int argc, char **argv)
+{
+  long mb;
+  lua_State *L;
+  int rc;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: codecbench <root> [megabytes]\n");
+    return 8;
+  }
+  mb = (argc > 2) ? atol(argv[2]) : 16;
+  if (mb <= 0)
+    return 8;
+
+  L = luaL_newstate();
+  luaL_openlibs(L);
+  if (luaL_loadstring(L, g_script) != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    lua_close(L);
+    return 12;
+  }
+  luaopen_codec(L);
+  bench_push_text(L, (size_t)mb * 1024 * 1024);
+  rc = lua_pcall(L, 2, 0, 0);
+  if (rc != LUA_OK)
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+  lua_close(L);
+  return (rc == LUA_OK) ? 0 : 12;
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark and fixture check: COBOL records (zoned, packed,
+ * binary, OCCURS) decoded with a ds.copybook plan versus per-byte Lua.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_zoned | function | Store a zoned decimal field |
+ * | bench_packed | function | Store a packed decimal field |
+ * | bench_be | function | Store a big-endian binary field |
+ * | bench_gen_file | function | Write the binary fixture file |
+ * | bench_load_file | function | Read the fixture back into a Lua string |
+ * | main | function | Generate the fixture, check and time both decoders |
+ *
+ * Platform Requirements:
+ * - Host build only; see scripts/host_bench.sh. The fixture bytes are
+ *   the z/OS ones (EBCDIC zones F/D, big-endian binary), so the check is
+ *   the same decode the runtime does on z/OS.
+ */
+#include "DSCOPY"
+#include "DSREC"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_RECLEN 40
+
+/* 01 CUST-REC (40 bytes): the same layout in Lua source for both paths. */
+static const char *g_copybook =
+    "       01  CUST-REC.\n"
+    "           05  CUST-ID        PIC 9(8).\n"
+    "           05  CUST-NAME      PIC X(8).\n"
+    "           05  BALANCE        PIC S9(9)V99 COMP-3.\n"
+    "           05  VISITS         PIC S9(4) COMP.\n"
+    "           05  TOTAL          PIC 9(9) BINARY.\n"
+    "           05  HIST OCCURS 3 TIMES.\n"
+    "               10  H-AMT      PIC S9(5) COMP-3.\n"
+    "           05  DELTA          PIC S9(3).\n";
+
+static const char *g_script =
+    "local ds, data, nrec, want_bal, want_vis = ...\n"
+    "local cb = ds.copybook(CPY)\n"
+    "assert(cb:reclen() == 40)\n"
+    "local function packed(s, i, n)\n"
+    "  local v = 0\n"
+    "  for k = i, i + n - 1 do\n"
+    "    local b = s:byte(k)\n"
+    "    if k < i + n - 1 then v = v * 100 + (b >> 4) * 10 + (b & 15)\n"
+    "    else v = v * 10 + (b >> 4); if (b & 15) == 13 then v = -v end end\n"
+    "  end\n"
+    "  return v\n"
+    "end\n"
+    "local function zoned(s, i, n)\n"
+    "  local v = 0\n"
+    "  for k = i, i + n - 1 do v = v * 10 + (s:byte(k) & 15) end\n"
+    "  if (s:byte(i + n - 1) >> 4) == 13 then v = -v end\n"
+    "  return v\n"
+    "end\n"
+    "local function lua_decode(r)\n"
+    "  return { ['CUST-ID'] = zoned(r, 1, 8), ['CUST-NAME'] = r:sub(9, 16),\n"
+    "    BALANCE = packed(r, 17, 6) / 100, VISITS = (string.unpack('>i2', r, 23)),\n"
+    "    TOTAL = (string.unpack('>I4', r, 25)),\n"
+    "    HIST = { { ['H-AMT'] = packed(r, 29, 3) }, { ['H-AMT'] = packed(r, 32, 3) },\n"
+    "             { ['H-AMT'] = packed(r, 35, 3) } },\n"
+    "    DELTA = zoned(r, 38, 3) }\n"
+    "end\n"
+    "local function pass(decode)\n"
+    "  local bal, vis, t = 0, 0, {}\n"
+    "  local t0 = os.clock()\n"
+    "  for i = 0, nrec - 1 do\n"
+    "    local r = decode(data:sub(i * 40 + 1, i * 40 + 40), t)\n"
+    "    bal = bal + math.floor(r.BALANCE * 100 + 0.5)\n"
+    "    vis = vis + r.VISITS + r.HIST[2]['H-AMT'] + r.DELTA\n"
+    "  end\n"
+    "  assert(bal == want_bal and vis == want_vis, 'fixture mismatch')\n"
+    "  return (os.clock() - t0) * 1000\n"
+    "end\n"
+    "local c = pass(function(r, t) return cb:decode(r, t) end)\n"
+    "local l = pass(lua_decode)\n"
+    "print(string.format('records=%d copybook_ms=%.1f lua_ms=%.1f check=ok', nrec, c, l))\n";
+
+/**
+ * @brief Store a zoned decimal field (zone F, D on the last byte if < 0).
+ *
+ * @param p Output bytes.
+ * @param n Field length.
+ * @param v Value.
+ */
+static void bench_zoned(unsigned char *p, int n, long v)
+{
+  int neg = v < 0;
+  int i;
+
+  if (neg)
+    v = -v;
+  for (i = n - 1; i >= 0; i--) {
+    p[i] = (unsigned char)(0xF0 | (v % 10));
+    v /= 10;
+  }
+  if (neg)
+    p[n - 1] = (unsigned char)(0xD0 | (p[n - 1] & 0x0F));
+}
+
+/**
+ * @brief Store a packed decimal field (sign nibble C or D).
+ *
+ * @param p Output bytes.
+ * @param n Field length.
+ * @param v Value.
+ */
+static void bench_packed(unsigned char *p, int n, long long v)
+{
+  int neg = v < 0;
+  int i;
+
+  if (neg)
+    v = -v;
+  p[n - 1] = (unsigned char)(((v % 10) << 4) | (neg ? 0x0D : 0x0C));
+  v /= 10;
+  for (i = n - 2; i >= 0; i--) {
+    p[i] = (unsigned char)((v % 10) | (((v / 10) % 10) << 4));
+    v /= 100;
+  }
+}
+
+/**
+ * @brief Store a big-endian binary field.
+ *
+ * @param p Output bytes.
+ * @param n Field length.
+ * @param v Value (two's complement bits for negative numbers).
+ */
+static void bench_be(unsigned char *p, int n, unsigned long v)
+{
+  int i;
+
+  for (i = n - 1; i >= 0; i--) {
+    p[i] = (unsigned char)(v & 0xFF);
+    v >>= 8;
+  }
+}
+
+/**
+ * @brief Write the fixture file and the expected totals.
+ *
+ * @param path File path.
+ * @param nrec Record count.
+ * @param bal Output sum of BALANCE in cents.
+ * @param vis Output sum of VISITS + HIST(2) + DELTA.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_gen_file(const char *path, long nrec, long long *bal,
+                          long long *vis)
+{
+  FILE *fp = fopen(path, "wb");
+  unsigned char r[BENCH_RECLEN];
+  long i;
+
+  if (fp == NULL)
+    return -1;
+  *bal = 0;
+  *vis = 0;
+  for (i = 0; i < nrec; i++) {
+    long long b = (i * 7919LL) % 100000000000LL - 50000000000LL;
+    long v = (i % 20000) - 10000;
+    long h = (i * 31) % 199981 - 99990;
+    long d = (i % 1999) - 999;
+    int k;
+    bench_zoned(r, 8, i);
+    memcpy(r + 8, "NAME    ", 8);
+    bench_packed(r + 16, 6, b);
+    bench_be(r + 22, 2, (unsigned long)(v & 0xFFFF));
+    bench_be(r + 24, 4, (unsigned long)(i * 3));
+    for (k = 0; k < 3; k++)
+      bench_packed(r + 28 + k * 3, 3, h + k);
+    bench_zoned(r + 37, 3, d);
+    *bal += b;
+    *vis += v + (h + 1) + d;
+    if (fwrite(r, 1, sizeof(r), fp) != sizeof(r)) {
+      fclose(fp);
+      return -1;
+    }
+  }
+  return (fclose(fp) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Read the fixture file back and push it as a Lua string.
+ *
+ * The runtime disables io.open under LUAZ_ZOS, so the bench reads the
+ * file in C.
+ *
+ * @param L Lua state.
+ * @param path File path.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_load_file(lua_State *L, const char *path)
+{
+  FILE *fp = fopen(path, "rb");
+  luaL_Buffer b;
+  size_t n;
+
+  if (fp == NULL)
+    return -1;
+  luaL_buffinit(L, &b);
+  do {
+    char *p = luaL_prepbuffer(&b);
+    n = fread(p, 1, LUAL_BUFFERSIZE, fp);
+    luaL_addsize(&b, n);
+  } while (n == LUAL_BUFFERSIZE);
+  luaL_pushresult(&b);
+  fclose(fp);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  char path[1024];
+  long long bal = 0;
+  long long vis = 0;
+  long nrec;
+  lua_State *L;
+  int rc;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: cpybench <root> [records]\n");
+    return 8;
+  }
+  nrec = (argc > 2) ? atol(argv[2]) : 200000;
+  if (nrec <= 0)
+    return 8;
+  snprintf(path, sizeof(path), "%s/CPYBENCH.DAT", argv[1]);
+  if (bench_gen_file(path, nrec, &bal, &vis) != 0)
+    return 12;
+
+  L = luaL_newstate();
+  luaL_openlibs(L);
+  luaz_dsrec_open(L);
+  luaz_dscopy_open(L);
+  lua_pushstring(L, g_copybook);
+  lua_setglobal(L, "CPY");
+  if (luaL_loadstring(L, g_script) != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    lua_close(L);
+    return 12;
+  }
+  lua_newtable(L);
+  lua_pushcfunction(L, luaz_dscopy_l_copybook);
+  lua_setfield(L, -2, "copybook");
+  lua_pushcfunction(L, luaz_dsrec_l_layout);
+  lua_setfield(L, -2, "layout");
+  if (bench_load_file(L, path) != 0) {
+    lua_close(L);
+    return 12;
+  }
+  lua_pushinteger(L, nrec);
+  lua_pushinteger(L, bal);
+  lua_pushinteger(L, vis);
+  rc = lua_pcall(L, 5, 0, 0);
+  if (rc != LUA_OK)
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+  lua_close(L);
+  remove(path);
+  return (rc == LUA_OK) ? 0 : 12;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: totals of a packed-decimal amount over a record
+ * batch with ds.decimal_sum, per-record ds.decimal arithmetic and a
+ * float layout decode.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_packed | function | Store a packed decimal field |
+ * | bench_push_batch | function | Push the record batch as a Lua array |
+ * | main | function | Build the batch, check and time the three sums |
+ *
+ * Platform Requirements:
+ * - Host build only; see scripts/host_bench.sh. Amounts are packed
+ *   S9(15)V99 (9 bytes) so the exact total needs more than 18 digits.
+ */
+#include "DSDEC"
+#include "DSREC"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_RECLEN 24
+
+static const char *g_script =
+    "local ds, recs, want = ...\n"
+    "local spec = { pos = 5, len = 9, type = 'packed', scale = 2 }\n"
+    "local lay = ds.layout({ { name = 'amt', pos = 5, len = 9,\n"
+    "                          type = 'packed', scale = 2 } })\n"
+    "local function timed(f)\n"
+    "  local t0 = os.clock()\n"
+    "  local v = f()\n"
+    "  return v, (os.clock() - t0) * 1000\n"
+    "end\n"
+    "local s, sum_ms = timed(function() return ds.decimal_sum(recs, spec) end)\n"
+    "assert(tostring(s) == want, 'decimal_sum ' .. tostring(s))\n"
+    "local d, dec_ms = timed(function()\n"
+    "  local acc = ds.decimal(0, 2)\n"
+    "  for i = 1, #recs do\n"
+    "    acc = acc + ds.unpack_decimal('packed', recs[i], 2, 5, 9)\n"
+    "  end\n"
+    "  return acc\n"
+    "end)\n"
+    "assert(tostring(d) == want, 'decimal loop ' .. tostring(d))\n"
+    "local f, flt_ms = timed(function()\n"
+    "  local acc = 0.0\n"
+    "  for i = 1, #recs do acc = acc + lay:decode(recs[i]) end\n"
+    "  return acc\n"
+    "end)\n"
+    "print(string.format('records=%d sum_ms=%.1f decimal_ms=%.1f float_ms=%.1f',\n"
+    "  #recs, sum_ms, dec_ms, flt_ms))\n"
+    "print(string.format('exact=%s float=%.2f float_exact=%s', want, f,\n"
+    "  tostring(string.format('%.2f', f) == want)))\n";
+
+/**
+ * @brief Store a packed decimal field (sign nibble C or D).
+ *
+ * @param p Output bytes.
+ * @param n Field length.
+ * @param v Value.
+ */
+static void bench_packed(unsigned char *p, int n, long long v)
+{
+  int neg = v < 0;
+  int i;
+
+  if (neg)
+    v = -v;
+  p[n - 1] = (unsigned char)(((v % 10) << 4) | (neg ? 0x0D : 0x0C));
+  v /= 10;
+  for (i = n - 2; i >= 0; i--) {
+    p[i] = (unsigned char)((v % 10) | (((v / 10) % 10) << 4));
+    v /= 100;
+  }
+}
+
+/**
+ * @brief Push an array of nrec records and compute the exact total.
+ *
+ * The total is kept as a count of 10^15-cent units plus a remainder so
+ * it stays exact past 64 bits.
+ *
+ * @param L Lua state.
+ * @param nrec Record count.
+ * @param want Output total text (at least 48 bytes).
+ */
+static void bench_push_batch(lua_State *L, long nrec, char *want)
+{
+  const long long unit = 1000000000000000LL;
+  long long hi = 0;
+  long long lo = 0;
+  unsigned char r[BENCH_RECLEN];
+  long i;
+
+  lua_createtable(L, (int)nrec, 0);
+  for (i = 0; i < nrec; i++) {
+    /* Up to about 9e14 cents, mostly positive. */
+    long long v = (i * 7919LL * 104729LL) % 900000000000000LL -
+                  ((i % 5 == 0) ? 450000000000000LL : 0);
+    memset(r, ' ', sizeof(r));
+    memcpy(r, "ACCT", 4);
+    bench_packed(r + 4, 9, v);
+    lua_pushlstring(L, (const char *)r, sizeof(r));
+    lua_rawseti(L, -2, i + 1);
+    lo += v;
+    hi += lo / unit;
+    lo %= unit;
+  }
+  if (hi != 0 && lo < 0) {
+    hi -= 1;
+    lo += unit;
+  }
+  if (hi != 0)
+    sprintf(want, "%lld%013lld.%02lld", hi, lo / 100, lo % 100);
+  else
+    sprintf(want, "%s%lld.%02lld", lo < 0 ? "-" : "", llabs(lo) / 100,
+            llabs(lo) % 100);
+}
+
+int main(int argc, char **argv)
+{
+  char want[64];
+  long nrec;
+  lua_State *L;
+  int rc;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: decbench <root> [records]\n");
+    return 8;
+  }
+  nrec = (argc > 2) ? atol(argv[2]) : 1000000;
+  if (nrec <= 0)
+    return 8;
+
+  L = luaL_newstate();
+  luaL_openlibs(L);
+  luaz_dsrec_open(L);
+  luaz_dsdec_open(L);
+  if (luaL_loadstring(L, g_script) != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    lua_close(L);
+    return 12;
+  }
+  lua_newtable(L);
+  lua_pushcfunction(L, luaz_dsdec_l_decimal);
+  lua_setfield(L, -2, "decimal");
+  lua_pushcfunction(L, luaz_dsdec_l_unpack);
+  lua_setfield(L, -2, "unpack_decimal");
+  lua_pushcfunction(L, luaz_dsdec_l_sum);
+  lua_setfield(L, -2, "decimal_sum");
+  lua_pushcfunction(L, luaz_dsrec_l_layout);
+  lua_setfield(L, -2, "layout");
+  bench_push_batch(L, nrec, want);
+  lua_pushstring(L, want);
+  rc = lua_pcall(L, 3, 0, 0);
+  if (rc != LUA_OK)
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+  lua_close(L);
+  return (rc == LUA_OK) ? 0 : 12;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: ds.grep block scanning versus a Lua lines() plus
+ * string.find loop over the same SYSLOG-like text.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_text | struct | Generated text and the Lua iterator position |
+ * | bench_fill | function | Generate the text |
+ * | bench_next | function | Lua iterator: one line string per call |
+ * | bench_hit | function | Count one matching line |
+ * | bench_grep | function | Time luaz_dsgrep_lines over 64 KiB blocks |
+ * | main | function | Time both scans, print the rates |
+ *
+ * Platform Requirements:
+ * - Host build only; see scripts/host_bench.sh. The text is ASCII with
+ *   '\n' line ends, so folding uses the ISO-8859-1 table.
+ */
+#include "CODEC"
+#include "DSGREP"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_BLOCK 65536
+
+struct bench_text {
+  char *p;
+  size_t n;
+  size_t pos;
+  long lines;
+};
+
+static const char *g_script =
+    "local next_line, needle, fold = ...\n"
+    "collectgarbage('collect')\n"
+    "local t0 = os.clock()\n"
+    "local hits = 0\n"
+    "for line in next_line do\n"
+    "  local s = fold and line:upper() or line\n"
+    "  if s:find(needle, 1, true) then hits = hits + 1 end\n"
+    "end\n"
+    "return hits, (os.clock() - t0) * 1000\n";
+
+static const char *g_msgs[] = {
+    "IEF142I JOB%05ld STEP1 - STEP WAS EXECUTED - COND CODE 0000",
+    "IEF285I   SYS1.LINKLIB                                 KEPT",
+    "$HASP373 JOB%05ld STARTED - INIT 1    - CLASS A - SYS SYSA",
+    "IEF373I STEP/STEP1   /START 2026290.1200",
+    "IEF374I STEP/STEP1   /STOP  2026290.1200 CPU    0MIN 00.01SEC",
+    "$HASP395 JOB%05ld ENDED - RC=0000"};
+
+/**
+ * @brief Generate SYSLOG-like lines; one line in 1000 is an abend
+ *        (IEF450I), half of those in lower case.
+ *
+ * @param t Text to fill.
+ * @param mb Size in MiB.
+ * @return 0 on success, or -1 without memory.
+ */
+static int bench_fill(struct bench_text *t, long mb)
+{
+  size_t cap = (size_t)mb * 1024u * 1024u;
+  size_t n = 0;
+  long i = 0;
+
+  t->p = (char *)malloc(cap + 256);
+  if (t->p == NULL)
+    return -1;
+  while (n < cap) {
+    int len;
+    if (i % 1000 == 999)
+      len = sprintf(t->p + n, "SYSA 26290 12:00:00 %s JOB%05ld %s", "STC",
+                    i % 100000, (i % 2000 == 999)
+                                    ? "ief450i job abended - abend=s0c4"
+                                    : "IEF450I JOB ABENDED - ABEND=S0C4");
+    else
+      len = sprintf(t->p + n, "SYSA 26290 12:00:00 JOB%05ld ", i % 100000) +
+            sprintf(t->p + n + 31, g_msgs[i % 6], i % 100000);
+    n += (size_t)len;
+    t->p[n++] = '\n';
+    i++;
+  }
+  t->n = n;
+  t->lines = i;
+  return 0;
+}
+
+static int bench_next(lua_State *L)
+{
+  struct bench_text *t =
+      (struct bench_text *)lua_touserdata(L, lua_upvalueindex(1));
+  const char *nl;
+
+  if (t->pos >= t->n)
+    return 0;
+  nl = (const char *)memchr(t->p + t->pos, '\n', t->n - t->pos);
+  lua_pushlstring(L, t->p + t->pos, (size_t)(nl - (t->p + t->pos)));
+  t->pos = (size_t)(nl - t->p) + 1;
+  return 1;
+}
+
+static int bench_hit(void *ud, lua_Integer lineno, const char *line, size_t n)
+{
+  (void)lineno;
+  (void)line;
+  (void)n;
+  (*(long *)ud)++;
+  return 0;
+}
+
+/**
+ * @brief Scan the text in 64 KiB blocks of complete lines, as ds.grep
+ *        does for a text stream.
+ *
+ * @param t Text.
+ * @param needle Literal.
+ * @param fold_cp Codec id for case folding, or -1.
+ * @param label Case name for the output line.
+ * @return Hit count.
+ */
+static long bench_grep(const struct bench_text *t, const char *needle,
+                       int fold_cp, const char *label)
+{
+  struct luaz_dsgrep g;
+  lua_Integer lineno = 0;
+  long hits = 0;
+  size_t pos = 0;
+  clock_t t0;
+
+  luaz_dsgrep_init(&g, needle, strlen(needle), fold_cp);
+  t0 = clock();
+  while (pos < t->n) {
+    size_t done = t->n - pos;
+    if (done > BENCH_BLOCK) {
+      done = BENCH_BLOCK;
+      while (done > 0 && t->p[pos + done - 1] != '\n')
+        done--;
+    }
+    luaz_dsgrep_lines(&g, t->p + pos, done, &lineno, bench_hit, &hits);
+    pos += done;
+  }
+  printf("%s_ms=%.0f hits=%ld lines=%ld\n", label,
+         (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC, hits,
+         (long)lineno);
+  return hits;
+}
+
+/**
+ * @brief Run the Lua loop once.
+ *
+ * @param L Lua state with the script chunk on top (kept).
+ * @param t Text.
+ * @param needle Literal.
+ * @param fold Upper-case each line first.
+ * @param label Case name for the output line.
+ * @return Hit count, or -1 on a Lua error.
+ */
+static long bench_lua(lua_State *L, struct bench_text *t, const char *needle,
+                      int fold, const char *label)
+{
+  long hits;
+
+  t->pos = 0;
+  lua_pushvalue(L, -1);
+  lua_pushlightuserdata(L, t);
+  lua_pushcclosure(L, bench_next, 1);
+  lua_pushstring(L, needle);
+  lua_pushboolean(L, fold);
+  if (lua_pcall(L, 3, 2, 0) != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    return -1;
+  }
+  hits = (long)lua_tointeger(L, -2);
+  printf("%s_ms=%.0f hits=%ld\n", label, lua_tonumber(L, -1), hits);
+  lua_pop(L, 2);
+  return hits;
+}
+
+int main(int argc, char **argv)
+{
+  struct bench_text t;
+  lua_State *L;
+  long mb;
+  long c1, c2, l1, l2;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: grepbench <root> [megabytes]\n");
+    return 8;
+  }
+  mb = (argc > 2) ? atol(argv[2]) : 64;
+  if (mb <= 0)
+    return 8;
+  memset(&t, 0, sizeof(t));
+  if (bench_fill(&t, mb) != 0)
+    return 12;
+  printf("megabytes=%ld lines=%ld\n", mb, t.lines);
+
+  c1 = bench_grep(&t, "IEF450I", -1, "dsgrep_literal");
+  c2 = bench_grep(&t, "ief450i", LUAZ_CODEC_LATIN1, "dsgrep_ignorecase");
+
+  L = luaL_newstate();
+  luaL_openlibs(L);
+  if (luaL_loadstring(L, g_script) != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    lua_close(L);
+    return 12;
+  }
+  l1 = bench_lua(L, &t, "IEF450I", 0, "lua_find");
+  l2 = bench_lua(L, &t, "IEF450I", 1, "lua_upper_find");
+  lua_close(L);
+  free(t.p);
+  return (l1 == c1 && l2 == c2) ? 0 : 12;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: ds line reads with 256-byte fgets (previous
+ * ds_readline_stream) versus the LSCAN block scanner.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_gen_file | function | Write a file of fixed-length lines |
+ * | bench_fgets_line | function | Previous readline: fgets + luaL_Buffer |
+ * | bench_scan_line | function | Scanner readline (as ds_scan_line) |
+ * | bench_run | function | Time one pass over a file |
+ * | main | function | Generate files and print lines per second |
+ *
+ * Platform Requirements:
+ * - Host build only (clock_gettime); see scripts/host_bench.sh.
+ * - Lines are pushed onto a Lua stack as handle:readline() does.
+ */
+#include "LSCAN"
+
+#include "lua.h"
+#include "lauxlib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Write a file of fixed-length lines.
+ *
+ * @param path File path.
+ * @param reclen Line length without the newline.
+ * @param lines Number of lines.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_gen_file(const char *path, int reclen, long lines)
+{
+  FILE *fp = fopen(path, "wb");
+  char *rec;
+  long i;
+  int k;
+  int rc = 0;
+
+  if (fp == NULL)
+    return -1;
+  rec = (char *)malloc((size_t)reclen + 1u);
+  if (rec == NULL) {
+    fclose(fp);
+    return -1;
+  }
+  for (i = 0; i < lines && rc == 0; i++) {
+    for (k = 0; k < reclen; k++)
+      rec[k] = (char)('A' + (int)((i + k) % 26));
+    rec[reclen] = '\n';
+    if (fwrite(rec, 1, (size_t)reclen + 1u, fp) != (size_t)reclen + 1u)
+      rc = -1;
+  }
+  free(rec);
+  if (fclose(fp) != 0)
+    rc = -1;
+  return rc;
+}
+
+/**
+ * @brief Previous handle:readline() body: fgets into 256 bytes.
+ *
+ * @param L Lua state.
+ * @param fp Stream.
+ * @return 1 and push a line, 0 at EOF.
+ */
+static int bench_fgets_line(lua_State *L, FILE *fp)
+{
+  char buf[256];
+  luaL_Buffer b;
+  int have_data = 0;
+
+  luaL_buffinit(L, &b);
+  while (fgets(buf, sizeof(buf), fp) != NULL) {
+    size_t len = strlen(buf);
+    have_data = 1;
+    if (len > 0 && buf[len - 1] == '\n') {
+      luaL_addlstring(&b, buf, len - 1);
+      luaL_pushresult(&b);
+      return 1;
+    }
+    luaL_addlstring(&b, buf, len);
+    if (len + 1 < sizeof(buf)) {
+      luaL_pushresult(&b);
+      return 1;
+    }
+  }
+  lua_pop(L, 1);
+  return have_data;
+}
+
+/**
+ * @brief Scanner readline, as ds_scan_line in src/ds.c.
+ *
+ * @param L Lua state.
+ * @param s Scanner.
+ * @return 1 and push a line, 0 at EOF.
+ */
+static int bench_scan_line(lua_State *L, struct luaz_lscan *s)
+{
+  const char *p = NULL;
+  size_t len = 0;
+  luaL_Buffer b;
+  int rc = luaz_lscan_next(s, &p, &len);
+
+  if (rc == LUAZ_LSCAN_LINE) {
+    lua_pushlstring(L, p, len);
+    return 1;
+  }
+  if (rc != LUAZ_LSCAN_PART)
+    return 0;
+  luaL_buffinit(L, &b);
+  do {
+    luaL_addlstring(&b, p, len);
+    rc = luaz_lscan_next(s, &p, &len);
+  } while (rc == LUAZ_LSCAN_PART);
+  if (rc == LUAZ_LSCAN_LINE)
+    luaL_addlstring(&b, p, len);
+  luaL_pushresult(&b);
+  return 1;
+}
+
+/**
+ * @brief Time one pass over a file.
+ *
+ * @param path File path.
+ * @param scan Nonzero for the scanner, zero for fgets.
+ * @param out_lines Output line count.
+ * @param out_ms Output elapsed milliseconds.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_run(const char *path, int scan, long *out_lines,
+                     double *out_ms)
+{
+  lua_State *L = luaL_newstate();
+  struct luaz_lscan s;
+  struct timespec t0;
+  struct timespec t1;
+  FILE *fp;
+  long lines = 0;
+
+  fp = fopen(path, "rb");
+  if (L == NULL || fp == NULL ||
+      (scan && luaz_lscan_init(&s, fp, 0) != 0)) {
+    if (fp != NULL)
+      fclose(fp);
+    if (L != NULL)
+      lua_close(L);
+    return -1;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (;;) {
+    int got = scan ? bench_scan_line(L, &s) : bench_fgets_line(L, fp);
+    if (!got)
+      break;
+    lua_pop(L, 1);
+    lines++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  if (scan)
+    luaz_lscan_free(&s);
+  fclose(fp);
+  lua_close(L);
+  *out_lines = lines;
+  *out_ms = (double)(t1.tv_sec - t0.tv_sec) * 1000.0 +
+            (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  char path[1024];
+  long mbytes;
+  int k;
+  static const int reclens[] = {80, 32760};
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: lscanbench <root> [mbytes]\n");
+    return 8;
+  }
+  mbytes = (argc > 2) ? atol(argv[2]) : 64;
+  if (mbytes <= 0)
+    return 8;
+
+  for (k = 0; k < (int)(sizeof(reclens) / sizeof(reclens[0])); k++) {
+    long lines = mbytes * 1048576L / (reclens[k] + 1);
+    int scan;
+    snprintf(path, sizeof(path), "%s/LSCAN.R%d", argv[1], reclens[k]);
+    if (bench_gen_file(path, reclens[k], lines) != 0)
+      return 12;
+    for (scan = 0; scan <= 1; scan++) {
+      long got = 0;
+      double ms = 0.0;
+      /* Warm the page cache, then time. */
+      if (bench_run(path, scan, &got, &ms) != 0 ||
+          bench_run(path, scan, &got, &ms) != 0)
+        return 12;
+      printf("reclen=%-5d %-6s lines=%ld ms=%.1f lines_per_sec=%.0f\n",
+             reclens[k], scan ? "lscan" : "fgets", got, ms,
+             (double)got * 1000.0 / ms);
+    }
+    remove(path);
+  }
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: load a large generated table module from a plain
+ * and from a compressed (LZMEM) LUAPATH member.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_write_file | function | Write a stand-in member or config |
+ * | bench_gen_table | function | Generate the source of a table module |
+ * | bench_stat | function | Fetch a LUAPATH counter by name |
+ * | bench_run | function | Time N loads of one member |
+ * | main | function | Prepare members and print timings |
+ *
+ * Platform Requirements:
+ * - Host build only (POSIX mkdir/clock_gettime); see scripts/host_bench.sh.
+ * - Uses the IOHOST stand-in: <root>/LUAPATH directory.
+ */
+#include "IOHOST"
+#include "LZMEM"
+#include "PATH"
+#include "POLICY"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/**
+ * @brief Write a stand-in member or config file.
+ *
+ * @param path File path.
+ * @param data File contents.
+ * @param len Number of bytes.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_write_file(const char *path, const char *data,
+                            unsigned long len)
+{
+  FILE *fp = fopen(path, "wb");
+  int rc;
+
+  if (fp == NULL)
+    return -1;
+  rc = (fwrite(data, 1, (size_t)len, fp) == (size_t)len) ? 0 : -1;
+  if (fclose(fp) != 0)
+    rc = -1;
+  return rc;
+}
+
+/**
+ * @brief Generate a module returning a table of rows.
+ *
+ * @param rows Number of rows.
+ * @param len Output source length.
+ * @return Heap buffer with the source (caller frees), or NULL.
+ */
+static char *bench_gen_table(int rows, unsigned long *len)
+{
+  size_t cap = (size_t)rows * 80u + 64u;
+  char *buf = (char *)malloc(cap);
+  size_t n = 0;
+  int i;
+
+  if (buf == NULL)
+    return NULL;
+  n += (size_t)snprintf(buf + n, cap - n, "local T = {\n");
+  for (i = 0; i < rows; i++) {
+    n += (size_t)snprintf(buf + n, cap - n,
+                          "  { id = %d, name = \"ITEM%05d\", rate = %d, "
+                          "on = %s },\n",
+                          i, i, (i * 37) % 1000, (i % 3) ? "true" : "false");
+  }
+  n += (size_t)snprintf(buf + n, cap - n, "}\nreturn T\n");
+  *len = (unsigned long)n;
+  return buf;
+}
+
+static unsigned long bench_stat(const char *name)
+{
+  int i;
+
+  for (i = 0; i < luaz_path_stat_count(); i++) {
+    const char *s = luaz_path_stat_name(i);
+    if (s != NULL && strcmp(s, name) == 0)
+      return luaz_path_stat_value(i);
+  }
+  return 0;
+}
+
+/**
+ * @brief Time N loads of one member in fresh Lua states.
+ *
+ * @param root Stand-in root directory.
+ * @param cfg LUACFG-style config file.
+ * @param member Member to load.
+ * @param stream Nonzero to use loadfile (streaming), zero for require.
+ * @param iters Number of iterations.
+ * @param out_ms Output elapsed milliseconds.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_run(const char *root, const char *cfg, const char *member,
+                     int stream, int iters, double *out_ms)
+{
+  struct timespec t0;
+  struct timespec t1;
+  int i;
+
+  if (luaz_policy_load(cfg) != 0 || luaz_io_host_register(root) != 0)
+    return -1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (i = 0; i < iters; i++) {
+    lua_State *L = luaL_newstate();
+    int rc;
+    luaL_openlibs(L);
+    lua_getglobal(L, stream ? "loadfile" : "require");
+    lua_pushstring(L, member);
+    rc = lua_pcall(L, 1, 1, 0);
+    if (rc == LUA_OK && stream) {
+      if (lua_isfunction(L, -1))
+        rc = lua_pcall(L, 0, 1, 0);
+      else
+        rc = LUA_ERRFILE;
+    }
+    if (rc != LUA_OK || !lua_istable(L, -1)) {
+      fprintf(stderr, "load %s failed: %s\n", member, lua_tostring(L, -1));
+      lua_close(L);
+      return -1;
+    }
+    lua_close(L);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  *out_ms = (double)(t1.tv_sec - t0.tv_sec) * 1000.0 +
+            (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  char path[1024];
+  char cfg[1024];
+  char *src;
+  char *img = NULL;
+  unsigned long src_len = 0;
+  unsigned long img_len = 0;
+  const char *root;
+  int iters;
+  int rows;
+  int k;
+  double ms = 0.0;
+  static const struct {
+    const char *label;
+    const char *member;
+    int stream;
+  } phases[] = {
+    {"plain-require", "BIGP", 0},
+    {"lzm-require", "BIGZ", 0},
+    {"plain-loadfile", "BIGP", 1},
+    {"lzm-loadfile", "BIGZ", 1}
+  };
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: lzmbench <root> [iters] [rows]\n");
+    return 8;
+  }
+  root = argv[1];
+  iters = (argc > 2) ? atoi(argv[2]) : 20;
+  rows = (argc > 3) ? atoi(argv[3]) : 50000;
+  if (iters <= 0 || rows <= 0)
+    return 8;
+
+  (void)mkdir(root, 0755);
+  snprintf(path, sizeof(path), "%s/LUAPATH", root);
+  (void)mkdir(path, 0755);
+  src = bench_gen_table(rows, &src_len);
+  if (src == NULL || luaz_lzm_encode(src, src_len, 0, &img, &img_len) != 0)
+    return 12;
+  snprintf(path, sizeof(path), "%s/LUAPATH/BIGP", root);
+  if (bench_write_file(path, src, src_len) != 0)
+    return 12;
+  snprintf(path, sizeof(path), "%s/LUAPATH/BIGZ", root);
+  if (bench_write_file(path, img, img_len) != 0)
+    return 12;
+  snprintf(cfg, sizeof(cfg), "%s/LUACFG.LZM", root);
+  if (bench_write_file(cfg, "# LUAPATH members\n", 18) != 0)
+    return 12;
+  printf("member  plain=%lu compressed=%lu ratio=%.2f\n", src_len, img_len,
+         (double)src_len / (double)img_len);
+
+  for (k = 0; k < (int)(sizeof(phases) / sizeof(phases[0])); k++) {
+    unsigned long moved;
+    if (bench_run(root, cfg, phases[k].member, phases[k].stream, iters,
+                  &ms) != 0)
+      return 12;
+    moved = (phases[k].member[3] == 'Z') ? bench_stat("lzm_bytes_in")
+                                          : src_len * (unsigned long)iters;
+    printf("%-14s iters=%d total_ms=%.1f per_run_ms=%.2f "
+           "bytes_read_per_run=%lu\n",
+           phases[k].label, iters, ms, ms / (double)iters,
+           moved / (unsigned long)iters);
+  }
+  free(src);
+  free(img);
+  return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: ds.members directory enumeration (PDSDIR blocks,
+ * ISPF statistics, name patterns) over the IOHOST directory stand-in.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_count | struct | Members seen and statistics checks |
+ * | bench_gen_lib | function | Write a library of member files |
+ * | bench_entry | function | Decode and check one directory entry |
+ * | bench_ms | function | Milliseconds between two timestamps |
+ * | bench_parse | function | Time parse passes over the blocks |
+ * | main | function | Read the stand-in blocks, time the parse passes |
+ *
+ * Platform Requirements:
+ * - Host build only (clock_gettime); see scripts/host_bench.sh.
+ * - Member i (0-based) of MEMLIB holds i % 50 + 1 lines, so the decoded
+ *   current size of every entry can be checked.
+ */
+#include "DSMEM"
+#include "IOHOST"
+#include "PDSDIR"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+struct bench_count {
+  const char *pattern;
+  long members;
+  long bad;
+};
+
+/**
+ * @brief Write <root>/MEMLIB with members M0000000, M0000001, ...
+ *
+ * @param root Stand-in root directory.
+ * @param count Member count.
+ * @return 0 on success, or -1 on failure.
+ */
+static int bench_gen_lib(const char *root, long count)
+{
+  char path[1024];
+  long i;
+
+  snprintf(path, sizeof(path), "%s/MEMLIB", root);
+  mkdir(path, 0755);
+  for (i = 0; i < count; i++) {
+    FILE *fp;
+    long k;
+    snprintf(path, sizeof(path), "%s/MEMLIB/M%07ld", root, i);
+    fp = fopen(path, "w");
+    if (fp == NULL)
+      return -1;
+    for (k = 0; k <= i % 50; k++)
+      fputs("         DC    CL80' '\n", fp);
+    if (fclose(fp) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+static int bench_entry(void *ud, const struct luaz_pdsdir_entry *e)
+{
+  struct bench_count *c = (struct bench_count *)ud;
+  struct luaz_dsmem_stats st;
+
+  if (!luaz_dsmem_match(c->pattern, e->name))
+    return 0;
+  c->members++;
+  if (luaz_dsmem_stats(e, &st) != 0 ||
+      st.size != atol(e->name + 1) % 50 + 1 || strcmp(st.user, "IOHOST") != 0)
+    c->bad++;
+  return 0;
+}
+
+static double bench_ms(const struct timespec *t0, const struct timespec *t1)
+{
+  return (double)(t1->tv_sec - t0->tv_sec) * 1000.0 +
+         (double)(t1->tv_nsec - t0->tv_nsec) / 1e6;
+}
+
+/**
+ * @brief Parse the directory blocks iters times, decoding the statistics
+ *        of every entry that matches c->pattern.
+ *
+ * @param blocks Directory blocks.
+ * @param nblk Block count.
+ * @param iters Passes.
+ * @param c Counters (pattern set by the caller).
+ * @param label Case name for the output line.
+ * @return 0 on success, or -1 for a malformed block.
+ */
+static int bench_parse(const unsigned char *blocks, size_t nblk, int iters,
+                       struct bench_count *c, const char *label)
+{
+  struct timespec t0;
+  struct timespec t1;
+  int pass;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (pass = 0; pass < iters; pass++) {
+    struct luaz_pdsdir_state st;
+    size_t b;
+    luaz_pdsdir_init(&st);
+    for (b = 0; b < nblk; b++) {
+      if (luaz_pdsdir_block(&st, blocks + b * LUAZ_PDSDIR_BLKSIZE,
+                            LUAZ_PDSDIR_BLKSIZE, bench_entry, c) < 0)
+        return -1;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("%s_ms=%.1f passes=%d per_block_ns=%.0f matched=%ld bad=%ld\n",
+         label, bench_ms(&t0, &t1), iters,
+         bench_ms(&t0, &t1) * 1e6 / ((double)nblk * iters),
+         c->members / iters, c->bad);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  const struct luaz_dsmem_ops *ops;
+  struct timespec t0;
+  struct timespec t1;
+  unsigned char *blocks;
+  size_t nblk = 0;
+  size_t cap = 64;
+  long count;
+  int iters;
+  void *dir;
+  unsigned long len;
+  struct bench_count all;
+  struct bench_count some;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: membench <root> [members] [iters]\n");
+    return 8;
+  }
+  count = (argc > 2) ? atol(argv[2]) : 5000;
+  iters = (argc > 3) ? atoi(argv[3]) : 200;
+  if (count <= 0 || count > 9999999 || iters <= 0)
+    return 8;
+  if (bench_gen_lib(argv[1], count) != 0 ||
+      luaz_io_host_register(argv[1]) != 0 ||
+      (ops = luaz_dsmem_get_ops()) == NULL) {
+    fprintf(stderr, "membench: setup failed\n");
+    return 12;
+  }
+
+  /* The stand-in stats every file for its ISPF statistics; time it
+   * apart from the parse passes. */
+  blocks = (unsigned char *)malloc(cap * LUAZ_PDSDIR_BLKSIZE);
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  if (blocks == NULL || ops->open("DD:MEMLIB", &dir) != 0)
+    return 12;
+  for (;;) {
+    if (nblk == cap) {
+      unsigned char *n =
+          (unsigned char *)realloc(blocks, cap * 2 * LUAZ_PDSDIR_BLKSIZE);
+      if (n == NULL)
+        return 12;
+      blocks = n;
+      cap *= 2;
+    }
+    len = LUAZ_PDSDIR_BLKSIZE;
+    if (ops->read(dir, blocks + nblk * LUAZ_PDSDIR_BLKSIZE, &len) != 0)
+      return 12;
+    if (len == 0)
+      break;
+    nblk++;
+  }
+  ops->close(dir);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("members=%ld blocks=%lu standin_ms=%.1f\n", count,
+         (unsigned long)nblk, bench_ms(&t0, &t1));
+
+  memset(&all, 0, sizeof(all));
+  memset(&some, 0, sizeof(some));
+  some.pattern = "M%%%%%1*";
+  if (bench_parse(blocks, nblk, iters, &all, "parse_all") != 0 ||
+      bench_parse(blocks, nblk, iters, &some, "parse_pattern") != 0)
+    return 12;
+  free(blocks);
+  return (all.bad + some.bad == 0 && all.members == count * iters) ? 0 : 12;
+}
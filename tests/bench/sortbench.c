@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+ *
+ * Off-host benchmark: ds.sort engine (in memory and with work files)
+ * versus table.sort over the same records in Lua.
+ *
+ * Object Table:
+ * | Object | Kind | Purpose |
+ * |--------|------|---------|
+ * | bench_src | struct | Generated records and the output check |
+ * | bench_record | function | Build one generated record |
+ * | bench_read | function | Input callback |
+ * | bench_write | function | Output callback with an order check |
+ * | bench_spill_open | function | Create or reopen a work file |
+ * | bench_spill_remove | function | Delete a work file |
+ * | bench_sort | function | Time one luaz_dssort_run |
+ * | main | function | Time table.sort and ds.sort, print the rates |
+ *
+ * Platform Requirements:
+ * - Host build only; see scripts/host_bench.sh. Work files go to the
+ *   bench data directory instead of ds.tmpname datasets.
+ */
+#include "DSSORT"
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RECLEN 80
+#define BENCH_KEYPOS 10
+#define BENCH_KEYLEN 10
+
+struct bench_src {
+  const char *dir;
+  long count;
+  long next;
+  char rec[BENCH_RECLEN];
+  char last[BENCH_KEYLEN];
+  long written;
+  int bad;
+  char path[512];
+};
+
+static const char *g_script =
+    "local recs = ...\n"
+    "local function timed(f)\n"
+    "  collectgarbage('collect')\n"
+    "  local t0 = os.clock()\n"
+    "  f()\n"
+    "  return (os.clock() - t0) * 1000\n"
+    "end\n"
+    "local kb = collectgarbage('count')\n"
+    "local t = table.move(recs, 1, #recs, 1, {})\n"
+    "local table_kb = collectgarbage('count') - kb\n"
+    "local key_ms = timed(function()\n"
+    "  table.sort(t, function(a, b) return a:sub(11, 20) < b:sub(11, 20) end)\n"
+    "end)\n"
+    "for i = 2, #t do\n"
+    "  assert(t[i - 1]:sub(11, 20) <= t[i]:sub(11, 20), 'table.sort order')\n"
+    "end\n"
+    "t = table.move(recs, 1, #recs, 1, {})\n"
+    "local plain_ms = timed(function() table.sort(t) end)\n"
+    "print(string.format('table_sort_key_ms=%.0f table_sort_plain_ms=%.0f "
+    "lua_kb=%.0f', key_ms, plain_ms, kb + table_kb))\n";
+
+/**
+ * @brief Build generated record i: a sequence number, a pseudo-random
+ *        10-digit key at offset 10, and filler.
+ *
+ * @param out Record buffer (BENCH_RECLEN bytes).
+ * @param i Record number.
+ */
+static void bench_record(char *out, long i)
+{
+  unsigned long x = (unsigned long)i * 2654435761ul + 12345ul;
+  char tmp[32];
+
+  memset(out, 'F', BENCH_RECLEN);
+  snprintf(tmp, sizeof(tmp), "%010ld", i);
+  memcpy(out, tmp, 10);
+  snprintf(tmp, sizeof(tmp), "%010lu", (x ^ (x >> 13)) % 10000000000ul);
+  memcpy(out + BENCH_KEYPOS, tmp, BENCH_KEYLEN);
+}
+
+static int bench_read(void *ud, const char **p, size_t *n)
+{
+  struct bench_src *b = (struct bench_src *)ud;
+
+  if (b->next == b->count)
+    return 0;
+  bench_record(b->rec, b->next++);
+  *p = b->rec;
+  *n = BENCH_RECLEN;
+  return 1;
+}
+
+static int bench_write(void *ud, const char *p, size_t n)
+{
+  struct bench_src *b = (struct bench_src *)ud;
+
+  if (n != BENCH_RECLEN ||
+      (b->written > 0 &&
+       memcmp(b->last, p + BENCH_KEYPOS, BENCH_KEYLEN) > 0))
+    b->bad = 1;
+  memcpy(b->last, p + BENCH_KEYPOS, BENCH_KEYLEN);
+  b->written++;
+  return 0;
+}
+
+static FILE *bench_spill_open(void *ud, int run, int create,
+                              lua_Integer bytes)
+{
+  struct bench_src *b = (struct bench_src *)ud;
+
+  (void)bytes;
+  snprintf(b->path, sizeof(b->path), "%s/sortrun.%d", b->dir, run);
+  return fopen(b->path, create ? "wb" : "rb");
+}
+
+static void bench_spill_remove(void *ud, int run)
+{
+  struct bench_src *b = (struct bench_src *)ud;
+
+  snprintf(b->path, sizeof(b->path), "%s/sortrun.%d", b->dir, run);
+  remove(b->path);
+}
+
+/**
+ * @brief Sort the generated records with a given arena size.
+ *
+ * @param dir Directory for work files.
+ * @param count Record count.
+ * @param memory Arena bytes.
+ * @param label Case name for the output line.
+ * @return 0 on success, or -1 when the sort or the order check failed.
+ */
+static int bench_sort(const char *dir, long count, size_t memory,
+                      const char *label)
+{
+  struct luaz_dssort s;
+  struct luaz_dssort_io io;
+  struct bench_src b;
+  clock_t t0;
+  double ms;
+
+  memset(&b, 0, sizeof(b));
+  b.dir = dir;
+  b.count = count;
+  luaz_dssort_init(&s);
+  s.keys[0].off = BENCH_KEYPOS;
+  s.keys[0].len = BENCH_KEYLEN;
+  s.nkeys = 1;
+  s.keylen = BENCH_KEYLEN;
+  s.memory = memory;
+  io.ud = &b;
+  io.read = bench_read;
+  io.write = bench_write;
+  io.spill_open = bench_spill_open;
+  io.spill_remove = bench_spill_remove;
+  t0 = clock();
+  if (luaz_dssort_run(&s, &io) != 0 || b.bad || b.written != count) {
+    fprintf(stderr, "%s: sort failed err=%d\n", label, s.err);
+    return -1;
+  }
+  ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+  printf("%s_ms=%.0f runs=%d memory_kb=%lu\n", label, ms, s.runs,
+         (unsigned long)(memory / 1024));
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  long count;
+  lua_State *L;
+  long i;
+  int rc;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: sortbench <root> [records]\n");
+    return 8;
+  }
+  count = (argc > 2) ? atol(argv[2]) : 1000000;
+  if (count <= 0)
+    return 8;
+
+  /* Record generation is part of both C cases; time it alone. */
+  {
+    char rec[BENCH_RECLEN];
+    clock_t t0 = clock();
+    for (i = 0; i < count; i++)
+      bench_record(rec, i);
+    printf("records=%ld generate_ms=%.0f\n", count,
+           (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC);
+  }
+  if (bench_sort(argv[1], count, LUAZ_DSSORT_MEMORY_MAX, "dssort_memory") != 0 ||
+      bench_sort(argv[1], count, 8u * 1024u * 1024u, "dssort_spill") != 0)
+    return 12;
+
+  L = luaL_newstate();
+  luaL_openlibs(L);
+  if (luaL_loadstring(L, g_script) != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    lua_close(L);
+    return 12;
+  }
+  lua_createtable(L, (int)count, 0);
+  for (i = 0; i < count; i++) {
+    char rec[BENCH_RECLEN];
+    bench_record(rec, i);
+    lua_pushlstring(L, rec, BENCH_RECLEN);
+    lua_rawseti(L, -2, (lua_Integer)i + 1);
+  }
+  rc = lua_pcall(L, 1, 0, 0);
+  if (rc != LUA_OK)
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+  lua_close(L);
+  return (rc == LUA_OK) ? 0 : 12;
+}
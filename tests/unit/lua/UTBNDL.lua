@@ -0,0 +1,63 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO application bundle (luabundle.dd) unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00003 and return RC 8 |
+-- | delta | function | Counter change between two pathstats snapshots |
+-- | main | function | Validate searcher order: preload, bundle, LUAPATH |
+local function fail(msg)
+  print("LUZ00003 LUAPATH UT failed: " .. msg)
+  return 8
+end
+
+local function delta(before, after, key)
+  return (after[key] or 0) - (before[key] or 0)
+end
+
+local function main()
+  local s0 = package.pathstats()
+
+  -- Long name with no LUAMAP entry: only the bundle has it.
+  local v = require("app.mod")
+  if v ~= "bundle:app.mod" then
+    return fail("app.mod " .. tostring(v))
+  end
+  -- SHARED is in the bundle and in LUAPATH: the bundle comes first.
+  v = require("shared")
+  if v ~= "bundle:shared" then
+    return fail("shared " .. tostring(v))
+  end
+  -- Not in the bundle: falls through to LUAPATH.
+  v = require("pathonly")
+  if v ~= "path:pathonly" then
+    return fail("pathonly " .. tostring(v))
+  end
+  local s1 = package.pathstats()
+  if delta(s0, s1, "bundle_hits") ~= 2 or delta(s0, s1, "bundle_misses") ~= 1 then
+    return fail("bundle hits/misses")
+  end
+  if s1.bundle_loads ~= 1 or s1.bundle_entries ~= 2 then
+    return fail("bundle loads/entries")
+  end
+
+  -- package.preload comes before the bundle.
+  package.loaded.shared = nil
+  package.preload.shared = function()
+    return "preload:shared"
+  end
+  v = require("shared")
+  if v ~= "preload:shared" then
+    return fail("preload before bundle " .. tostring(v))
+  end
+  if delta(s1, package.pathstats(), "bundle_hits") ~= 0 then
+    return fail("bundle searched after preload")
+  end
+
+  print("LUZ00002 LUAPATH BUNDLE UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,129 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO codec module and ds encoding= option unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | all_bytes | function | Build the 256-byte string 0x00..0xFF |
+-- | main | function | Validate codec.convert and encoded dataset I/O |
+--
+-- Literals are byte escapes so the test does not depend on the character
+-- set the script source was transferred in.
+local ds = require("ds")
+local codec = require("codec")
+
+local function fail(msg)
+  print("LUZ00005 CODEC UT failed: " .. msg)
+  return 8
+end
+
+local function all_bytes()
+  local t = {}
+  for i = 0, 255 do
+    t[#t + 1] = string.char(i)
+  end
+  return table.concat(t)
+end
+
+local function main()
+  -- "HELLO" in IBM-1047, and the NL (0x15) line end.
+  if codec.convert("\xC8\xC5\xD3\xD3\xD6\x15", "IBM-1047", "UTF-8")
+      ~= "\x48\x45\x4C\x4C\x4F\x0A" then
+    return fail("IBM-1047 to UTF-8")
+  end
+  -- e-acute is two bytes in UTF-8 and 0x51 in the EBCDIC Latin-1 pages.
+  if codec.convert("\xC3\xA9", "utf8", "ibm1047") ~= "\x51" then
+    return fail("UTF-8 to IBM-1047")
+  end
+  -- '[' differs between IBM-1047 (0xAD) and IBM-037 (0xBA).
+  if codec.convert("\xAD", "IBM-1047", "IBM-037") ~= "\xBA"
+      or codec.convert("\x5B", "ISO8859-1", "CP037") ~= "\xBA" then
+    return fail("IBM-1047 to IBM-037")
+  end
+  -- A-, O-, U-umlaut in IBM-273.
+  if codec.convert("\x4A\xE0\x5A", "IBM-273", "UTF-8")
+      ~= "\xC3\x84\xC3\x96\xC3\x9C" then
+    return fail("IBM-273 to UTF-8")
+  end
+  if codec.convert("\xC8\xC9\x4F", "IBM-500", "ISO8859-1") ~= "\x48\x49\x21" then
+    return fail("IBM-500 to ISO8859-1")
+  end
+
+  local bytes = all_bytes()
+  for _, cp in ipairs({ "IBM-1047", "IBM-037", "IBM-273", "IBM-500" }) do
+    local u = codec.convert(bytes, cp, "UTF-8")
+    if codec.convert(u, "UTF-8", cp) ~= bytes
+        or codec.convert(codec.convert(bytes, cp, "ISO8859-1"), "ISO8859-1", cp)
+          ~= bytes then
+      return fail("round trip " .. cp)
+    end
+  end
+
+  -- The euro sign has no ISO-8859-1 position; 0xC3 alone is invalid.
+  local s, msg, code = codec.convert("\x41\xE2\x82\xAC", "UTF-8", "IBM-1047")
+  if s ~= nil or code ~= 30058 or not tostring(msg):find("byte=2", 1, true)
+      and not tostring(msg):find("byte 2", 1, true) then
+    return fail("unmappable character accepted")
+  end
+  if codec.convert("\xC3", "UTF-8", "IBM-1047") ~= nil then
+    return fail("truncated sequence accepted")
+  end
+  if codec.convert("\x41\xE2\x82\xAC\xC3", "UTF-8", "IBM-1047", "\x6F")
+      ~= "\xC1\x6F\x6F" then
+    return fail("replacement byte")
+  end
+  if pcall(codec.convert, "x", "IBM-9999", "UTF-8") then
+    return fail("unknown encoding accepted")
+  end
+
+  -- Records written from UTF-8 land in the dataset as IBM-1047.
+  local h
+  h, msg = ds.open_dd("DSOUT", { mode = "w", type = "record",
+    encoding = "IBM-1047" })
+  if not h then
+    return fail(msg or "open DSOUT write")
+  end
+  local count, err = h:write_records({ "\x48\x49", "\xC3\xA9" })
+  h:close()
+  if count ~= 2 then
+    return fail(err or "write_records DSOUT")
+  end
+  h, msg = ds.open_dd("DSOUT", { mode = "r", type = "record" })
+  if not h then
+    return fail(msg or "open DSOUT raw")
+  end
+  local r1, r2 = h:readline(), h:readline()
+  h:close()
+  if r1 ~= "\xC8\xC9" or r2 ~= "\x51" then
+    return fail("raw records " .. tostring(r1) .. "/" .. tostring(r2))
+  end
+  h, msg = ds.open_dd("DSOUT", { mode = "r", type = "record",
+    encoding = "IBM-1047" })
+  if not h then
+    return fail(msg or "open DSOUT read")
+  end
+  local all = h:read("a")
+  h:close()
+  if all ~= "\x48\x49\x0A\xC3\xA9\x0A" then
+    return fail("read(\"a\") with encoding")
+  end
+
+  h = ds.open_dd("DSOUT", { mode = "w", type = "record",
+    encoding = "IBM-1047" })
+  local ok
+  ok, msg, code = h:writeline("\xE2\x82\xAC")
+  h:close()
+  if ok or code ~= 30058 then
+    return fail("unmappable write accepted")
+  end
+  if ds.open_dd("DSOUT", { mode = "r", encoding = "EBCDIC-X" }) then
+    return fail("unknown encoding= accepted")
+  end
+
+  print("LUZ00004 CODEC UT OK")
+  return 0
+end
+
+return main()
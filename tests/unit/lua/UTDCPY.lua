@@ -0,0 +1,108 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.copybook COBOL record decoder unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | near | function | Compare a scaled value within rounding |
+-- | main | function | Validate ds.copybook, copybook:decode, handle:fields |
+local ds = require("ds")
+
+local function fail(msg)
+  print("LUZ00005 DS UT failed: " .. msg)
+  return 8
+end
+
+local function near(a, b)
+  return type(a) == "number" and math.abs(a - b) < 1e-9
+end
+
+-- Fixed format: sequence area in columns 1-6, text from column 8.
+local CPY = table.concat({
+  "000100* ORDER RECORD, 20 BYTES",
+  "000200 01  ORDER-REC.",
+  "000300     05  ORD-ID          PIC 9(4).",
+  "000400     05  AMOUNT          PIC S9(5)V99 COMP-3.",
+  "000500     05  AMOUNT-X REDEFINES AMOUNT PIC X(4).",
+  "000600     05  QTY             PIC S9(4) COMP.",
+  "000700     05  TAGS OCCURS 2 TIMES.",
+  "000800         10  TAG         PIC X(3).",
+  "000900     05  FILLER          PIC X(4).",
+}, "\n")
+
+-- ORD-ID 0042 (zoned), AMOUNT -1234.56 (packed), QTY -5, TAGS AAA/BBB.
+local REC = "\xF0\xF0\xF4\xF2" .. "\x01\x23\x45\x6D" .. "\xFF\xFB"
+  .. "AAABBB" .. "    "
+
+local function main()
+  local cb = ds.copybook(CPY)
+  if cb:reclen() ~= 20 or #cb ~= 20 then
+    return fail("copybook reclen")
+  end
+  local list = cb:fields()
+  if list[1].name ~= "ORDER-REC" or list[3].type ~= "packed"
+      or list[3].offset ~= 5 or list[3].scale ~= 2 then
+    return fail("copybook fields listing")
+  end
+
+  local t = cb:decode(REC)
+  if t["ORD-ID"] ~= 42 or not near(t.AMOUNT, -1234.56) or t.QTY ~= -5 then
+    return fail("decode numeric items")
+  end
+  if #t.TAGS ~= 2 or t.TAGS[2].TAG ~= "BBB" or #t["AMOUNT-X"] ~= 4 then
+    return fail("decode OCCURS/REDEFINES")
+  end
+  if t.FILLER ~= nil then
+    return fail("FILLER decoded")
+  end
+  local bad = cb:decode("\xF0\xF0\xF4\xF2\x01\x23\x45\x67")
+  if bad.AMOUNT ~= nil or bad.QTY ~= nil or bad["ORD-ID"] ~= 42 then
+    return fail("invalid packed or short record")
+  end
+
+  local lua = ds.copybook("01 ORDER-REC. 05 ORD-ID PIC 9(4).",
+    { format = "free", names = "lua" })
+  if lua:decode("\xF0\xF0\xF0\xF7").ord_id ~= 7 then
+    return fail("free format with lua names")
+  end
+  if pcall(ds.copybook, "01 R. 05 A PIC 9 OCCURS 1 TO 5 DEPENDING ON N.",
+      { format = "free" }) then
+    return fail("OCCURS DEPENDING accepted")
+  end
+  -- 42951 x 99999 wraps to 89753 in 32 bits.
+  if pcall(ds.copybook, "01 R. 05 A PIC X(42951) OCCURS 99999.",
+      { format = "free" }) then
+    return fail("record over the extent limit accepted")
+  end
+
+  local h, msg = ds.open_dd("DSOUT", { mode = "w", type = "record" })
+  if not h then
+    return fail(msg or "open DSOUT write")
+  end
+  local count, err = h:write_records({ REC, REC })
+  h:close()
+  if count ~= 2 then
+    return fail(err or "write_records DSOUT")
+  end
+  h, msg = ds.open_dd("DSOUT", { mode = "r", type = "record" })
+  if not h then
+    return fail(msg or "open DSOUT read")
+  end
+  local total, n = 0, 0
+  t = {}
+  while h:fields(cb, t) do
+    total = total + t.QTY
+    n = n + 1
+  end
+  h:close()
+  if n ~= 2 or total ~= -10 or t.TAGS[1].TAG ~= "AAA" then
+    return fail("handle:fields(copybook) DSOUT")
+  end
+
+  print("LUZ00004 DS UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,68 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.decimal fixed-point arithmetic unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | main | function | Validate ds.decimal, pack/unpack, ds.decimal_sum |
+local ds = require("ds")
+
+local function fail(msg)
+  print("LUZ00005 DS UT failed: " .. msg)
+  return 8
+end
+
+local function main()
+  local D = ds.decimal
+  if tostring(D("0.1") + 0.2) ~= "0.3" or tostring(D("1.50") - 2) ~= "-0.50" then
+    return fail("add/sub")
+  end
+  if tostring(D("1.5") * D("1.5")) ~= "2.25" or tostring(D("100.00") / 3) ~= "33.333333" then
+    return fail("mul/div")
+  end
+  if tostring(D("-12.345", 2)) ~= "-12.35" or D("abc") ~= nil then
+    return fail("construct/round")
+  end
+  if not (D("1.0") == D("1.00") and D("1.0") < 2 and D(5):cmp(5) == 0) then
+    return fail("compare")
+  end
+  local big = D(string.rep("9", 31))
+  if pcall(function() return big + 1 end) then
+    return fail("31-digit overflow accepted")
+  end
+
+  local p = D("-1234.56"):pack("packed", 4, 2)
+  if p ~= "\x01\x23\x45\x6D" or tostring(ds.unpack_decimal("packed", p, 2)) ~= "-1234.56" then
+    return fail("packed pack/unpack")
+  end
+  if D("-12"):pack("zoned", 3) ~= "\xF0\xF1\xD2" or ds.unpack_decimal("packed", "\x12\x34") ~= nil then
+    return fail("zoned pack or invalid packed")
+  end
+
+  local recs, want = {}, 0
+  for i = 1, 500 do
+    local cents = i * 1234567 - 300000000
+    recs[i] = "R" .. D(cents):pack("packed", 9, 0)
+    want = want + cents
+  end
+  local total, n = ds.decimal_sum(recs, { pos = 2, len = 9, type = "packed", scale = 2 })
+  if n ~= 500 or total ~= D(want):div(100, 2) then
+    return fail("decimal_sum")
+  end
+  local bad, msg = ds.decimal_sum({ recs[1], "R" }, { pos = 2, len = 9, type = "packed" })
+  if bad ~= nil or not msg:find("record 2") then
+    return fail("decimal_sum short record")
+  end
+
+  local lay = ds.layout({ { name = "amt", pos = 2, len = 9, type = "packed", scale = 2, decimal = true } })
+  if lay:decode(recs[1]) ~= D(1234567 - 300000000):div(100, 2) then
+    return fail("layout decimal field")
+  end
+
+  print("LUZ00004 DS UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,140 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.grep dataset scanning unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | fill | function | Write the FB40 input records |
+-- | same | function | Compare two record number lists |
+-- | main | function | Validate literal, folded, pattern and limit scans |
+local ds = require("ds")
+
+local COUNT = 2000
+
+local function fail(msg)
+  print("LUZ00005 DS GREP UT failed: " .. msg)
+  return 8
+end
+
+-- Every 100th record holds "IEF450I", every 250th "ief450i" in lower case.
+local function fill()
+  local h, msg = ds.open_dd("DSIN", { mode = "w", type = "record" })
+  if not h then
+    return nil, msg
+  end
+  local batch = {}
+  for i = 1, COUNT do
+    local text = "IEF142I STEP OK"
+    if i % 100 == 0 then
+      text = "IEF450I JOB" .. i .. " ABEND"
+    elseif i % 250 == 0 then
+      text = "ief450i job" .. i .. " abend"
+    end
+    batch[#batch + 1] = string.format("%-40s", string.format("%05d %s", i, text))
+    if #batch == 500 then
+      h:write_records(batch)
+      batch = {}
+    end
+  end
+  h:write_records(batch)
+  h:close()
+  return true
+end
+
+local function same(a, b)
+  if #a ~= #b then
+    return false
+  end
+  for i = 1, #a do
+    if a[i] ~= b[i] then
+      return false
+    end
+  end
+  return true
+end
+
+local function main()
+  local ok, msg = fill()
+  if not ok then
+    return fail(msg or "fill DSIN")
+  end
+
+  local upper, folded = {}, {}
+  for i = 1, COUNT do
+    if i % 100 == 0 then
+      upper[#upper + 1] = i
+      folded[#folded + 1] = i
+    elseif i % 250 == 0 then
+      folded[#folded + 1] = i
+    end
+  end
+
+  local recs, lines = ds.grep("DD:DSIN", "IEF450I", { type = "record" })
+  if not recs or not same(recs, upper) or #lines ~= #upper then
+    return fail("record literal")
+  end
+  if lines[1] ~= string.format("%-40s", "00100 IEF450I JOB100 ABEND") then
+    return fail("record line")
+  end
+
+  recs, lines = ds.grep("DD:DSIN", "IEF450I")
+  if not recs or not same(recs, upper) or
+      lines[1]:match("^(.-)%s*$") ~= "00100 IEF450I JOB100 ABEND" then
+    return fail("stream literal")
+  end
+
+  recs = ds.grep("DD:DSIN", "Ief450I", { ignorecase = true })
+  if not recs or not same(recs, folded) then
+    return fail("ignorecase")
+  end
+
+  recs, lines = ds.grep("DD:DSIN", "IEF450I", { max = 3 })
+  if not recs or #recs ~= 3 or #lines ~= 3 or recs[3] ~= 300 then
+    return fail("max")
+  end
+
+  recs, lines = ds.grep("DD:DSIN", "JOB%d+00 ABEND", { pattern = true,
+    type = "record" })
+  if not recs or not same(recs, upper) then
+    return fail("pattern")
+  end
+  recs = ds.grep("DD:DSIN", "^%d+ ief", { pattern = true })
+  if not recs or #recs ~= #folded - #upper or recs[1] ~= 250 then
+    return fail("pattern anchor")
+  end
+
+  recs, lines = ds.grep("DD:DSIN", "IEF450I", { lines = false })
+  if not recs or lines ~= nil or #recs ~= #upper then
+    return fail("lines=false")
+  end
+  recs, lines = ds.grep("DD:DSIN", "NOSUCHTEXT")
+  if not recs or #recs ~= 0 or #lines ~= 0 then
+    return fail("no hits")
+  end
+
+  local code
+  recs, msg, code = ds.grep("DD:DSIN", "x", { pattern = true,
+    ignorecase = true })
+  if recs ~= nil or code ~= 30006 then
+    return fail("pattern with ignorecase accepted")
+  end
+  recs, msg, code = ds.grep("DD:DSIN", "x", { max = 0 })
+  if recs ~= nil or code ~= 30006 then
+    return fail("max=0 accepted")
+  end
+  recs, msg, code = ds.grep("DD:DSIN", "[A", { pattern = true })
+  if recs ~= nil or code ~= 30006 then
+    return fail("malformed pattern accepted")
+  end
+  recs, msg, code = ds.grep("DD:NODD", "x")
+  if recs ~= nil or code ~= 30006 then
+    return fail("missing input accepted")
+  end
+
+  print("LUZ00004 DS GREP UT OK")
+  return 0
+end
+
+return main()
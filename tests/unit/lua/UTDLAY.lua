@@ -0,0 +1,68 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.layout fixed-position field extraction unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | main | function | Validate ds.layout, layout:decode, handle:fields |
+local ds = require("ds")
+
+local function fail(msg)
+  print("LUZ00005 DS UT failed: " .. msg)
+  return 8
+end
+
+local function main()
+  local lay = ds.layout({
+    { name = "key", pos = 1, len = 8 },
+    { name = "date", pos = 9, len = 8, type = "number" },
+    { name = "amt", pos = 18, len = 9, type = "number" },
+    { name = "name", pos = 29, len = 10, trim = true },
+  })
+  if #lay ~= 4 or lay:names()[4] ~= "name" then
+    return fail("layout field list")
+  end
+
+  local key, date, amt, name = lay:decode("K000000120261017      -125  ALPHA     ")
+  if key ~= "K0000001" or date ~= 20261017 or amt ~= -125 or name ~= "ALPHA" then
+    return fail("decode values")
+  end
+  local t = {}
+  if lay:decode("K2", t) ~= t or t.key ~= "K2" or t.date ~= nil or t.name ~= "" then
+    return fail("decode short record into table")
+  end
+  if pcall(ds.layout, { { name = "x", pos = 0, len = 1 } }) then
+    return fail("invalid pos accepted")
+  end
+
+  local h, msg = ds.open_dd("DSIN", { mode = "r", type = "record" })
+  if not h then
+    return fail(msg or "open DSIN")
+  end
+  local total, count = 0, 0
+  while h:fields(lay, t) do
+    total = total + t.amt
+    count = count + 1
+  end
+  h:close()
+  if count ~= 3 or total ~= 600 or t.name ~= "GAMMA" then
+    return fail("handle:fields DSIN")
+  end
+
+  h, msg = ds.open_dd("DSIN", "r")
+  if not h then
+    return fail(msg or "reopen DSIN")
+  end
+  key, date, amt, name = h:fields(lay)
+  h:close()
+  if key ~= "K0000001" or date ~= 20261017 or amt ~= 100 or name ~= "ALPHA" then
+    return fail("handle:fields values")
+  end
+
+  print("LUZ00004 DS UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,78 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.members directory enumeration unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | names | function | Join a member list for comparison |
+-- | main | function | Validate lists, patterns, stats, concatenation, iterator |
+local ds = require("ds")
+
+local function fail(msg)
+  print("LUZ00005 DS MEMBERS UT failed: " .. msg)
+  return 8
+end
+
+local function names(list)
+  local out = {}
+  for i, m in ipairs(list) do
+    out[i] = type(m) == "table" and (m.name .. ":" .. m.lib) or m
+  end
+  return table.concat(out, ",")
+end
+
+local function main()
+  local list, msg, code = ds.members("DD:PDS1")
+  if not list or names(list) ~= "ALPHA,BETA" then
+    return fail("list " .. tostring(list and names(list) or msg))
+  end
+  list = ds.members("DD:PDS1", { pattern = "al*" })
+  if not list or names(list) ~= "ALPHA" then
+    return fail("pattern")
+  end
+  list = ds.members("DD:PDS1", { pattern = "%ETA" })
+  if not list or names(list) ~= "BETA" then
+    return fail("pattern %")
+  end
+
+  -- IEBGENER writes no ISPF statistics: names, alias flag and library only.
+  list = ds.members("DD:PDS1", { stats = true })
+  if not list or #list ~= 2 or list[1].name ~= "ALPHA" or list[1].alias or
+      list[1].version ~= nil then
+    return fail("stats")
+  end
+
+  -- Concatenation: BETA of the third library is hidden by the first; the
+  -- empty second library still counts.
+  list = ds.members("DD:LIB", { stats = true })
+  if not list or names(list) ~= "ALPHA:1,BETA:1,GAMMA:3" then
+    return fail("concatenation " .. tostring(list and names(list)))
+  end
+
+  local n = 0
+  for name in ds.members("DD:LIB", { iter = true }) do
+    n = n + 1
+    if type(name) ~= "string" then
+      return fail("iterator value")
+    end
+  end
+  if n ~= 3 then
+    return fail("iterator count " .. n)
+  end
+
+  list, msg, code = ds.members("DD:PDS1", { pattern = 1 })
+  if list ~= nil or code ~= 30006 then
+    return fail("invalid options accepted")
+  end
+  list, msg, code = ds.members("DD:NODD")
+  if list ~= nil or code ~= 30006 then
+    return fail("missing DD accepted")
+  end
+
+  print("LUZ00004 DS MEMBERS UT OK")
+  return 0
+end
+
+return main()
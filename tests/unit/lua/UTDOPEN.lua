@@ -6,7 +6,7 @@
 -- | Object | Kind | Purpose |
 -- |--------|------|---------|
 -- | fail | function | Emit LUZ00005 and return RC 8 |
--- | main | function | Validate ds.open_dd read/write |
+-- | main | function | Validate ds.open_dd read/write, read/write formats and open cache |
 local ds = require("ds")
 
 local function rstrip(value)
@@ -37,6 +37,61 @@ local function main()
     return fail(cerr or "close DSIN")
   end
 
+  h, msg = ds.open_dd("DSIN", { mode = "r", bufsize = 65536, buffering = "full" })
+  if not h then
+    return fail(msg or "open DSIN bufsize")
+  end
+  line = h:readline()
+  h:close()
+  if not line or rstrip(line) ~= "HELLO" then
+    return fail("read DSIN bufsize mismatch")
+  end
+  if ds.open_dd("DSIN", { mode = "r", buffering = "sometimes" }) ~= nil then
+    return fail("invalid buffering accepted")
+  end
+
+  h, msg = ds.open_dd("DSIN", { mode = "r", readahead = 2 })
+  if not h then
+    return fail(msg or "open DSIN readahead")
+  end
+  line = h:readline()
+  h:close()
+  if not line or rstrip(line) ~= "HELLO" then
+    return fail("read DSIN readahead mismatch")
+  end
+  h, msg = ds.open_dd("DSIN", { mode = "r", type = "record", readahead = 2 })
+  if h ~= nil or msg ~= "LUZ30006 ds.open_dd invalid option readahead=2" then
+    return fail("readahead accepted on a record handle")
+  end
+  h, msg = ds.open_dd("DSIN", { mode = "r", bufsize = 0 })
+  if h ~= nil or msg ~= "LUZ30006 ds.open_dd invalid option bufsize=0" then
+    return fail("bufsize=0 message " .. tostring(msg))
+  end
+  h, msg = ds.open_dd("DSIN", { mode = "r", encoding = "NOSUCH" })
+  if h ~= nil or msg ~= "LUZ30006 ds.open_dd invalid option encoding=NOSUCH" then
+    return fail("encoding message " .. tostring(msg))
+  end
+  h, msg = ds.open_dd("DSIN", "x")
+  if h ~= nil or msg ~= "LUZ30006 ds.open_dd invalid option mode=x" then
+    return fail("mode message " .. tostring(msg))
+  end
+
+  local data = ds.slurp("DD:DSIN", { size = 4096 })
+  if not data or rstrip(data) ~= "HELLO" then
+    return fail("ds.slurp DSIN mismatch")
+  end
+
+  local before = ds.openstats()
+  h, msg = ds.open_dd("DSIN", "r")
+  if not h then
+    return fail(msg or "reopen DSIN")
+  end
+  h:close()
+  local after = ds.openstats()
+  if after.hits ~= before.hits + 1 or after.probes ~= before.probes + 1 then
+    return fail("reopen DSIN did not use the open cache")
+  end
+
   h, msg = ds.open_dd("DSOUT", { mode = "w" })
   if not h then
     return fail(msg or "open DSOUT write")
@@ -69,6 +124,27 @@ local function main()
     return fail(cerr or "close DSOUT")
   end
 
+  h, msg = ds.open_dd("DSOUT", { mode = "w" })
+  if not h then
+    return fail(msg or "open DSOUT write")
+  end
+  if h:write("WOR", "LD", "\n") ~= h then
+    h:close()
+    return fail("write(...) DSOUT")
+  end
+  h:close()
+
+  h, msg = ds.open_dd("DSOUT", { mode = "r" })
+  if not h then
+    return fail(msg or "open DSOUT read all")
+  end
+  local all = h:read("a")
+  local tail = h:read("a")
+  h:close()
+  if not all or rstrip(all) ~= "WORLD" or tail ~= "" then
+    return fail("read(\"a\") DSOUT mismatch")
+  end
+
   print("LUZ00004 DS UT OK")
   return 0
 end
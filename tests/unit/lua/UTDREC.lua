@@ -0,0 +1,94 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds handle batch record API unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | main | function | Validate read_records/write_records and their edges |
+local ds = require("ds")
+
+local function rstrip(value)
+  return (value:gsub("%s+$", ""))
+end
+
+local function fail(msg)
+  print("LUZ00005 DS UT failed: " .. msg)
+  return 8
+end
+
+local function main()
+  local h, msg = ds.open_dd("DSIN", { mode = "r", type = "record" })
+  if not h then
+    return fail(msg or "open DSIN")
+  end
+  local t, n = h:read_records(3)
+  if not t or n ~= 3 or #t[1] ~= 80 or rstrip(t[3]) ~= "REC3" then
+    h:close()
+    return fail("read_records(3) DSIN")
+  end
+  t, n = h:read_records(100)
+  if not t or n ~= 2 or rstrip(t[2]) ~= "REC5" then
+    h:close()
+    return fail("read_records(100) DSIN")
+  end
+  if h:read_records(10) ~= nil then
+    h:close()
+    return fail("read_records at EOF")
+  end
+  h:close()
+
+  local recs = { "A", "BB", "CCC", "DDDD" }
+  h, msg = ds.open_dd("DSOUT", { mode = "w", type = "record" })
+  if not h then
+    return fail(msg or "open DSOUT write")
+  end
+  local count, err = h:write_records(recs, 2, 4)
+  if count ~= 3 then
+    h:close()
+    return fail(err or "write_records DSOUT")
+  end
+  h:close()
+
+  h, msg = ds.open_dd("DSOUT", { mode = "r", type = "record" })
+  if not h then
+    return fail(msg or "open DSOUT read")
+  end
+  t, n = h:read_records(10)
+  h:close()
+  if not t or n ~= 3 or t[1] ~= "BB" or t[3] ~= "DDDD" then
+    return fail("DSOUT records mismatch")
+  end
+
+  -- j may be math.maxinteger; an empty string is one blank record.
+  local m = math.maxinteger
+  h, msg = ds.open_dd("DSOUT", { mode = "w", type = "record" })
+  if not h then
+    return fail(msg or "open DSOUT rewrite")
+  end
+  count, err = h:write_records({ [m - 2] = "\x41\x42", [m - 1] = "",
+    [m] = "\xFF" }, m - 2, m)
+  h:close()
+  if count ~= 3 then
+    return fail(err or "write_records up to math.maxinteger")
+  end
+
+  -- 0xFF is not UTF-8: the two records before it come back with the error.
+  h, msg = ds.open_dd("DSOUT", { mode = "r", type = "record",
+    encoding = "UTF-8", internal = "ISO8859-1" })
+  if not h then
+    return fail(msg or "open DSOUT UTF-8")
+  end
+  local code
+  t, n, msg, code = h:read_records(10)
+  h:close()
+  if not t or n ~= 2 or t[1] ~= "AB" or #t[2] ~= 1 or code ~= 30058 then
+    return fail("partial read_records " .. tostring(msg))
+  end
+
+  print("LUZ00004 DS UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,130 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.sort external merge sort unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | fill | function | Write the FB20 input records |
+-- | sorted | function | Check the order of the output records |
+-- | main | function | Validate in-memory, spilled and in-place sorts |
+local ds = require("ds")
+
+local COUNT = 50000
+
+local function fail(msg)
+  print("LUZ00005 DS SORT UT failed: " .. msg)
+  return 8
+end
+
+-- Record: 6-digit key (many duplicates), 8-digit sequence, filler.
+local function fill()
+  local h, msg = ds.open_dd("DSIN", { mode = "w", type = "record" })
+  if not h then
+    return nil, msg
+  end
+  local batch = {}
+  for i = 1, COUNT do
+    batch[#batch + 1] = string.format("%06d%08d%s", (i * 7919) % 1000, i,
+      "XXXXXX")
+    if #batch == 1000 then
+      h:write_records(batch)
+      batch = {}
+    end
+  end
+  h:write_records(batch)
+  h:close()
+  return true
+end
+
+-- before(a, b) is true when a may precede b.
+local function sorted(dd, before)
+  local h = ds.open_dd(dd, { mode = "r", type = "record" })
+  if not h then
+    return nil
+  end
+  local n, prev = 0, nil
+  for rec in h:lines() do
+    if prev and not before(prev, rec) then
+      h:close()
+      return nil
+    end
+    prev = rec
+    n = n + 1
+  end
+  h:close()
+  return n
+end
+
+local function asc_stable(a, b)
+  local ka, kb = a:sub(1, 6), b:sub(1, 6)
+  return ka < kb or (ka == kb and a:sub(7, 14) < b:sub(7, 14))
+end
+
+local function main()
+  local ok, msg = fill()
+  if not ok then
+    return fail(msg or "fill DSIN")
+  end
+
+  local n, runs = ds.sort{ input = "DD:DSIN", output = "DD:DSOUT",
+    keys = { { pos = 1, len = 6 } } }
+  if n ~= COUNT or runs ~= 0 then
+    return fail("in-memory sort " .. tostring(n) .. "/" .. tostring(runs))
+  end
+  if sorted("DSOUT", asc_stable) ~= COUNT then
+    return fail("in-memory order")
+  end
+
+  n, runs = ds.sort{ input = "DD:DSIN", output = "DD:DSOUT",
+    keys = { { pos = 1, len = 6, order = "D" }, { pos = 7, len = 8 } },
+    memory = 1048576 }
+  if n ~= COUNT or not runs or runs < 2 then
+    return fail("spilled sort " .. tostring(n) .. "/" .. tostring(runs))
+  end
+  if sorted("DSOUT", function(a, b)
+        local ka, kb = a:sub(1, 6), b:sub(1, 6)
+        return ka > kb or (ka == kb and a:sub(7, 14) < b:sub(7, 14))
+      end) ~= COUNT then
+    return fail("spilled order")
+  end
+
+  n = ds.sort{ input = "DD:DSOUT", output = "DD:DSOUT",
+    keys = { { pos = 7, len = 8 } } }
+  if n ~= COUNT or sorted("DSOUT", function(a, b)
+        return a:sub(7, 14) < b:sub(7, 14)
+      end) ~= COUNT then
+    return fail("in-place sort")
+  end
+
+  local code
+  n, msg, code = ds.sort{ input = "DD:DSIN", output = "DD:DSOUT", keys = {} }
+  if n ~= nil or code ~= 30006 then
+    return fail("empty keys accepted")
+  end
+  n, msg, code = ds.sort{ input = "DD:DSIN", output = "DD:DSOUT",
+    keys = { { pos = 1, len = 6, order = "X" } } }
+  if n ~= nil or code ~= 30006 or not msg:find("keys[1]", 1, true) then
+    return fail("bad order accepted")
+  end
+  n, msg, code = ds.sort{ input = "DD:DSIN", keys = { { pos = 1, len = 1 } } }
+  if n ~= nil or code ~= 30006 or not msg:find("output", 1, true) then
+    return fail("missing output accepted")
+  end
+  n, msg, code = ds.sort{ input = "DD:DSIN", output = "DD:DSOUT",
+    keys = { { pos = 1, len = 1 } }, memory = 1 }
+  if n ~= nil or code ~= 30006 or not msg:find("memory", 1, true) then
+    return fail("bad memory accepted")
+  end
+  n, msg, code = ds.sort{ input = "DD:NODD", output = "DD:DSOUT",
+    keys = { { pos = 1, len = 1 } } }
+  if n ~= nil or code ~= 30006 then
+    return fail("missing input accepted")
+  end
+
+  print("LUZ00004 DS SORT UT OK")
+  return 0
+end
+
+return main()
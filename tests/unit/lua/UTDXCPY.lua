@@ -0,0 +1,108 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO ds.copy dataset-to-dataset copy unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00005 and return RC 8 |
+-- | records | function | Read all records of a DD |
+-- | main | function | Validate ds.copy modes and close failures |
+local ds = require("ds")
+
+local function fail(msg)
+  print("LUZ00005 DS UT failed: " .. msg)
+  return 8
+end
+
+local function records(dd)
+  local h, msg = ds.open_dd(dd, { mode = "r", type = "record" })
+  if not h then
+    return nil, msg
+  end
+  local t = h:read_records(100) or {}
+  h:close()
+  return t
+end
+
+local function main()
+  -- DSIN is FB20, DSOUT is VB84.
+  local h, msg = ds.open_dd("DSIN", { mode = "w", type = "record" })
+  if not h then
+    return fail(msg or "open DSIN write")
+  end
+  local pad = string.rep(" ", 20)
+  h:write_records({ ("AAA" .. pad):sub(1, 20), ("BBBBB" .. pad):sub(1, 20),
+    ("C" .. pad):sub(1, 20) })
+  h:close()
+
+  local n, bytes = ds.copy("DD:DSIN", "DD:DSOUT", { trim = true })
+  if n ~= 3 or bytes ~= 9 then
+    return fail("copy FB to VB with trim " .. tostring(bytes))
+  end
+  local t = records("DSOUT")
+  if not t or #t ~= 3 or t[1] ~= "AAA" or t[2] ~= "BBBBB" then
+    return fail("VB records after trim")
+  end
+
+  n, bytes = ds.copy("DD:DSOUT", "DD:DSIN")
+  t = records("DSIN")
+  if n ~= 3 or bytes ~= 60 or not t or t[3] ~= ("C" .. pad):sub(1, 20) then
+    return fail("copy VB to FB pads to LRECL")
+  end
+
+  n, bytes = ds.copy("DD:DSIN", "DD:DSOUT", { lrecl = 10, truncate = true,
+    mode = "a" })
+  t = records("DSOUT")
+  if n ~= 3 or bytes ~= 30 or not t or #t ~= 6 or #t[4] ~= 10 then
+    return fail("append with lrecl and truncate")
+  end
+
+  n, msg = ds.copy("DD:DSOUT", "DD:DSIN", { lrecl = 4 })
+  if n ~= nil or not tostring(msg):find("LUZ30008", 1, true) then
+    return fail("long record accepted without truncate")
+  end
+  n = ds.copy("DD:DSOUT", "DD:DSIN", { lrecl = 4, truncate = true })
+  if n ~= 6 then
+    return fail("truncate")
+  end
+
+  -- Transcode: the EBCDIC "AAA" becomes ISO8859-1 and the pad is the
+  -- ISO8859-1 blank; trim first so the 10-byte records fit LRECL 5.
+  n = ds.copy("DD:DSOUT", "DD:DSIN", { from = "IBM-1047", to = "ISO8859-1",
+    lrecl = 5, trim = true })
+  t = records("DSIN")
+  if n ~= 6 or not t or t[1] ~= "\x41\x41\x41\x20\x20" then
+    return fail("transcoded copy")
+  end
+
+  n, bytes = ds.copy("DD:DSOUT", "DD:DSIN", { type = "stream" })
+  if n ~= 6 or bytes == nil then
+    return fail("stream copy")
+  end
+  if ds.copy("DD:DSOUT", "DD:DSIN", { from = "IBM-1047" }) ~= nil then
+    return fail("from without to accepted")
+  end
+
+  -- DSTINY holds two FB80 blocks of 349 records; the third block is
+  -- only written when the target closes, so the failure shows there.
+  h = ds.open_dd("DSBIG", { mode = "w", type = "record" })
+  if not h then
+    return fail("open DSBIG write")
+  end
+  local big = {}
+  for i = 1, 699 do
+    big[i] = string.format("%-80d", i)
+  end
+  h:write_records(big)
+  h:close()
+  n, msg = ds.copy("DD:DSBIG", "DD:DSTINY")
+  if n ~= nil or not tostring(msg):find("LUZ30009", 1, true) then
+    return fail("close failure reported as success " .. tostring(msg))
+  end
+
+  print("LUZ00004 DS UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,53 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO require negative-lookup cache unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00003 and return RC 8 |
+-- | main | function | Validate cached require failures and package.invalidate |
+local function fail(msg)
+  print("LUZ00003 LUAPATH UT failed: " .. msg)
+  return 8
+end
+
+local function main()
+  local i
+  for i = 1, 3 do
+    local ok, err = pcall(require, "absent")
+    if ok or not tostring(err):match("^LUZ47003") then
+      return fail("absent module probe " .. i .. ": " .. tostring(err))
+    end
+  end
+  local ok, err = pcall(require, "missing.long.name")
+  if ok or not tostring(err):match("^LUZ47002") then
+    return fail("missing long name: " .. tostring(err))
+  end
+
+  local stats = package.pathstats()
+  if stats.neg_hits ~= 2 or stats.neg_entries ~= 2 then
+    return fail("neg_hits=" .. tostring(stats.neg_hits) ..
+      " neg_entries=" .. tostring(stats.neg_entries))
+  end
+
+  local present = require("present")
+  if present ~= 7 then
+    return fail("present module value " .. tostring(present))
+  end
+
+  if package.invalidate("absent") ~= 1 then
+    return fail("invalidate(name) count")
+  end
+  if package.invalidate() ~= 1 then
+    return fail("invalidate() count")
+  end
+  if package.pathstats().neg_entries ~= 0 then
+    return fail("entries left after invalidate")
+  end
+
+  print("LUZ00002 LUAPATH NEG UT OK")
+  return 0
+end
+
+return main()
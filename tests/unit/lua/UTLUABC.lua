@@ -0,0 +1,51 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO require bytecode cache (luabc.dd) unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00003 and return RC 8 |
+-- | delta | function | Counter change between two pathstats snapshots |
+-- | main | function | Validate cache write, stale entry and hit |
+local function fail(msg)
+  print("LUZ00003 LUAPATH UT failed: " .. msg)
+  return 8
+end
+
+local function delta(before, after, key)
+  return (after[key] or 0) - (before[key] or 0)
+end
+
+local function main()
+  -- RUN1 sees BCMOD version 1 and an empty cache; RUN2 sees version 2
+  -- with the version 1 entry still cached.
+  local s0 = package.pathstats()
+  local v = require("bcmod")
+  local s1 = package.pathstats()
+  if v ~= 1 and v ~= 2 then
+    return fail("bcmod value " .. tostring(v))
+  end
+  if delta(s0, s1, "bc_hits") ~= 0 or delta(s0, s1, "bc_misses") ~= 1 or
+      delta(s0, s1, "bc_writes") ~= 1 then
+    return fail("first require hits/misses/writes")
+  end
+  if delta(s0, s1, "bc_stale") ~= ((v == 2) and 1 or 0) then
+    return fail("stale count for version " .. v)
+  end
+
+  -- The entry written above is current: the reload skips the parser.
+  package.loaded.bcmod = nil
+  if require("bcmod") ~= v then
+    return fail("cached bcmod value")
+  end
+  local s2 = package.pathstats()
+  if delta(s1, s2, "bc_hits") ~= 1 or delta(s1, s2, "bc_writes") ~= 0 then
+    return fail("cache hit")
+  end
+
+  print("LUZ00002 LUAPATH BC UT OK")
+  return 0
+end
+
+return main()
@@ -0,0 +1,41 @@
+-- Copyright 2026 drblez AKA Ruslan Stepanenko (drblez@gmail.com)
+--
+-- Lua/TSO preload manifest (luapreload.member) unit test via LUACMD.
+--
+-- Object Table:
+-- | Object | Kind | Purpose |
+-- |--------|------|---------|
+-- | fail | function | Emit LUZ00003 and return RC 8 |
+-- | main | function | Validate package.preload entries from the manifest |
+local function fail(msg)
+  print("LUZ00003 LUAPATH UT failed: " .. msg)
+  return 8
+end
+
+local function main()
+  if type(package.preload["prela"]) ~= "function" then
+    return fail("prela not in package.preload")
+  end
+  if type(package.preload["pre.long.name"]) ~= "function" then
+    return fail("pre.long.name not in package.preload")
+  end
+
+  local before = package.pathstats()
+  local a = require("prela")
+  if a ~= "prela|:preload:" then
+    return fail("prela value " .. tostring(a))
+  end
+  local c = require("pre.long.name")
+  if type(c) ~= "table" or c.n ~= 3 then
+    return fail("pre.long.name value " .. tostring(c))
+  end
+  local after = package.pathstats()
+  if after.luamap_lookups ~= before.luamap_lookups then
+    return fail("require looked up LUAMAP after preload")
+  end
+
+  print("LUZ00002 LUAPATH PRELOAD UT OK")
+  return 0
+end
+
+return main()